@@ -85,9 +85,12 @@ void PhysicsStressTest::CreateScene()
     // Create octree, use default volume (-1000, -1000, -1000) to (1000, 1000, 1000)
     // Create a physics simulation world with default parameters, which will update at 60fps. Like the Octree must
     // exist before creating drawable components, the PhysicsWorld must exist before creating physics components.
-    // Finally, create a DebugRenderer component so that we can draw physics debug geometry
+    // The world is multithreaded to run the simulation of the many bodies on the worker threads. Finally, create a
+    // DebugRenderer component so that we can draw physics debug geometry
     scene_->CreateComponent<Octree>();
+    PhysicsWorld::config.multiThreaded_ = true;
     scene_->CreateComponent<PhysicsWorld>();
+    PhysicsWorld::config.multiThreaded_ = false;
     scene_->CreateComponent<DebugRenderer>();
 
     // Create a Zone component for ambient lighting & fog control
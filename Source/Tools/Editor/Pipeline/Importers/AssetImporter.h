@@ -67,6 +67,8 @@ public:
     void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const override;
     ///
     void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override;
+    /// Attribute access is customized, so direct serialization is disabled.
+    bool IsDirectAttributeSerializationEnabled() const override { return false; }
     /// Returns a list of known byproduct resource names.
     const StringVector& GetByproducts() const { return byproducts_; }
     /// Implements inheritance of default importer settings.
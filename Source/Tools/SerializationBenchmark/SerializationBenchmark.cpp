@@ -0,0 +1,232 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/ArchiveSerialization.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/Scene.h>
+
+using namespace Urho3D;
+
+/// Compares attribute serialization through Variant with direct typed accessors on binary archives.
+class BenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(BenchmarkApplication, Application);
+public:
+    explicit BenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+
+        auto& app = GetCommandLineParser();
+        app.add_option("-n,--nodes", numNodes_, "Number of nodes in the test scene.")->set_default_str("10000");
+        app.add_option("-i,--iterations", numIterations_, "Number of iterations of each test.")->set_default_str("10");
+    }
+
+    void Start() override
+    {
+        CreateScene();
+
+        // Gather objects the same way scene serialization visits them
+        serializables_.push_back(scene_);
+        for (Node* node : scene_->GetChildren(true))
+        {
+            serializables_.push_back(node);
+            for (Component* component : node->GetComponents())
+                serializables_.push_back(component);
+        }
+
+        unsigned numAttributes = 0;
+        unsigned numDirectAttributes = 0;
+        for (Serializable* serializable : serializables_)
+        {
+            for (const AttributeInfo& attr : *serializable->GetAttributes())
+            {
+                if (!attr.ShouldSave())
+                    continue;
+                ++numAttributes;
+                if (IsDirect(serializable, attr))
+                    ++numDirectAttributes;
+            }
+        }
+
+        PrintLine(Format("{} objects, {} attributes, {} serialized directly", serializables_.size(), numAttributes, numDirectAttributes));
+
+        VectorBuffer variantData;
+        VectorBuffer directData;
+        const long long variantSave = Measure([&] { variantData.Clear(); SaveAttributes(variantData, false); });
+        const long long directSave = Measure([&] { directData.Clear(); SaveAttributes(directData, true); });
+        const long long variantLoad = Measure([&] { LoadAttributes(variantData, false); });
+        const long long directLoad = Measure([&] { LoadAttributes(directData, true); });
+
+        VectorBuffer sceneData;
+        const long long sceneSave = Measure([&]
+        {
+            sceneData.Clear();
+            BinaryOutputArchive archive(context_, sceneData);
+            scene_->Serialize(archive);
+        });
+        const long long sceneLoad = Measure([&]
+        {
+            sceneData.Seek(0);
+            BinaryInputArchive archive(context_, sceneData);
+            scene_->Serialize(archive);
+        });
+
+        if (variantData.GetBuffer() != directData.GetBuffer())
+            PrintLine("Direct and Variant serialization produced different data!", true);
+
+        PrintLine(Format("Save through Variant: {} us", variantSave));
+        PrintLine(Format("Save direct:          {} us", directSave));
+        PrintLine(Format("Load through Variant: {} us", variantLoad));
+        PrintLine(Format("Load direct:          {} us", directLoad));
+        PrintLine(Format("Scene save:           {} us", sceneSave));
+        PrintLine(Format("Scene load:           {} us", sceneLoad));
+
+        engine_->Exit();
+    }
+
+private:
+    /// Create the test scene.
+    void CreateScene()
+    {
+        scene_ = MakeShared<Scene>(context_);
+        scene_->CreateComponent<Octree>();
+
+        for (unsigned i = 0; i < numNodes_; ++i)
+        {
+            Node* node = scene_->CreateChild(Format("Node{}", i));
+            node->SetPosition(Vector3(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)));
+            node->SetRotation(Quaternion(static_cast<float>(i), Vector3::UP));
+            node->CreateComponent<StaticModel>();
+            if (i % 4 == 0)
+                node->CreateComponent<Light>();
+        }
+    }
+
+    /// Return whether the attribute is serialized directly.
+    bool IsDirect(Serializable* serializable, const AttributeInfo& attr) const
+    {
+        return !attr.enumNames_ && attr.accessor_ && attr.accessor_->IsDirectSerializable()
+            && serializable->IsDirectAttributeSerializationEnabled();
+    }
+
+    /// Return average duration of the function in microseconds.
+    template <class T> long long Measure(T function)
+    {
+        HiresTimer timer;
+        for (unsigned i = 0; i < numIterations_; ++i)
+            function();
+        return timer.GetUSec(false) / ea::max(numIterations_, 1u);
+    }
+
+    /// Save attribute values of all objects.
+    void SaveAttributes(VectorBuffer& dest, bool direct)
+    {
+        BinaryOutputArchive archive(context_, dest);
+        if (auto block = archive.OpenSequentialBlock("attributes"))
+        {
+            Variant value;
+            for (Serializable* serializable : serializables_)
+            {
+                for (const AttributeInfo& attr : *serializable->GetAttributes())
+                {
+                    if (!attr.ShouldSave())
+                        continue;
+
+                    if (direct && IsDirect(serializable, attr))
+                        attr.accessor_->SerializeDirect(serializable, archive, "attribute");
+                    else if (attr.enumNames_)
+                    {
+                        serializable->OnGetAttribute(attr, value);
+                        int enumValue = value.GetInt();
+                        SerializeValue(archive, "attribute", enumValue);
+                    }
+                    else
+                    {
+                        serializable->OnGetAttribute(attr, value);
+                        SerializeVariantValue(archive, attr.type_, "attribute", value);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Load attribute values of all objects.
+    void LoadAttributes(VectorBuffer& source, bool direct)
+    {
+        source.Seek(0);
+        BinaryInputArchive archive(context_, source);
+        if (auto block = archive.OpenSequentialBlock("attributes"))
+        {
+            for (Serializable* serializable : serializables_)
+            {
+                for (const AttributeInfo& attr : *serializable->GetAttributes())
+                {
+                    if (!attr.ShouldSave())
+                        continue;
+
+                    if (direct && IsDirect(serializable, attr))
+                        attr.accessor_->SerializeDirect(serializable, archive, "attribute");
+                    else if (attr.enumNames_)
+                    {
+                        int enumValue{};
+                        SerializeValue(archive, "attribute", enumValue);
+                        serializable->OnSetAttribute(attr, enumValue);
+                    }
+                    else
+                    {
+                        Variant value = attr.type_ == VAR_CUSTOM ? attr.defaultValue_ : Variant::EMPTY;
+                        SerializeVariantValue(archive, attr.type_, "attribute", value);
+                        serializable->OnSetAttribute(attr, value);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Number of nodes.
+    unsigned numNodes_{10000};
+    /// Number of iterations.
+    unsigned numIterations_{10};
+    /// Test scene.
+    SharedPtr<Scene> scene_;
+    /// Objects of the test scene.
+    ea::vector<Serializable*> serializables_;
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(BenchmarkApplication);
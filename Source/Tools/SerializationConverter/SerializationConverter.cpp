@@ -59,8 +59,8 @@ public:
 
         auto& app = GetCommandLineParser();
         app.add_option("-t,--type", type_, "Name of type that handles serialization of specified files.")->required();
-        app.add_option("-i,--input-type", inputType_, "Serialization format of input file.")->set_default_str("old");
-        app.add_option("-o,--output-type", outputType_, "Serialization format of output file.")-> set_default_str("new");
+        app.add_option("-i,--input-type", inputType_, "Serialization format of input file (old/new/snapshot).")->set_default_str("old");
+        app.add_option("-o,--output-type", outputType_, "Serialization format of output file (old/new/snapshot).")-> set_default_str("new");
         app.add_option("input", input_, "Input file (xml/json/binary).")->required();
         app.add_option("output", output_, "Output file (xml/json/binary).")->required();
     }
@@ -123,6 +123,11 @@ public:
                     BinaryInputArchive archive(context_, file);
                     loaded = converter->Serialize(archive);
                 }
+                else if (inputType_ == "snapshot" && converter->GetTypeName() == "Scene")
+                {
+                    file.Close();
+                    loaded = StaticCast<Scene>(converter)->LoadSnapshot(input_);
+                }
             }
 
             if (!loaded)
@@ -190,6 +195,13 @@ public:
                     BinaryOutputArchive archive(context_, file);
                     saved = converter->Serialize(archive);
                 }
+                else if (outputType_ == "snapshot")
+                {
+                    if (converter->GetTypeName() == "Scene")
+                        saved = StaticCast<Scene>(converter)->SaveSnapshot(file);
+                    else
+                        PrintLine("Snapshots are supported for 'Scene' type only.", true);
+                }
             }
         } while (false);
 
@@ -56,6 +56,7 @@ enum AttributeMode
 };
 URHO3D_FLAGSET(AttributeMode, AttributeModeFlags);
 
+class Archive;
 class Serializable;
 
 /// Abstract base class for invoking attribute accessors.
@@ -68,6 +69,10 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+    /// Return whether the attribute can be serialized directly to and from binary archives.
+    virtual bool IsDirectSerializable() const { return false; }
+    /// Serialize the attribute directly between the object and the archive, bypassing Variant. Produces the same data as serializing the Variant value. Return false on error.
+    virtual bool SerializeDirect(Serializable* ptr, Archive& archive, const char* name) { return false; }
 };
 
 /// Description of an automatically serializable variable.
@@ -40,24 +40,80 @@ URHO3D_EVENT(E_UPDATE, Update)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Application-wide logic update event payload.
+struct UpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_UPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[Update::P_TIMESTEP] = timeStep_; }
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[Update::P_TIMESTEP].GetFloat(); }
+
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Application-wide logic post-update event.
 URHO3D_EVENT(E_POSTUPDATE, PostUpdate)
 {
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Application-wide logic post-update event payload.
+struct PostUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_POSTUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[PostUpdate::P_TIMESTEP] = timeStep_; }
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[PostUpdate::P_TIMESTEP].GetFloat(); }
+
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Render update event.
 URHO3D_EVENT(E_RENDERUPDATE, RenderUpdate)
 {
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Render update event payload.
+struct RenderUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_RENDERUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[RenderUpdate::P_TIMESTEP] = timeStep_; }
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[RenderUpdate::P_TIMESTEP].GetFloat(); }
+
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Post-render update event.
 URHO3D_EVENT(E_POSTRENDERUPDATE, PostRenderUpdate)
 {
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Post-render update event payload.
+struct PostRenderUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_POSTRENDERUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const { eventData[PostRenderUpdate::P_TIMESTEP] = timeStep_; }
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData) { timeStep_ = eventData[PostRenderUpdate::P_TIMESTEP].GetFloat(); }
+
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Frame end event.
 URHO3D_EVENT(E_ENDFRAME, EndFrame)
 {
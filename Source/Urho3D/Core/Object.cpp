@@ -97,38 +97,54 @@ void Object::OnEvent(Object* sender, StringHash eventType, VariantMap& eventData
 
     // Make a copy of the context pointer in case the object is destroyed during event handler invocation
     Context* context = context_;
-    EventHandler* specific = nullptr;
-    EventHandler* nonSpecific = nullptr;
+    EventHandler* handler = GetEventHandlerToInvoke(sender, eventType);
+    if (handler)
+    {
+        context->SetEventHandler(handler);
+        handler->Invoke(eventData);
+        context->SetEventHandler(nullptr);
+    }
+}
 
-    for (auto& handler : eventHandlers_)
+void Object::OnTypedEvent(Object* sender, StringHash eventType, TypedEventArgs& args)
+{
+    if (blockEvents_)
+        return;
+
+    Context* context = context_;
+    EventHandler* handler = GetEventHandlerToInvoke(sender, eventType);
+    if (handler)
     {
-        if (handler.GetEventType() == eventType)
+        context->SetEventHandler(handler);
+        if (!handler->InvokeTyped(args.args_))
         {
-            if (!handler.GetSender())
-                nonSpecific = &handler;
-            else if (handler.GetSender() == sender)
+            // Fill event data once for all VariantMap handlers
+            if (!args.eventDataFilled_)
             {
-                specific = &handler;
-                break;
+                args.toVariantMap_(args.args_, *args.eventData_);
+                args.eventDataFilled_ = true;
             }
+            handler->Invoke(*args.eventData_);
         }
-    }
-
-    // Specific event handlers have priority, so if found, invoke first
-    if (specific)
-    {
-        context->SetEventHandler(specific);
-        specific->Invoke(eventData);
         context->SetEventHandler(nullptr);
-        return;
     }
+}
 
-    if (nonSpecific)
+EventHandler* Object::GetEventHandlerToInvoke(Object* sender, StringHash eventType)
+{
+    EventHandler* nonSpecific = nullptr;
+    for (auto& handler : eventHandlers_)
     {
-        context->SetEventHandler(nonSpecific);
-        nonSpecific->Invoke(eventData);
-        context->SetEventHandler(nullptr);
+        if (handler.GetEventType() == eventType)
+        {
+            // Specific event handlers have priority
+            if (!handler.GetSender())
+                nonSpecific = &handler;
+            else if (handler.GetSender() == sender)
+                return &handler;
+        }
     }
+    return nonSpecific;
 }
 
 bool Object::Serialize(Archive& /*archive*/)
@@ -314,15 +330,25 @@ void Object::SendEvent(StringHash eventType)
 
 void Object::SendEvent(StringHash eventType, VariantMap& eventData)
 {
-    if (!Thread::IsMainThread())
-    {
-        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+    if (!CanSendEvents())
         return;
-    }
 
-    if (blockEvents_)
+    SendEventToReceivers(eventType, eventData, nullptr);
+}
+
+void Object::SendTypedEvent(StringHash eventType, TypedEventArgs& args)
+{
+    if (!CanSendEvents())
         return;
 
+    // Take the event data map before the send begins, so that it is not shared with events sent by the handlers
+    VariantMap& eventData = GetEventDataMap();
+    args.eventData_ = &eventData;
+    SendEventToReceivers(eventType, eventData, &args);
+}
+
+void Object::SendEventToReceivers(StringHash eventType, VariantMap& eventData, TypedEventArgs* typedArgs)
+{
 #if URHO3D_PROFILING
     URHO3D_PROFILE_C("SendEvent", PROFILER_COLOR_EVENTS);
     const auto& eventName = GetEventNameRegister().GetString(eventType);
@@ -350,7 +376,10 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             if (!receiver)
                 continue;
 
-            receiver->OnEvent(this, eventType, eventData);
+            if (typedArgs)
+                receiver->OnTypedEvent(this, eventType, *typedArgs);
+            else
+                receiver->OnEvent(this, eventType, eventData);
 
             // If self has been destroyed as a result of event handling, exit
             if (self.Expired())
@@ -378,7 +407,10 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
             if (!receiver || (group && group->receivers_.contains(receiver)))
                 continue;
 
-            receiver->OnEvent(this, eventType, eventData);
+            if (typedArgs)
+                receiver->OnTypedEvent(this, eventType, *typedArgs);
+            else
+                receiver->OnEvent(this, eventType, eventData);
 
             if (self.Expired())
             {
@@ -394,6 +426,17 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     context->EndSendEvent();
 }
 
+bool Object::CanSendEvents() const
+{
+    if (!Thread::IsMainThread())
+    {
+        URHO3D_LOGERROR("Sending events is only supported from the main thread");
+        return false;
+    }
+
+    return !blockEvents_;
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
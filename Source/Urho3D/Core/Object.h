@@ -38,6 +38,7 @@ namespace Urho3D
 class Archive;
 class Context;
 class EventHandler;
+class Object;
 class Engine;
 class Time;
 class WorkQueue;
@@ -109,6 +110,20 @@ private:
         static const ea::string& GetTypeNameStatic() { return GetTypeInfoStatic()->GetTypeName(); } \
         static const Urho3D::TypeInfo* GetTypeInfoStatic() { static const Urho3D::TypeInfo typeInfoStatic(#typeName, BaseClassName::GetTypeInfoStatic()); return &typeInfoStatic; }
 
+/// Typed event payload being sent. Event data for VariantMap handlers is filled from the payload on first use.
+/// @nobind
+struct TypedEventArgs
+{
+    /// Payload.
+    void* args_{};
+    /// Fill event data from the payload.
+    void (*toVariantMap_)(const void* args, VariantMap& eventData){};
+    /// Event data for VariantMap handlers.
+    VariantMap* eventData_{};
+    /// Whether event data has been filled.
+    bool eventDataFilled_{};
+};
+
 /// Base class for objects with type identification, subsystem access and event sending/receiving capability.
 /// @templateversion
 class URHO3D_API Object : public RefCounted
@@ -162,6 +177,15 @@ public:
     /// Subscribe to a specific sender's event.
     template<typename T>
     void SubscribeToEvent(Object* sender, StringHash eventType, void(T::*handler)(StringHash, VariantMap&));
+    /// Subscribe to a typed event that can be sent by any sender. Typed handlers receive the payload struct without VariantMap conversion.
+    template <class T, class Receiver, class = decltype(T::GetEventType())>
+    void SubscribeToEvent(void(Receiver::*handler)(Object*, T&));
+    /// Subscribe to a specific sender's typed event.
+    template <class T, class Receiver, class = decltype(T::GetEventType())>
+    void SubscribeToEvent(Object* sender, void(Receiver::*handler)(T&));
+    /// Unsubscribe from a typed event, including the subscriptions to specific senders.
+    template <class T, class = decltype(T::GetEventType())>
+    void UnsubscribeFromEvent();
     /// Unsubscribe from an event.
     void UnsubscribeFromEvent(StringHash eventType);
     /// Unsubscribe from a specific sender's event.
@@ -180,6 +204,9 @@ public:
     void SendEvent(StringHash eventType, VariantMap& eventData);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap() const;
+    /// Send typed event to all subscribers. Event data is filled from the payload only if a VariantMap subscriber receives it.
+    template <class T, class = decltype(T::GetEventType())>
+    void SendEvent(T& args);
     /// Send event with variadic parameter pairs to all subscribers. The parameter pairs is a list of paramID and paramValue separated by comma, one pair after another.
     template <typename... Args> void SendEvent(StringHash eventType, Args... args)
     {
@@ -245,6 +272,16 @@ private:
     ea::intrusive_list<EventHandler>::iterator EraseEventHandler(ea::intrusive_list<EventHandler>::iterator handlerIter);
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Return the handler to invoke for an event: the specific handler of the sender if any, otherwise the non-specific one.
+    EventHandler* GetEventHandlerToInvoke(Object* sender, StringHash eventType);
+    /// Handle event sent with typed payload.
+    void OnTypedEvent(Object* sender, StringHash eventType, TypedEventArgs& args);
+    /// Send typed event to all subscribers.
+    void SendTypedEvent(StringHash eventType, TypedEventArgs& args);
+    /// Send event to the specific receivers first, then the non-specific ones. Typed args are null for VariantMap sends.
+    void SendEventToReceivers(StringHash eventType, VariantMap& eventData, TypedEventArgs* typedArgs);
+    /// Check whether events may be sent now. Logs an error when not called from the main thread.
+    bool CanSendEvents() const;
 
     /// Event handlers. Sender is null for non-specific handlers.
     ea::intrusive_list<EventHandler> eventHandlers_;
@@ -330,6 +367,8 @@ public:
 
     /// Invoke event handler function.
     virtual void Invoke(VariantMap& eventData) = 0;
+    /// Invoke event handler function with typed event payload. Return false if the handler takes event data only.
+    virtual bool InvokeTyped(void* /*args*/) { return false; }
     /// Return a unique copy of the event handler.
     virtual EventHandler* Clone() const = 0;
 
@@ -419,6 +458,68 @@ private:
     std::function<void(StringHash, VariantMap&)> function_;
 };
 
+/// Template implementation of the typed event handler invoke helper. Reads the payload from event data when the event is sent as VariantMap.
+template <class T, class Receiver> class TypedEventHandlerImpl : public EventHandler
+{
+public:
+    using AnySenderFunctionPtr = void (Receiver::*)(Object*, T&);
+    using SenderFunctionPtr = void (Receiver::*)(T&);
+
+    /// Construct with receiver and handler of any sender's event.
+    TypedEventHandlerImpl(Receiver* receiver, AnySenderFunctionPtr function) :
+        EventHandler(receiver),
+        anySenderFunction_(function)
+    {
+        assert(receiver_);
+        assert(anySenderFunction_);
+    }
+
+    /// Construct with receiver and handler of specific sender's event.
+    TypedEventHandlerImpl(Receiver* receiver, SenderFunctionPtr function) :
+        EventHandler(receiver),
+        senderFunction_(function)
+    {
+        assert(receiver_);
+        assert(senderFunction_);
+    }
+
+    /// Invoke event handler function. Changes to the payload are written back to event data.
+    void Invoke(VariantMap& eventData) override
+    {
+        T args;
+        args.FromVariantMap(eventData);
+        InvokeTyped(&args);
+        args.ToVariantMap(eventData);
+    }
+
+    /// Invoke event handler function with typed event payload.
+    bool InvokeTyped(void* args) override
+    {
+        auto* receiver = static_cast<Receiver*>(receiver_);
+        T& typedArgs = *static_cast<T*>(args);
+        if (anySenderFunction_)
+            (receiver->*anySenderFunction_)(receiver->GetEventSender(), typedArgs);
+        else
+            (receiver->*senderFunction_)(typedArgs);
+        return true;
+    }
+
+    /// Return a unique copy of the event handler.
+    EventHandler* Clone() const override
+    {
+        auto* receiver = static_cast<Receiver*>(receiver_);
+        if (anySenderFunction_)
+            return new TypedEventHandlerImpl(receiver, anySenderFunction_);
+        return new TypedEventHandlerImpl(receiver, senderFunction_);
+    }
+
+private:
+    /// Handler of any sender's event.
+    AnySenderFunctionPtr anySenderFunction_{};
+    /// Handler of specific sender's event.
+    SenderFunctionPtr senderFunction_{};
+};
+
 template<typename T>
 inline void Object::SubscribeToEvent(StringHash eventType, void(T::*handler)(StringHash, VariantMap&))
 {
@@ -431,11 +532,40 @@ inline void Object::SubscribeToEvent(Object* sender, StringHash eventType, void(
     SubscribeToEvent(sender, eventType, new Urho3D::EventHandlerImpl<T>((T*)this, handler));
 }
 
+template <class T, class Receiver, class>
+void Object::SubscribeToEvent(void(Receiver::*handler)(Object*, T&))
+{
+    SubscribeToEvent(T::GetEventType(), new TypedEventHandlerImpl<T, Receiver>(static_cast<Receiver*>(this), handler));
+}
+
+template <class T, class Receiver, class>
+void Object::SubscribeToEvent(Object* sender, void(Receiver::*handler)(T&))
+{
+    SubscribeToEvent(sender, T::GetEventType(), new TypedEventHandlerImpl<T, Receiver>(static_cast<Receiver*>(this), handler));
+}
+
+template <class T, class>
+void Object::UnsubscribeFromEvent()
+{
+    UnsubscribeFromEvent(T::GetEventType());
+}
+
+template <class T, class>
+void Object::SendEvent(T& args)
+{
+    TypedEventArgs typedArgs;
+    typedArgs.args_ = &args;
+    typedArgs.toVariantMap_ = [](const void* args, VariantMap& eventData) { static_cast<const T*>(args)->ToVariantMap(eventData); };
+    SendTypedEvent(T::GetEventType(), typedArgs);
+}
+
 /// Get register of event names.
 URHO3D_API StringHashRegister& GetEventNameRegister();
 
 /// Describe an event's hash ID and begin a namespace in which to define its parameters.
 #define URHO3D_EVENT(eventID, eventName) static const Urho3D::StringHash eventID(Urho3D::GetEventNameRegister().RegisterString(#eventName)); namespace eventName
+/// Describe the event ID of a typed event payload struct. The struct should also define `void ToVariantMap(VariantMap& eventData) const` and `void FromVariantMap(VariantMap& eventData)` to exchange the payload with VariantMap senders and subscribers. Each event ID should have only one payload struct.
+#define URHO3D_TYPED_EVENT(eventID) static Urho3D::StringHash GetEventType() { return eventID; }
 /// Describe an event's parameter hash ID. Should be used inside an event namespace.
 #define URHO3D_PARAM(paramID, paramName) static const Urho3D::StringHash paramID = #paramName
 /// Convenience macro to construct an EventHandler that points to a receiver object and its member function.
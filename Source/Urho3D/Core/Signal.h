@@ -25,6 +25,7 @@
 #include "../Container/Ptr.h"
 #include "../Container/RefCounted.h"
 #include "../Core/Function.h"
+#include "../Math/MathDefs.h"
 
 #include <EASTL/utility.h>
 #include <EASTL/vector.h>
@@ -33,18 +34,222 @@
 namespace Urho3D
 {
 
+/// Handler storage of a signal. Handlers may subscribe and unsubscribe while the signal is being invoked: new handlers are
+/// invoked starting from the next invocation, and removed handlers leave holes that are compacted afterward. Subscribing
+/// returns a handle that unsubscribes the handler without searching for it.
+template<typename Handler>
+class SignalHandlers
+{
+public:
+    /// Unsubscribe all handlers of specified receiver from this events.
+    void Unsubscribe(RefCounted* receiver)
+    {
+        for (HandlerEntry& entry : pendingHandlers_)
+        {
+            if (entry.receiver_ == receiver)
+                RemoveEntry(entry, true);
+        }
+
+        for (HandlerEntry& entry : handlers_)
+        {
+            if (entry.receiver_ == receiver)
+                RemoveEntry(entry, false);
+        }
+
+        if (!invoking_ && numRemoved_)
+            Compact();
+    }
+
+    /// Unsubscribe the handler of specified subscription handle if it still belongs to the receiver.
+    void Unsubscribe(unsigned handle, RefCounted* receiver)
+    {
+        if (handle >= handleIndices_.size() || handleIndices_[handle] == M_MAX_UNSIGNED)
+            return;
+
+        const unsigned index = handleIndices_[handle];
+        const bool pending = (index & PENDING_HANDLER) != 0;
+        HandlerEntry& entry = pending ? pendingHandlers_[index & ~PENDING_HANDLER] : handlers_[index];
+        if (entry.receiver_ != receiver)
+            return;
+
+        RemoveEntry(entry, pending);
+
+        // Compact once most of the entries are holes, so that removal stays constant time on average
+        if (!invoking_ && numRemoved_ * 2 > handlers_.size())
+            Compact();
+    }
+
+    /// Unsubscribe all handlers.
+    void UnsubscribeAll()
+    {
+        for (HandlerEntry& entry : pendingHandlers_)
+            RemoveEntry(entry, true);
+        for (HandlerEntry& entry : handlers_)
+            RemoveEntry(entry, false);
+
+        if (!invoking_)
+            Compact();
+    }
+
+    /// Returns true when event has at least one subscriber.
+    bool HasSubscribers() const { return handlers_.size() > numRemoved_ || !pendingHandlers_.empty(); }
+    /// Return whether the signal is being invoked.
+    bool IsInvoking() const { return invoking_ != 0; }
+
+protected:
+    /// Handle index flag of handlers subscribed during invocation.
+    static const unsigned PENDING_HANDLER = 0x80000000u;
+
+    /// Handler with weak reference to its receiver.
+    struct HandlerEntry
+    {
+        /// Receiver.
+        WeakPtr<RefCounted> receiver_;
+        /// Handler function.
+        Handler handler_;
+        /// Subscription handle, or M_MAX_UNSIGNED if removed.
+        unsigned handle_;
+    };
+
+    /// Add handler and return its subscription handle. Deferred until the end of the invocation if invoked.
+    template<typename Function>
+    unsigned AddHandler(RefCounted* receiver, Function&& handler)
+    {
+        unsigned handle;
+        if (!freeHandles_.empty())
+        {
+            handle = freeHandles_.back();
+            freeHandles_.pop_back();
+        }
+        else
+        {
+            handle = handleIndices_.size();
+            handleIndices_.push_back(M_MAX_UNSIGNED);
+        }
+
+        ea::vector<HandlerEntry>& handlers = invoking_ ? pendingHandlers_ : handlers_;
+        handlers.push_back(HandlerEntry{ WeakPtr<RefCounted>(receiver), Handler(ea::forward<Function>(handler)), handle });
+        handleIndices_[handle] = (handlers.size() - 1) | (invoking_ ? PENDING_HANDLER : 0);
+        return handle;
+    }
+
+    /// Call invoker for each live handler. Handlers for which the invoker returns false are removed.
+    template<typename Invoker>
+    void InvokeHandlers(const Invoker& invoker)
+    {
+        ++invoking_;
+
+        bool expired = false;
+        const unsigned numHandlers = handlers_.size();
+        for (unsigned i = 0; i < numHandlers; ++i)
+        {
+            HandlerEntry& entry = handlers_[i];
+            RefCounted* receiver = entry.receiver_.Get();
+            if (!receiver)
+                expired = true;
+            // Entry may not be referenced after the call if the handler subscribed recursively
+            else if (!invoker(entry.handler_, receiver))
+                RemoveEntry(handlers_[i], false);
+        }
+
+        if (--invoking_ == 0)
+        {
+            if (expired || numRemoved_)
+                Compact();
+            if (!pendingHandlers_.empty())
+            {
+                for (HandlerEntry& entry : pendingHandlers_)
+                {
+                    if (entry.receiver_.Expired())
+                        FreeHandle(entry.handle_);
+                    else
+                    {
+                        handleIndices_[entry.handle_] = handlers_.size();
+                        handlers_.push_back(ea::move(entry));
+                    }
+                }
+                pendingHandlers_.clear();
+            }
+        }
+    }
+
+    /// Remove handler, leaving a hole in its place. Holes of pending handlers are dropped when they are merged.
+    void RemoveEntry(HandlerEntry& entry, bool pending)
+    {
+        if (entry.handle_ == M_MAX_UNSIGNED)
+            return;
+
+        entry.receiver_.Reset();
+        FreeHandle(entry.handle_);
+        entry.handle_ = M_MAX_UNSIGNED;
+        if (!pending)
+            ++numRemoved_;
+    }
+
+    /// Free a subscription handle for reuse.
+    void FreeHandle(unsigned handle)
+    {
+        if (handle == M_MAX_UNSIGNED)
+            return;
+        handleIndices_[handle] = M_MAX_UNSIGNED;
+        freeHandles_.push_back(handle);
+    }
+
+    /// Remove holes and handlers of expired receivers.
+    void Compact()
+    {
+        unsigned numLive = 0;
+        for (unsigned i = 0; i < handlers_.size(); ++i)
+        {
+            HandlerEntry& entry = handlers_[i];
+            if (entry.receiver_.Expired())
+            {
+                FreeHandle(entry.handle_);
+                continue;
+            }
+
+            if (numLive != i)
+                handlers_[numLive] = ea::move(entry);
+            handleIndices_[handlers_[numLive].handle_] = numLive;
+            ++numLive;
+        }
+
+        handlers_.erase(handlers_.begin() + numLive, handlers_.end());
+        numRemoved_ = 0;
+    }
+
+    /// A collection of event handlers.
+    ea::vector<HandlerEntry> handlers_;
+    /// Handlers subscribed during invocation.
+    ea::vector<HandlerEntry> pendingHandlers_;
+    /// Handler index by subscription handle. Pending handlers are flagged, free handles are M_MAX_UNSIGNED.
+    ea::vector<unsigned> handleIndices_;
+    /// Free subscription handles.
+    ea::vector<unsigned> freeHandles_;
+    /// Invocation nesting depth.
+    unsigned invoking_{};
+    /// Number of removed handlers not compacted yet.
+    unsigned numRemoved_{};
+};
+
 template<typename T, typename Sender=RefCounted>
-class Signal
+class Signal : public SignalHandlers<Function<bool(RefCounted*, Sender*, T&)>>
 {
 public:
     /// Signal handler type.
     using Handler = Function<bool(RefCounted*, Sender*, T&)>;
 
-    /// Subscribe to event.
+    /// Subscribe to event with a handler function. Handler returns false to unsubscribe. Return subscription handle.
+    unsigned Subscribe(RefCounted* receiver, Handler handler)
+    {
+        return this->AddHandler(receiver, ea::move(handler));
+    }
+
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*, T&))
+    unsigned Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*, T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(sender, args);
@@ -53,11 +258,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*, T&))
+    unsigned Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*, T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(sender, args);
@@ -65,11 +270,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, void(Receiver::*handler)(T&))
+    unsigned Subscribe(Receiver* receiver, void(Receiver::*handler)(T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(args);
@@ -78,11 +283,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, bool(Receiver::*handler)(T&))
+    unsigned Subscribe(Receiver* receiver, bool(Receiver::*handler)(T&))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender, T& args)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(args);
@@ -90,57 +295,34 @@ public:
         );
     }
 
-    /// Unsubscribe all handlers of specified receiver from this events.
-    void Unsubscribe(RefCounted* receiver)
-    {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
-        {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
-            else
-                ++it;
-        }
-    }
-
     /// Invoke event.
     void operator()(Sender* sender, T& args)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        this->InvokeHandlers([sender, &args](Handler& handler, RefCounted* receiver)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
-            {
-                if (pair.second(receiver, sender, args))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
-            }
-            else
-                it = handlers_.erase(it);
-        }
+            return handler(receiver, sender, args);
+        });
     }
-
-    /// Returns true when event has at least one subscriber.
-    bool HasSubscribers() const { return !handlers_.empty(); }
-
-protected:
-    /// A collection of event handlers.
-    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
 };
 
 template<typename Sender>
-class Signal<void, Sender>
+class Signal<void, Sender> : public SignalHandlers<Function<bool(RefCounted*, Sender*)>>
 {
 public:
     /// Signal handler type.
     using Handler = Function<bool(RefCounted*, Sender*)>;
 
-    /// Subscribe to event.
+    /// Subscribe to event with a handler function. Handler returns false to unsubscribe. Return subscription handle.
+    unsigned Subscribe(RefCounted* receiver, Handler handler)
+    {
+        return this->AddHandler(receiver, ea::move(handler));
+    }
+
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*))
+    unsigned Subscribe(Receiver* receiver, void(Receiver::*handler)(Sender*))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 (static_cast<Receiver*>(receiver)->*handler)(sender);
@@ -149,11 +331,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*))
+    unsigned Subscribe(Receiver* receiver, bool(Receiver::*handler)(RefCounted*))
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)(sender);
@@ -161,11 +343,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, void(Receiver::*handler)())
+    unsigned Subscribe(Receiver* receiver, void(Receiver::*handler)())
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 (static_cast<Receiver*>(receiver)->*handler)();
@@ -174,11 +356,11 @@ public:
         );
     }
 
-    /// Subscribe to event.
+    /// Subscribe to event. Return subscription handle.
     template<typename Receiver>
-    void Subscribe(Receiver* receiver, bool(Receiver::*handler)())
+    unsigned Subscribe(Receiver* receiver, bool(Receiver::*handler)())
     {
-        handlers_.emplace_back(WeakPtr<RefCounted>(static_cast<RefCounted*>(receiver)),
+        return this->AddHandler(static_cast<RefCounted*>(receiver),
             [handler](RefCounted* receiver, Sender* sender)
             {
                 return (static_cast<Receiver*>(receiver)->*handler)();
@@ -186,43 +368,14 @@ public:
         );
     }
 
-    /// Unsubscribe all handlers of specified receiver from this events.
-    void Unsubscribe(RefCounted* receiver)
-    {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
-        {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (pair.first.Expired() || pair.first == receiver)
-                it = handlers_.erase(it);
-            else
-                ++it;
-        }
-    }
-
     /// Invoke event.
     void operator()(Sender* sender)
     {
-        for (auto it = handlers_.begin(); it != handlers_.end();)
+        this->InvokeHandlers([sender](Handler& handler, RefCounted* receiver)
         {
-            ea::pair<WeakPtr<RefCounted>, Handler>& pair = *it;
-            if (RefCounted* receiver = pair.first.Get())
-            {
-                if (pair.second(receiver, sender))
-                    ++it;
-                else
-                    it = handlers_.erase(it);
-            }
-            else
-                it = handlers_.erase(it);
-        }
+            return handler(receiver, sender);
+        });
     }
-
-    /// Returns true when event has at least one subscriber.
-    bool HasSubscribers() const { return !handlers_.empty(); }
-
-protected:
-    /// A collection of event handlers.
-    ea::vector<ea::pair<WeakPtr<RefCounted>, Handler>> handlers_;
 };
 
 }
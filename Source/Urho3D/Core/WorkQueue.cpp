@@ -30,9 +30,136 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 
+#include <EASTL/deque.h>
+#include <EASTL/fixed_vector.h>
+
+#include <thread>
+
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Index of the worker thread executing the current code. Zero for the main thread.
+thread_local unsigned currentThreadIndex = M_MAX_UNSIGNED;
+
+}
+
+/// Shared state of parallel loop.
+struct ParallelForState
+{
+    /// Loop body.
+    const std::function<void(unsigned, unsigned, unsigned)>* callback_{};
+    /// Optional stop token.
+    const StopToken* stopToken_{};
+    /// Number of elements.
+    unsigned count_{};
+    /// Minimum number of elements per chunk.
+    unsigned minChunkSize_{};
+    /// Number of threads processing the loop.
+    unsigned numThreads_{};
+    /// Whether the loop belongs to thread not owned by the queue. Such loops are processed by worker threads only.
+    bool external_{};
+    /// First element that is not claimed yet.
+    std::atomic<unsigned> nextIndex_{};
+    /// Number of helper work items that are not finished yet.
+    std::atomic<unsigned> numPendingItems_{};
+
+    /// Claim next chunk. Chunk size is proportional to the remaining elements, so that all threads finish at roughly the same time.
+    bool ClaimChunk(unsigned& begin, unsigned& end)
+    {
+        if (stopToken_ && stopToken_->IsStopped())
+            return false;
+
+        unsigned index = nextIndex_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if (index >= count_)
+                return false;
+
+            const unsigned remaining = count_ - index;
+            const unsigned chunkSize = Min(Max(minChunkSize_, remaining / (2 * numThreads_)), remaining);
+            if (nextIndex_.compare_exchange_weak(index, index + chunkSize, std::memory_order_relaxed))
+            {
+                begin = index;
+                end = index + chunkSize;
+                return true;
+            }
+        }
+    }
+
+    /// Process chunks until the range is exhausted or stopped.
+    void Process(unsigned threadIndex)
+    {
+        unsigned begin, end;
+        while (ClaimChunk(begin, end))
+            (*callback_)(begin, end, threadIndex);
+    }
+};
+
+/// Per-thread deque of work items. Owner thread pushes and pops at the back, other threads steal from the front.
+class WorkStealingDeque
+{
+public:
+    /// Push item to the back.
+    void Push(WorkItem* item)
+    {
+        MutexLock lock(mutex_);
+        items_.push_back(item);
+    }
+
+    /// Pop item from the back. Return null if empty.
+    WorkItem* Pop()
+    {
+        MutexLock lock(mutex_);
+        if (items_.empty())
+            return nullptr;
+        WorkItem* item = items_.back();
+        items_.pop_back();
+        return item;
+    }
+
+    /// Pop item from the back only if it belongs to the specified parallel loop. Return null otherwise.
+    WorkItem* PopParallelFor(const ParallelForState* parallelFor)
+    {
+        MutexLock lock(mutex_);
+        if (items_.empty() || items_.back()->parallelFor_ != parallelFor)
+            return nullptr;
+        WorkItem* item = items_.back();
+        items_.pop_back();
+        return item;
+    }
+
+    /// Steal item from the front. Return null if empty.
+    WorkItem* Steal()
+    {
+        MutexLock lock(mutex_);
+        if (items_.empty())
+            return nullptr;
+        WorkItem* item = items_.front();
+        items_.pop_front();
+        return item;
+    }
+
+    /// Remove specific item. Return true if found.
+    bool Remove(WorkItem* item)
+    {
+        MutexLock lock(mutex_);
+        auto iter = ea::find(items_.begin(), items_.end(), item);
+        if (iter == items_.end())
+            return false;
+        items_.erase(iter);
+        return true;
+    }
+
+private:
+    /// Deque mutex. Contended only when other threads steal.
+    SpinLockMutex mutex_;
+    /// Queued items.
+    ea::deque<WorkItem*> items_;
+};
+
 /// Worker thread managed by the work queue.
 class WorkerThread : public Thread, public RefCounted
 {
@@ -50,6 +177,7 @@ public:
         URHO3D_PROFILE_THREAD(Format("WorkerThread {}", (uint64_t)GetCurrentThreadID()).c_str());
         // Init FPU state first
         InitFPU();
+        currentThreadIndex = index_;
         owner_->ProcessItems(index_);
     }
 
@@ -65,22 +193,27 @@ private:
 
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
+    numQueuedItems_(0),
     shutDown_(false),
-    pausing_(false),
     paused_(false),
+    numSleepingThreads_(0),
     completing_(false),
     tolerance_(10),
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    deques_.push_back(ea::make_unique<WorkStealingDeque>());
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
 WorkQueue::~WorkQueue()
 {
     // Stop the worker threads. First make sure they are not waiting for work items
-    shutDown_ = true;
-    Resume();
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex_);
+        shutDown_ = true;
+    }
+    wakeCondition_.notify_all();
 
     for (unsigned i = 0; i < threads_.size(); ++i)
         threads_[i]->Stop();
@@ -97,6 +230,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     // Start threads in paused mode
     Pause();
 
+    // Create the deques before any thread runs, the deque vector is not modified afterwards
+    for (unsigned i = 0; i < numThreads; ++i)
+        deques_.push_back(ea::make_unique<WorkStealingDeque>());
+
     for (unsigned i = 0; i < numThreads; ++i)
     {
         SharedPtr<WorkerThread> thread(new WorkerThread(this, i + 1));
@@ -111,22 +248,28 @@ void WorkQueue::CreateThreads(unsigned numThreads)
 
 SharedPtr<WorkItem> WorkQueue::GetFreeItem()
 {
-    if (!poolItems_.empty())
-    {
-        SharedPtr<WorkItem> item = poolItems_.front();
-        poolItems_.pop_front();
-        return item;
-    }
-    else
     {
-        // No usable items found, create a new one set it as pooled and return it.
-        SharedPtr<WorkItem> item(new WorkItem());
-        item->pooled_ = true;
-        return item;
+        MutexLock lock(poolMutex_);
+        if (!poolItems_.empty())
+        {
+            SharedPtr<WorkItem> item = poolItems_.front();
+            poolItems_.pop_front();
+            return item;
+        }
     }
+
+    // No usable items found, create a new one set it as pooled and return it.
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->pooled_ = true;
+    return item;
 }
 
 void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
+{
+    AddWorkItem(item, {});
+}
+
+void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies)
 {
     if (!item)
     {
@@ -141,46 +284,29 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
     // Clear completed flag in case item is reused
     workItems_.push_back(item);
     item->completed_ = false;
+    item->finished_ = false;
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.size() && !paused_)
-        queueMutex_.Acquire();
-
-    // Find position for new item
-    if (queue_.empty())
-        queue_.push_back(item.Get());
-    else
-    {
-        bool inserted = false;
-
-        for (auto i = queue_.begin(); i != queue_.end(); ++i)
-        {
-            if ((*i)->priority_ <= item->priority_)
-            {
-                queue_.insert(i, item.Get());
-                inserted = true;
-                break;
-            }
-        }
-
-        if (!inserted)
-            queue_.push_back(item.Get());
-    }
+    // Items with unfinished dependencies are queued by the thread which finishes the last dependency
+    if (AddDependencies(item.Get(), dependencies))
+        QueueItem(item.Get(), 0);
 
     if (threads_.size())
-    {
-        queueMutex_.Release();
-        paused_ = false;
-    }
+        Resume();
 }
 
 SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction, unsigned priority)
+{
+    return AddWorkItem(std::move(workFunction), {}, priority);
+}
+
+SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction,
+    const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority)
 {
     SharedPtr<WorkItem> item = GetFreeItem();
     item->workLambda_ = std::move(workFunction);
     item->workFunction_ = [](const WorkItem* item, unsigned) { item->workLambda_(); };
     item->priority_ = priority;
-    AddWorkItem(item);
+    AddWorkItem(item, dependencies);
     return item;
 }
 
@@ -189,44 +315,42 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
     if (!item)
         return false;
 
-    MutexLock lock(queueMutex_);
-
     // Can only remove successfully if the item was not yet taken by threads for execution
-    auto i = ea::find(queue_.begin(), queue_.end(), item.Get());
-    if (i != queue_.end())
+    auto j = ea::find(workItems_.begin(), workItems_.end(), item);
+    if (j == workItems_.end())
+        return false;
+
+    bool removed = false;
     {
-        auto j = ea::find(workItems_.begin(), workItems_.end(), item);
-        if (j != workItems_.end())
+        MutexLock lock(queueMutex_);
+        auto i = ea::find(queue_.begin(), queue_.end(), item.Get());
+        if (i != queue_.end())
         {
             queue_.erase(i);
-            ReturnToPool(item);
-            workItems_.erase(j);
-            return true;
+            removed = true;
         }
     }
 
-    return false;
+    for (unsigned i = 0; i < deques_.size() && !removed; ++i)
+        removed = deques_[i]->Remove(item.Get());
+
+    if (!removed)
+        return false;
+
+    --numQueuedItems_;
+    ReturnToPool(item);
+    workItems_.erase(j);
+    return true;
 }
 
 unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items)
 {
-    MutexLock lock(queueMutex_);
     unsigned removed = 0;
 
     for (auto i = items.begin(); i != items.end(); ++i)
     {
-        auto j = ea::find(queue_.begin(), queue_.end(), i->Get());
-        if (j != queue_.end())
-        {
-            auto k = ea::find(workItems_.begin(), workItems_.end(), *i);
-            if (k != workItems_.end())
-            {
-                queue_.erase(j);
-                ReturnToPool(*k);
-                workItems_.erase(k);
-                ++removed;
-            }
-        }
+        if (RemoveWorkItem(*i))
+            ++removed;
     }
 
     return removed;
@@ -234,23 +358,18 @@ unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& item
 
 void WorkQueue::Pause()
 {
-    if (!paused_)
-    {
-        pausing_ = true;
-
-        queueMutex_.Acquire();
-        paused_ = true;
-
-        pausing_ = false;
-    }
+    paused_ = true;
 }
 
 void WorkQueue::Resume()
 {
     if (paused_)
     {
-        queueMutex_.Release();
-        paused_ = false;
+        {
+            std::lock_guard<std::mutex> lock(pauseMutex_);
+            paused_ = false;
+        }
+        wakeCondition_.notify_all();
     }
 }
 
@@ -260,51 +379,142 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = true;
 
     if (threads_.size())
+        Resume();
+
+    // Take work items also in the main thread until all high-priority items are finished
+    while (!IsCompleted(priority))
+    {
+        if (WorkItem* item = TakeItem(0, priority))
+            ExecuteItem(item, 0);
+        else if (threads_.empty())
+        {
+            // No worker threads and nothing to take: remaining items wait for lower priority dependencies
+            break;
+        }
+    }
+
+    // If no work at all remaining, let idle worker threads sleep
+    if (threads_.size() && numQueuedItems_ == 0)
+        Pause();
+
+    PurgeCompleted(priority);
+    completing_ = false;
+}
+
+void WorkQueue::Complete(const ea::vector<SharedPtr<WorkItem> >& items)
+{
+    if (!Thread::IsMainThread())
     {
+        URHO3D_LOGERROR("WorkQueue::Complete() can not be called from worker threads");
+        return;
+    }
+
+    if (threads_.size())
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.empty())
+    // Execute only high-priority work in the main thread unless there are no worker threads at all
+    const unsigned minPriority = threads_.empty() ? 0 : M_MAX_UNSIGNED;
+    for (const SharedPtr<WorkItem>& item : items)
+    {
+        while (!item->completed_)
         {
-            queueMutex_.Acquire();
-            if (!queue_.empty() && queue_.front()->priority_ >= priority)
+            if (WorkItem* otherItem = TakeItem(0, minPriority))
+                ExecuteItem(otherItem, 0);
+            else if (threads_.empty())
             {
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
-                break;
+                URHO3D_LOGERROR("Work item can not be completed, its dependencies are never finished");
+                return;
             }
         }
+    }
+}
 
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
-        {
-        }
+void WorkQueue::ParallelFor(unsigned count, unsigned minChunkSize, const std::function<void(unsigned, unsigned, unsigned)>& callback)
+{
+    ParallelForInternal(count, minChunkSize, nullptr, callback);
+}
+
+bool WorkQueue::ParallelFor(unsigned count, unsigned minChunkSize, const StopToken& stopToken,
+    const std::function<void(unsigned, unsigned, unsigned)>& callback)
+{
+    ParallelForInternal(count, minChunkSize, &stopToken, callback);
+    return !stopToken.IsStopped();
+}
+
+void WorkQueue::ParallelForInternal(unsigned count, unsigned minChunkSize, const StopToken* stopToken,
+    const std::function<void(unsigned, unsigned, unsigned)>& callback)
+{
+    if (count == 0)
+        return;
+
+    const unsigned threadIndex = GetThreadIndex();
+    const bool external = threadIndex == M_MAX_UNSIGNED;
 
-        // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.empty())
-            Pause();
+    ParallelForState state;
+    state.callback_ = &callback;
+    state.stopToken_ = stopToken;
+    state.count_ = count;
+    state.minChunkSize_ = Max(minChunkSize, 1U);
+    state.external_ = external;
+
+    // Spawn at most one helper item per worker thread, each helper claims chunks until the range is exhausted
+    const unsigned numHelpers = Min<unsigned>(threads_.size(), (count - 1) / state.minChunkSize_ + (external ? 1 : 0));
+    state.numThreads_ = Max(numHelpers + (external ? 0 : 1), 1U);
+
+    // Process in place if there is no one to help
+    if (numHelpers == 0)
+    {
+        state.Process(external ? 0 : threadIndex);
+        return;
     }
-    else
+
+    // Queueing work resumes the worker threads, like adding a work item
+    Resume();
+
+    // External loops go to the shared queue, so that the main thread keeps executing frame work only
+    state.numPendingItems_ = numHelpers;
+    ea::fixed_vector<SharedPtr<WorkItem>, 16> helperItems;
+    for (unsigned i = 0; i < numHelpers; ++i)
+    {
+        SharedPtr<WorkItem> item = GetFreeItem();
+        item->parallelFor_ = &state;
+        item->priority_ = external ? 0 : M_MAX_UNSIGNED;
+        item->workFunction_ = [](const WorkItem* item, unsigned threadIndex) { item->parallelFor_->Process(threadIndex); };
+        helperItems.push_back(item);
+        QueueItem(item, threadIndex);
+    }
+
+    if (!external)
     {
-        // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.empty() && queue_.front()->priority_ >= priority)
+        state.Process(threadIndex);
+
+        // The range is exhausted, helper items not taken by other threads yet will finish immediately
+        while (state.numPendingItems_.load(std::memory_order_acquire) != 0)
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            if (WorkItem* item = deques_[threadIndex]->PopParallelFor(&state))
+            {
+                --numQueuedItems_;
+                ExecuteItem(item, threadIndex);
+            }
+            else
+                std::this_thread::yield();
         }
     }
+    else
+    {
+        while (state.numPendingItems_.load(std::memory_order_acquire) != 0)
+            Time::Sleep(1);
+    }
 
-    PurgeCompleted(priority);
-    completing_ = false;
+    for (SharedPtr<WorkItem>& item : helperItems)
+        ReturnToPool(item);
+}
+
+unsigned WorkQueue::GetThreadIndex()
+{
+    if (currentThreadIndex == M_MAX_UNSIGNED && Thread::IsMainThread())
+        currentThreadIndex = 0;
+    return currentThreadIndex;
 }
 
 unsigned WorkQueue::GetNumIncomplete(unsigned priority) const
@@ -332,39 +542,133 @@ bool WorkQueue::IsCompleted(unsigned priority) const
 
 void WorkQueue::ProcessItems(unsigned threadIndex)
 {
-    bool wasActive = false;
-
     for (;;)
     {
         if (shutDown_)
             return;
 
-        if (pausing_ && !wasActive)
-            Time::Sleep(0);
-        else
+        // Paused threads may finish the item they are executing, but do not take new ones
+        if (!paused_)
         {
-            queueMutex_.Acquire();
-            if (!queue_.empty())
+            if (WorkItem* item = TakeItem(threadIndex, 0))
             {
-                wasActive = true;
-
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
+                ExecuteItem(item, threadIndex);
+                continue;
             }
-            else
-            {
-                wasActive = false;
+        }
 
-                queueMutex_.Release();
-                Time::Sleep(0);
-            }
+        // Sleep until resumed with work queued. The sleeping count is raised before checking for work, so that a thread
+        // queueing work either sees it and wakes this thread, or this thread sees the queued work
+        std::unique_lock<std::mutex> lock(pauseMutex_);
+        ++numSleepingThreads_;
+        wakeCondition_.wait(lock, [this] { return shutDown_ || (!paused_ && numQueuedItems_ != 0); });
+        --numSleepingThreads_;
+    }
+}
+
+void WorkQueue::QueueItem(WorkItem* item, unsigned threadIndex)
+{
+    ++numQueuedItems_;
+
+    if (item->priority_ == M_MAX_UNSIGNED)
+        deques_[threadIndex < deques_.size() ? threadIndex : 0]->Push(item);
+    else
+    {
+        MutexLock lock(queueMutex_);
+
+        // Find position for new item
+        auto i = queue_.begin();
+        while (i != queue_.end() && (*i)->priority_ > item->priority_)
+            ++i;
+        queue_.insert(i, item);
+    }
+
+    // Wake up a sleeping worker thread. Locking the mutex guarantees that no thread is about to sleep
+    // after missing the updated number of queued items
+    if (numSleepingThreads_ != 0 && !paused_)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pauseMutex_);
         }
+        wakeCondition_.notify_one();
     }
 }
 
+WorkItem* WorkQueue::TakeItem(unsigned threadIndex, unsigned minPriority)
+{
+    if (numQueuedItems_.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+
+    WorkItem* item = deques_[threadIndex]->Pop();
+
+    // Steal from other threads, starting from the next one to spread contention
+    const unsigned numDeques = deques_.size();
+    for (unsigned i = 1; !item && i < numDeques; ++i)
+        item = deques_[(threadIndex + i) % numDeques]->Steal();
+
+    if (!item)
+    {
+        MutexLock lock(queueMutex_);
+        for (auto i = queue_.begin(); i != queue_.end() && (*i)->priority_ >= minPriority; ++i)
+        {
+            // Don't let the main thread stall on long loops of external threads
+            if (threadIndex == 0 && (*i)->parallelFor_ && (*i)->parallelFor_->external_)
+                continue;
+
+            item = *i;
+            queue_.erase(i);
+            break;
+        }
+    }
+
+    if (item)
+        --numQueuedItems_;
+    return item;
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    item->workFunction_(item, threadIndex);
+
+    // Close the dependents list, it is not modified anymore and can be iterated without the lock
+    {
+        MutexLock lock(item->dependentsMutex_);
+        item->finished_ = true;
+    }
+
+    for (WorkItem* dependent : item->dependents_)
+    {
+        if (--dependent->numDependencies_ == 0)
+            QueueItem(dependent, threadIndex);
+    }
+
+    // The item may be recycled as soon as it is marked completed, so this must be the last access
+    ParallelForState* parallelFor = item->parallelFor_;
+    item->completed_ = true;
+    if (parallelFor)
+        parallelFor->numPendingItems_.fetch_sub(1, std::memory_order_release);
+}
+
+bool WorkQueue::AddDependencies(WorkItem* item, const ea::vector<SharedPtr<WorkItem> >& dependencies)
+{
+    if (dependencies.empty())
+        return true;
+
+    // Hold one extra dependency while registering so that the item is not queued prematurely
+    item->numDependencies_ = 1;
+    for (const SharedPtr<WorkItem>& dependency : dependencies)
+    {
+        MutexLock lock(dependency->dependentsMutex_);
+        if (!dependency->finished_)
+        {
+            ++item->numDependencies_;
+            dependency->dependents_.push_back(item);
+        }
+    }
+
+    return --item->numDependencies_ == 0;
+}
+
 void WorkQueue::PurgeCompleted(unsigned priority)
 {
     // Purge completed work items and send completion events. Do not signal items lower than priority threshold,
@@ -393,6 +697,8 @@ void WorkQueue::PurgeCompleted(unsigned priority)
 
 void WorkQueue::PurgePool()
 {
+    MutexLock lock(poolMutex_);
+
     unsigned currentSize = poolItems_.size();
     int difference = lastSize_ - currentSize;
 
@@ -416,10 +722,16 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->end_ = nullptr;
         item->aux_ = nullptr;
         item->workFunction_ = nullptr;
+        item->workLambda_ = nullptr;
+        item->parallelFor_ = nullptr;
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
+        item->finished_ = false;
+        item->numDependencies_ = 0;
+        item->dependents_.clear();
 
+        MutexLock lock(poolMutex_);
         poolItems_.push_back(item);
     }
 }
@@ -427,18 +739,18 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.empty() && !queue_.empty())
+    if (threads_.empty() && numQueuedItems_ != 0)
     {
         URHO3D_PROFILE("CompleteWorkNonthreaded");
 
         HiresTimer timer;
 
-        while (!queue_.empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            WorkItem* item = TakeItem(0, 0);
+            if (!item)
+                break;
+            ExecuteItem(item, 0);
         }
     }
 
@@ -23,12 +23,16 @@
 #pragma once
 
 #include <EASTL/list.h>
-#include <atomic>
+#include <EASTL/unique_ptr.h>
 
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
+#include "../Core/StopToken.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 namespace Urho3D
 {
@@ -40,12 +44,15 @@ URHO3D_EVENT(E_WORKITEMCOMPLETED, WorkItemCompleted)
 }
 
 class WorkerThread;
+class WorkStealingDeque;
+struct ParallelForState;
 
 /// Work queue item.
 /// @nobind
 struct WorkItem : public RefCounted
 {
     friend class WorkQueue;
+    friend class WorkStealingDeque;
 
 public:
     /// Work function. Called with the work item and thread index (0 = main thread) as parameters.
@@ -67,6 +74,16 @@ private:
     bool pooled_{};
     /// Work function. Called without any parameters.
     std::function<void()> workLambda_;
+    /// Parallel loop processed by this item. Null for regular work items.
+    ParallelForState* parallelFor_{};
+    /// Number of unfinished dependencies. The item is queued for execution when it reaches zero.
+    std::atomic<unsigned> numDependencies_{};
+    /// Items waiting for this item to finish.
+    ea::vector<WorkItem*> dependents_;
+    /// Dependents list mutex.
+    SpinLockMutex dependentsMutex_;
+    /// Whether the work function has finished and the dependents list is closed.
+    bool finished_{};
 };
 
 /// Work queue subsystem for multithreading.
@@ -90,6 +107,10 @@ public:
     void AddWorkItem(const SharedPtr<WorkItem>& item);
     /// Add a work item and resume worker threads.
     SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, unsigned priority = 0);
+    /// Add a work item that is started only after all dependencies have finished. Dependencies must be already added to the queue.
+    void AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies);
+    /// Add a work item that is started only after all dependencies have finished. Dependencies must be already added to the queue.
+    SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority = 0);
     /// Remove a work item before it has started executing. Return true if successfully removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
@@ -100,6 +121,29 @@ public:
     void Resume();
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
+    /// Wait until the specified work items are finished. Main thread will also execute priority work while waiting. Can only be called from the main thread.
+    void Complete(const ea::vector<SharedPtr<WorkItem> >& items);
+    /// Process index range [0, count) in chunks of at least minChunkSize elements. Callback is invoked with begin index, end index and thread index of each chunk.
+    /// Chunks shrink as the range is consumed to balance the load between threads. Can be called from any thread:
+    /// main and worker threads participate in processing, other threads wait for the worker threads.
+    void ParallelFor(unsigned count, unsigned minChunkSize, const std::function<void(unsigned, unsigned, unsigned)>& callback);
+    /// Process index range [0, count) in parallel until finished or stopped. Return false if stopped. Chunks already started are always finished.
+    bool ParallelFor(unsigned count, unsigned minChunkSize, const StopToken& stopToken, const std::function<void(unsigned, unsigned, unsigned)>& callback);
+    /// Reduce index range [0, count) in parallel. Map callback returns the value for begin and end index of the chunk.
+    /// Reduce callback combines two values and should be commutative and associative, as the chunks are combined in arbitrary order.
+    template <class T, class MapCallback, class ReduceCallback>
+    T ParallelReduce(unsigned count, unsigned minChunkSize, const T& identity, const MapCallback& map, const ReduceCallback& reduce)
+    {
+        T result = identity;
+        SpinLockMutex resultMutex;
+        ParallelFor(count, minChunkSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            const T value = map(begin, end);
+            MutexLock lock(resultMutex);
+            result = reduce(result, value);
+        });
+        return result;
+    }
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
@@ -116,6 +160,8 @@ public:
     bool IsCompleted(unsigned priority) const;
     /// Return whether the queue is currently completing work in the main thread.
     bool IsCompleting() const { return completing_; }
+    /// Return thread index of the calling thread: 0 for the main thread, 1..n for worker threads and M_MAX_UNSIGNED for other threads.
+    static unsigned GetThreadIndex();
 
     /// Return the pool tolerance.
     int GetTolerance() const { return tolerance_; }
@@ -126,6 +172,17 @@ public:
 private:
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Process parallel loop with optional stop token.
+    void ParallelForInternal(unsigned count, unsigned minChunkSize, const StopToken* stopToken,
+        const std::function<void(unsigned, unsigned, unsigned)>& callback);
+    /// Queue work item for execution. Items with maximum priority go to the deque of the specified thread, others go to the shared prioritized queue.
+    void QueueItem(WorkItem* item, unsigned threadIndex);
+    /// Take work item for execution: own deque first, then steal from other threads, then the shared queue if the priority is high enough.
+    WorkItem* TakeItem(unsigned threadIndex, unsigned minPriority);
+    /// Execute work item and release its dependents.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Register dependencies of work item. Return true if the item can be queued immediately.
+    bool AddDependencies(WorkItem* item, const ea::vector<SharedPtr<WorkItem> >& dependencies);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -141,16 +198,26 @@ private:
     ea::list<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     ea::list<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems).
+    /// Work item prioritized queue for low-priority work. Pointers are guaranteed to be valid (point to workItems).
     ea::list<WorkItem*> queue_;
-    /// Worker queue mutex.
+    /// Per-thread deques for maximum priority work. Index 0 is the main thread.
+    ea::vector<ea::unique_ptr<WorkStealingDeque> > deques_;
+    /// Prioritized queue mutex.
     Mutex queueMutex_;
+    /// Pause mutex. Guards sleeping of idle and paused worker threads.
+    std::mutex pauseMutex_;
+    /// Condition to wake up sleeping worker threads when resumed or when work is queued.
+    std::condition_variable wakeCondition_;
+    /// Work item pool mutex.
+    SpinLockMutex poolMutex_;
+    /// Number of queued items that are not taken for execution yet.
+    std::atomic<unsigned> numQueuedItems_;
     /// Shutting down flag.
     std::atomic<bool> shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
-    std::atomic<bool> pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Worker threads do not take work items while paused.
+    std::atomic<bool> paused_;
+    /// Number of worker threads sleeping on the wake condition.
+    std::atomic<unsigned> numSleepingThreads_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
@@ -720,20 +720,20 @@ void Engine::Update()
     URHO3D_PROFILE("Update");
 
     // Logic update event
-    using namespace Update;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_TIMESTEP] = timeStep_;
-    SendEvent(E_UPDATE, eventData);
+    UpdateArgs updateArgs{timeStep_};
+    SendEvent(updateArgs);
 
     // Logic post-update event
-    SendEvent(E_POSTUPDATE, eventData);
+    PostUpdateArgs postUpdateArgs{timeStep_};
+    SendEvent(postUpdateArgs);
 
     // Rendering update event
-    SendEvent(E_RENDERUPDATE, eventData);
+    RenderUpdateArgs renderUpdateArgs{timeStep_};
+    SendEvent(renderUpdateArgs);
 
     // Post-render update event
-    SendEvent(E_POSTRENDERUPDATE, eventData);
+    PostRenderUpdateArgs postRenderUpdateArgs{timeStep_};
+    SendEvent(postRenderUpdateArgs);
 }
 
 void Engine::Render()
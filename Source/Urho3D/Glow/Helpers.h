@@ -23,6 +23,8 @@
 #pragma once
 
 #include "../Core/Context.h"
+#include "../Core/StopToken.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/RenderPath.h"
 #include "../Graphics/StaticModel.h"
@@ -34,31 +36,41 @@
 
 #include <EASTL/string.h>
 
-#include <future>
-
 namespace Urho3D
 {
 
-/// Parallel loop.
+/// Number of elements per work item of the parallel loop. The WorkQueue claims larger chunks while much of the range remains.
+static const unsigned PARALLEL_FOR_GRAIN_SIZE = 64;
+
+/// Parallel loop over engine worker threads. Single task runs the loop in the calling thread.
+template <class T>
+void ParallelFor(Context* context, unsigned count, unsigned numTasks, const T& callback)
+{
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    if (!workQueue || numTasks <= 1)
+    {
+        callback(0, count);
+        return;
+    }
+
+    workQueue->ParallelFor(count, PARALLEL_FOR_GRAIN_SIZE, [&](unsigned fromIndex, unsigned toIndex, unsigned) { callback(fromIndex, toIndex); });
+}
+
+/// Process range in parallel until finished or stopped. Return false if stopped.
 template <class T>
-void ParallelFor(unsigned count, unsigned numTasks, const T& callback)
+bool ParallelFor(Context* context, unsigned count, unsigned numTasks, const StopToken& stopToken, const T& callback)
 {
-    // Post async tasks
-    ea::vector<std::future<void>> tasks;
-    const unsigned chunkSize = (count + numTasks - 1) / numTasks;
-    for (unsigned i = 0; i < numTasks; ++i)
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    if (!workQueue || numTasks <= 1)
     {
-        tasks.push_back(std::async([&, i]()
-        {
-            const unsigned fromIndex = i * chunkSize;
-            const unsigned toIndex = ea::min(fromIndex + chunkSize, count);
-            callback(fromIndex, toIndex);
-        }));
+        if (stopToken.IsStopped())
+            return false;
+        callback(0, count);
+        return true;
     }
 
-    // Wait for async tasks
-    for (auto& task : tasks)
-        task.wait();
+    return workQueue->ParallelFor(count, PARALLEL_FOR_GRAIN_SIZE, stopToken,
+        [&](unsigned fromIndex, unsigned toIndex, unsigned) { callback(fromIndex, toIndex); });
 }
 
 /// Load render path.
@@ -258,16 +258,19 @@ struct IncrementalLightBaker::Impl
                 LightmapChartBakedDirect bakedDirect{ geometryBuffer.lightmapSize_ };
 
                 // Bake emission
-                BakeEmissionLight(bakedDirect, geometryBuffer,
-                    settings_.emissionTracing_, settings_.properties_.emissionBrightness_);
+                BakeEmissionLight(context_, bakedDirect, geometryBuffer,
+                    settings_.emissionTracing_, settings_.properties_.emissionBrightness_, stopToken);
 
                 // Bake direct lights for charts
                 for (const BakedLight& bakedLight : bakedChunk->bakedLights_)
                 {
                     BakeDirectLightForCharts(bakedDirect, geometryBuffer, *bakedChunk->raytracerScene_,
-                        bakedChunk->geometryBufferToRaytracer_, bakedLight, settings_.directChartTracing_);
+                        bakedChunk->geometryBufferToRaytracer_, bakedLight, settings_.directChartTracing_, stopToken);
                 }
 
+                if (stopToken.IsStopped())
+                    return false;
+
                 // Store direct light
                 cache_->StoreDirectLight(lightmapIndex, ea::move(bakedDirect));
             }
@@ -306,7 +309,7 @@ struct IncrementalLightBaker::Impl
 
             // Bake indirect light for light probes
             BakeIndirectLightForLightProbes(lightProbesBakedData, bakedChunk->lightProbesCollection_,
-                bakedDirectLightmaps, *bakedChunk->raytracerScene_, settings_.indirectProbesTracing_);
+                bakedDirectLightmaps, *bakedChunk->raytracerScene_, settings_.indirectProbesTracing_, stopToken);
 
             // Build light probes mesh for fallback indirect
             TetrahedralMesh lightProbesMesh;
@@ -328,23 +331,26 @@ struct IncrementalLightBaker::Impl
                 BakeIndirectLightForCharts(bakedIndirect, bakedDirectLightmaps,
                     geometryBuffer, lightProbesMesh, lightProbesBakedData,
                     *bakedChunk->raytracerScene_, bakedChunk->geometryBufferToRaytracer_,
-                    settings_.indirectChartTracing_);
+                    settings_.indirectChartTracing_, stopToken);
 
                 // Filter direct and indirect
                 bakedIndirect.NormalizeLight();
 
                 if (settings_.directFilter_.kernelRadius_ > 0)
                 {
-                    FilterDirectLight(*bakedDirect, directFilterBuffer,
-                        geometryBuffer, settings_.directFilter_, settings_.directChartTracing_.numTasks_);
+                    FilterDirectLight(context_, *bakedDirect, directFilterBuffer,
+                        geometryBuffer, settings_.directFilter_, settings_.directChartTracing_.numTasks_, stopToken);
                 }
 
                 if (settings_.indirectFilter_.kernelRadius_ > 0)
                 {
-                    FilterIndirectLight(bakedIndirect, indirectFilterBuffer,
-                        geometryBuffer, settings_.indirectFilter_, settings_.indirectChartTracing_.numTasks_);
+                    FilterIndirectLight(context_, bakedIndirect, indirectFilterBuffer,
+                        geometryBuffer, settings_.indirectFilter_, settings_.indirectChartTracing_.numTasks_, stopToken);
                 }
 
+                if (stopToken.IsStopped())
+                    return false;
+
                 // Generate final images
                 BakedLightmap bakedLightmap(settings_.charting_.lightmapSize_);
                 for (unsigned i = 0; i < bakedLightmap.lightmap_.size(); ++i)
@@ -364,9 +370,12 @@ struct IncrementalLightBaker::Impl
             {
                 BakeDirectLightForLightProbes(lightProbesBakedData,
                     bakedChunk->lightProbesCollection_, *bakedChunk->raytracerScene_,
-                    bakedLight, settings_.directProbesTracing_);
+                    bakedLight, settings_.directProbesTracing_, stopToken);
             }
 
+            if (stopToken.IsStopped())
+                return false;
+
             // Save light probes
             for (unsigned groupIndex = 0; groupIndex < bakedChunk->numUniqueLightProbes_; ++groupIndex)
             {
@@ -540,12 +540,12 @@ struct LightProbeDirectTracingKernel
 /// Trace direct lighting.
 template <class T, class U>
 void TraceDirectLight(T sharedKernel, U sharedGenerator,
-    const RaytracerScene& raytracerScene, const DirectLightTracingSettings& settings)
+    const RaytracerScene& raytracerScene, const DirectLightTracingSettings& settings, const StopToken& stopToken)
 {
     RTCScene scene = raytracerScene.GetEmbreeScene();
     const ea::vector<RaytracerGeometry>& raytracerGeometries = raytracerScene.GetGeometries();
 
-    ParallelFor(sharedKernel.GetNumElements(), settings.numTasks_,
+    ParallelFor(raytracerScene.GetContext(), sharedKernel.GetNumElements(), settings.numTasks_, stopToken,
         [&](unsigned fromIndex, unsigned toIndex)
     {
         auto kernel = sharedKernel;
@@ -779,11 +779,11 @@ struct LightProbeIndirectTracingKernel
 /// Trace indirect lighting.
 template <class T>
 void TraceIndirectLight(T sharedKernel, const ea::vector<const LightmapChartBakedDirect*>& bakedDirect,
-    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings)
+    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings, const StopToken& stopToken)
 {
     assert(settings.maxBounces_ <= IndirectLightTracingSettings::MaxBounces);
 
-    ParallelFor(sharedKernel.GetNumElements(), settings.numTasks_,
+    ParallelFor(raytracerScene.GetContext(), sharedKernel.GetNumElements(), settings.numTasks_, stopToken,
         [&](unsigned fromIndex, unsigned toIndex)
     {
         T kernel = sharedKernel;
@@ -920,7 +920,7 @@ void PreprocessGeometryBuffer(LightmapChartGeometryBuffer& geometryBuffer,
 {
     RTCScene scene = raytracerScene.GetEmbreeScene();
     const ea::vector<RaytracerGeometry>& raytracerGeometries = raytracerScene.GetGeometries();
-    ParallelFor(geometryBuffer.positions_.size(), settings.numTasks_,
+    ParallelFor(raytracerScene.GetContext(), geometryBuffer.positions_.size(), settings.numTasks_,
         [&](unsigned fromIndex, unsigned toIndex)
     {
         RTCRayHit rayHit;
@@ -1007,10 +1007,10 @@ void PreprocessGeometryBuffer(LightmapChartGeometryBuffer& geometryBuffer,
     });
 }
 
-void BakeEmissionLight(LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
-    const EmissionLightTracingSettings& settings, float indirectBrightnessMultiplier)
+void BakeEmissionLight(Context* context, LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
+    const EmissionLightTracingSettings& settings, float indirectBrightnessMultiplier, const StopToken& stopToken)
 {
-    ParallelFor(bakedDirect.directLight_.size(), settings.numTasks_,
+    ParallelFor(context, bakedDirect.directLight_.size(), settings.numTasks_, stopToken,
         [&](unsigned fromIndex, unsigned toIndex)
     {
         for (unsigned i = fromIndex; i < toIndex; ++i)
@@ -1031,7 +1031,7 @@ void BakeEmissionLight(LightmapChartBakedDirect& bakedDirect, const LightmapChar
 
 void BakeDirectLightForCharts(LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
     const RaytracerScene& raytracerScene, const ea::vector<unsigned>& geometryBufferToRaytracer,
-    const BakedLight& light, const DirectLightTracingSettings& settings)
+    const BakedLight& light, const DirectLightTracingSettings& settings, const StopToken& stopToken)
 {
     const bool bakeDirect = light.lightMode_ == LM_BAKED;
     const bool bakeIndirect = true;
@@ -1043,24 +1043,25 @@ void BakeDirectLightForCharts(LightmapChartBakedDirect& bakedDirect, const Light
     {
         const RayGeneratorForDirectLight generator{ light.color_, light.direction_, light.rotation_,
             raytracerScene.GetMaxDistance(), light.halfAngleTan_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
     else if (light.lightType_ == LIGHT_POINT)
     {
         const RayGeneratorForPointLight generator{ light.color_, light.position_, light.distance_, light.radius_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
     else if (light.lightType_ == LIGHT_SPOT)
     {
         const RayGeneratorForSpotLight generator{ light.color_, light.position_, light.direction_, light.rotation_,
             light.distance_, light.radius_, light.cutoff_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
 }
 
 void BakeDirectLightForLightProbes(
     LightProbeCollectionBakedData& bakedData, const LightProbeCollection& collection,
-    const RaytracerScene& raytracerScene, const BakedLight& light, const DirectLightTracingSettings& settings)
+    const RaytracerScene& raytracerScene, const BakedLight& light, const DirectLightTracingSettings& settings,
+    const StopToken& stopToken)
 {
     const bool bakeDirect = light.lightMode_ == LM_BAKED;
     const unsigned numSamples = CalculateNumSamples(light, settings.maxSamples_);
@@ -1071,18 +1072,18 @@ void BakeDirectLightForLightProbes(
     {
         const RayGeneratorForDirectLight generator{ light.color_, light.direction_, light.rotation_,
             raytracerScene.GetMaxDistance(), light.halfAngleTan_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
     else if (light.lightType_ == LIGHT_POINT)
     {
         const RayGeneratorForPointLight generator{ light.color_, light.position_, light.distance_, light.radius_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
     else if (light.lightType_ == LIGHT_SPOT)
     {
         const RayGeneratorForSpotLight generator{ light.color_, light.position_, light.direction_, light.rotation_,
             light.distance_, light.radius_, light.cutoff_ };
-        TraceDirectLight(kernel, generator, raytracerScene, settings);
+        TraceDirectLight(kernel, generator, raytracerScene, settings, stopToken);
     }
 }
 
@@ -1090,26 +1091,26 @@ void BakeIndirectLightForCharts(LightmapChartBakedIndirect& bakedIndirect,
     const ea::vector<const LightmapChartBakedDirect*>& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
     const TetrahedralMesh& lightProbesMesh, const LightProbeCollectionBakedData& lightProbesData,
     const RaytracerScene& raytracerScene, const ea::vector<unsigned>& geometryBufferToRaytracer,
-    const IndirectLightTracingSettings& settings)
+    const IndirectLightTracingSettings& settings, const StopToken& stopToken)
 {
     if (settings.maxBounces_ == 0)
         return;
 
     const ChartIndirectTracingKernel kernel{ &bakedIndirect, &geometryBuffer, &lightProbesMesh, &lightProbesData,
         &geometryBufferToRaytracer, &raytracerScene.GetGeometries(), &settings };
-    TraceIndirectLight(kernel, bakedDirect, raytracerScene, settings);
+    TraceIndirectLight(kernel, bakedDirect, raytracerScene, settings, stopToken);
 }
 
 void BakeIndirectLightForLightProbes(
     LightProbeCollectionBakedData& bakedData, const LightProbeCollection& collection,
     const ea::vector<const LightmapChartBakedDirect*>& bakedDirect,
-    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings)
+    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings, const StopToken& stopToken)
 {
     if (settings.maxBounces_ == 0)
         return;
 
     const LightProbeIndirectTracingKernel kernel{ &collection, &bakedData, &settings };
-    TraceIndirectLight(kernel, bakedDirect, raytracerScene, settings);
+    TraceIndirectLight(kernel, bakedDirect, raytracerScene, settings, stopToken);
 }
 
 }
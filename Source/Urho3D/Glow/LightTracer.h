@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "../Core/StopToken.h"
 #include "../Glow/BakedLight.h"
 #include "../Glow/LightmapCharter.h"
 #include "../Glow/LightmapGeometryBuffer.h"
@@ -115,30 +116,31 @@ struct LightmapChartBakedIndirect
 };
 
 /// Accumulate emission light.
-URHO3D_API void BakeEmissionLight(LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
-    const EmissionLightTracingSettings& settings, float indirectBrightnessMultiplier);
+URHO3D_API void BakeEmissionLight(Context* context, LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
+    const EmissionLightTracingSettings& settings, float indirectBrightnessMultiplier, const StopToken& stopToken);
 
 /// Accumulate direct light for charts.
 URHO3D_API void BakeDirectLightForCharts(LightmapChartBakedDirect& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
     const RaytracerScene& raytracerScene, const ea::vector<unsigned>& geometryBufferToRaytracer,
-    const BakedLight& light, const DirectLightTracingSettings& settings);
+    const BakedLight& light, const DirectLightTracingSettings& settings, const StopToken& stopToken);
 
 /// Accumulate direct light for light probes.
 URHO3D_API void BakeDirectLightForLightProbes(
     LightProbeCollectionBakedData& bakedData, const LightProbeCollection& collection,
-    const RaytracerScene& raytracerScene, const BakedLight& light, const DirectLightTracingSettings& settings);
+    const RaytracerScene& raytracerScene, const BakedLight& light, const DirectLightTracingSettings& settings,
+    const StopToken& stopToken);
 
 /// Accumulate indirect light for charts.
 URHO3D_API void BakeIndirectLightForCharts(LightmapChartBakedIndirect& bakedIndirect,
     const ea::vector<const LightmapChartBakedDirect*>& bakedDirect, const LightmapChartGeometryBuffer& geometryBuffer,
     const TetrahedralMesh& lightProbesMesh, const LightProbeCollectionBakedData& lightProbesData,
     const RaytracerScene& raytracerScene, const ea::vector<unsigned>& geometryBufferToRaytracer,
-    const IndirectLightTracingSettings& settings);
+    const IndirectLightTracingSettings& settings, const StopToken& stopToken);
 
 /// Accumulate indirect light for light probes.
 URHO3D_API void BakeIndirectLightForLightProbes(
     LightProbeCollectionBakedData& bakedData, const LightProbeCollection& collection,
     const ea::vector<const LightmapChartBakedDirect*>& bakedDirect,
-    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings);
+    const RaytracerScene& raytracerScene, const IndirectLightTracingSettings& settings, const StopToken& stopToken);
 
 }
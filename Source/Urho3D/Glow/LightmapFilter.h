@@ -33,11 +33,13 @@ namespace Urho3D
 {
 
 /// Filter direct light.
-URHO3D_API void FilterDirectLight(const LightmapChartBakedDirect& bakedDirect, ea::vector<Vector3>& outputBuffer,
-    const LightmapChartGeometryBuffer& geometryBuffer, const EdgeStoppingGaussFilterParameters& params, unsigned numTasks);
+URHO3D_API void FilterDirectLight(Context* context, const LightmapChartBakedDirect& bakedDirect, ea::vector<Vector3>& outputBuffer,
+    const LightmapChartGeometryBuffer& geometryBuffer, const EdgeStoppingGaussFilterParameters& params, unsigned numTasks,
+    const StopToken& stopToken);
 
 /// Filter indirect light.
-URHO3D_API void FilterIndirectLight(const LightmapChartBakedIndirect& bakedIndirect, ea::vector<Vector4>& outputBuffer,
-    const LightmapChartGeometryBuffer& geometryBuffer, const EdgeStoppingGaussFilterParameters& params, unsigned numTasks);
+URHO3D_API void FilterIndirectLight(Context* context, const LightmapChartBakedIndirect& bakedIndirect, ea::vector<Vector4>& outputBuffer,
+    const LightmapChartGeometryBuffer& geometryBuffer, const EdgeStoppingGaussFilterParameters& params, unsigned numTasks,
+    const StopToken& stopToken);
 
 }
@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationState.h"
@@ -329,8 +330,14 @@ void AnimatedModel::UpdateGeometry(const FrameInfo& frame)
 
 UpdateGeometryType AnimatedModel::GetUpdateGeometryType()
 {
-    if (morphsDirty_ || forceAnimationUpdate_ || (skinningDirty_ && softwareSkinning_))
+    if (forceAnimationUpdate_)
         return UPDATE_MAIN_THREAD;
+    else if (morphsDirty_ || (skinningDirty_ && softwareSkinning_))
+    {
+        // Software skinning and morphing only touch CPU-side copies of the vertex data, so only the upload needs the main thread
+        auto* renderer = GetSubsystem<Renderer>();
+        return renderer && renderer->GetThreadedSoftwareAnimation() ? UPDATE_WORKER_THREAD_COMMIT : UPDATE_MAIN_THREAD;
+    }
     else if (skinningDirty_)
         return UPDATE_WORKER_THREAD;
     else
@@ -1283,12 +1290,24 @@ void AnimatedModel::UpdateMorphs()
         modelAnimator_->ApplyMorphs(morphs_);
         if (softwareSkinning_)
             modelAnimator_->ApplySkinning(skinMatrices_);
-        modelAnimator_->Commit();
+
+        if (Thread::IsMainThread())
+            modelAnimator_->Commit();
+        else
+            commitPending_ = true;
     }
 
     morphsDirty_ = false;
 }
 
+void AnimatedModel::CommitGeometry()
+{
+    if (commitPending_ && modelAnimator_)
+        modelAnimator_->Commit();
+
+    commitPending_ = false;
+}
+
 void AnimatedModel::HandleModelReloadFinished(StringHash eventType, VariantMap& eventData)
 {
     Model* currentModel = model_;
@@ -69,6 +69,8 @@ public:
     void UpdateGeometry(const FrameInfo& frame) override;
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     UpdateGeometryType GetUpdateGeometryType() override;
+    /// Upload software skinning and morphing results prepared in a worker thread.
+    void CommitGeometry() override;
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) override;
 
@@ -213,7 +215,7 @@ private:
     void UpdateAnimation(const FrameInfo& frame);
     /// Recalculate skinning.
     void UpdateSkinning();
-    /// Reapply all vertex morphs.
+    /// Reapply all vertex morphs. When called from a worker thread, the GPU upload is deferred to CommitGeometry().
     void UpdateMorphs();
     /// Handle model reload finished.
     void HandleModelReloadFinished(StringHash eventType, VariantMap& eventData);
@@ -270,6 +272,8 @@ private:
     bool assignBonesPending_;
     /// Force animation update after becoming visible flag.
     bool forceAnimationUpdate_;
+    /// Software animation results waiting for upload to the GPU flag.
+    bool commitPending_{};
 };
 
 }
@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include <EASTL/algorithm.h>
 #include <EASTL/sort.h>
 
 #include "../Core/Context.h"
@@ -37,9 +38,265 @@
 
 #include "../DebugNew.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Quantization range of smallest-three quaternion components.
+const float QUATERNION_COMPONENT_RANGE = 1.41421356f;
+/// Maximum value of a 15-bit quaternion component.
+const float QUATERNION_COMPONENT_MAX = 32767.0f;
+/// Maximum value of a 16-bit vector component.
+const float VECTOR_COMPONENT_MAX = 65535.0f;
+
+Vector3 InterpolateSample(const Vector3& lhs, const Vector3& rhs, float t) { return lhs.Lerp(rhs, t); }
+
+Quaternion InterpolateSample(const Quaternion& lhs, const Quaternion& rhs, float t) { return lhs.Nlerp(rhs, t, true); }
+
+float SampleError(const Vector3& lhs, const Vector3& rhs) { return (lhs - rhs).Length(); }
+
+float SampleError(const Quaternion& lhs, const Quaternion& rhs) { return 2.0f * Acos(Abs(lhs.DotProduct(rhs))); }
+
+/// Return samples taken from reference samples at a lower uniform rate that divides the reference intervals evenly, as long as the error stays within tolerance.
+template <class T> ea::vector<T> ReduceSamples(const ea::vector<T>& reference, float baseRate, float tolerance, float& sampleRate)
+{
+    const unsigned numReference = reference.size();
+
+    // Constant channel
+    bool constant = true;
+    for (unsigned i = 1; i < numReference && constant; ++i)
+        constant = SampleError(reference[0], reference[i]) <= tolerance;
+    if (constant)
+    {
+        sampleRate = baseRate;
+        return { reference[0] };
+    }
+
+    // Use the largest divisor of the reference intervals that keeps the reconstruction within tolerance. Dividing the
+    // intervals evenly keeps the last sample on the last reference sample, so the end pose stays at the animation length
+    const unsigned numIntervals = numReference - 1;
+    unsigned divisor = 1;
+    for (unsigned candidate = numIntervals; candidate > 1; --candidate)
+    {
+        if (numIntervals % candidate)
+            continue;
+
+        const unsigned lastIndex = numIntervals / candidate - 1;
+        bool withinTolerance = true;
+        for (unsigned i = 1; i <= numIntervals && withinTolerance; ++i)
+        {
+            const unsigned index = Min(i / candidate, lastIndex);
+            const float t = static_cast<float>(i - index * candidate) / candidate;
+            const T value = InterpolateSample(reference[index * candidate], reference[(index + 1) * candidate], t);
+            withinTolerance = SampleError(value, reference[i]) <= tolerance;
+        }
+
+        if (withinTolerance)
+        {
+            divisor = candidate;
+            break;
+        }
+    }
+
+    const unsigned numSamples = numIntervals / divisor + 1;
+    ea::vector<T> samples(numSamples);
+    for (unsigned i = 0; i < numSamples; ++i)
+        samples[i] = reference[i * divisor];
+    sampleRate = baseRate / divisor;
+    return samples;
+}
+
+void QuantizeChannel(CompressedAnimationChannel& channel, const ea::vector<Vector3>& samples, float sampleRate)
+{
+    Vector3 minValue = samples[0];
+    Vector3 maxValue = samples[0];
+    for (const Vector3& sample : samples)
+    {
+        minValue = VectorMin(minValue, sample);
+        maxValue = VectorMax(maxValue, sample);
+    }
+
+    const Vector3 range = maxValue - minValue;
+    channel.numSamples_ = samples.size();
+    channel.sampleRate_ = sampleRate;
+    channel.offset_ = minValue;
+    channel.scale_ = range / VECTOR_COMPONENT_MAX;
+    channel.data_.resize(samples.size() * 3 + 1);
+
+    for (unsigned i = 0; i < samples.size(); ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+        {
+            const float normalized = range.Data()[j] > 0.0f ? (samples[i].Data()[j] - minValue.Data()[j]) / range.Data()[j] : 0.0f;
+            channel.data_[i * 3 + j] = static_cast<unsigned short>(Clamp(RoundToInt(normalized * VECTOR_COMPONENT_MAX), 0, 65535));
+        }
+    }
+    channel.data_.back() = 0;
+}
+
+void QuantizeChannel(CompressedAnimationChannel& channel, const ea::vector<Quaternion>& samples, float sampleRate)
+{
+    channel.numSamples_ = samples.size();
+    channel.sampleRate_ = sampleRate;
+    channel.offset_ = Vector3::ZERO;
+    channel.scale_ = Vector3::ZERO;
+    channel.data_.resize(samples.size() * 3 + 1);
+
+    for (unsigned i = 0; i < samples.size(); ++i)
+    {
+        const Quaternion rotation = samples[i].Normalized();
+        const float components[4] = { rotation.w_, rotation.x_, rotation.y_, rotation.z_ };
+
+        // Drop the largest component, it is reconstructed from the unit length
+        unsigned largest = 0;
+        for (unsigned j = 1; j < 4; ++j)
+        {
+            if (Abs(components[j]) > Abs(components[largest]))
+                largest = j;
+        }
+        const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+        unsigned short* dest = &channel.data_[i * 3];
+        unsigned k = 0;
+        for (unsigned j = 0; j < 4; ++j)
+        {
+            if (j == largest)
+                continue;
+            const float normalized = components[j] * sign / QUATERNION_COMPONENT_RANGE + 0.5f;
+            dest[k++] = static_cast<unsigned short>(Clamp(RoundToInt(normalized * QUATERNION_COMPONENT_MAX), 0, 32767));
+        }
+
+        // Store the index of the dropped component in the high bits of the first two values
+        dest[0] |= (largest & 1u) << 15u;
+        dest[1] |= (largest >> 1u) << 15u;
+    }
+    channel.data_.back() = 0;
+}
+
+/// Load the masked 16-bit values of the samples around time. Return index of the first sample.
+inline unsigned LoadSamplePair(const CompressedAnimationChannel& channel, float time, unsigned short mask, float* values,
+    float* nextValues, unsigned& nextIndex, float& t)
+{
+    const unsigned index = channel.GetSampleIndex(time, t);
+    nextIndex = Min(index + 1, channel.numSamples_ - 1);
+    const unsigned short* data = &channel.data_[index * 3];
+    const unsigned short* nextData = &channel.data_[nextIndex * 3];
+
+#ifdef URHO3D_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i valueMask = _mm_set1_epi32(mask);
+    _mm_storeu_ps(values, _mm_cvtepi32_ps(_mm_and_si128(
+        _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)), zero), valueMask)));
+    _mm_storeu_ps(nextValues, _mm_cvtepi32_ps(_mm_and_si128(
+        _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(nextData)), zero), valueMask)));
+#else
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        values[i] = static_cast<float>(data[i] & mask);
+        nextValues[i] = static_cast<float>(nextData[i] & mask);
+    }
+#endif
+
+    return index;
+}
+
+Vector3 DecodeVector3(const CompressedAnimationChannel& channel, float time)
+{
+    float values[4];
+    float nextValues[4];
+    unsigned nextIndex;
+    float t;
+    LoadSamplePair(channel, time, 0xffff, values, nextValues, nextIndex, t);
+
+#ifdef URHO3D_SSE
+    __m128 value = _mm_loadu_ps(values);
+    value = _mm_add_ps(value, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(nextValues), value), _mm_set1_ps(t)));
+    value = _mm_add_ps(_mm_mul_ps(value, _mm_set_ps(0.0f, channel.scale_.z_, channel.scale_.y_, channel.scale_.x_)),
+        _mm_set_ps(0.0f, channel.offset_.z_, channel.offset_.y_, channel.offset_.x_));
+    _mm_storeu_ps(values, value);
+    return Vector3(values);
+#else
+    const Vector3 value = Vector3(values).Lerp(Vector3(nextValues), t);
+    return channel.offset_ + value * channel.scale_;
+#endif
+}
+
+Quaternion DecodeRotation(const unsigned short* data, const float* values)
+{
+    const unsigned largest = (data[0] >> 15u) | ((data[1] >> 15u) << 1u);
+    float components[4];
+    float sumSquares = 0.0f;
+    unsigned k = 0;
+    for (unsigned j = 0; j < 4; ++j)
+    {
+        if (j == largest)
+            continue;
+        components[j] = (values[k++] / QUATERNION_COMPONENT_MAX - 0.5f) * QUATERNION_COMPONENT_RANGE;
+        sumSquares += components[j] * components[j];
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+    return Quaternion(components[0], components[1], components[2], components[3]);
+}
+
+Quaternion DecodeQuaternion(const CompressedAnimationChannel& channel, float time)
+{
+    float values[4];
+    float nextValues[4];
+    unsigned nextIndex;
+    float t;
+    const unsigned index = LoadSamplePair(channel, time, 0x7fff, values, nextValues, nextIndex, t);
+    const Quaternion rotation = DecodeRotation(&channel.data_[index * 3], values);
+    if (index == nextIndex || t <= 0.0f)
+        return rotation;
+    return rotation.Nlerp(DecodeRotation(&channel.data_[nextIndex * 3], nextValues), t, true);
+}
+
+bool ReadChannel(Deserializer& source, CompressedAnimationChannel& channel, bool hasRange)
+{
+    channel.numSamples_ = source.ReadUInt();
+    channel.sampleRate_ = source.ReadFloat();
+    if (hasRange)
+    {
+        channel.offset_ = source.ReadVector3();
+        channel.scale_ = source.ReadVector3();
+    }
+
+    // Sampling needs at least one sample, and the samples must fit in the remaining data
+    const unsigned dataSize = channel.numSamples_ * 3 * sizeof(unsigned short);
+    if (!channel.numSamples_ || channel.numSamples_ > M_MAX_UNSIGNED / (3 * sizeof(unsigned short)) ||
+        dataSize > source.GetSize() - source.GetPosition())
+    {
+        channel.numSamples_ = 0;
+        channel.data_.clear();
+        return false;
+    }
+
+    channel.data_.resize(channel.numSamples_ * 3 + 1);
+    source.Read(channel.data_.data(), dataSize);
+    channel.data_.back() = 0;
+    return true;
+}
+
+void WriteChannel(Serializer& dest, const CompressedAnimationChannel& channel, bool hasRange)
+{
+    dest.WriteUInt(channel.numSamples_);
+    dest.WriteFloat(channel.sampleRate_);
+    if (hasRange)
+    {
+        dest.WriteVector3(channel.offset_);
+        dest.WriteVector3(channel.scale_);
+    }
+    dest.Write(channel.data_.data(), channel.numSamples_ * 3 * sizeof(unsigned short));
+}
+
+}
+
 inline bool CompareTriggers(const AnimationTriggerPoint& lhs, const AnimationTriggerPoint& rhs)
 {
     return lhs.time_ < rhs.time_;
@@ -98,20 +355,151 @@ bool AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
     if (time < 0.0f)
         time = 0.0f;
 
-    if (index >= keyFrames_.size())
-        index = keyFrames_.size() - 1;
+    const unsigned numKeyFrames = keyFrames_.size();
+    if (index >= numKeyFrames)
+        index = numKeyFrames - 1;
 
-    // Check for being too far ahead
-    while (index && time < keyFrames_[index].time_)
-        --index;
+    // Playback usually stays at the previous keyframe or advances by one
+    if (time >= keyFrames_[index].time_)
+    {
+        if (index + 1 >= numKeyFrames || time < keyFrames_[index + 1].time_)
+            return true;
+        if (index + 2 >= numKeyFrames || time < keyFrames_[index + 2].time_)
+        {
+            ++index;
+            return true;
+        }
+    }
 
-    // Check for being too far behind
-    while (index < keyFrames_.size() - 1 && time >= keyFrames_[index + 1].time_)
-        ++index;
+    // Otherwise find the last keyframe not after time
+    auto i = ea::upper_bound(keyFrames_.begin(), keyFrames_.end(), time,
+        [](float lhs, const AnimationKeyFrame& rhs) { return lhs < rhs.time_; });
+    index = i != keyFrames_.begin() ? static_cast<unsigned>(i - keyFrames_.begin()) - 1 : 0;
+    return true;
+}
+
+bool AnimationTrack::SampleKeyFrames(float time, float length, bool looped, unsigned& index, Vector3& position,
+    Quaternion& rotation, Vector3& scale) const
+{
+    if (!GetKeyFrameIndex(time, index))
+        return false;
+
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    unsigned nextIndex = index + 1;
+    bool interpolate = true;
+    if (nextIndex >= keyFrames_.size())
+    {
+        if (!looped)
+        {
+            nextIndex = index;
+            interpolate = false;
+        }
+        else
+            nextIndex = 0;
+    }
+
+    const AnimationKeyFrame& keyFrame = keyFrames_[index];
+    if (interpolate)
+    {
+        const AnimationKeyFrame& nextKeyFrame = keyFrames_[nextIndex];
+        float timeInterval = nextKeyFrame.time_ - keyFrame.time_;
+        if (timeInterval < 0.0f)
+            timeInterval += length;
+        float t = timeInterval > 0.0f ? (time - keyFrame.time_) / timeInterval : 1.0f;
+
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame.position_.Lerp(nextKeyFrame.position_, t);
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, t);
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame.scale_.Lerp(nextKeyFrame.scale_, t);
+    }
+    else
+    {
+        if (channelMask_ & CHANNEL_POSITION)
+            position = keyFrame.position_;
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = keyFrame.rotation_;
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = keyFrame.scale_;
+    }
 
     return true;
 }
 
+void AnimationTrack::Compress(float length, const AnimationCompressionSettings& settings)
+{
+    if (compressed_ || keyFrames_.empty())
+        return;
+
+    // Round the base rate so that the last sample falls exactly on the animation length
+    const unsigned numIntervals = length > 0.0f ? (unsigned)Max(CeilToInt(length * Max(settings.sampleRate_, 1.0f)), 1) : 0;
+    const float baseRate = numIntervals ? numIntervals / length : 1.0f;
+    const unsigned numReference = numIntervals + 1;
+
+    ea::vector<Vector3> positions(numReference);
+    ea::vector<Quaternion> rotations(numReference);
+    ea::vector<Vector3> scales(numReference, Vector3::ONE);
+    unsigned index = 0;
+    for (unsigned i = 0; i < numReference; ++i)
+    {
+        const float time = i < numIntervals ? i / baseRate : length;
+        SampleKeyFrames(time, length, false, index, positions[i], rotations[i], scales[i]);
+    }
+
+    float sampleRate;
+    if (channelMask_ & CHANNEL_POSITION)
+    {
+        const ea::vector<Vector3> samples = ReduceSamples(positions, baseRate, settings.positionTolerance_, sampleRate);
+        QuantizeChannel(positionChannel_, samples, sampleRate);
+    }
+    if (channelMask_ & CHANNEL_ROTATION)
+    {
+        const ea::vector<Quaternion> samples = ReduceSamples(rotations, baseRate, settings.rotationTolerance_, sampleRate);
+        QuantizeChannel(rotationChannel_, samples, sampleRate);
+    }
+    if (channelMask_ & CHANNEL_SCALE)
+    {
+        const ea::vector<Vector3> samples = ReduceSamples(scales, baseRate, settings.scaleTolerance_, sampleRate);
+        QuantizeChannel(scaleChannel_, samples, sampleRate);
+    }
+
+    endTime_ = Clamp(keyFrames_.back().time_, 0.0f, length);
+    keyFrames_.clear();
+    keyFrames_.shrink_to_fit();
+    compressed_ = true;
+}
+
+void AnimationTrack::SampleCompressed(float time, float length, bool looped, Vector3& position, Quaternion& rotation,
+    Vector3& scale) const
+{
+    // The channels hold the last keyframe until the animation end. When looped, interpolate from it to the first sample instead
+    if (looped && time > endTime_ && endTime_ < length)
+    {
+        const float t = Min((time - endTime_) / (length - endTime_), 1.0f);
+        if (channelMask_ & CHANNEL_POSITION)
+            position = DecodeVector3(positionChannel_, endTime_).Lerp(DecodeVector3(positionChannel_, 0.0f), t);
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = DecodeQuaternion(rotationChannel_, endTime_).Nlerp(DecodeQuaternion(rotationChannel_, 0.0f), t, true);
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = DecodeVector3(scaleChannel_, endTime_).Lerp(DecodeVector3(scaleChannel_, 0.0f), t);
+        return;
+    }
+
+    if (channelMask_ & CHANNEL_POSITION)
+        position = DecodeVector3(positionChannel_, time);
+    if (channelMask_ & CHANNEL_ROTATION)
+        rotation = DecodeQuaternion(rotationChannel_, time);
+    if (channelMask_ & CHANNEL_SCALE)
+        scale = DecodeVector3(scaleChannel_, time);
+}
+
+unsigned AnimationTrack::GetMemoryUse() const
+{
+    return keyFrames_.size() * sizeof(AnimationKeyFrame) + positionChannel_.GetMemoryUse() + rotationChannel_.GetMemoryUse() +
+        scaleChannel_.GetMemoryUse();
+}
+
 Animation::Animation(Context* context) :
     ResourceWithMetadata(context),
     length_(0.f)
@@ -127,10 +515,10 @@ void Animation::RegisterObject(Context* context)
 
 bool Animation::BeginLoad(Deserializer& source)
 {
-    unsigned memoryUse = sizeof(Animation);
-
     // Check ID
-    if (source.ReadFileID() != "UANI")
+    const ea::string fileID = source.ReadFileID();
+    const bool compressedFile = fileID == "UACA";
+    if (fileID != "UANI" && !compressedFile)
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
@@ -143,7 +531,6 @@ bool Animation::BeginLoad(Deserializer& source)
     tracks_.clear();
 
     unsigned tracks = source.ReadUInt();
-    memoryUse += tracks * sizeof(AnimationTrack);
 
     // Read tracks
     for (unsigned i = 0; i < tracks; ++i)
@@ -151,9 +538,24 @@ bool Animation::BeginLoad(Deserializer& source)
         AnimationTrack* newTrack = CreateTrack(source.ReadString());
         newTrack->channelMask_ = AnimationChannelFlags(source.ReadUByte());
 
+        // Compressed files store quantized channels for each track that could be compressed
+        if (compressedFile && source.ReadBool())
+        {
+            newTrack->endTime_ = source.ReadFloat();
+            if (((newTrack->channelMask_ & CHANNEL_POSITION) && !ReadChannel(source, newTrack->positionChannel_, true)) ||
+                ((newTrack->channelMask_ & CHANNEL_ROTATION) && !ReadChannel(source, newTrack->rotationChannel_, false)) ||
+                ((newTrack->channelMask_ & CHANNEL_SCALE) && !ReadChannel(source, newTrack->scaleChannel_, true)))
+            {
+                URHO3D_LOGERROR(source.GetName() + " has an invalid compressed channel in track " + newTrack->name_);
+                tracks_.clear();
+                return false;
+            }
+            newTrack->compressed_ = true;
+            continue;
+        }
+
         unsigned keyFrames = source.ReadUInt();
         newTrack->keyFrames_.resize(keyFrames);
-        memoryUse += keyFrames * sizeof(AnimationKeyFrame);
 
         // Read keyframes of the track
         for (unsigned j = 0; j < keyFrames; ++j)
@@ -169,6 +571,11 @@ bool Animation::BeginLoad(Deserializer& source)
         }
     }
 
+    // Creating tracks clears the compressed flag, set it once all tracks are known
+    compressed_ = !tracks_.empty();
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        compressed_ &= i->second.compressed_;
+
     // Optionally read triggers from an XML file
     auto* cache = GetSubsystem<ResourceCache>();
     ea::string xmlName = ReplaceExtension(GetName(), ".xml");
@@ -186,51 +593,54 @@ bool Animation::BeginLoad(Deserializer& source)
         }
 
         LoadMetadataFromXML(rootElem);
-
-        memoryUse += triggers_.size() * sizeof(AnimationTriggerPoint);
-        SetMemoryUse(memoryUse);
-        return true;
     }
-
-    // Optionally read triggers from a JSON file
-    ea::string jsonName = ReplaceExtension(GetName(), ".json");
-
-    SharedPtr<JSONFile> jsonFile(cache->GetTempResource<JSONFile>(jsonName, false));
-    if (jsonFile)
+    else
     {
-        const JSONValue& rootVal = jsonFile->GetRoot();
-        const JSONArray& triggerArray = rootVal.Get("triggers").GetArray();
+        // Optionally read triggers from a JSON file
+        ea::string jsonName = ReplaceExtension(GetName(), ".json");
 
-        for (unsigned i = 0; i < triggerArray.size(); i++)
+        SharedPtr<JSONFile> jsonFile(cache->GetTempResource<JSONFile>(jsonName, false));
+        if (jsonFile)
         {
-            const JSONValue& triggerValue = triggerArray.at(i);
-            JSONValue normalizedTimeValue = triggerValue.Get("normalizedTime");
-            if (!normalizedTimeValue.IsNull())
-                AddTrigger(normalizedTimeValue.GetFloat(), true, triggerValue.GetVariant());
-            else
+            const JSONValue& rootVal = jsonFile->GetRoot();
+            const JSONArray& triggerArray = rootVal.Get("triggers").GetArray();
+
+            for (unsigned i = 0; i < triggerArray.size(); i++)
             {
-                JSONValue timeVal = triggerValue.Get("time");
-                if (!timeVal.IsNull())
-                    AddTrigger(timeVal.GetFloat(), false, triggerValue.GetVariant());
+                const JSONValue& triggerValue = triggerArray.at(i);
+                JSONValue normalizedTimeValue = triggerValue.Get("normalizedTime");
+                if (!normalizedTimeValue.IsNull())
+                    AddTrigger(normalizedTimeValue.GetFloat(), true, triggerValue.GetVariant());
+                else
+                {
+                    JSONValue timeVal = triggerValue.Get("time");
+                    if (!timeVal.IsNull())
+                        AddTrigger(timeVal.GetFloat(), false, triggerValue.GetVariant());
+                }
             }
-        }
 
-        const JSONArray& metadataArray = rootVal.Get("metadata").GetArray();
-        LoadMetadataFromJSON(metadataArray);
-
-        memoryUse += triggers_.size() * sizeof(AnimationTriggerPoint);
-        SetMemoryUse(memoryUse);
-        return true;
+            const JSONArray& metadataArray = rootVal.Get("metadata").GetArray();
+            LoadMetadataFromJSON(metadataArray);
+        }
     }
 
-    SetMemoryUse(memoryUse);
+    // Uncompressed animations can request compression on load through metadata
+    if (!compressed_ && GetMetadata("compress").GetBool())
+        Compress();
+
+    UpdateMemoryUse();
     return true;
 }
 
 bool Animation::Save(Serializer& dest) const
 {
+    // Use the compressed format if any track is compressed. It also holds the tracks that are not
+    bool anyCompressed = false;
+    for (auto i = tracks_.begin(); i != tracks_.end() && !anyCompressed; ++i)
+        anyCompressed = i->second.compressed_;
+
     // Write ID, name and length
-    dest.WriteFileID("UANI");
+    dest.WriteFileID(anyCompressed ? "UACA" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -241,6 +651,23 @@ bool Animation::Save(Serializer& dest) const
         const AnimationTrack& track = i->second;
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
+
+        if (anyCompressed)
+        {
+            dest.WriteBool(track.compressed_);
+            if (track.compressed_)
+            {
+                dest.WriteFloat(track.endTime_);
+                if (track.channelMask_ & CHANNEL_POSITION)
+                    WriteChannel(dest, track.positionChannel_, true);
+                if (track.channelMask_ & CHANNEL_ROTATION)
+                    WriteChannel(dest, track.rotationChannel_, false);
+                if (track.channelMask_ & CHANNEL_SCALE)
+                    WriteChannel(dest, track.scaleChannel_, true);
+                continue;
+            }
+        }
+
         dest.WriteUInt(track.keyFrames_.size());
 
         // Write keyframes of the track
@@ -307,6 +734,7 @@ AnimationTrack* Animation::CreateTrack(const ea::string& name)
         return oldTrack;
 
     AnimationTrack& newTrack = tracks_[nameHash];
+    compressed_ = false;
     newTrack.name_ = name;
     newTrack.nameHash_ = nameHash;
     return &newTrack;
@@ -327,6 +755,7 @@ bool Animation::RemoveTrack(const ea::string& name)
 void Animation::RemoveAllTracks()
 {
     tracks_.clear();
+    compressed_ = false;
 }
 
 void Animation::SetTrigger(unsigned index, const AnimationTriggerPoint& trigger)
@@ -372,6 +801,21 @@ void Animation::SetNumTriggers(unsigned num)
     triggers_.resize(num);
 }
 
+void Animation::Compress(const AnimationCompressionSettings& settings)
+{
+    URHO3D_PROFILE("CompressAnimation");
+
+    compressed_ = true;
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+    {
+        AnimationTrack& track = i->second;
+        track.Compress(length_, settings);
+        compressed_ &= track.IsCompressed();
+    }
+
+    UpdateMemoryUse();
+}
+
 SharedPtr<Animation> Animation::Clone(const ea::string& cloneName) const
 {
     SharedPtr<Animation> ret(context_->CreateObject<Animation>());
@@ -380,6 +824,7 @@ SharedPtr<Animation> Animation::Clone(const ea::string& cloneName) const
     ret->SetAnimationName(animationName_);
     ret->length_ = length_;
     ret->tracks_ = tracks_;
+    ret->compressed_ = compressed_;
     ret->triggers_ = triggers_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
@@ -425,10 +870,21 @@ void Animation::SetTracks(const ea::vector<AnimationTrack>& tracks)
 {
     tracks_.clear();
 
+    compressed_ = !tracks.empty();
     for (auto itr = tracks.begin(); itr != tracks.end(); itr++)
     {
         tracks_[itr->name_] = *itr;
+        compressed_ &= itr->IsCompressed();
     }
 }
 
+void Animation::UpdateMemoryUse()
+{
+    unsigned memoryUse = sizeof(Animation) + tracks_.size() * sizeof(AnimationTrack) +
+        triggers_.size() * sizeof(AnimationTriggerPoint);
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        memoryUse += i->second.GetMemoryUse();
+    SetMemoryUse(memoryUse);
+}
+
 }
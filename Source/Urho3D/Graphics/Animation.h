@@ -74,6 +74,46 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
+/// Settings for compressing animation keyframes into uniformly sampled, quantized channels.
+struct AnimationCompressionSettings
+{
+    /// Base sampling rate in samples per second.
+    float sampleRate_{30.0f};
+    /// Maximum position error allowed when reducing the sampling rate of a channel.
+    float positionTolerance_{0.001f};
+    /// Maximum rotation error in degrees allowed when reducing the sampling rate of a channel.
+    float rotationTolerance_{0.1f};
+    /// Maximum scale error allowed when reducing the sampling rate of a channel.
+    float scaleTolerance_{0.001f};
+};
+
+/// Compressed animation channel. Stores three 16-bit values per sample, taken at a uniform rate from zero to animation length. Rotations use smallest-three quaternion encoding, positions and scales are quantized within the channel bounds.
+struct URHO3D_API CompressedAnimationChannel
+{
+    /// Return sample index and interpolation factor towards the next sample at time. Cost does not depend on the number of samples.
+    unsigned GetSampleIndex(float time, float& t) const
+    {
+        const float position = Max(time * sampleRate_, 0.0f);
+        const unsigned index = Min(static_cast<unsigned>(position), numSamples_ - 1);
+        t = Min(position - static_cast<float>(index), 1.0f);
+        return index;
+    }
+
+    /// Return sample memory use in bytes.
+    unsigned GetMemoryUse() const { return data_.size() * sizeof(unsigned short); }
+
+    /// Number of samples. Single sample for a constant channel.
+    unsigned numSamples_{};
+    /// Samples per second.
+    float sampleRate_{};
+    /// Dequantization offset. Not used for rotations.
+    Vector3 offset_;
+    /// Dequantization scale. Not used for rotations.
+    Vector3 scale_;
+    /// Quantized samples. Padded with one value so that samples can be read with 64-bit loads.
+    ea::vector<unsigned short> data_;
+};
+
 /// Skeletal animation track, stores keyframes of a single bone.
 /// @fakeref
 struct URHO3D_API AnimationTrack
@@ -102,6 +142,17 @@ struct URHO3D_API AnimationTrack
     unsigned GetNumKeyFrames() const { return keyFrames_.size(); }
     /// Return keyframe index based on time and previous index. Return false if animation is empty.
     bool GetKeyFrameIndex(float time, unsigned& index) const;
+    /// Sample keyframes at time using the previous keyframe index. Interpolates across the loop point when looped. Return false if the track is empty.
+    bool SampleKeyFrames(float time, float length, bool looped, unsigned& index, Vector3& position, Quaternion& rotation, Vector3& scale) const;
+
+    /// Resample keyframes into compressed channels over animation length and remove the keyframes.
+    void Compress(float length, const AnimationCompressionSettings& settings);
+    /// Return whether the track has been compressed.
+    bool IsCompressed() const { return compressed_; }
+    /// Sample compressed channels at time. Interpolates from the last keyframe back to the first when looped. Cost does not depend on the animation length.
+    void SampleCompressed(float time, float length, bool looped, Vector3& position, Quaternion& rotation, Vector3& scale) const;
+    /// Return memory use of keyframes or compressed channels in bytes.
+    unsigned GetMemoryUse() const;
 
     /// Bone or scene node name.
     ea::string name_;
@@ -109,8 +160,18 @@ struct URHO3D_API AnimationTrack
     StringHash nameHash_;
     /// Bitmask of included data (position, rotation, scale).
     AnimationChannelFlags channelMask_{};
-    /// Keyframes.
+    /// Keyframes. Empty when compressed.
     ea::vector<AnimationKeyFrame> keyFrames_;
+    /// Compressed flag.
+    bool compressed_{};
+    /// Time of the last keyframe before compression.
+    float endTime_{};
+    /// Compressed position channel.
+    CompressedAnimationChannel positionChannel_;
+    /// Compressed rotation channel.
+    CompressedAnimationChannel rotationChannel_;
+    /// Compressed scale channel.
+    CompressedAnimationChannel scaleChannel_;
 
     /// Instance equality operator.
     bool operator ==(const AnimationTrack& rhs) const
@@ -196,6 +257,8 @@ public:
     /// Resize trigger point vector.
     /// @property
     void SetNumTriggers(unsigned num);
+    /// Compress all tracks into uniformly sampled, quantized channels and drop the keyframes. Compressed animations are saved in the compressed format.
+    void Compress(const AnimationCompressionSettings& settings = AnimationCompressionSettings());
     /// Clone the animation.
     SharedPtr<Animation> Clone(const ea::string& cloneName = EMPTY_STRING) const;
 
@@ -210,6 +273,10 @@ public:
     /// @property
     float GetLength() const { return length_; }
 
+    /// Return whether all tracks are compressed.
+    /// @property
+    bool IsCompressed() const { return compressed_; }
+
     /// Return all animation tracks.
     const ea::unordered_map<StringHash, AnimationTrack>& GetTracks() const { return tracks_; }
 
@@ -239,6 +306,9 @@ public:
     /// Set all animation tracks.
     void SetTracks(const ea::vector<AnimationTrack>& tracks);
 private:
+    /// Recalculate memory use from tracks and triggers.
+    void UpdateMemoryUse();
+
     /// Animation name.
     ea::string animationName_;
     /// Animation name hash.
@@ -247,6 +317,8 @@ private:
     float length_;
     /// Animation tracks.
     ea::unordered_map<StringHash, AnimationTrack> tracks_;
+    /// Compressed flag.
+    bool compressed_{};
     /// Animation trigger points.
     ea::vector<AnimationTriggerPoint> triggers_;
 };
@@ -455,16 +455,22 @@ void AnimationState::Apply()
 
 void AnimationState::ApplyToModel()
 {
-    for (auto i = stateTracks_.begin(); i != stateTracks_.end(); ++i)
+    // Sample all tracks first, so that the compressed channels are decoded in one tight loop
+    trackSamples_.resize(stateTracks_.size());
+    for (unsigned i = 0; i < stateTracks_.size(); ++i)
     {
-        AnimationStateTrack& stateTrack = *i;
+        AnimationStateTrack& stateTrack = stateTracks_[i];
+        AnimationTrackSample& sample = trackSamples_[i];
         float finalWeight = weight_ * stateTrack.weight_;
 
         // Do not apply if zero effective weight or the bone has animation disabled
-        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_)
-            continue;
+        sample.valid_ = !Equals(finalWeight, 0.0f) && stateTrack.bone_->animated_ && SampleTrack(stateTrack, sample);
+    }
 
-        ApplyTrack(stateTrack, finalWeight, true);
+    for (unsigned i = 0; i < stateTracks_.size(); ++i)
+    {
+        if (trackSamples_[i].valid_)
+            ApplyTrackSample(stateTracks_[i], trackSamples_[i], weight_ * stateTracks_[i].weight_, true);
     }
 }
 
@@ -477,60 +483,36 @@ void AnimationState::ApplyToNodes()
 
 void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent)
 {
-    const AnimationTrack* track = stateTrack.track_;
-    Node* node = stateTrack.node_;
-
-    if (track->keyFrames_.empty() || !node)
-        return;
+    AnimationTrackSample sample;
+    if (SampleTrack(stateTrack, sample))
+        ApplyTrackSample(stateTrack, sample, weight, silent);
+}
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
+bool AnimationState::SampleTrack(AnimationStateTrack& stateTrack, AnimationTrackSample& sample) const
+{
+    const AnimationTrack* track = stateTrack.track_;
+    if (!stateTrack.node_)
+        return false;
 
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.size())
+    if (track->IsCompressed())
     {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
+        track->SampleCompressed(time_, animation_->GetLength(), looped_, sample.position_, sample.rotation_, sample.scale_);
+        return true;
     }
 
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
-    const AnimationChannelFlags channelMask = track->channelMask_;
-
-    Vector3 newPosition;
-    Quaternion newRotation;
-    Vector3 newScale;
+    return track->SampleKeyFrames(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, sample.position_,
+        sample.rotation_, sample.scale_);
+}
 
-    if (interpolate)
-    {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
+void AnimationState::ApplyTrackSample(AnimationStateTrack& stateTrack, const AnimationTrackSample& sample, float weight,
+    bool silent)
+{
+    Node* node = stateTrack.node_;
+    const AnimationChannelFlags channelMask = stateTrack.track_->channelMask_;
 
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
-    }
-    else
-    {
-        if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
-        if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
-        if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
-    }
+    Vector3 newPosition = sample.position_;
+    Quaternion newRotation = sample.rotation_;
+    Vector3 newScale = sample.scale_;
 
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
@@ -27,7 +27,9 @@
 #include <EASTL/unordered_map.h>
 
 #include "../Container/Ptr.h"
+#include "../Math/Quaternion.h"
 #include "../Math/StringHash.h"
+#include "../Math/Vector3.h"
 
 namespace Urho3D
 {
@@ -82,6 +84,19 @@ struct URHO3D_API AnimationStateTrack
     unsigned keyFrame_;
 };
 
+/// Sampled transform of an animation track.
+struct AnimationTrackSample
+{
+    /// Position.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+    /// Scale.
+    Vector3 scale_;
+    /// Whether the track was sampled.
+    bool valid_;
+};
+
 /// %Animation instance.
 class URHO3D_API AnimationState : public RefCounted
 {
@@ -187,6 +202,10 @@ private:
     void ApplyToNodes();
     /// Apply track.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Sample track at the current time position. Return false if there is nothing to apply.
+    bool SampleTrack(AnimationStateTrack& stateTrack, AnimationTrackSample& sample) const;
+    /// Blend sampled track transform into the target node.
+    void ApplyTrackSample(AnimationStateTrack& stateTrack, const AnimationTrackSample& sample, float weight, bool silent);
 
     /// Animated model (model mode).
     WeakPtr<AnimatedModel> model_;
@@ -198,6 +217,8 @@ private:
     Bone* startBone_;
     /// Per-track data.
     ea::vector<AnimationStateTrack> stateTracks_;
+    /// Per-track samples of the current time position, reused between updates.
+    ea::vector<AnimationTrackSample> trackSamples_;
     /// Looped flag.
     bool looped_;
     /// Blending weight.
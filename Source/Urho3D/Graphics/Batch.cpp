@@ -26,6 +26,7 @@
 
 #include "../Core/Context.h"
 #include "../Graphics/Camera.h"
+#include "../Graphics/DrawCommandList.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsImpl.h"
@@ -78,6 +79,9 @@ inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceD
     return lhs.distance_ < rhs.distance_;
 }
 
+/// Maximum average number of element moves per batch before sorting from the previous order falls back to a full sort.
+static const unsigned MAX_INCREMENTAL_SORT_MOVES = 8;
+
 inline bool CompareBatchGroupOrder(const BatchGroup* lhs, const BatchGroup* rhs)
 {
     return lhs->renderOrder_ < rhs->renderOrder_;
@@ -162,21 +166,115 @@ void CalculateSpotMatrix(Matrix4& dest, Light* light)
     dest = texAdjust * spotProj * spotView;
 }
 
-void SetInstanceShaderParameters(Graphics* graphics, const InstanceShaderParameters& params)
+template <class T> void SetInstanceShaderParameters(T& target, const InstanceShaderParameters& params)
 {
 #if URHO3D_SPHERICAL_HARMONICS
-    graphics->SetShaderParameter(VSP_SHAR, params.ambient_.Ar_);
-    graphics->SetShaderParameter(VSP_SHAG, params.ambient_.Ag_);
-    graphics->SetShaderParameter(VSP_SHAB, params.ambient_.Ab_);
-    graphics->SetShaderParameter(VSP_SHBR, params.ambient_.Br_);
-    graphics->SetShaderParameter(VSP_SHBG, params.ambient_.Bg_);
-    graphics->SetShaderParameter(VSP_SHBB, params.ambient_.Bb_);
-    graphics->SetShaderParameter(VSP_SHC, params.ambient_.C_);
+    target.SetShaderParameter(VSP_SHAR, params.ambient_.Ar_);
+    target.SetShaderParameter(VSP_SHAG, params.ambient_.Ag_);
+    target.SetShaderParameter(VSP_SHAB, params.ambient_.Ab_);
+    target.SetShaderParameter(VSP_SHBR, params.ambient_.Br_);
+    target.SetShaderParameter(VSP_SHBG, params.ambient_.Bg_);
+    target.SetShaderParameter(VSP_SHBB, params.ambient_.Bb_);
+    target.SetShaderParameter(VSP_SHC, params.ambient_.C_);
 #else
-    graphics->SetShaderParameter(VSP_AMBIENT, params.ambient_);
+    target.SetShaderParameter(VSP_AMBIENT, params.ambient_);
 #endif
 }
 
+/// Set hardware culling mode, reversing it if the camera reverses culling due to vertical flipping or reflection.
+template <class T> static void SetCullMode(T& target, CullMode mode, Camera* camera)
+{
+    if (camera && camera->GetReverseCulling())
+    {
+        if (mode == CULL_CW)
+            mode = CULL_CCW;
+        else if (mode == CULL_CCW)
+            mode = CULL_CW;
+    }
+
+    target.SetCullMode(mode);
+}
+
+/// Set global (per-frame) shader parameters of the view.
+static void SetGlobalShaderParameters(Graphics& /*graphics*/, View* view)
+{
+    view->SetGlobalShaderParameters();
+}
+
+/// Record global (per-frame) shader parameters of the view.
+static void SetGlobalShaderParameters(DrawCommandList& commandList, View* view)
+{
+    view->SetGlobalShaderParameters(commandList);
+}
+
+/// Set camera and viewport shader parameters.
+static void SetCameraShaderParameters(Graphics& /*graphics*/, View* view, Camera* camera, const IntVector2& viewSize)
+{
+    view->SetCameraShaderParameters(camera);
+    // During renderpath commands the G-Buffer or viewport texture is assumed to always be viewport-sized
+    view->SetGBufferShaderParameters(viewSize, IntRect(0, 0, viewSize.x_, viewSize.y_));
+}
+
+/// Record camera and viewport shader parameters.
+static void SetCameraShaderParameters(DrawCommandList& commandList, View* view, Camera* camera, const IntVector2& viewSize)
+{
+    view->SetCameraShaderParameters(commandList, camera);
+    view->SetGBufferShaderParameters(commandList, viewSize, IntRect(0, 0, viewSize.x_, viewSize.y_));
+}
+
+/// Set geometry buffers and draw.
+template <class T> static void DrawGeometry(T& target, const Geometry* geometry)
+{
+    if (geometry->GetIndexBuffer() && geometry->GetIndexCount() > 0)
+    {
+        target.SetIndexBuffer(geometry->GetIndexBuffer());
+        target.SetVertexBuffers(geometry->GetVertexBuffers());
+        target.Draw(geometry->GetPrimitiveType(), geometry->GetIndexStart(), geometry->GetIndexCount(),
+            geometry->GetVertexStart(), geometry->GetVertexCount());
+    }
+    else if (geometry->GetVertexCount() > 0)
+    {
+        target.SetVertexBuffers(geometry->GetVertexBuffers());
+        target.Draw(geometry->GetPrimitiveType(), geometry->GetVertexStart(), geometry->GetVertexCount());
+    }
+}
+
+/// Set geometry vertex buffers followed by the instancing buffer.
+static void SetInstancedVertexBuffers(Graphics& graphics, const Geometry* geometry, VertexBuffer* instanceBuffer, unsigned startIndex)
+{
+    // Get the geometry vertex buffers, then add the instancing stream buffer
+    // Hack: use a const_cast to avoid dynamic allocation of new temp vectors
+    auto& vertexBuffers = const_cast<ea::vector<SharedPtr<VertexBuffer> >&>(
+        geometry->GetVertexBuffers());
+    vertexBuffers.push_back(SharedPtr<VertexBuffer>(instanceBuffer));
+
+    graphics.SetVertexBuffers(vertexBuffers, startIndex);
+
+    // Remove the instancing buffer & element mask now
+    vertexBuffers.pop_back();
+}
+
+/// Record geometry vertex buffers followed by the instancing buffer. Does not modify the geometry, as it may be shared
+/// between worker threads.
+static void SetInstancedVertexBuffers(DrawCommandList& commandList, const Geometry* geometry, VertexBuffer* instanceBuffer,
+    unsigned startIndex)
+{
+    commandList.SetVertexBuffers(geometry->GetVertexBuffers(), instanceBuffer, startIndex);
+}
+
+/// Optimize light rendering by setting up a scissor rectangle.
+static void OptimizeLightByScissor(Graphics& /*graphics*/, Renderer* renderer, Light* light, Camera* camera)
+{
+    renderer->OptimizeLightByScissor(light, camera);
+}
+
+/// Light scissor rectangles are cached by Renderer and can not be calculated on worker threads. View does not record
+/// queues that contain per-pixel lit batches, so only disable the scissor test.
+static void OptimizeLightByScissor(DrawCommandList& commandList, Renderer* /*renderer*/, Light* /*light*/, Camera* /*camera*/)
+{
+    commandList.SetScissorTest(false);
+}
+
 void Batch::CalculateSortKey()
 {
     auto shaderID = (unsigned)(
@@ -194,18 +292,22 @@ void Batch::CalculateSortKey()
 }
 
 void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const
+{
+    Prepare(*view->GetContext()->GetSubsystem<Graphics>(), view, camera, setModelTransform, allowDepthWrite);
+}
+
+template <class T> void Batch::Prepare(T& target, View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const
 {
     if (!vertexShader_ || !pixelShader_)
         return;
 
-    Graphics* graphics = view->GetContext()->GetSubsystem<Graphics>();
     Renderer* renderer = view->GetContext()->GetSubsystem<Renderer>();
     Node* cameraNode = camera ? camera->GetNode() : nullptr;
     Light* light = lightQueue_ ? lightQueue_->light_ : nullptr;
     Texture2D* shadowMap = lightQueue_ ? lightQueue_->shadowMap_ : nullptr;
 
     // Set shaders first. The available shader parameters and their register/uniform positions depend on the currently set shaders
-    graphics->SetShaders(vertexShader_, pixelShader_);
+    target.SetShaders(vertexShader_, pixelShader_);
 
     // Set pass / material-specific renderstates
     if (pass_ && material_)
@@ -219,8 +321,8 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             else if (blend == BLEND_ADDALPHA)
                 blend = BLEND_SUBTRACTALPHA;
         }
-        graphics->SetBlendMode(blend, pass_->GetAlphaToCoverage() || material_->GetAlphaToCoverage());
-        graphics->SetLineAntiAlias(material_->GetLineAntiAlias());
+        target.SetBlendMode(blend, pass_->GetAlphaToCoverage() || material_->GetAlphaToCoverage());
+        target.SetLineAntiAlias(material_->GetLineAntiAlias());
 
         bool isShadowPass = pass_->GetIndex() == Technique::shadowPassIndex;
         CullMode effectiveCullMode = pass_->GetCullMode();
@@ -228,73 +330,69 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
         if (effectiveCullMode == MAX_CULLMODES)
             effectiveCullMode = isShadowPass ? material_->GetShadowCullMode() : material_->GetCullMode();
 
-        renderer->SetCullMode(effectiveCullMode, camera);
+        SetCullMode(target, effectiveCullMode, camera);
         if (!isShadowPass)
         {
             const BiasParameters& depthBias = material_->GetDepthBias();
-            graphics->SetDepthBias(depthBias.constantBias_, depthBias.slopeScaledBias_);
+            target.SetDepthBias(depthBias.constantBias_, depthBias.slopeScaledBias_);
         }
 
         // Use the "least filled" fill mode combined from camera & material
-        graphics->SetFillMode((FillMode)(Max(camera->GetFillMode(), material_->GetFillMode())));
-        graphics->SetDepthTest(pass_->GetDepthTestMode());
-        graphics->SetDepthWrite(pass_->GetDepthWrite() && allowDepthWrite);
+        target.SetFillMode((FillMode)(Max(camera->GetFillMode(), material_->GetFillMode())));
+        target.SetDepthTest(pass_->GetDepthTestMode());
+        target.SetDepthWrite(pass_->GetDepthWrite() && allowDepthWrite);
     }
 
     // Set global (per-frame) shader parameters
-    if (graphics->NeedParameterUpdate(SP_FRAME, nullptr))
-        view->SetGlobalShaderParameters();
+    if (target.NeedParameterUpdate(SP_FRAME, nullptr))
+        SetGlobalShaderParameters(target, view);
 
     // Set camera & viewport shader parameters
     auto cameraHash = (unsigned)(size_t)camera;
-    IntRect viewport = graphics->GetViewport();
+    IntRect viewport = target.GetViewport();
     IntVector2 viewSize = IntVector2(viewport.Width(), viewport.Height());
     auto viewportHash = (unsigned)viewSize.x_ | (unsigned)viewSize.y_ << 16u;
-    if (graphics->NeedParameterUpdate(SP_CAMERA, reinterpret_cast<const void*>(cameraHash + viewportHash)))
-    {
-        view->SetCameraShaderParameters(camera);
-        // During renderpath commands the G-Buffer or viewport texture is assumed to always be viewport-sized
-        view->SetGBufferShaderParameters(viewSize, IntRect(0, 0, viewSize.x_, viewSize.y_));
-    }
+    if (target.NeedParameterUpdate(SP_CAMERA, reinterpret_cast<const void*>(cameraHash + viewportHash)))
+        SetCameraShaderParameters(target, view, camera, viewSize);
 
     // Set model or skinning transforms
-    if (setModelTransform && graphics->NeedParameterUpdate(SP_OBJECT, worldTransform_))
+    if (setModelTransform && target.NeedParameterUpdate(SP_OBJECT, worldTransform_))
     {
-        SetInstanceShaderParameters(graphics, shaderParameters_);
+        SetInstanceShaderParameters(target, shaderParameters_);
         if (geometryType_ == GEOM_SKINNED)
         {
-            graphics->SetShaderParameter(VSP_SKINMATRICES, reinterpret_cast<const float*>(worldTransform_),
+            target.SetShaderParameter(VSP_SKINMATRICES, reinterpret_cast<const float*>(worldTransform_),
                 12 * numWorldTransforms_);
         }
         else
-            graphics->SetShaderParameter(VSP_MODEL, *worldTransform_);
+            target.SetShaderParameter(VSP_MODEL, *worldTransform_);
 
         // Set the orientation for billboards, either from the object itself or from the camera
         if (geometryType_ == GEOM_BILLBOARD)
         {
             if (numWorldTransforms_ > 1)
-                graphics->SetShaderParameter(VSP_BILLBOARDROT, worldTransform_[1].RotationMatrix());
+                target.SetShaderParameter(VSP_BILLBOARDROT, worldTransform_[1].RotationMatrix());
             else
-                graphics->SetShaderParameter(VSP_BILLBOARDROT, cameraNode->GetWorldRotation().RotationMatrix());
+                target.SetShaderParameter(VSP_BILLBOARDROT, cameraNode->GetWorldRotation().RotationMatrix());
         }
     }
 
     if (lightmapScaleOffset_)
     {
-        graphics->SetShaderParameter(VSP_LMOFFSET, *lightmapScaleOffset_);
+        target.SetShaderParameter(VSP_LMOFFSET, *lightmapScaleOffset_);
     }
 
     // Set zone-related shader parameters
-    BlendMode blend = graphics->GetBlendMode();
+    BlendMode blend = target.GetBlendMode();
     // If the pass is additive, override fog color to black so that shaders do not need a separate additive path
     bool overrideFogColorToBlack = blend == BLEND_ADD || blend == BLEND_ADDALPHA;
     auto zoneHash = (unsigned)(size_t)zone_;
     if (overrideFogColorToBlack)
         zoneHash += 0x80000000;
-    if (zone_ && graphics->NeedParameterUpdate(SP_ZONE, reinterpret_cast<const void*>(zoneHash)))
+    if (zone_ && target.NeedParameterUpdate(SP_ZONE, reinterpret_cast<const void*>(zoneHash)))
     {
-        graphics->SetShaderParameter(VSP_AMBIENTSTARTCOLOR, zone_->GetAmbientStartColor());
-        graphics->SetShaderParameter(VSP_AMBIENTENDCOLOR,
+        target.SetShaderParameter(VSP_AMBIENTSTARTCOLOR, zone_->GetAmbientStartColor());
+        target.SetShaderParameter(VSP_AMBIENTENDCOLOR,
             zone_->GetAmbientEndColor().ToVector4() - zone_->GetAmbientStartColor().ToVector4());
 
         const BoundingBox& box = zone_->GetBoundingBox();
@@ -303,12 +401,12 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
         adjust.SetScale(Vector3(1.0f / boxSize.x_, 1.0f / boxSize.y_, 1.0f / boxSize.z_));
         adjust.SetTranslation(Vector3(0.5f, 0.5f, 0.5f));
         Matrix3x4 zoneTransform = adjust * zone_->GetInverseWorldTransform();
-        graphics->SetShaderParameter(VSP_ZONE, zoneTransform);
+        target.SetShaderParameter(VSP_ZONE, zoneTransform);
 
-        graphics->SetShaderParameter(PSP_AMBIENTCOLOR, zone_->GetAmbientColor());
-        graphics->SetShaderParameter(PSP_FOGCOLOR, overrideFogColorToBlack ? Color::BLACK : zone_->GetFogColor());
-        graphics->SetShaderParameter(PSP_ZONEMIN, zone_->GetBoundingBox().min_);
-        graphics->SetShaderParameter(PSP_ZONEMAX, zone_->GetBoundingBox().max_);
+        target.SetShaderParameter(PSP_AMBIENTCOLOR, zone_->GetAmbientColor());
+        target.SetShaderParameter(PSP_FOGCOLOR, overrideFogColorToBlack ? Color::BLACK : zone_->GetFogColor());
+        target.SetShaderParameter(PSP_ZONEMIN, zone_->GetBoundingBox().min_);
+        target.SetShaderParameter(PSP_ZONEMAX, zone_->GetBoundingBox().max_);
 
         float farClip = camera->GetFarClip();
         float fogStart = Min(zone_->GetFogStart(), farClip);
@@ -326,23 +424,23 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             fogParams.w_ = zone_->GetFogHeightScale() / Max(zoneNode->GetWorldScale().y_, M_EPSILON);
         }
 
-        graphics->SetShaderParameter(PSP_FOGPARAMS, fogParams);
+        target.SetShaderParameter(PSP_FOGPARAMS, fogParams);
     }
 
     // Set light-related shader parameters
     if (lightQueue_)
     {
-        if (light && graphics->NeedParameterUpdate(SP_LIGHT, lightQueue_))
+        if (light && target.NeedParameterUpdate(SP_LIGHT, lightQueue_))
         {
             Node* lightNode = light->GetNode();
             float atten = 1.0f / Max(light->GetRange(), M_EPSILON);
             Vector3 lightDir(lightNode->GetWorldRotation() * Vector3::BACK);
             Vector4 lightPos(lightNode->GetWorldPosition(), atten);
 
-            graphics->SetShaderParameter(VSP_LIGHTDIR, lightDir);
-            graphics->SetShaderParameter(VSP_LIGHTPOS, lightPos);
+            target.SetShaderParameter(VSP_LIGHTDIR, lightDir);
+            target.SetShaderParameter(VSP_LIGHTPOS, lightPos);
 
-            if (graphics->HasShaderParameter(VSP_LIGHTMATRICES))
+            if (target.HasShaderParameter(VSP_LIGHTMATRICES))
             {
                 switch (light->GetLightType())
                 {
@@ -354,7 +452,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         for (unsigned i = 0; i < numSplits; ++i)
                             CalculateShadowMatrix(shadowMatrices[i], lightQueue_, i, renderer);
 
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
+                        target.SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
                     }
                     break;
 
@@ -363,11 +461,11 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         Matrix4 shadowMatrices[2];
 
                         CalculateSpotMatrix(shadowMatrices[0], light);
-                        bool isShadowed = shadowMap && graphics->HasTextureUnit(TU_SHADOWMAP);
+                        bool isShadowed = shadowMap && target.HasTextureUnit(TU_SHADOWMAP);
                         if (isShadowed)
                             CalculateShadowMatrix(shadowMatrices[1], lightQueue_, 0, renderer);
 
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
+                        target.SetShaderParameter(VSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
                     }
                     break;
 
@@ -377,9 +475,9 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         // HLSL compiler will pack the parameters as if the matrix is only 3x4, so must be careful to not overwrite
                         // the next parameter
 #ifdef URHO3D_OPENGL
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 16);
+                        target.SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 16);
 #else
-                        graphics->SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 12);
+                        target.SetShaderParameter(VSP_LIGHTMATRICES, lightVecRot.Data(), 12);
 #endif
                     }
                     break;
@@ -395,14 +493,14 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                 fade = Min(1.0f - (light->GetDistance() - fadeStart) / (fadeEnd - fadeStart), 1.0f);
 
             // Negative lights will use subtract blending, so write absolute RGB values to the shader parameter
-            graphics->SetShaderParameter(PSP_LIGHTCOLOR, Color(light->GetEffectiveColor().Abs(),
+            target.SetShaderParameter(PSP_LIGHTCOLOR, Color(light->GetEffectiveColor().Abs(),
                 light->GetEffectiveSpecularIntensity()) * fade);
-            graphics->SetShaderParameter(PSP_LIGHTDIR, lightDir);
-            graphics->SetShaderParameter(PSP_LIGHTPOS, lightPos);
-            graphics->SetShaderParameter(PSP_LIGHTRAD, light->GetRadius());
-            graphics->SetShaderParameter(PSP_LIGHTLENGTH, light->GetLength());
+            target.SetShaderParameter(PSP_LIGHTDIR, lightDir);
+            target.SetShaderParameter(PSP_LIGHTPOS, lightPos);
+            target.SetShaderParameter(PSP_LIGHTRAD, light->GetRadius());
+            target.SetShaderParameter(PSP_LIGHTLENGTH, light->GetLength());
 
-            if (graphics->HasShaderParameter(PSP_LIGHTMATRICES))
+            if (target.HasShaderParameter(PSP_LIGHTMATRICES))
             {
                 switch (light->GetLightType())
                 {
@@ -414,7 +512,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         for (unsigned i = 0; i < numSplits; ++i)
                             CalculateShadowMatrix(shadowMatrices[i], lightQueue_, i, renderer);
 
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
+                        target.SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), 16 * numSplits);
                     }
                     break;
 
@@ -427,7 +525,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         if (isShadowed)
                             CalculateShadowMatrix(shadowMatrices[1], lightQueue_, 0, renderer);
 
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
+                        target.SetShaderParameter(PSP_LIGHTMATRICES, shadowMatrices[0].Data(), isShadowed ? 32 : 16);
                     }
                     break;
 
@@ -437,9 +535,9 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         // HLSL compiler will pack the parameters as if the matrix is only 3x4, so must be careful to not overwrite
                         // the next parameter
 #ifdef URHO3D_OPENGL
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 16);
+                        target.SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 16);
 #else
-                        graphics->SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 12);
+                        target.SetShaderParameter(PSP_LIGHTMATRICES, lightVecRot.Data(), 12);
 #endif
                     }
                     break;
@@ -472,7 +570,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                         addX -= 0.5f / width;
                         addY -= 0.5f / height;
                     }
-                    graphics->SetShaderParameter(PSP_SHADOWCUBEADJUST, Vector4(mulX, mulY, addX, addY));
+                    target.SetShaderParameter(PSP_SHADOWCUBEADJUST, Vector4(mulX, mulY, addX, addY));
                 }
 
                 {
@@ -491,7 +589,7 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                     float fadeEnd = shadowRange / viewFarClip;
                     float fadeRange = fadeEnd - fadeStart;
 
-                    graphics->SetShaderParameter(PSP_SHADOWDEPTHFADE, Vector4(q, r, fadeStart, 1.0f / fadeRange));
+                    target.SetShaderParameter(PSP_SHADOWDEPTHFADE, Vector4(q, r, fadeStart, 1.0f / fadeRange));
                 }
 
                 {
@@ -505,12 +603,12 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                     float samples = 1.0f;
                     if (renderer->GetShadowQuality() == SHADOWQUALITY_PCF_16BIT || renderer->GetShadowQuality() == SHADOWQUALITY_PCF_24BIT)
                         samples = 4.0f;
-                    graphics->SetShaderParameter(PSP_SHADOWINTENSITY, Vector4(pcfValues / samples, intensity, 0.0f, 0.0f));
+                    target.SetShaderParameter(PSP_SHADOWINTENSITY, Vector4(pcfValues / samples, intensity, 0.0f, 0.0f));
                 }
 
                 float sizeX = 1.0f / (float)shadowMap->GetWidth();
                 float sizeY = 1.0f / (float)shadowMap->GetHeight();
-                graphics->SetShaderParameter(PSP_SHADOWMAPINVSIZE, Vector2(sizeX, sizeY));
+                target.SetShaderParameter(PSP_SHADOWMAPINVSIZE, Vector2(sizeX, sizeY));
 
                 Vector4 lightSplits(M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE, M_LARGE_VALUE);
                 if (lightQueue_->shadowSplits_.size() > 1)
@@ -520,10 +618,10 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                 if (lightQueue_->shadowSplits_.size() > 3)
                     lightSplits.z_ = lightQueue_->shadowSplits_[2].farSplit_ / camera->GetFarClip();
 
-                graphics->SetShaderParameter(PSP_SHADOWSPLITS, lightSplits);
+                target.SetShaderParameter(PSP_SHADOWSPLITS, lightSplits);
 
-                if (graphics->HasShaderParameter(PSP_VSMSHADOWPARAMS))
-                    graphics->SetShaderParameter(PSP_VSMSHADOWPARAMS, renderer->GetVSMShadowParameters());
+                if (target.HasShaderParameter(PSP_VSMSHADOWPARAMS))
+                    target.SetShaderParameter(PSP_VSMSHADOWPARAMS, renderer->GetVSMShadowParameters());
 
                 if (light->GetShadowBias().normalOffset_ > 0.0f)
                 {
@@ -550,13 +648,13 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
 #ifdef GL_ES_VERSION_2_0
                     normalOffsetScale *= renderer->GetMobileNormalOffsetMul();
 #endif
-                    graphics->SetShaderParameter(VSP_NORMALOFFSETSCALE, normalOffsetScale);
-                    graphics->SetShaderParameter(PSP_NORMALOFFSETSCALE, normalOffsetScale);
+                    target.SetShaderParameter(VSP_NORMALOFFSETSCALE, normalOffsetScale);
+                    target.SetShaderParameter(PSP_NORMALOFFSETSCALE, normalOffsetScale);
                 }
             }
         }
-        else if (lightQueue_->vertexLights_.size() && graphics->HasShaderParameter(VSP_VERTEXLIGHTS) &&
-                 graphics->NeedParameterUpdate(SP_LIGHT, lightQueue_))
+        else if (lightQueue_->vertexLights_.size() && target.HasShaderParameter(VSP_VERTEXLIGHTS) &&
+                 target.NeedParameterUpdate(SP_LIGHT, lightQueue_))
         {
             Vector4 vertexLights[MAX_VERTEX_LIGHTS * 3];
             const ea::vector<Light*>& lights = lightQueue_->vertexLights_;
@@ -603,29 +701,29 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
                 vertexLights[i * 3 + 2] = Vector4(vertexLightNode->GetWorldPosition(), invCutoff);
             }
 
-            graphics->SetShaderParameter(VSP_VERTEXLIGHTS, vertexLights[0].Data(), lights.size() * 3 * 4);
+            target.SetShaderParameter(VSP_VERTEXLIGHTS, vertexLights[0].Data(), lights.size() * 3 * 4);
         }
     }
 
     // Set zone texture if necessary
 #ifndef GL_ES_VERSION_2_0
-    if (zone_ && graphics->HasTextureUnit(TU_ZONE))
-        graphics->SetTexture(TU_ZONE, zone_->GetZoneTexture());
+    if (zone_ && target.HasTextureUnit(TU_ZONE))
+        target.SetTexture(TU_ZONE, zone_->GetZoneTexture());
 #else
     // On OpenGL ES set the zone texture to the environment unit instead
-    if (zone_ && zone_->GetZoneTexture() && graphics->HasTextureUnit(TU_ENVIRONMENT))
-        graphics->SetTexture(TU_ENVIRONMENT, zone_->GetZoneTexture());
+    if (zone_ && zone_->GetZoneTexture() && target.HasTextureUnit(TU_ENVIRONMENT))
+        target.SetTexture(TU_ENVIRONMENT, zone_->GetZoneTexture());
 #endif
 
     // Set material-specific shader parameters and textures
     if (material_)
     {
-        if (graphics->NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material_->GetShaderParameterHash())))
+        if (target.NeedParameterUpdate(SP_MATERIAL, reinterpret_cast<const void*>(material_->GetShaderParameterHash())))
         {
             const ea::unordered_map<StringHash, MaterialShaderParameter>& parameters = material_->GetShaderParameters();
             for (auto i = parameters.begin(); i !=
                 parameters.end(); ++i)
-                graphics->SetShaderParameter(i->first, i->second.value_);
+                target.SetShaderParameter(i->first, i->second.value_);
         }
 
         const ea::unordered_map<TextureUnit, SharedPtr<Texture> >& textures = material_->GetTextures();
@@ -635,56 +733,61 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             if (i->first == TU_EMISSIVE && lightmapScaleOffset_)
                 continue;
 
-            if (graphics->HasTextureUnit(i->first))
-                graphics->SetTexture(i->first, i->second.Get());
+            if (target.HasTextureUnit(i->first))
+                target.SetTexture(i->first, i->second.Get());
         }
 
         if (lightmapScaleOffset_)
         {
             if (Scene* scene = view->GetScene())
-                graphics->SetTexture(TU_EMISSIVE, scene->GetLightmapTexture(lightmapIndex_));
+                target.SetTexture(TU_EMISSIVE, scene->GetLightmapTexture(lightmapIndex_));
         }
     }
 
     // Set light-related textures
     if (light)
     {
-        if (shadowMap && graphics->HasTextureUnit(TU_SHADOWMAP))
-            graphics->SetTexture(TU_SHADOWMAP, shadowMap);
-        if (graphics->HasTextureUnit(TU_LIGHTRAMP))
+        if (shadowMap && target.HasTextureUnit(TU_SHADOWMAP))
+            target.SetTexture(TU_SHADOWMAP, shadowMap);
+        if (target.HasTextureUnit(TU_LIGHTRAMP))
         {
             Texture* rampTexture = light->GetRampTexture();
             if (!rampTexture)
                 rampTexture = renderer->GetDefaultLightRamp();
-            graphics->SetTexture(TU_LIGHTRAMP, rampTexture);
+            target.SetTexture(TU_LIGHTRAMP, rampTexture);
         }
-        if (graphics->HasTextureUnit(TU_LIGHTSHAPE))
+        if (target.HasTextureUnit(TU_LIGHTSHAPE))
         {
             Texture* shapeTexture = light->GetShapeTexture();
             if (!shapeTexture && light->GetLightType() == LIGHT_SPOT)
                 shapeTexture = renderer->GetDefaultLightSpot();
-            graphics->SetTexture(TU_LIGHTSHAPE, shapeTexture);
+            target.SetTexture(TU_LIGHTSHAPE, shapeTexture);
         }
     }
 }
 
 void Batch::Draw(View* view, Camera* camera, bool allowDepthWrite) const
+{
+    Draw(*view->GetContext()->GetSubsystem<Graphics>(), view, camera, allowDepthWrite);
+}
+
+template <class T> void Batch::Draw(T& target, View* view, Camera* camera, bool allowDepthWrite) const
 {
     if (!geometry_->IsEmpty())
     {
-        Prepare(view, camera, true, allowDepthWrite);
-        geometry_->Draw(view->GetContext()->GetSubsystem<Graphics>());
+        Prepare(target, view, camera, true, allowDepthWrite);
+        DrawGeometry(target, geometry_);
     }
 }
 
-void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
+void BatchGroup::SetInstancingData(void* lockedData, unsigned lockStart, unsigned stride, unsigned& freeIndex)
 {
     // Do not use up buffer space if not going to draw as instanced
     if (geometryType_ != GEOM_INSTANCED)
         return;
 
     startIndex_ = freeIndex;
-    unsigned char* buffer = static_cast<unsigned char*>(lockedData) + startIndex_ * stride;
+    unsigned char* buffer = static_cast<unsigned char*>(lockedData) + (startIndex_ - lockStart) * stride;
 
     for (unsigned i = 0; i < instances_.size(); ++i)
     {
@@ -709,7 +812,11 @@ void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned&
 
 void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 {
-    Graphics* graphics = view->GetContext()->GetSubsystem<Graphics>();
+    Draw(*view->GetContext()->GetSubsystem<Graphics>(), view, camera, allowDepthWrite);
+}
+
+template <class T> void BatchGroup::Draw(T& target, View* view, Camera* camera, bool allowDepthWrite) const
+{
     Renderer* renderer = view->GetContext()->GetSubsystem<Renderer>();
 
     if (instances_.size() && !geometry_->IsEmpty())
@@ -718,40 +825,31 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
         VertexBuffer* instanceBuffer = renderer->GetInstancingBuffer();
         if (!instanceBuffer || geometryType_ != GEOM_INSTANCED || startIndex_ == M_MAX_UNSIGNED)
         {
-            Batch::Prepare(view, camera, false, allowDepthWrite);
+            Batch::Prepare(target, view, camera, false, allowDepthWrite);
 
-            graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
-            graphics->SetVertexBuffers(geometry_->GetVertexBuffers());
+            target.SetIndexBuffer(geometry_->GetIndexBuffer());
+            target.SetVertexBuffers(geometry_->GetVertexBuffers());
 
             for (unsigned i = 0; i < instances_.size(); ++i)
             {
-                if (graphics->NeedParameterUpdate(SP_OBJECT, instances_[i].worldTransform_))
+                if (target.NeedParameterUpdate(SP_OBJECT, instances_[i].worldTransform_))
                 {
-                    graphics->SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_);
-                    SetInstanceShaderParameters(graphics, instances_[i].shaderParameters_);
+                    target.SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_);
+                    SetInstanceShaderParameters(target, instances_[i].shaderParameters_);
                 }
 
-                graphics->Draw(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
+                target.Draw(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
                     geometry_->GetVertexStart(), geometry_->GetVertexCount());
             }
         }
         else
         {
-            Batch::Prepare(view, camera, false, allowDepthWrite);
+            Batch::Prepare(target, view, camera, false, allowDepthWrite);
 
-            // Get the geometry vertex buffers, then add the instancing stream buffer
-            // Hack: use a const_cast to avoid dynamic allocation of new temp vectors
-            auto& vertexBuffers = const_cast<ea::vector<SharedPtr<VertexBuffer> >&>(
-                geometry_->GetVertexBuffers());
-            vertexBuffers.push_back(SharedPtr<VertexBuffer>(instanceBuffer));
-
-            graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
-            graphics->SetVertexBuffers(vertexBuffers, startIndex_);
-            graphics->DrawInstanced(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
+            target.SetIndexBuffer(geometry_->GetIndexBuffer());
+            SetInstancedVertexBuffers(target, geometry_, instanceBuffer, startIndex_);
+            target.DrawInstanced(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
                 geometry_->GetVertexStart(), geometry_->GetVertexCount(), instances_.size());
-
-            // Remove the instancing buffer & element mask now
-            vertexBuffers.pop_back();
         }
     }
 }
@@ -777,7 +875,7 @@ void BatchQueue::SortBackToFront()
     for (unsigned i = 0; i < batches_.size(); ++i)
         sortedBatches_[i] = &batches_[i];
 
-    ea::quick_sort(sortedBatches_.begin(), sortedBatches_.end(), CompareBatchesBackToFront);
+    SortFromPreviousOrder(sortedBatches_, 0, CompareBatchesBackToFront);
 
     sortedBatchGroups_.resize(batchGroups_.size());
 
@@ -831,10 +929,10 @@ template <class T> void BatchQueue::SortFrontToBack2Pass(ea::vector<T>& batches)
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
     // method is also time consuming, so just sort with state having priority
 #ifdef GL_ES_VERSION_2_0
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    SortFromPreviousOrder(batches, 0, CompareBatchesState);
 #else
     // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesFrontToBack);
+    SortFromPreviousOrder(batches, 0, CompareBatchesFrontToBack);
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
@@ -882,56 +980,126 @@ template <class T> void BatchQueue::SortFrontToBack2Pass(ea::vector<T>& batches)
     geometryRemapping_.clear();
 
     // Finally sort again with the rewritten ID's
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    SortFromPreviousOrder(batches, 1, CompareBatchesState);
 #endif
 }
 
-void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
+template <class T, class U> void BatchQueue::SortFromPreviousOrder(ea::vector<T>& batches, unsigned orderIndex, U compare)
+{
+    const unsigned numBatches = batches.size();
+
+    // Sort fully when most batches are new, such as after a camera cut or for batch groups which are not retained
+    unsigned numOrdered = 0;
+    for (T batch : batches)
+    {
+        if (batch->sortOrder_[orderIndex] < numBatches * 2)
+            ++numOrdered;
+    }
+
+    if (numOrdered * 2 < numBatches)
+        ea::quick_sort(batches.begin(), batches.end(), compare);
+    else
+    {
+        // Restore the previous order. Batches without a previous position go last
+        previousOrder_.clear();
+        previousOrder_.resize(numBatches * 2, nullptr);
+        unorderedBatches_.clear();
+        for (T batch : batches)
+        {
+            const unsigned order = batch->sortOrder_[orderIndex];
+            if (order < previousOrder_.size() && !previousOrder_[order])
+                previousOrder_[order] = batch;
+            else
+                unorderedBatches_.push_back(batch);
+        }
+
+        unsigned index = 0;
+        for (Batch* batch : previousOrder_)
+        {
+            if (batch)
+                batches[index++] = static_cast<T>(batch);
+        }
+        for (Batch* batch : unorderedBatches_)
+            batches[index++] = static_cast<T>(batch);
+
+        // Insertion sort is close to linear when the order changed little. Fall back to a full sort otherwise
+        const unsigned maxMoves = numBatches * MAX_INCREMENTAL_SORT_MOVES;
+        unsigned numMoves = 0;
+        for (unsigned i = 1; i < numBatches; ++i)
+        {
+            T batch = batches[i];
+            unsigned j = i;
+            for (; j > 0 && compare(batch, batches[j - 1]); --j)
+                batches[j] = batches[j - 1];
+            batches[j] = batch;
+
+            numMoves += i - j;
+            if (numMoves > maxMoves)
+            {
+                ea::quick_sort(batches.begin(), batches.end(), compare);
+                break;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < numBatches; ++i)
+        batches[i]->sortOrder_[orderIndex] = i;
+}
+
+void BatchQueue::SetInstancingData(void* lockedData, unsigned lockStart, unsigned stride, unsigned& freeIndex)
 {
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        i->second.SetInstancingData(lockedData, stride, freeIndex);
+        i->second.SetInstancingData(lockedData, lockStart, stride, freeIndex);
 }
 
 void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const
 {
-    Graphics* graphics = view->GetContext()->GetSubsystem<Graphics>();
+    Draw(*view->GetContext()->GetSubsystem<Graphics>(), view, camera, markToStencil, usingLightOptimization, allowDepthWrite, 0,
+        GetNumDrawItems());
+}
+
+template <class T> void BatchQueue::Draw(T& target, View* view, Camera* camera, bool markToStencil, bool usingLightOptimization,
+    bool allowDepthWrite, unsigned start, unsigned end) const
+{
     Renderer* renderer = view->GetContext()->GetSubsystem<Renderer>();
 
     // If View has set up its own light optimizations, do not disturb the stencil/scissor test settings
     if (!usingLightOptimization)
     {
-        graphics->SetScissorTest(false);
+        target.SetScissorTest(false);
 
         // During G-buffer rendering, mark opaque pixels' lightmask to stencil buffer if requested
         if (!markToStencil)
-            graphics->SetStencilTest(false);
+            target.SetStencilTest(false);
     }
 
+    const unsigned numGroups = sortedBatchGroups_.size();
+
     // Instanced
-    for (auto i = sortedBatchGroups_.begin(); i != sortedBatchGroups_.end(); ++i)
+    for (unsigned i = start; i < Min(end, numGroups); ++i)
     {
-        BatchGroup* group = *i;
+        BatchGroup* group = sortedBatchGroups_[i];
         if (markToStencil)
-            graphics->SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, group->lightMask_);
+            target.SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, group->lightMask_);
 
-        group->Draw(view, camera, allowDepthWrite);
+        group->Draw(target, view, camera, allowDepthWrite);
     }
     // Non-instanced
-    for (auto i = sortedBatches_.begin(); i != sortedBatches_.end(); ++i)
+    for (unsigned i = Max(start, numGroups); i < end; ++i)
     {
-        Batch* batch = *i;
+        Batch* batch = sortedBatches_[i - numGroups];
         if (markToStencil)
-            graphics->SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, batch->lightMask_);
+            target.SetStencilTest(true, CMP_ALWAYS, OP_REF, OP_KEEP, OP_KEEP, batch->lightMask_);
         if (!usingLightOptimization)
         {
             // If drawing an alpha batch, we can optimize fillrate by scissor test
             if (!batch->isBase_ && batch->lightQueue_)
-                renderer->OptimizeLightByScissor(batch->lightQueue_->light_, camera);
+                OptimizeLightByScissor(target, renderer, batch->lightQueue_->light_, camera);
             else
-                graphics->SetScissorTest(false);
+                target.SetScissorTest(false);
         }
 
-        batch->Draw(view, camera, allowDepthWrite);
+        batch->Draw(target, view, camera, allowDepthWrite);
     }
 }
 
@@ -949,4 +1117,15 @@ unsigned BatchQueue::GetNumInstances() const
     return total;
 }
 
+template void Batch::Prepare(Graphics& target, View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
+template void Batch::Prepare(DrawCommandList& target, View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
+template void Batch::Draw(Graphics& target, View* view, Camera* camera, bool allowDepthWrite) const;
+template void Batch::Draw(DrawCommandList& target, View* view, Camera* camera, bool allowDepthWrite) const;
+template void BatchGroup::Draw(Graphics& target, View* view, Camera* camera, bool allowDepthWrite) const;
+template void BatchGroup::Draw(DrawCommandList& target, View* view, Camera* camera, bool allowDepthWrite) const;
+template void BatchQueue::Draw(Graphics& target, View* view, Camera* camera, bool markToStencil, bool usingLightOptimization,
+    bool allowDepthWrite, unsigned start, unsigned end) const;
+template void BatchQueue::Draw(DrawCommandList& target, View* view, Camera* camera, bool markToStencil,
+    bool usingLightOptimization, bool allowDepthWrite, unsigned start, unsigned end) const;
+
 }
@@ -38,7 +38,9 @@ namespace Urho3D
 
 class Camera;
 class Drawable;
+class DrawCommandList;
 class Geometry;
+class GlobalIllumination;
 class Light;
 class Material;
 class Matrix3x4;
@@ -89,8 +91,12 @@ struct Batch
     void CalculateSortKey();
     /// Prepare for rendering.
     void Prepare(View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
+    /// Prepare for rendering on a target, which is either Graphics or a DrawCommandList.
+    template <class T> void Prepare(T& target, View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
+    /// Prepare and draw on a target, which is either Graphics or a DrawCommandList.
+    template <class T> void Draw(T& target, View* view, Camera* camera, bool allowDepthWrite) const;
 
     /// State sorting key.
     unsigned long long sortKey_{};
@@ -130,6 +136,10 @@ struct Batch
     Vector4* lightmapScaleOffset_{};
     /// Lightmap index.
     unsigned lightmapIndex_{};
+    /// Index of the retained base batch in the view, or M_MAX_UNSIGNED if the batch is not retained.
+    unsigned retainedIndex_{M_MAX_UNSIGNED};
+    /// Sorted positions on the previous frame for the distance and state sorts, or M_MAX_UNSIGNED if unknown.
+    unsigned sortOrder_[2]{M_MAX_UNSIGNED, M_MAX_UNSIGNED};
 };
 
 /// Data for one geometry instance.
@@ -172,6 +182,9 @@ struct BatchGroup : public Batch
         Batch(batch),
         startIndex_(M_MAX_UNSIGNED)
     {
+        // Groups are rebuilt every frame and have no retained state
+        retainedIndex_ = M_MAX_UNSIGNED;
+        sortOrder_[0] = sortOrder_[1] = M_MAX_UNSIGNED;
     }
 
     /// Destruct.
@@ -192,10 +205,12 @@ struct BatchGroup : public Batch
         }
     }
 
-    /// Pre-set the instance data. Buffer must be big enough to hold all data.
-    void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Pre-set the instance data. Locked data starts at the lock start instance of the buffer and must be big enough to hold all data.
+    void SetInstancingData(void* lockedData, unsigned lockStart, unsigned stride, unsigned& freeIndex);
     /// Prepare and draw.
     void Draw(View* view, Camera* camera, bool allowDepthWrite) const;
+    /// Prepare and draw on a target, which is either Graphics or a DrawCommandList.
+    template <class T> void Draw(T& target, View* view, Camera* camera, bool allowDepthWrite) const;
 
     /// Instance data.
     ea::vector<InstanceData> instances_;
@@ -251,6 +266,65 @@ struct BatchGroupKey
     unsigned ToHash() const;
 };
 
+/// Base batch retained across frames. The prepared batch is reused only while all the inputs it was prepared from are unchanged.
+/// The input objects are referenced weakly, so that an object created at the address of a destroyed one does not match.
+struct RetainedBaseBatch
+{
+    /// Source batch index in the drawable.
+    unsigned batchIndex_{};
+    /// Scene pass index.
+    unsigned passIndex_{};
+    /// Prepared batch with shaders, sort key and ambient lighting. Also holds the sorted positions of the previous frame.
+    Batch batch_;
+
+    /// Whether the prepared batch is valid.
+    bool valid_{};
+    /// Material of the source batch.
+    WeakPtr<Material> sourceMaterial_;
+    /// %Geometry of the source batch.
+    WeakPtr<Geometry> sourceGeometry_;
+    /// Pass of the prepared batch.
+    WeakPtr<Pass> pass_;
+    /// Zone of the prepared batch.
+    WeakPtr<Zone> zone_;
+    /// %Geometry type of the source batch.
+    GeometryType sourceGeometryType_{};
+    /// Whether instancing was allowed.
+    bool allowInstancing_{};
+    /// Height fog flag of the zone.
+    bool heightFog_{};
+    /// Renderer dynamic instancing flag.
+    bool dynamicInstancing_{};
+    /// Renderer shaders changed frame number.
+    unsigned shadersChangedFrameNumber_{};
+    /// Pass shaders revision.
+    unsigned shadersRevision_{};
+    /// Batch queue vertex shader extra defines hash.
+    StringHash vsExtraDefinesHash_;
+    /// Batch queue pixel shader extra defines hash.
+    StringHash psExtraDefinesHash_;
+
+    /// Whether the ambient lighting of the prepared batch is valid.
+    bool ambientValid_{};
+    /// Global illumination the ambient lighting was sampled from.
+    WeakPtr<GlobalIllumination> globalIllumination_;
+    /// Global illumination data revision.
+    unsigned globalIlluminationRevision_{};
+    /// Ambient lighting sample position.
+    Vector3 ambientPosition_;
+};
+
+/// Range of base batches retained for a drawable.
+struct RetainedDrawable
+{
+    /// Drawable.
+    WeakPtr<Drawable> drawable_;
+    /// Index of the first retained base batch.
+    unsigned firstBatch_{};
+    /// Number of retained base batches.
+    unsigned numBatches_{};
+};
+
 /// Queue that contains both instanced and non-instanced draw calls.
 struct BatchQueue
 {
@@ -263,12 +337,20 @@ public:
     void SortFrontToBack();
     /// Sort batches front to back while also maintaining state sorting.
     template <class T> void SortFrontToBack2Pass(ea::vector<T>& batches);
-    /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
-    void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
+    /// Sort batches starting from their sorted positions on the previous frame.
+    template <class T, class U> void SortFromPreviousOrder(ea::vector<T>& batches, unsigned orderIndex, U compare);
+    /// Pre-set instance data of all groups. Locked data starts at the lock start instance of the vertex buffer and must be big enough to hold all data.
+    void SetInstancingData(void* lockedData, unsigned lockStart, unsigned stride, unsigned& freeIndex);
     /// Draw.
     void Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const;
+    /// Draw a range of draw items on a target, which is either Graphics or a DrawCommandList. Draw items are the sorted
+    /// batch groups followed by the sorted non-instanced batches.
+    template <class T> void Draw(T& target, View* view, Camera* camera, bool markToStencil, bool usingLightOptimization,
+        bool allowDepthWrite, unsigned start, unsigned end) const;
     /// Return the combined amount of instances.
     unsigned GetNumInstances() const;
+    /// Return number of draw items, which are the sorted batch groups and the sorted non-instanced batches.
+    unsigned GetNumDrawItems() const { return sortedBatchGroups_.size() + sortedBatches_.size(); }
 
     /// Return whether the batch group is empty.
     bool IsEmpty() const { return batches_.empty() && batchGroups_.empty(); }
@@ -281,6 +363,10 @@ public:
     ea::unordered_map<unsigned short, unsigned short> materialRemapping_;
     /// Geometry remapping table for 2-pass state and distance sort.
     ea::unordered_map<unsigned short, unsigned short> geometryRemapping_;
+    /// Batches placed by their previous sorted positions.
+    ea::vector<Batch*> previousOrder_;
+    /// Batches without a previous sorted position.
+    ea::vector<Batch*> unorderedBatches_;
 
     /// Unsorted non-instanced draw calls.
     ea::vector<Batch> batches_;
@@ -91,6 +91,8 @@ public:
     void UpdateGeometry(const FrameInfo& frame) override;
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     UpdateGeometryType GetUpdateGeometryType() override;
+    /// Return whether the world bounding box depends on the view.
+    bool HasViewDependentBoundingBox() const override { return fixedScreenSize_; }
 
     /// Set material.
     /// @property
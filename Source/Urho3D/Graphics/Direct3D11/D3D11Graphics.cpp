@@ -26,6 +26,7 @@
 #include "../../Core/ProcessUtils.h"
 #include "../../Core/Profiler.h"
 #include "../../Graphics/ConstantBuffer.h"
+#include "../../Graphics/DrawCommandList.h"
 #include "../../Graphics/Geometry.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
@@ -501,6 +502,52 @@ void Graphics::EndFrame()
     }
 }
 
+void Graphics::ExecuteCommandList(const DrawCommandList& commandList)
+{
+    commandList.Execute(*this);
+
+    // The parameters set by the list are not tracked, so make sure they are set again by later draws
+    ClearParameterSources();
+}
+
+void* Graphics::InsertFence()
+{
+    D3D11_QUERY_DESC queryDesc;
+    queryDesc.Query = D3D11_QUERY_EVENT;
+    queryDesc.MiscFlags = 0;
+
+    ID3D11Query* query = nullptr;
+    HRESULT hr = impl_->device_->CreateQuery(&queryDesc, &query);
+    if (FAILED(hr))
+    {
+        URHO3D_SAFE_RELEASE(query);
+        URHO3D_LOGD3DERROR("Failed to create fence query", hr);
+        return nullptr;
+    }
+
+    impl_->deviceContext_->End(query);
+    return query;
+}
+
+bool Graphics::IsFenceSignaled(void* fence, bool wait)
+{
+    if (!fence)
+        return true;
+
+    // Flush when waiting, so that the fence is guaranteed to be reached
+    auto* query = static_cast<ID3D11Query*>(fence);
+    HRESULT hr = impl_->deviceContext_->GetData(query, nullptr, 0, wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH);
+    while (wait && hr == S_FALSE)
+        hr = impl_->deviceContext_->GetData(query, nullptr, 0, 0);
+    return hr != S_FALSE;
+}
+
+void Graphics::ReleaseFence(void* fence)
+{
+    if (fence)
+        static_cast<ID3D11Query*>(fence)->Release();
+}
+
 void Graphics::Clear(ClearTargetFlags flags, const Color& color, float depth, unsigned stencil)
 {
     IntVector2 rtSize = GetRenderTargetDimensions();
@@ -278,13 +278,19 @@ void* VertexBuffer::MapBuffer(unsigned start, unsigned count, bool discard)
         D3D11_MAPPED_SUBRESOURCE mappedData;
         mappedData.pData = nullptr;
 
-        HRESULT hr = graphics_->GetImpl()->GetDeviceContext()->Map((ID3D11Buffer*)object_.ptr_, 0, discard ? D3D11_MAP_WRITE_DISCARD :
-            D3D11_MAP_WRITE, 0, &mappedData);
+        D3D11_MAP mapType = D3D11_MAP_WRITE;
+        if (discard)
+            mapType = D3D11_MAP_WRITE_DISCARD;
+        else if (noOverwriteLock_ && dynamic_)
+            mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+
+        HRESULT hr = graphics_->GetImpl()->GetDeviceContext()->Map((ID3D11Buffer*)object_.ptr_, 0, mapType, 0, &mappedData);
         if (FAILED(hr) || !mappedData.pData)
             URHO3D_LOGD3DERROR("Failed to map vertex buffer", hr);
         else
         {
-            hwData = mappedData.pData;
+            // The whole buffer is always mapped, so offset to the requested range
+            hwData = static_cast<unsigned char*>(mappedData.pData) + start * vertexSize_;
             lockState_ = LOCK_HARDWARE;
         }
     }
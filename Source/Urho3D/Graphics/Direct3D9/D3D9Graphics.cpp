@@ -25,6 +25,7 @@
 #include "../../Core/Context.h"
 #include "../../Core/ProcessUtils.h"
 #include "../../Core/Profiler.h"
+#include "../../Graphics/DrawCommandList.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -711,6 +712,52 @@ void Graphics::EndFrame()
     }
 }
 
+void Graphics::ExecuteCommandList(const DrawCommandList& commandList)
+{
+    commandList.Execute(*this);
+
+    // The parameters set by the list are not tracked, so make sure they are set again by later draws
+    ClearParameterSources();
+}
+
+void* Graphics::InsertFence()
+{
+    // The frame query exists only if the device supports event queries
+    if (!impl_->device_ || !impl_->frameQuery_)
+        return nullptr;
+
+    IDirect3DQuery9* query = nullptr;
+    HRESULT hr = impl_->device_->CreateQuery(D3DQUERYTYPE_EVENT, &query);
+    if (FAILED(hr))
+    {
+        URHO3D_SAFE_RELEASE(query);
+        URHO3D_LOGD3DERROR("Failed to create fence query", hr);
+        return nullptr;
+    }
+
+    query->Issue(D3DISSUE_END);
+    return query;
+}
+
+bool Graphics::IsFenceSignaled(void* fence, bool wait)
+{
+    if (!fence)
+        return true;
+
+    // Flush when waiting, so that the fence is guaranteed to be reached. Queries fail when the device is lost
+    auto* query = static_cast<IDirect3DQuery9*>(fence);
+    HRESULT hr = query->GetData(nullptr, 0, wait ? D3DGETDATA_FLUSH : 0);
+    while (wait && hr == S_FALSE)
+        hr = query->GetData(nullptr, 0, D3DGETDATA_FLUSH);
+    return hr != S_FALSE;
+}
+
+void Graphics::ReleaseFence(void* fence)
+{
+    if (fence)
+        static_cast<IDirect3DQuery9*>(fence)->Release();
+}
+
 void Graphics::Clear(ClearTargetFlags flags, const Color& color, float depth, unsigned stencil)
 {
     DWORD d3dFlags = 0;
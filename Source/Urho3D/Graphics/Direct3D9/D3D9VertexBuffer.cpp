@@ -284,6 +284,8 @@ void* VertexBuffer::MapBuffer(unsigned start, unsigned count, bool discard)
 
         if (discard && dynamic_)
             flags = D3DLOCK_DISCARD;
+        else if (noOverwriteLock_ && dynamic_)
+            flags = D3DLOCK_NOOVERWRITE;
 
         HRESULT hr = ((IDirect3DVertexBuffer9*)object_.ptr_)->Lock(start * vertexSize_, count * vertexSize_, &hwData, flags);
         if (FAILED(hr))
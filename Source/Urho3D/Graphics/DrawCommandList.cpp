@@ -0,0 +1,357 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Variant.h"
+#include "../Graphics/DrawCommandList.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+DrawCommandList::DrawCommandList()
+{
+    Reset(IntRect::ZERO);
+}
+
+void DrawCommandList::Reset(const IntRect& viewport)
+{
+    commands_.clear();
+    floatData_.clear();
+    vertexBuffers_.clear();
+    viewport_ = viewport;
+    vertexShader_ = nullptr;
+    pixelShader_ = nullptr;
+    blendMode_ = BLEND_REPLACE;
+    constantDepthBias_ = 0.0f;
+    numDraws_ = 0;
+
+    for (auto& source : shaderParameterSources_)
+        source = reinterpret_cast<const void*>(M_MAX_UNSIGNED);
+}
+
+void DrawCommandList::SetShaders(ShaderVariation* vs, ShaderVariation* ps)
+{
+    if (vs == vertexShader_ && ps == pixelShader_)
+        return;
+
+    DrawCommand& command = AddCommand(DCMD_SHADERS);
+    command.objects_[0] = vs;
+    command.objects_[1] = ps;
+    vertexShader_ = vs;
+    pixelShader_ = ps;
+
+    // Parameters set for the previous shaders may not be valid for the new ones
+    for (auto& source : shaderParameterSources_)
+        source = reinterpret_cast<const void*>(M_MAX_UNSIGNED);
+}
+
+void DrawCommandList::SetBlendMode(BlendMode mode, bool alphaToCoverage)
+{
+    DrawCommand& command = AddCommand(DCMD_BLENDMODE);
+    command.args_[0] = mode;
+    command.args_[1] = alphaToCoverage;
+    blendMode_ = mode;
+}
+
+void DrawCommandList::SetLineAntiAlias(bool enable)
+{
+    AddCommand(DCMD_LINEANTIALIAS).args_[0] = enable;
+}
+
+void DrawCommandList::SetCullMode(CullMode mode)
+{
+    AddCommand(DCMD_CULLMODE).args_[0] = mode;
+}
+
+void DrawCommandList::SetDepthBias(float constantBias, float slopeScaledBias)
+{
+    AddCommand(DCMD_DEPTHBIAS).args_[0] = floatData_.size();
+    floatData_.push_back(constantBias);
+    floatData_.push_back(slopeScaledBias);
+    constantDepthBias_ = constantBias;
+}
+
+void DrawCommandList::SetFillMode(FillMode mode)
+{
+    AddCommand(DCMD_FILLMODE).args_[0] = mode;
+}
+
+void DrawCommandList::SetDepthTest(CompareMode mode)
+{
+    AddCommand(DCMD_DEPTHTEST).args_[0] = mode;
+}
+
+void DrawCommandList::SetDepthWrite(bool enable)
+{
+    AddCommand(DCMD_DEPTHWRITE).args_[0] = enable;
+}
+
+void DrawCommandList::SetStencilTest(bool enable, CompareMode mode, StencilOp pass, StencilOp fail, StencilOp zFail,
+    unsigned stencilRef, unsigned compareMask, unsigned writeMask)
+{
+    DrawCommand& command = AddCommand(DCMD_STENCILTEST);
+    command.args_[0] = enable;
+    command.args_[1] = mode;
+    command.args_[2] = pass;
+    command.args_[3] = fail;
+    command.args_[4] = zFail;
+    command.args_[5] = stencilRef;
+    command.args_[6] = compareMask;
+    command.args_[7] = writeMask;
+}
+
+void DrawCommandList::SetScissorTest(bool enable, const IntRect& rect)
+{
+    DrawCommand& command = AddCommand(DCMD_SCISSORTEST);
+    command.args_[0] = enable;
+    command.args_[1] = (unsigned)rect.left_;
+    command.args_[2] = (unsigned)rect.top_;
+    command.args_[3] = (unsigned)rect.right_;
+    command.args_[4] = (unsigned)rect.bottom_;
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const float data[], unsigned count)
+{
+    AddShaderParameter(param, DCPT_FLOATS, data, count);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, float value)
+{
+    AddShaderParameter(param, DCPT_FLOAT, &value, 1);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, int value)
+{
+    DrawCommand& command = AddCommand(DCMD_SHADERPARAMETER);
+    command.name_ = param;
+    command.args_[0] = DCPT_INT;
+    command.args_[1] = (unsigned)value;
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, bool value)
+{
+    DrawCommand& command = AddCommand(DCMD_SHADERPARAMETER);
+    command.name_ = param;
+    command.args_[0] = DCPT_BOOL;
+    command.args_[1] = value;
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Color& color)
+{
+    AddShaderParameter(param, DCPT_COLOR, color.Data(), 4);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Vector2& vector)
+{
+    AddShaderParameter(param, DCPT_VECTOR2, vector.Data(), 2);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Matrix3& matrix)
+{
+    AddShaderParameter(param, DCPT_MATRIX3, matrix.Data(), 9);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Vector3& vector)
+{
+    AddShaderParameter(param, DCPT_VECTOR3, vector.Data(), 3);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Matrix4& matrix)
+{
+    AddShaderParameter(param, DCPT_MATRIX4, matrix.Data(), 16);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Vector4& vector)
+{
+    AddShaderParameter(param, DCPT_VECTOR4, vector.Data(), 4);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Matrix3x4& matrix)
+{
+    AddShaderParameter(param, DCPT_MATRIX3X4, matrix.Data(), 12);
+}
+
+void DrawCommandList::SetShaderParameter(StringHash param, const Variant& value)
+{
+    switch (value.GetType())
+    {
+    case VAR_BOOL:
+        SetShaderParameter(param, value.GetBool());
+        break;
+
+    case VAR_INT:
+        SetShaderParameter(param, value.GetInt());
+        break;
+
+    case VAR_FLOAT:
+    case VAR_DOUBLE:
+        SetShaderParameter(param, value.GetFloat());
+        break;
+
+    case VAR_VECTOR2:
+        SetShaderParameter(param, value.GetVector2());
+        break;
+
+    case VAR_VECTOR3:
+        SetShaderParameter(param, value.GetVector3());
+        break;
+
+    case VAR_VECTOR4:
+        SetShaderParameter(param, value.GetVector4());
+        break;
+
+    case VAR_COLOR:
+        SetShaderParameter(param, value.GetColor());
+        break;
+
+    case VAR_MATRIX3:
+        SetShaderParameter(param, value.GetMatrix3());
+        break;
+
+    case VAR_MATRIX3X4:
+        SetShaderParameter(param, value.GetMatrix3x4());
+        break;
+
+    case VAR_MATRIX4:
+        SetShaderParameter(param, value.GetMatrix4());
+        break;
+
+    case VAR_BUFFER:
+        {
+            const ea::vector<unsigned char>& buffer = value.GetBuffer();
+            if (buffer.size() >= sizeof(float))
+                SetShaderParameter(param, reinterpret_cast<const float*>(&buffer[0]), buffer.size() / sizeof(float));
+        }
+        break;
+
+    default:
+        // Unsupported parameter type, do nothing
+        break;
+    }
+}
+
+bool DrawCommandList::NeedParameterUpdate(ShaderParameterGroup group, const void* source)
+{
+    if (shaderParameterSources_[group] == source)
+        return false;
+
+    shaderParameterSources_[group] = source;
+    return true;
+}
+
+void DrawCommandList::SetTexture(unsigned index, Texture* texture)
+{
+    DrawCommand& command = AddCommand(DCMD_TEXTURE);
+    command.args_[0] = index;
+    command.objects_[0] = texture;
+}
+
+void DrawCommandList::SetIndexBuffer(IndexBuffer* buffer)
+{
+    AddCommand(DCMD_INDEXBUFFER).objects_[0] = buffer;
+}
+
+void DrawCommandList::SetVertexBuffers(const ea::vector<VertexBuffer*>& buffers, unsigned instanceOffset)
+{
+    DrawCommand& command = AddCommand(DCMD_VERTEXBUFFERS);
+    command.args_[0] = vertexBuffers_.size();
+    command.args_[1] = buffers.size();
+    command.args_[2] = instanceOffset;
+    vertexBuffers_.insert(vertexBuffers_.end(), buffers.begin(), buffers.end());
+}
+
+void DrawCommandList::SetVertexBuffers(const ea::vector<SharedPtr<VertexBuffer> >& buffers, unsigned instanceOffset)
+{
+    SetVertexBuffers(buffers, nullptr, instanceOffset);
+}
+
+void DrawCommandList::SetVertexBuffers(const ea::vector<SharedPtr<VertexBuffer> >& buffers, VertexBuffer* instanceBuffer,
+    unsigned instanceOffset)
+{
+    DrawCommand& command = AddCommand(DCMD_VERTEXBUFFERS);
+    command.args_[0] = vertexBuffers_.size();
+    command.args_[2] = instanceOffset;
+
+    for (const SharedPtr<VertexBuffer>& buffer : buffers)
+        vertexBuffers_.push_back(buffer.Get());
+    if (instanceBuffer)
+        vertexBuffers_.push_back(instanceBuffer);
+
+    command.args_[1] = vertexBuffers_.size() - command.args_[0];
+}
+
+void DrawCommandList::Draw(PrimitiveType type, unsigned vertexStart, unsigned vertexCount)
+{
+    DrawCommand& command = AddCommand(DCMD_DRAW);
+    command.args_[0] = type;
+    command.args_[1] = vertexStart;
+    command.args_[2] = vertexCount;
+    ++numDraws_;
+}
+
+void DrawCommandList::Draw(PrimitiveType type, unsigned indexStart, unsigned indexCount, unsigned minVertex, unsigned vertexCount)
+{
+    DrawCommand& command = AddCommand(DCMD_DRAWINDEXED);
+    command.args_[0] = type;
+    command.args_[1] = indexStart;
+    command.args_[2] = indexCount;
+    command.args_[3] = minVertex;
+    command.args_[4] = vertexCount;
+    ++numDraws_;
+}
+
+void DrawCommandList::DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned indexCount, unsigned minVertex,
+    unsigned vertexCount, unsigned instanceCount)
+{
+    DrawCommand& command = AddCommand(DCMD_DRAWINSTANCED);
+    command.args_[0] = type;
+    command.args_[1] = indexStart;
+    command.args_[2] = indexCount;
+    command.args_[3] = minVertex;
+    command.args_[4] = vertexCount;
+    command.args_[5] = instanceCount;
+    ++numDraws_;
+}
+
+DrawCommand& DrawCommandList::AddCommand(DrawCommandType type)
+{
+    commands_.push_back();
+    DrawCommand& command = commands_.back();
+    command = {};
+    command.type_ = type;
+    return command;
+}
+
+void DrawCommandList::AddShaderParameter(StringHash param, DrawCommandParameterType type, const float* data, unsigned count)
+{
+    DrawCommand& command = AddCommand(DCMD_SHADERPARAMETER);
+    command.name_ = param;
+    command.args_[0] = type;
+    command.args_[1] = floatData_.size();
+    command.args_[2] = count;
+    floatData_.insert(floatData_.end(), data, data + count);
+}
+
+}
@@ -0,0 +1,386 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Graphics/GraphicsDefs.h"
+#include "../Math/Color.h"
+#include "../Math/Matrix3.h"
+#include "../Math/Matrix3x4.h"
+#include "../Math/Matrix4.h"
+#include "../Math/Rect.h"
+#include "../Math/StringHash.h"
+#include "../Math/Vector4.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class IndexBuffer;
+class ShaderVariation;
+class Texture;
+class Variant;
+class VertexBuffer;
+
+/// Recorded draw command type.
+enum DrawCommandType
+{
+    DCMD_SHADERS = 0,
+    DCMD_BLENDMODE,
+    DCMD_LINEANTIALIAS,
+    DCMD_CULLMODE,
+    DCMD_DEPTHBIAS,
+    DCMD_FILLMODE,
+    DCMD_DEPTHTEST,
+    DCMD_DEPTHWRITE,
+    DCMD_STENCILTEST,
+    DCMD_SCISSORTEST,
+    DCMD_SHADERPARAMETER,
+    DCMD_TEXTURE,
+    DCMD_INDEXBUFFER,
+    DCMD_VERTEXBUFFERS,
+    DCMD_DRAW,
+    DCMD_DRAWINDEXED,
+    DCMD_DRAWINSTANCED
+};
+
+/// Recorded shader parameter value type.
+enum DrawCommandParameterType
+{
+    DCPT_FLOATS = 0,
+    DCPT_FLOAT,
+    DCPT_INT,
+    DCPT_BOOL,
+    DCPT_VECTOR2,
+    DCPT_VECTOR3,
+    DCPT_VECTOR4,
+    DCPT_COLOR,
+    DCPT_MATRIX3,
+    DCPT_MATRIX3X4,
+    DCPT_MATRIX4
+};
+
+/// Recorded draw command. Meaning of the arguments depends on the command type.
+struct DrawCommand
+{
+    /// Command type.
+    DrawCommandType type_;
+    /// Shader parameter name.
+    StringHash name_;
+    /// Integer arguments. Float arguments are stored as offsets to the float data of the command list.
+    unsigned args_[8];
+    /// Object arguments.
+    const void* objects_[2];
+};
+
+/// Backend-neutral list of render state changes, shader parameter writes and draw calls. Can be recorded on a worker
+/// thread using the same interface as Graphics and later executed on the main thread. Queries of the shader program
+/// (used shader parameters and texture units) are not available while recording, so texture assignments are deferred
+/// to execution time and shader parameters are always recorded.
+class URHO3D_API DrawCommandList
+{
+public:
+    /// Construct.
+    DrawCommandList();
+
+    /// Remove all commands and reset the tracked state. The viewport is the one that is expected to be set when the
+    /// list is executed.
+    void Reset(const IntRect& viewport);
+
+    /// Record shaders.
+    void SetShaders(ShaderVariation* vs, ShaderVariation* ps);
+    /// Record blending mode.
+    void SetBlendMode(BlendMode mode, bool alphaToCoverage = false);
+    /// Record line antialiasing on/off.
+    void SetLineAntiAlias(bool enable);
+    /// Record hardware culling mode.
+    void SetCullMode(CullMode mode);
+    /// Record depth bias.
+    void SetDepthBias(float constantBias, float slopeScaledBias);
+    /// Record polygon fill mode.
+    void SetFillMode(FillMode mode);
+    /// Record depth compare.
+    void SetDepthTest(CompareMode mode);
+    /// Record depth write on/off.
+    void SetDepthWrite(bool enable);
+    /// Record stencil test.
+    void SetStencilTest(bool enable, CompareMode mode = CMP_ALWAYS, StencilOp pass = OP_KEEP, StencilOp fail = OP_KEEP,
+        StencilOp zFail = OP_KEEP, unsigned stencilRef = 0, unsigned compareMask = M_MAX_UNSIGNED,
+        unsigned writeMask = M_MAX_UNSIGNED);
+    /// Record scissor test.
+    void SetScissorTest(bool enable, const IntRect& rect = IntRect::ZERO);
+
+    /// Record shader float constants.
+    void SetShaderParameter(StringHash param, const float data[], unsigned count);
+    /// Record shader float constant.
+    void SetShaderParameter(StringHash param, float value);
+    /// Record shader integer constant.
+    void SetShaderParameter(StringHash param, int value);
+    /// Record shader boolean constant.
+    void SetShaderParameter(StringHash param, bool value);
+    /// Record shader color constant.
+    void SetShaderParameter(StringHash param, const Color& color);
+    /// Record shader 2D vector constant.
+    void SetShaderParameter(StringHash param, const Vector2& vector);
+    /// Record shader 3x3 matrix constant.
+    void SetShaderParameter(StringHash param, const Matrix3& matrix);
+    /// Record shader 3D vector constant.
+    void SetShaderParameter(StringHash param, const Vector3& vector);
+    /// Record shader 4x4 matrix constant.
+    void SetShaderParameter(StringHash param, const Matrix4& matrix);
+    /// Record shader 4D vector constant.
+    void SetShaderParameter(StringHash param, const Vector4& vector);
+    /// Record shader 3x4 matrix constant.
+    void SetShaderParameter(StringHash param, const Matrix3x4& matrix);
+    /// Record shader constant from a variant. Supports the same variant types as Graphics.
+    void SetShaderParameter(StringHash param, const Variant& value);
+    /// Check whether a shader parameter group needs update. Tracked per list, and reset when shaders change.
+    bool NeedParameterUpdate(ShaderParameterGroup group, const void* source);
+    /// Check whether the current shader program uses a shader parameter. Always true while recording.
+    bool HasShaderParameter(StringHash /*param*/) const { return true; }
+    /// Check whether the current shader program uses a texture unit. Always true while recording.
+    bool HasTextureUnit(TextureUnit /*unit*/) const { return true; }
+
+    /// Record texture. Only set on execution if the shader program uses the texture unit.
+    void SetTexture(unsigned index, Texture* texture);
+    /// Record index buffer.
+    void SetIndexBuffer(IndexBuffer* buffer);
+    /// Record vertex buffers.
+    void SetVertexBuffers(const ea::vector<VertexBuffer*>& buffers, unsigned instanceOffset = 0);
+    /// Record vertex buffers.
+    void SetVertexBuffers(const ea::vector<SharedPtr<VertexBuffer> >& buffers, unsigned instanceOffset = 0);
+    /// Record vertex buffers followed by an instancing data buffer.
+    void SetVertexBuffers(const ea::vector<SharedPtr<VertexBuffer> >& buffers, VertexBuffer* instanceBuffer, unsigned instanceOffset);
+    /// Record non-indexed draw.
+    void Draw(PrimitiveType type, unsigned vertexStart, unsigned vertexCount);
+    /// Record indexed draw.
+    void Draw(PrimitiveType type, unsigned indexStart, unsigned indexCount, unsigned minVertex, unsigned vertexCount);
+    /// Record indexed, instanced draw.
+    void DrawInstanced(PrimitiveType type, unsigned indexStart, unsigned indexCount, unsigned minVertex, unsigned vertexCount,
+        unsigned instanceCount);
+
+    /// Execute the commands on a target. The target is Graphics or any other class with the same interface.
+    template <class T> void Execute(T& target) const;
+
+    /// Return the viewport the list was recorded for.
+    const IntRect& GetViewport() const { return viewport_; }
+    /// Return the recorded blending mode.
+    BlendMode GetBlendMode() const { return blendMode_; }
+    /// Return the recorded constant depth bias.
+    float GetDepthConstantBias() const { return constantDepthBias_; }
+    /// Return number of recorded commands.
+    unsigned GetNumCommands() const { return commands_.size(); }
+    /// Return number of recorded draw calls.
+    unsigned GetNumDraws() const { return numDraws_; }
+    /// Return whether the list is empty.
+    bool IsEmpty() const { return commands_.empty(); }
+
+private:
+    /// Add a command and return it.
+    DrawCommand& AddCommand(DrawCommandType type);
+    /// Record a shader parameter from float data.
+    void AddShaderParameter(StringHash param, DrawCommandParameterType type, const float* data, unsigned count);
+
+    /// Commands.
+    ea::vector<DrawCommand> commands_;
+    /// Float data of shader parameters and depth bias.
+    ea::vector<float> floatData_;
+    /// Vertex buffers referred to by the commands.
+    ea::vector<VertexBuffer*> vertexBuffers_;
+    /// Expected viewport.
+    IntRect viewport_;
+    /// Current vertex shader.
+    ShaderVariation* vertexShader_{};
+    /// Current pixel shader.
+    ShaderVariation* pixelShader_{};
+    /// Current blending mode.
+    BlendMode blendMode_{BLEND_REPLACE};
+    /// Current constant depth bias.
+    float constantDepthBias_{};
+    /// Shader parameter sources.
+    const void* shaderParameterSources_[MAX_SHADER_PARAMETER_GROUPS];
+    /// Number of draw calls.
+    unsigned numDraws_{};
+};
+
+template <class T> void DrawCommandList::Execute(T& target) const
+{
+    ea::vector<VertexBuffer*> vertexBuffers;
+
+    for (const DrawCommand& command : commands_)
+    {
+        const unsigned* args = command.args_;
+
+        switch (command.type_)
+        {
+        case DCMD_SHADERS:
+            target.SetShaders(static_cast<ShaderVariation*>(const_cast<void*>(command.objects_[0])),
+                static_cast<ShaderVariation*>(const_cast<void*>(command.objects_[1])));
+            break;
+
+        case DCMD_BLENDMODE:
+            target.SetBlendMode((BlendMode)args[0], args[1] != 0);
+            break;
+
+        case DCMD_LINEANTIALIAS:
+            target.SetLineAntiAlias(args[0] != 0);
+            break;
+
+        case DCMD_CULLMODE:
+            target.SetCullMode((CullMode)args[0]);
+            break;
+
+        case DCMD_DEPTHBIAS:
+            target.SetDepthBias(floatData_[args[0]], floatData_[args[0] + 1]);
+            break;
+
+        case DCMD_FILLMODE:
+            target.SetFillMode((FillMode)args[0]);
+            break;
+
+        case DCMD_DEPTHTEST:
+            target.SetDepthTest((CompareMode)args[0]);
+            break;
+
+        case DCMD_DEPTHWRITE:
+            target.SetDepthWrite(args[0] != 0);
+            break;
+
+        case DCMD_STENCILTEST:
+            target.SetStencilTest(args[0] != 0, (CompareMode)args[1], (StencilOp)args[2], (StencilOp)args[3],
+                (StencilOp)args[4], args[5], args[6], args[7]);
+            break;
+
+        case DCMD_SCISSORTEST:
+            target.SetScissorTest(args[0] != 0, IntRect((int)args[1], (int)args[2], (int)args[3], (int)args[4]));
+            break;
+
+        case DCMD_SHADERPARAMETER:
+            {
+                const float* data = floatData_.data() + args[1];
+                switch ((DrawCommandParameterType)args[0])
+                {
+                case DCPT_FLOATS: target.SetShaderParameter(command.name_, data, args[2]); break;
+                case DCPT_FLOAT: target.SetShaderParameter(command.name_, data[0]); break;
+                case DCPT_INT: target.SetShaderParameter(command.name_, (int)args[1]); break;
+                case DCPT_BOOL: target.SetShaderParameter(command.name_, args[1] != 0); break;
+                case DCPT_VECTOR2: target.SetShaderParameter(command.name_, Vector2(data)); break;
+                case DCPT_VECTOR3: target.SetShaderParameter(command.name_, Vector3(data)); break;
+                case DCPT_VECTOR4: target.SetShaderParameter(command.name_, Vector4(data)); break;
+                case DCPT_COLOR: target.SetShaderParameter(command.name_, Color(data[0], data[1], data[2], data[3])); break;
+                case DCPT_MATRIX3: target.SetShaderParameter(command.name_, Matrix3(data)); break;
+                case DCPT_MATRIX3X4: target.SetShaderParameter(command.name_, Matrix3x4(data)); break;
+                case DCPT_MATRIX4: target.SetShaderParameter(command.name_, Matrix4(data)); break;
+                }
+            }
+            break;
+
+        case DCMD_TEXTURE:
+            if (target.HasTextureUnit((TextureUnit)args[0]))
+                target.SetTexture(args[0], static_cast<Texture*>(const_cast<void*>(command.objects_[0])));
+            break;
+
+        case DCMD_INDEXBUFFER:
+            target.SetIndexBuffer(static_cast<IndexBuffer*>(const_cast<void*>(command.objects_[0])));
+            break;
+
+        case DCMD_VERTEXBUFFERS:
+            vertexBuffers.assign(vertexBuffers_.begin() + args[0], vertexBuffers_.begin() + args[0] + args[1]);
+            target.SetVertexBuffers(vertexBuffers, args[2]);
+            break;
+
+        case DCMD_DRAW:
+            target.Draw((PrimitiveType)args[0], args[1], args[2]);
+            break;
+
+        case DCMD_DRAWINDEXED:
+            target.Draw((PrimitiveType)args[0], args[1], args[2], args[3], args[4]);
+            break;
+
+        case DCMD_DRAWINSTANCED:
+            target.DrawInstanced((PrimitiveType)args[0], args[1], args[2], args[3], args[4], args[5]);
+            break;
+        }
+    }
+}
+
+/// Command list execution target that only counts the commands. Used to execute command lists without a graphics
+/// context, for example in headless mode and tests.
+struct URHO3D_API NullDrawCommandTarget
+{
+    /// Set shaders.
+    void SetShaders(ShaderVariation* /*vs*/, ShaderVariation* /*ps*/) { ++numStateChanges_; }
+    /// Set blending mode.
+    void SetBlendMode(BlendMode /*mode*/, bool /*alphaToCoverage*/) { ++numStateChanges_; }
+    /// Set line antialiasing on/off.
+    void SetLineAntiAlias(bool /*enable*/) { ++numStateChanges_; }
+    /// Set hardware culling mode.
+    void SetCullMode(CullMode /*mode*/) { ++numStateChanges_; }
+    /// Set depth bias.
+    void SetDepthBias(float /*constantBias*/, float /*slopeScaledBias*/) { ++numStateChanges_; }
+    /// Set polygon fill mode.
+    void SetFillMode(FillMode /*mode*/) { ++numStateChanges_; }
+    /// Set depth compare.
+    void SetDepthTest(CompareMode /*mode*/) { ++numStateChanges_; }
+    /// Set depth write on/off.
+    void SetDepthWrite(bool /*enable*/) { ++numStateChanges_; }
+    /// Set stencil test.
+    void SetStencilTest(bool /*enable*/, CompareMode /*mode*/, StencilOp /*pass*/, StencilOp /*fail*/, StencilOp /*zFail*/,
+        unsigned /*stencilRef*/, unsigned /*compareMask*/, unsigned /*writeMask*/) { ++numStateChanges_; }
+    /// Set scissor test.
+    void SetScissorTest(bool /*enable*/, const IntRect& /*rect*/) { ++numStateChanges_; }
+    /// Set shader constant.
+    template <class U> void SetShaderParameter(StringHash /*param*/, const U& /*value*/) { ++numShaderParameters_; }
+    /// Set shader float constants.
+    void SetShaderParameter(StringHash /*param*/, const float* /*data*/, unsigned /*count*/) { ++numShaderParameters_; }
+    /// Check whether the current shader program uses a texture unit.
+    bool HasTextureUnit(TextureUnit /*unit*/) const { return true; }
+    /// Set texture.
+    void SetTexture(unsigned /*index*/, Texture* /*texture*/) { ++numTextures_; }
+    /// Set index buffer.
+    void SetIndexBuffer(IndexBuffer* /*buffer*/) { ++numStateChanges_; }
+    /// Set vertex buffers.
+    bool SetVertexBuffers(const ea::vector<VertexBuffer*>& /*buffers*/, unsigned /*instanceOffset*/) { ++numStateChanges_; return true; }
+    /// Draw non-indexed geometry.
+    void Draw(PrimitiveType /*type*/, unsigned /*vertexStart*/, unsigned /*vertexCount*/) { ++numDraws_; }
+    /// Draw indexed geometry.
+    void Draw(PrimitiveType /*type*/, unsigned /*indexStart*/, unsigned /*indexCount*/, unsigned /*minVertex*/,
+        unsigned /*vertexCount*/) { ++numDraws_; }
+    /// Draw indexed, instanced geometry.
+    void DrawInstanced(PrimitiveType /*type*/, unsigned /*indexStart*/, unsigned /*indexCount*/, unsigned /*minVertex*/,
+        unsigned /*vertexCount*/, unsigned instanceCount) { ++numDraws_; numInstances_ += instanceCount; }
+
+    /// Number of render state changes.
+    unsigned numStateChanges_{};
+    /// Number of shader parameter writes.
+    unsigned numShaderParameters_{};
+    /// Number of texture assignments.
+    unsigned numTextures_{};
+    /// Number of draw calls.
+    unsigned numDraws_{};
+    /// Number of instances drawn by instanced draw calls.
+    unsigned numInstances_{};
+};
+
+}
@@ -66,7 +66,9 @@ enum UpdateGeometryType
 {
     UPDATE_NONE = 0,
     UPDATE_MAIN_THREAD,
-    UPDATE_WORKER_THREAD
+    UPDATE_WORKER_THREAD,
+    /// Update in a worker thread, then upload to the GPU in the main thread by CommitGeometry().
+    UPDATE_WORKER_THREAD_COMMIT
 };
 
 /// Rendering frame update parameters.
@@ -138,7 +140,7 @@ class URHO3D_API Drawable : public Component
 
     friend class Octant;
     friend class Octree;
-    friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
+    friend void UpdateDrawablesWork(const FrameInfo& frame, Drawable** start, Drawable** end);
 
 public:
     /// Construct.
@@ -161,6 +163,11 @@ public:
 
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     virtual UpdateGeometryType GetUpdateGeometryType() { return UPDATE_NONE; }
+    /// Upload geometry prepared by a worker thread update to the GPU. Called from the main thread for UPDATE_WORKER_THREAD_COMMIT updates.
+    virtual void CommitGeometry() { }
+
+    /// Return whether the world bounding box depends on the view and may change without the drawable being marked dirty. Such drawables are excluded from batched octree culling.
+    virtual bool HasViewDependentBoundingBox() const { return false; }
 
     /// Return the geometry for a specific LOD level.
     virtual Geometry* GetLodGeometry(unsigned batchIndex, unsigned level);
@@ -401,6 +408,8 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in the octant's drawable objects.
+    unsigned octantIndex_{};
     /// Current zone.
     Zone* zone_;
     /// View mask.
@@ -85,6 +85,7 @@ void GlobalIllumination::ResetLightProbes()
 {
     lightProbesBakedData_.Clear();
     lightProbesMesh_ = {};
+    ++revision_;
 }
 
 void GlobalIllumination::CompileLightProbes()
@@ -99,6 +100,7 @@ void GlobalIllumination::CompileLightProbes()
 
     // Add padding to avoid vertex collision
     lightProbesMesh_.Define(collection.worldPositions_);
+    ++revision_;
 
     // Store in file
     auto cache = context_->GetSubsystem<ResourceCache>();
@@ -159,6 +161,8 @@ bool GlobalIllumination::SerializeData(Archive& archive)
         {
             SerializeValue(archive, "Mesh", lightProbesMesh_);
             SerializeValue(archive, "Data", lightProbesBakedData_);
+            if (archive.IsInput())
+                ++revision_;
             return true;
         }
     }
@@ -182,6 +186,7 @@ void GlobalIllumination::ReloadData()
     {
         lightProbesMesh_ = {};
         lightProbesBakedData_.Clear();
+        ++revision_;
     }
 }
 
@@ -59,6 +59,8 @@ public:
     SphericalHarmonicsDot9 SampleAmbientSH(const Vector3& position, unsigned& hint) const;
     /// Sample average ambient lighting.
     Vector3 SampleAverageAmbient(const Vector3& position, unsigned& hint) const;
+    /// Return revision of light probe data. Changes whenever the data is reset or loaded.
+    unsigned GetRevision() const { return revision_; }
 
     /// Set emission brightness.
     void SetEmissionBrightness(float emissionBrightness) { emissionBrightness_ = emissionBrightness; }
@@ -99,6 +101,8 @@ private:
     TetrahedralMesh lightProbesMesh_;
     /// Baked light probes data.
     LightProbeCollectionBakedData lightProbesBakedData_;
+    /// Revision of light probe data.
+    unsigned revision_{};
 };
 
 }
@@ -40,6 +40,7 @@ namespace Urho3D
 {
 
 class ConstantBuffer;
+class DrawCommandList;
 class File;
 class Image;
 class IndexBuffer;
@@ -200,6 +201,14 @@ public:
     bool BeginFrame();
     /// End frame rendering and swap buffers.
     void EndFrame();
+    /// Execute draw commands recorded into a command list. Parameter sources are cleared afterward.
+    void ExecuteCommandList(const DrawCommandList& commandList);
+    /// Insert a fence after the commands issued so far. Return the fence, or null if fences are not supported.
+    void* InsertFence();
+    /// Return whether the GPU has finished the commands issued before a fence, optionally waiting for them. A fence that can not be queried counts as signaled.
+    bool IsFenceSignaled(void* fence, bool wait);
+    /// Release a fence.
+    void ReleaseFence(void* fence);
     /// Clear any or all of rendertarget, depth buffer and stencil buffer.
     void Clear(ClearTargetFlags flags, const Color& color = Color::TRANSPARENT_BLACK, float depth = 1.0f, unsigned stencil = 0);
     /// Resolve multisampled backbuffer to a texture rendertarget. The texture's size should match the viewport size.
@@ -45,14 +45,6 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("DrawOcclusionBatchWork");
-    auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
-}
-
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context)
 {
@@ -71,7 +63,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     if (height & 1u)
         ++height;
 
-    if (width == width_ && height == height_)
+    if (width == width_ && height == height_ && threaded == threaded_)
         return true;
 
     if (width <= 0 || height <= 0)
@@ -85,18 +77,20 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
 
     width_ = width;
     height_ = height;
+    threaded_ = threaded;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.get() + width + 1;
-        buffer.used_ = false;
-    }
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.get() + width + 1;
+
+    // Build triangle bins for threading. Each thread bins its own triangles, tiles are then rasterized in parallel
+    numTilesX_ = (width + OCCLUSION_TILE_WIDTH - 1) / OCCLUSION_TILE_WIDTH;
+    numTilesY_ = (height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT;
+    unsigned numThreadBins = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 0;
+    bins_.clear();
+    bins_.resize(numThreadBins);
+    for (OcclusionTriangleBins& bins : bins_)
+        bins.tiles_.resize(numTilesX_ * numTilesY_);
 
     mipBuffers_.clear();
 
@@ -113,7 +107,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + ea::to_string(width_) + "x" + ea::to_string(height_) + " with " +
-             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(numThreadBuffers) + " thread buffers");
+             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(threaded ? numTilesX_ * numTilesY_ : 1) + " tiles");
 
     CalculateViewport();
     return true;
@@ -159,12 +153,7 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
-
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-        buffers_[i].used_ = false;
-
+    ClearBuffer();
     depthHierarchyDirty_ = true;
 }
 
@@ -206,41 +195,61 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.size() == 1)
+    if (!buffer_.data_)
+    {
+        batches_.clear();
+        return;
+    }
+
+    if (!threaded_)
     {
         // Not threaded
         for (auto i = batches_.begin(); i != batches_.end(); ++i)
             DrawBatch(*i, 0);
-
-        depthHierarchyDirty_ = true;
     }
-    else if (buffers_.size() > 1)
+    else if (!batches_.empty())
     {
-        // Threaded
+        // Threaded: first transform, clip and bin the triangles of the batches in parallel
         auto* queue = GetSubsystem<WorkQueue>();
 
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
+        for (OcclusionTriangleBins& bins : bins_)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
+            bins.triangles_.clear();
+            for (ea::vector<unsigned>& tile : bins.tiles_)
+                tile.clear();
+            bins.numTriangles_ = 0;
+        }
+
+        {
+            URHO3D_PROFILE("BinOcclusionTriangles");
+            queue->ParallelFor(batches_.size(), 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                    DrawBatch(batches_[i], threadIndex);
+            });
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
+        // Then rasterize the screen tiles in parallel. Tiles do not overlap, so they can write to the same buffer
+        {
+            URHO3D_PROFILE("DrawOcclusionTiles");
+            queue->ParallelFor(numTilesX_ * numTilesY_, 1, [this](unsigned begin, unsigned end, unsigned)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                    DrawTile(i);
+            });
+        }
 
-        MergeBuffers();
-        depthHierarchyDirty_ = true;
+        for (const OcclusionTriangleBins& bins : bins_)
+            numTriangles_ += bins.numTriangles_;
     }
 
+    depthHierarchyDirty_ = true;
     batches_.clear();
 }
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE("BuildDepthHierarchy");
@@ -252,7 +261,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].get() + y * width;
             DepthValue* end = dest + width;
 
@@ -342,9 +351,100 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.empty())
+    if (!buffer_.data_)
         return true;
 
+    IntRect rect;
+    int z;
+    return !ProjectBox(worldSpaceBox, rect, z) || IsRectVisible(rect, z);
+}
+
+void OcclusionBuffer::IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const
+{
+    if (!buffer_.data_)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            results[i] = true;
+        return;
+    }
+
+    IntRect rect;
+    int z;
+    for (unsigned i = 0; i < count; ++i)
+        results[i] = !ProjectBox(worldSpaceBoxes[i], rect, z) || IsRectVisible(rect, z);
+}
+
+bool OcclusionBuffer::ProjectBox(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const
+{
+    float minX, maxX, minY, maxY, minZ;
+
+#ifdef URHO3D_SSE
+    // Transform corners to projection space, four corners at a time in the same order of operations as ModelTransform()
+    const __m128 cornersX = _mm_setr_ps(worldSpaceBox.min_.x_, worldSpaceBox.max_.x_, worldSpaceBox.min_.x_, worldSpaceBox.max_.x_);
+    const __m128 cornersY = _mm_setr_ps(worldSpaceBox.min_.y_, worldSpaceBox.min_.y_, worldSpaceBox.max_.y_, worldSpaceBox.max_.y_);
+    const __m128 nearZ = _mm_set1_ps(worldSpaceBox.min_.z_);
+    const __m128 farZ = _mm_set1_ps(worldSpaceBox.max_.z_);
+
+    const auto transformRow = [&](const float* row, __m128& nearResult, __m128& farResult)
+    {
+        const __m128 xy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), cornersX), _mm_mul_ps(_mm_set1_ps(row[1]), cornersY));
+        const __m128 m2 = _mm_set1_ps(row[2]);
+        const __m128 m3 = _mm_set1_ps(row[3]);
+        nearResult = _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(m2, nearZ)), m3);
+        farResult = _mm_add_ps(_mm_add_ps(xy, _mm_mul_ps(m2, farZ)), m3);
+    };
+
+    __m128 x0, x1, y0, y1, z0, z1, w0, w1;
+    transformRow(&viewProj_.m00_, x0, x1);
+    transformRow(&viewProj_.m10_, y0, y1);
+    transformRow(&viewProj_.m20_, z0, z1);
+    transformRow(&viewProj_.m30_, w0, w1);
+
+    // Apply a far clip relative bias
+    const __m128 bias = _mm_set1_ps(OCCLUSION_RELATIVE_BIAS);
+    z0 = _mm_sub_ps(z0, bias);
+    z1 = _mm_sub_ps(z1, bias);
+
+    // If any of the corners cross the near plane, assume visible
+    const __m128 zero = _mm_setzero_ps();
+    if (_mm_movemask_ps(_mm_or_ps(_mm_cmple_ps(z0, zero), _mm_cmple_ps(z1, zero))))
+        return false;
+
+    // Transform to screen space in the same order of operations as ViewportTransform()
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 invW0 = _mm_div_ps(one, w0);
+    const __m128 invW1 = _mm_div_ps(one, w1);
+    const __m128 scaleX = _mm_set1_ps(scaleX_);
+    const __m128 scaleY = _mm_set1_ps(scaleY_);
+    const __m128 offsetX = _mm_set1_ps(offsetX_);
+    const __m128 offsetY = _mm_set1_ps(offsetY_);
+    const __m128 scaleZ = _mm_set1_ps(OCCLUSION_Z_SCALE);
+    const __m128 projX0 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW0, x0), scaleX), offsetX);
+    const __m128 projX1 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW1, x1), scaleX), offsetX);
+    const __m128 projY0 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW0, y0), scaleY), offsetY);
+    const __m128 projY1 = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(invW1, y1), scaleY), offsetY);
+    const __m128 projZ0 = _mm_mul_ps(_mm_mul_ps(invW0, z0), scaleZ);
+    const __m128 projZ1 = _mm_mul_ps(_mm_mul_ps(invW1, z1), scaleZ);
+
+    const auto horizontalMin = [](__m128 v)
+    {
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    };
+    const auto horizontalMax = [](__m128 v)
+    {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    };
+
+    minX = horizontalMin(_mm_min_ps(projX0, projX1));
+    maxX = horizontalMax(_mm_max_ps(projX0, projX1));
+    minY = horizontalMin(_mm_min_ps(projY0, projY1));
+    maxY = horizontalMax(_mm_max_ps(projY0, projY1));
+    minZ = horizontalMin(_mm_min_ps(projZ0, projZ1));
+#else
     // Transform corners to projection space
     Vector4 vertices[8];
     vertices[0] = ModelTransform(viewProj_, worldSpaceBox.min_);
@@ -361,10 +461,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         vertice.z_ -= OCCLUSION_RELATIVE_BIAS;
 
     // Transform to screen space. If any of the corners cross the near plane, assume visible
-    float minX, maxX, minY, maxY, minZ;
-
     if (vertices[0].z_ <= 0.0f)
-        return true;
+        return false;
 
     Vector3 projected = ViewportTransform(vertices[0]);
     minX = maxX = projected.x_;
@@ -375,7 +473,7 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     for (unsigned i = 1; i < 8; ++i)
     {
         if (vertices[i].z_ <= 0.0f)
-            return true;
+            return false;
 
         projected = ViewportTransform(vertices[i]);
 
@@ -385,15 +483,16 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         if (projected.y_ > maxY) maxY = projected.y_;
         if (projected.z_ < minZ) minZ = projected.z_;
     }
+#endif
 
     // Expand the bounding box 1 pixel in each direction to be conservative and correct rasterization offset
-    IntRect rect((int)(minX - 1.5f), (int)(minY - 1.5f), RoundToInt(maxX), RoundToInt(maxY));
+    rect = IntRect((int)(minX - 1.5f), (int)(minY - 1.5f), RoundToInt(maxX), RoundToInt(maxY));
 
     // If the rect is outside, let frustum culling handle
     if (rect.right_ < 0 || rect.bottom_ < 0)
-        return true;
+        return false;
     if (rect.left_ >= width_ || rect.top_ >= height_)
-        return true;
+        return false;
 
     // Clipping of rect
     if (rect.left_ < 0)
@@ -406,8 +505,12 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
         rect.bottom_ = height_ - 1;
 
     // Convert depth to integer and apply final bias
-    int z = RoundToInt(minZ) - OCCLUSION_FIXED_BIAS;
+    z = RoundToInt(minZ) - OCCLUSION_FIXED_BIAS;
+    return true;
+}
 
+bool OcclusionBuffer::IsRectVisible(const IntRect& rect, int z) const
+{
     if (!depthHierarchyDirty_)
     {
         // Start from lowest mip level and check if a conclusive result can be found
@@ -444,8 +547,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -470,13 +573,6 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -640,7 +736,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            SubmitTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -678,7 +774,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    SubmitTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -686,7 +782,62 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
     }
 
     if (drawOk)
-        ++numTriangles_;
+    {
+        if (threaded_)
+            ++bins_[threadIndex].numTriangles_;
+        else
+            ++numTriangles_;
+    }
+}
+
+void OcclusionBuffer::SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+{
+    if (!threaded_)
+    {
+        DrawTriangle2D(vertices, clockwise, IntRect(0, 0, width_, height_));
+        return;
+    }
+
+    OcclusionTriangleBins& bins = bins_[threadIndex];
+    const auto triangleIndex = static_cast<unsigned>(bins.triangles_.size());
+    OcclusionTriangle& triangle = bins.triangles_.push_back();
+    triangle.vertices_[0] = vertices[0];
+    triangle.vertices_[1] = vertices[1];
+    triangle.vertices_[2] = vertices[2];
+    triangle.clockwise_ = clockwise;
+
+    // Bin into every tile touched by the screen space bounds. Off-screen parts are clipped during rasterization
+    const float minX = Min(Min(vertices[0].x_, vertices[1].x_), vertices[2].x_);
+    const float maxX = Max(Max(vertices[0].x_, vertices[1].x_), vertices[2].x_);
+    const float minY = Min(Min(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    const float maxY = Max(Max(vertices[0].y_, vertices[1].y_), vertices[2].y_);
+    const int tileLeft = Clamp(FloorToInt(minX) / OCCLUSION_TILE_WIDTH, 0, numTilesX_ - 1);
+    const int tileRight = Clamp(CeilToInt(maxX) / OCCLUSION_TILE_WIDTH, 0, numTilesX_ - 1);
+    const int tileTop = Clamp(FloorToInt(minY) / OCCLUSION_TILE_HEIGHT, 0, numTilesY_ - 1);
+    const int tileBottom = Clamp(CeilToInt(maxY) / OCCLUSION_TILE_HEIGHT, 0, numTilesY_ - 1);
+
+    for (int y = tileTop; y <= tileBottom; ++y)
+    {
+        for (int x = tileLeft; x <= tileRight; ++x)
+            bins.tiles_[y * numTilesX_ + x].push_back(triangleIndex);
+    }
+}
+
+void OcclusionBuffer::DrawTile(unsigned tileIndex)
+{
+    const int tileX = tileIndex % numTilesX_;
+    const int tileY = tileIndex / numTilesX_;
+    const IntRect clipRect(tileX * OCCLUSION_TILE_WIDTH, tileY * OCCLUSION_TILE_HEIGHT,
+        Min((tileX + 1) * OCCLUSION_TILE_WIDTH, width_), Min((tileY + 1) * OCCLUSION_TILE_HEIGHT, height_));
+
+    for (const OcclusionTriangleBins& bins : bins_)
+    {
+        for (unsigned triangleIndex : bins.tiles_[tileIndex])
+        {
+            const OcclusionTriangle& triangle = bins.triangles_[triangleIndex];
+            DrawTriangle2D(triangle.vertices_, triangle.clockwise_, clipRect);
+        }
+    }
 }
 
 void OcclusionBuffer::ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles)
@@ -819,7 +970,81 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+/// Fill a span of a depth buffer row, keeping the closer depth. Right edge is exclusive.
+static inline void DrawSpan(int* row, int left, int right, int invZ, int dInvZdX, const IntRect& clipRect)
+{
+    if (left < clipRect.left_)
+    {
+        invZ += (clipRect.left_ - left) * dInvZdX;
+        left = clipRect.left_;
+    }
+    if (right > clipRect.right_)
+        right = clipRect.right_;
+
+    int* dest = row + left;
+    int* end = row + right;
+
+#ifdef URHO3D_SSE
+    // Process four pixels at a time. Depth is interpolated in integers, so the result is identical to the scalar loop
+    if (end - dest >= 4)
+    {
+        __m128i depth = _mm_setr_epi32(invZ, invZ + dInvZdX, invZ + 2 * dInvZdX, invZ + 3 * dInvZdX);
+        const __m128i depthStep = _mm_set1_epi32(4 * dInvZdX);
+        while (end - dest >= 4)
+        {
+            const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+            const __m128i closer = _mm_cmplt_epi32(depth, current);
+            const __m128i result = _mm_or_si128(_mm_and_si128(closer, depth), _mm_andnot_si128(closer, current));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), result);
+            depth = _mm_add_epi32(depth, depthStep);
+            dest += 4;
+        }
+        invZ = _mm_cvtsi128_si32(depth);
+    }
+#endif
+
+    while (dest < end)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZdX;
+        ++dest;
+    }
+}
+
+/// Fill rows [startY, endY) between two edges, limited to a screen rectangle. Both edges are left stepped to endY.
+static void DrawSpans(int* buffer, int width, Edge& left, Edge& right, int dInvZdX, int startY, int endY, const IntRect& clipRect)
+{
+    const int numRows = endY - startY;
+    if (numRows <= 0)
+        return;
+
+    // Skip the rows outside the rectangle by stepping the edges directly
+    const int firstRow = Clamp(clipRect.top_ - startY, 0, numRows);
+    const int lastRow = Clamp(clipRect.bottom_ - startY, firstRow, numRows);
+
+    left.x_ += firstRow * left.xStep_;
+    left.invZ_ += firstRow * left.invZStep_;
+    right.x_ += firstRow * right.xStep_;
+
+    int* row = buffer + (startY + firstRow) * width;
+    for (int i = firstRow; i < lastRow; ++i)
+    {
+        DrawSpan(row, left.x_ >> 16u, right.x_ >> 16u, left.invZ_, dInvZdX, clipRect);
+
+        left.x_ += left.xStep_;
+        left.invZ_ += left.invZStep_;
+        right.x_ += right.xStep_;
+        row += width;
+    }
+
+    const int remainingRows = numRows - lastRow;
+    left.x_ += remainingRows * left.xStep_;
+    left.invZ_ += remainingRows * left.invZStep_;
+    right.x_ += remainingRows * right.xStep_;
+}
+
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, const IntRect& clipRect)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -882,8 +1107,8 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     auto middleY = (int)vertices[middle].y_;
     auto bottomY = (int)vertices[bottom].y_;
 
-    // Check for degenerate triangle
-    if (topY == bottomY)
+    // Check for degenerate triangle, or triangle outside the rectangle
+    if (topY == bottomY || bottomY <= clipRect.top_ || topY >= clipRect.bottom_)
         return;
 
     // Reverse middleIsRight test if triangle is counterclockwise
@@ -896,7 +1121,7 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Gradients gradients(vertices);
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = buffer_.data_;
 
     if (middleIsRight)
     {
@@ -904,52 +1129,14 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
         if (!topDegenerate)
         {
             Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (topToMiddle.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                topToMiddle.x_ += topToMiddle.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, topToBottom, topToMiddle, gradients.dInvZdXInt_, topY, middleY, clipRect);
         }
 
         // Bottom half
         if (!bottomDegenerate)
         {
             Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (middleToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                middleToBottom.x_ += middleToBottom.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, topToBottom, middleToBottom, gradients.dInvZdXInt_, middleY, bottomY, clipRect);
         }
     }
     else
@@ -958,86 +1145,24 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
         if (!topDegenerate)
         {
             Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToMiddle.invZ_;
-                int* dest = row + (topToMiddle.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToMiddle.x_ += topToMiddle.xStep_;
-                topToMiddle.invZ_ += topToMiddle.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
+            DrawSpans(bufferData, width_, topToMiddle, topToBottom, gradients.dInvZdXInt_, topY, middleY, clipRect);
         }
 
         // Bottom half
         if (!bottomDegenerate)
         {
             Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = middleToBottom.invZ_;
-                int* dest = row + (middleToBottom.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                middleToBottom.x_ += middleToBottom.xStep_;
-                middleToBottom.invZ_ += middleToBottom.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
-        }
-    }
-}
-
-void OcclusionBuffer::MergeBuffers()
-{
-    URHO3D_PROFILE("MergeBuffers");
-
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-    {
-        if (!buffers_[i].used_)
-            continue;
-
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
-
-        while (count--)
-        {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            DrawSpans(bufferData, width_, middleToBottom, topToBottom, gradients.dInvZdXInt_, middleY, bottomY, clipRect);
         }
     }
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     auto fillValue = (int)OCCLUSION_Z_SCALE;
 
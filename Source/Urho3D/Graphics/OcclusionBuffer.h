@@ -51,15 +51,33 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     ea::shared_array<int> dataWithSafety_;
     /// Buffer data.
-    int* data_;
-    /// Use flag.
-    bool used_;
+    int* data_{};
+};
+
+/// Clipped and projected occluder triangle waiting for tiled rasterization.
+struct OcclusionTriangle
+{
+    /// Screen space vertices.
+    Vector3 vertices_[3];
+    /// Clockwise flag.
+    bool clockwise_;
+};
+
+/// Per-thread occluder triangles and their screen tile bins.
+struct OcclusionTriangleBins
+{
+    /// Projected triangles.
+    ea::vector<OcclusionTriangle> triangles_;
+    /// Indices into triangles per screen tile.
+    ea::vector<ea::vector<unsigned> > tiles_;
+    /// Number of rendered triangles.
+    unsigned numTriangles_{};
 };
 
 /// Stored occlusion render job.
@@ -87,6 +105,8 @@ static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_TILE_WIDTH = 64;
+static const int OCCLUSION_TILE_HEIGHT = 32;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -102,7 +122,7 @@ public:
     /// Register object with the engine.
     static void RegisterObject(Context* context);
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to rasterize in screen tiles on worker threads.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -127,7 +147,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.size() ? buffers_[0].data_ : nullptr; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -151,10 +171,12 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
+    /// Test bounding boxes for visibility in a batch and write one result per box. For best performance, build depth hierarchy first.
+    void IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
@@ -172,19 +194,27 @@ private:
     inline float SignedArea(const Vector3& v0, const Vector3& v1, const Vector3& v2) const;
     /// Calculate viewport transform.
     void CalculateViewport();
+    /// Project a bounding box to a clipped screen rectangle and biased minimum depth. Return false if the box crosses the near plane or lies outside the screen, in which case it is assumed visible.
+    bool ProjectBox(const BoundingBox& worldSpaceBox, IntRect& rect, int& z) const;
+    /// Test a screen rectangle for visibility at given depth against the depth hierarchy and the depth buffer.
+    bool IsRectVisible(const IntRect& rect, int z) const;
     /// Draw a triangle.
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    ea::vector<OcclusionBufferData> buffers_;
+    /// Draw a clipped and projected triangle, or store it into the screen tile bins of the thread when threaded.
+    void SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Draw a clipped triangle limited to a screen rectangle. Right and bottom edges are exclusive.
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise, const IntRect& clipRect);
+    /// Rasterize binned triangles of a screen tile.
+    void DrawTile(unsigned tileIndex);
+    /// Clear the buffer.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Occluder triangle bins per thread when threaded.
+    ea::vector<OcclusionTriangleBins> bins_;
     /// Reduced size depth buffers.
     ea::vector<ea::shared_array<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
@@ -193,6 +223,12 @@ private:
     int width_{};
     /// Buffer height.
     int height_{};
+    /// Number of screen tiles in the X direction.
+    int numTilesX_{};
+    /// Number of screen tiles in the Y direction.
+    int numTilesY_{};
+    /// Threaded rasterization flag.
+    bool threaded_{};
     /// Number of rendered triangles.
     unsigned numTriangles_{};
     /// Maximum number of triangles.
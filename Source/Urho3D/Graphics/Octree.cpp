@@ -51,6 +51,96 @@ namespace Urho3D
 namespace
 {
 
+/// Minimum number of drawables updated by one parallel work chunk.
+static const unsigned DRAWABLES_PER_WORK_ITEM = 64;
+/// Number of drawables culled against a frustum before passing them to the query. Must be a multiple of 4.
+static const unsigned DRAWABLES_PER_CULLING_BATCH = 64;
+
+/// Frustum planes prepared for testing octant culling bounds four at a time.
+class FrustumCuller
+{
+public:
+    /// Construct from frustum.
+    explicit FrustumCuller(const Frustum& frustum)
+    {
+#ifdef URHO3D_SSE
+        for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+        {
+            const Plane& plane = frustum.planes_[i];
+            normalX_[i] = _mm_set1_ps(plane.normal_.x_);
+            normalY_[i] = _mm_set1_ps(plane.normal_.y_);
+            normalZ_[i] = _mm_set1_ps(plane.normal_.z_);
+            absNormalX_[i] = _mm_set1_ps(plane.absNormal_.x_);
+            absNormalY_[i] = _mm_set1_ps(plane.absNormal_.y_);
+            absNormalZ_[i] = _mm_set1_ps(plane.absNormal_.z_);
+            d_[i] = _mm_set1_ps(plane.d_);
+        }
+#else
+        frustum_ = &frustum;
+#endif
+    }
+
+    /// Return bit mask of the bounds in the block that are fully outside the frustum. Same test as Frustum::IsInsideFast().
+    unsigned GetOutsideMask(const OctantBoundsBlock& block) const
+    {
+#ifdef URHO3D_SSE
+        const __m128 centerX = _mm_loadu_ps(block.centerX_);
+        const __m128 centerY = _mm_loadu_ps(block.centerY_);
+        const __m128 centerZ = _mm_loadu_ps(block.centerZ_);
+        const __m128 edgeX = _mm_loadu_ps(block.edgeX_);
+        const __m128 edgeY = _mm_loadu_ps(block.edgeY_);
+        const __m128 edgeZ = _mm_loadu_ps(block.edgeZ_);
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+
+        __m128 outside = _mm_setzero_ps();
+        for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+        {
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(normalX_[i], centerX), _mm_mul_ps(normalY_[i], centerY)), _mm_mul_ps(normalZ_[i], centerZ)), d_[i]);
+            __m128 absDist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(absNormalX_[i], edgeX), _mm_mul_ps(absNormalY_[i], edgeY)), _mm_mul_ps(absNormalZ_[i], edgeZ));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_xor_ps(absDist, signMask)));
+        }
+        return static_cast<unsigned>(_mm_movemask_ps(outside));
+#else
+        unsigned outsideMask = 0;
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            const Vector3 center(block.centerX_[lane], block.centerY_[lane], block.centerZ_[lane]);
+            const Vector3 edge(block.edgeX_[lane], block.edgeY_[lane], block.edgeZ_[lane]);
+            for (const Plane& plane : frustum_->planes_)
+            {
+                float dist = plane.normal_.DotProduct(center) + plane.d_;
+                float absDist = plane.absNormal_.DotProduct(edge);
+                if (dist < -absDist)
+                {
+                    outsideMask |= 1u << lane;
+                    break;
+                }
+            }
+        }
+        return outsideMask;
+#endif
+    }
+
+private:
+#ifdef URHO3D_SSE
+    /// Plane normals.
+    __m128 normalX_[NUM_FRUSTUM_PLANES];
+    __m128 normalY_[NUM_FRUSTUM_PLANES];
+    __m128 normalZ_[NUM_FRUSTUM_PLANES];
+    /// Absolute plane normals.
+    __m128 absNormalX_[NUM_FRUSTUM_PLANES];
+    __m128 absNormalY_[NUM_FRUSTUM_PLANES];
+    __m128 absNormalZ_[NUM_FRUSTUM_PLANES];
+    /// Plane constants.
+    __m128 d_[NUM_FRUSTUM_PLANES];
+#else
+    /// Frustum.
+    const Frustum* frustum_;
+#endif
+};
+
 /// Unused vector of drawables.
 static ea::vector<Drawable*> unusedDrawablesVector;
 
@@ -150,12 +240,9 @@ static const int DEFAULT_OCTREE_LEVELS = 8;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+void UpdateDrawablesWork(const FrameInfo& frame, Drawable** start, Drawable** end)
 {
     URHO3D_PROFILE("UpdateDrawablesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
 
     while (start != end)
     {
@@ -187,11 +274,11 @@ Octant::~Octant()
         // Remove the drawables (if any) from this octant to the root octant
         for (auto i = drawables_.begin(); i != drawables_.end(); ++i)
         {
-            (*i)->SetOctant(root_);
-            root_->drawables_.push_back(*i);
+            root_->PushDrawable(*i);
             root_->QueueUpdate(*i);
         }
         drawables_.clear();
+        cullingBounds_.clear();
         numDrawables_ = 0;
     }
 
@@ -252,9 +339,13 @@ void Octant::InsertDrawable(Drawable* drawable)
         if (oldOctant != this)
         {
             // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+            const unsigned oldIndex = drawable->octantIndex_;
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+            {
+                oldOctant->EraseDrawable(oldIndex);
+                oldOctant->DecDrawableCount();
+            }
         }
     }
     else
@@ -292,6 +383,38 @@ bool Octant::CheckDrawableFit(const BoundingBox& box) const
     return false;
 }
 
+void Octant::UpdateDrawableBounds(Drawable* drawable)
+{
+    const unsigned index = drawable->octantIndex_;
+    assert(index < drawables_.size() && drawables_[index] == drawable);
+
+    OctantBoundsBlock& block = cullingBounds_[index >> 2u];
+    const unsigned lane = index & 3u;
+    if (drawable->HasViewDependentBoundingBox())
+    {
+        block.centerX_[lane] = block.centerY_[lane] = block.centerZ_[lane] = 0.0f;
+        block.edgeX_[lane] = block.edgeY_[lane] = block.edgeZ_[lane] = M_INFINITY;
+        return;
+    }
+
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    const Vector3 center = box.Center();
+    const Vector3 edge = center - box.min_;
+    block.centerX_[lane] = center.x_;
+    block.centerY_[lane] = center.y_;
+    block.centerZ_[lane] = center.z_;
+    block.edgeX_[lane] = edge.x_;
+    block.edgeY_[lane] = edge.y_;
+    block.edgeZ_[lane] = edge.z_;
+}
+
+void Octant::InvalidateDrawableBounds(Drawable* drawable)
+{
+    const unsigned index = drawable->octantIndex_;
+    if (index < drawables_.size() && drawables_[index] == drawable)
+        cullingBounds_[index >> 2u].edgeX_[index & 3u] = M_INFINITY;
+}
+
 void Octant::ResetRoot()
 {
     root_ = nullptr;
@@ -345,9 +468,15 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
 
     if (drawables_.size())
     {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-        query.TestDrawables(start, end, inside);
+        const Frustum* frustum = inside ? nullptr : query.GetCullingFrustum();
+        if (frustum)
+            CullDrawablesInternal(query, *frustum);
+        else
+        {
+            auto** start = const_cast<Drawable**>(&drawables_[0]);
+            Drawable** end = start + drawables_.size();
+            query.TestDrawables(start, end, inside);
+        }
     }
 
     for (auto child : children_)
@@ -357,6 +486,43 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     }
 }
 
+void Octant::CullDrawablesInternal(OctreeQuery& query, const Frustum& frustum) const
+{
+    const FrustumCuller culler(frustum);
+    const unsigned numDrawables = drawables_.size();
+
+    Drawable* insideDrawables[DRAWABLES_PER_CULLING_BATCH];
+    Drawable* uncertainDrawables[DRAWABLES_PER_CULLING_BATCH];
+
+    for (unsigned batchStart = 0; batchStart < numDrawables; batchStart += DRAWABLES_PER_CULLING_BATCH)
+    {
+        const unsigned batchEnd = Min(batchStart + DRAWABLES_PER_CULLING_BATCH, numDrawables);
+        unsigned numInside = 0;
+        unsigned numUncertain = 0;
+
+        for (unsigned i = batchStart; i < batchEnd; i += 4)
+        {
+            const OctantBoundsBlock& block = cullingBounds_[i >> 2u];
+            const unsigned outsideMask = culler.GetOutsideMask(block);
+            const unsigned numLanes = Min(4U, batchEnd - i);
+
+            for (unsigned lane = 0; lane < numLanes; ++lane)
+            {
+                // Drawables with out of date bounds are tested individually by the query
+                if (block.edgeX_[lane] == M_INFINITY)
+                    uncertainDrawables[numUncertain++] = drawables_[i + lane];
+                else if (!(outsideMask & (1u << lane)))
+                    insideDrawables[numInside++] = drawables_[i + lane];
+            }
+        }
+
+        if (numInside)
+            query.TestDrawables(insideDrawables, insideDrawables + numInside, true);
+        if (numUncertain)
+            query.TestDrawables(uncertainDrawables, uncertainDrawables + numUncertain, false);
+    }
+}
+
 void Octant::GetDrawablesInternal(RayOctreeQuery& query) const
 {
     float octantDist = query.ray_.HitDistance(cullingBox_);
@@ -472,6 +638,11 @@ void Octree::Update(const FrameInfo& frame)
         return;
     }
 
+    // Apply batched transform changes first, so that moved drawables are queued for reinsertion
+    Scene* scene = GetScene();
+    if (scene)
+        scene->UpdateTransforms();
+
     // Let drawables update themselves before reinsertion. This can be used for animation
     if (!drawableUpdates_.empty())
     {
@@ -479,34 +650,14 @@ void Octree::Update(const FrameInfo& frame)
 
         // Perform updates in worker threads. Notify the scene that a threaded update is going on and components
         // (for example physics objects) should not perform non-threadsafe work when marked dirty
-        Scene* scene = GetScene();
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.size() / numWorkItems), 1);
-
-        auto start = drawableUpdates_.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        queue->ParallelFor(drawableUpdates_.size(), DRAWABLES_PER_WORK_ITEM, [&](unsigned begin, unsigned end, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            auto end = drawableUpdates_.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+            UpdateDrawablesWork(frame, drawableUpdates_.data() + begin, drawableUpdates_.data() + end);
+        });
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -521,6 +672,9 @@ void Octree::Update(const FrameInfo& frame)
             Drawable* drawable = *i;
             if (drawable)
             {
+                // Invalidation of the culling bounds was deferred to the main thread
+                if (Octant* octant = drawable->GetOctant())
+                    octant->InvalidateDrawableBounds(drawable);
                 drawable->Update(frame);
                 drawableUpdates_.push_back(drawable);
             }
@@ -530,7 +684,6 @@ void Octree::Update(const FrameInfo& frame)
     }
 
     // Notify drawable update being finished. Custom animation (eg. IK) can be done at this point
-    Scene* scene = GetScene();
     if (scene)
     {
         using namespace SceneDrawableUpdateFinished;
@@ -557,15 +710,21 @@ void Octree::Update(const FrameInfo& frame)
             // Skip if no octant or does not belong to this octree anymore
             if (!octant || octant->GetRoot() != this)
                 continue;
-            // Skip if still fits the current octant
+            // Skip if still fits the current octant, but refresh its culling bounds
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            {
+                octant->UpdateDrawableBounds(drawable);
                 continue;
+            }
 
             InsertDrawable(drawable);
 
+            // Refresh culling bounds, the drawable may have stayed in the same octant
+            octant = drawable->GetOctant();
+            octant->UpdateDrawableBounds(drawable);
+
 #ifdef _DEBUG
             // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
             if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
             {
                 URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
@@ -671,12 +830,19 @@ void Octree::QueueUpdate(Drawable* drawable)
     Scene* scene = GetScene();
     if (scene && scene->IsThreadedUpdate())
     {
+        // The octant culling bounds are not thread-safe; they are invalidated when the queue is merged on the main thread
         MutexLock lock(octreeMutex_);
         threadedDrawableUpdates_.push_back(drawable);
     }
     else
+    {
         drawableUpdates_.push_back(drawable);
 
+        // Until reinsertion, the drawable can not be culled in batches
+        if (Octant* octant = drawable->GetOctant())
+            octant->InvalidateDrawableBounds(drawable);
+    }
+
     drawable->updateQueued_ = true;
 }
 
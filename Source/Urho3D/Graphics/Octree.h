@@ -36,6 +36,21 @@ class Zone;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// World bounding boxes of four octant drawables in structure of arrays layout, used for vectorized frustum culling.
+/// Drawables whose bounds may be out of date have infinite edge size.
+/// @nobind
+struct OctantBoundsBlock
+{
+    /// Bounding box centers.
+    float centerX_[4];
+    float centerY_[4];
+    float centerZ_[4];
+    /// Bounding box half sizes.
+    float edgeX_[4];
+    float edgeY_[4];
+    float edgeZ_[4];
+};
+
 /// %Octree octant.
 /// @nobind
 class URHO3D_API Octant
@@ -58,18 +73,17 @@ public:
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
-        drawable->SetOctant(this);
-        drawables_.push_back(drawable);
+        PushDrawable(drawable);
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        auto it = drawables_.find(drawable);
-        if (it != drawables_.end())
+        const unsigned index = drawable->octantIndex_;
+        if (index < drawables_.size() && drawables_[index] == drawable)
         {
-            drawables_.erase(it);
+            EraseDrawable(index);
             if (resetOctant)
                 drawable->SetOctant(nullptr);
             DecDrawableCount();
@@ -98,6 +112,11 @@ public:
     /// Return true if there are no drawable objects in this octant and child octants.
     bool IsEmpty() { return numDrawables_ == 0; }
 
+    /// Update culling bounds of a drawable in this octant from its world bounding box.
+    void UpdateDrawableBounds(Drawable* drawable);
+    /// Mark culling bounds of a drawable in this octant out of date, so that it is always tested individually.
+    void InvalidateDrawableBounds(Drawable* drawable);
+
     /// Reset root pointer recursively. Called when the whole octree is being destroyed.
     void ResetRoot();
     /// Draw bounds to the debug graphics recursively.
@@ -108,11 +127,51 @@ protected:
     void Initialize(const BoundingBox& box);
     /// Return drawable objects by a query, called internally.
     void GetDrawablesInternal(OctreeQuery& query, bool inside) const;
+    /// Cull drawable objects of this octant against a frustum using the culling bounds, then pass the rest to the query.
+    void CullDrawablesInternal(OctreeQuery& query, const Frustum& frustum) const;
     /// Return drawable objects by a ray query, called internally.
     void GetDrawablesInternal(RayOctreeQuery& query) const;
     /// Return drawable objects only for a threaded ray query, called internally.
     void GetDrawablesOnlyInternal(RayOctreeQuery& query, ea::vector<Drawable*>& drawables) const;
 
+    /// Append a drawable object and its culling bounds without updating the drawable count.
+    void PushDrawable(Drawable* drawable)
+    {
+        drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.size();
+        drawables_.push_back(drawable);
+        if ((drawables_.size() & 3u) == 1)
+            cullingBounds_.push_back();
+        UpdateDrawableBounds(drawable);
+    }
+
+    /// Remove a drawable object and its culling bounds by index, replacing it with the last one. Does not update the drawable count.
+    void EraseDrawable(unsigned index)
+    {
+        const unsigned lastIndex = drawables_.size() - 1;
+        if (index != lastIndex)
+        {
+            Drawable* lastDrawable = drawables_[lastIndex];
+            lastDrawable->octantIndex_ = index;
+            drawables_[index] = lastDrawable;
+
+            const OctantBoundsBlock& src = cullingBounds_[lastIndex >> 2u];
+            OctantBoundsBlock& dest = cullingBounds_[index >> 2u];
+            const unsigned srcLane = lastIndex & 3u;
+            const unsigned destLane = index & 3u;
+            dest.centerX_[destLane] = src.centerX_[srcLane];
+            dest.centerY_[destLane] = src.centerY_[srcLane];
+            dest.centerZ_[destLane] = src.centerZ_[srcLane];
+            dest.edgeX_[destLane] = src.edgeX_[srcLane];
+            dest.edgeY_[destLane] = src.edgeY_[srcLane];
+            dest.edgeZ_[destLane] = src.edgeZ_[srcLane];
+        }
+
+        drawables_.pop_back();
+        if ((drawables_.size() & 3u) == 0)
+            cullingBounds_.pop_back();
+    }
+
     /// Increase drawable object count recursively.
     void IncDrawableCount()
     {
@@ -143,6 +202,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// Culling bounds of drawable objects, four drawables per block in the same order as drawable objects.
+    ea::vector<OctantBoundsBlock> cullingBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -56,6 +56,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Return frustum outside of which no drawable can pass the query, or null if none. The octree uses it to cull drawables in batches and calls TestDrawables() with inside flag for the remaining ones.
+    virtual const Frustum* GetCullingFrustum() const { return nullptr; }
 
     /// Result vector reference.
     ea::vector<Drawable*>& result_;
@@ -148,6 +150,8 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Return frustum for batched culling of drawables.
+    const Frustum* GetCullingFrustum() const override { return &frustum_; }
 
     /// Frustum.
     Frustum frustum_;
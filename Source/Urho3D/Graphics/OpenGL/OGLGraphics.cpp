@@ -27,6 +27,7 @@
 #include "../../Core/ProcessUtils.h"
 #include "../../Core/Profiler.h"
 #include "../../Graphics/ConstantBuffer.h"
+#include "../../Graphics/DrawCommandList.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -253,6 +254,11 @@ static unsigned glesDepthStencilFormat = GL_DEPTH_COMPONENT16;
 static unsigned glesReadableDepthFormat = GL_DEPTH_COMPONENT;
 #endif
 
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+/// Timeout in nanoseconds of a single wait for a fence.
+static const GLuint64 FENCE_WAIT_TIMEOUT = 1000000000;
+#endif
+
 static ea::string extensions;
 
 bool CheckExtension(const ea::string& name)
@@ -654,6 +660,47 @@ void Graphics::EndFrame()
     }
 }
 
+void Graphics::ExecuteCommandList(const DrawCommandList& commandList)
+{
+    commandList.Execute(*this);
+
+    // The parameters set by the list are not tracked, so make sure they are set again by later draws
+    ClearParameterSources();
+}
+
+void* Graphics::InsertFence()
+{
+    // Sync objects require OpenGL 3 or OpenGL ES 3, and are not available on WebGL
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+    if (gl3Support)
+        return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+    return nullptr;
+}
+
+bool Graphics::IsFenceSignaled(void* fence, bool wait)
+{
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+    if (fence)
+    {
+        // Flush when waiting, so that the fence is guaranteed to be reached
+        GLenum result = glClientWaitSync((GLsync)fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? FENCE_WAIT_TIMEOUT : 0);
+        while (wait && result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync((GLsync)fence, 0, FENCE_WAIT_TIMEOUT);
+        return result != GL_TIMEOUT_EXPIRED;
+    }
+#endif
+    return true;
+}
+
+void Graphics::ReleaseFence(void* fence)
+{
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+    if (fence)
+        glDeleteSync((GLsync)fence);
+#endif
+}
+
 void Graphics::Clear(ClearTargetFlags flags, const Color& color, float depth, unsigned stencil)
 {
     PrepareDraw();
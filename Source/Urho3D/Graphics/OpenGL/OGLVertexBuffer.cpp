@@ -189,6 +189,13 @@ void* VertexBuffer::Lock(unsigned start, unsigned count, bool discard)
     lockCount_ = count;
     discardLock_ = discard;
 
+    // Map directly only when the caller guarantees the range is unused, otherwise mapping would wait for the GPU
+    if (noOverwriteLock_ && object_.name_ && !shadowData_ && dynamic_ && !graphics_->IsDeviceLost())
+    {
+        if (void* hwData = MapBuffer(start, count, false))
+            return hwData;
+    }
+
     if (shadowData_)
     {
         lockState_ = LOCK_SHADOW;
@@ -208,6 +215,10 @@ void VertexBuffer::Unlock()
 {
     switch (lockState_)
     {
+    case LOCK_HARDWARE:
+        UnmapBuffer();
+        break;
+
     case LOCK_SHADOW:
         SetDataRange(shadowData_.get() + lockStart_ * vertexSize_, lockStart_, lockCount_, discardLock_);
         lockState_ = LOCK_NONE;
@@ -267,13 +278,37 @@ bool VertexBuffer::UpdateToGPU()
 
 void* VertexBuffer::MapBuffer(unsigned start, unsigned count, bool discard)
 {
-    // Never called on OpenGL
-    return nullptr;
+    void* hwData = nullptr;
+
+    // Range mapping requires OpenGL 3 or OpenGL ES 3, and is not available on WebGL. Otherwise fall back to buffer updates
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+    if (object_.name_ && Graphics::GetGL3Support())
+    {
+        const GLbitfield access = GL_MAP_WRITE_BIT | (discard ? GL_MAP_INVALIDATE_BUFFER_BIT :
+            GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+        graphics_->SetVBO(object_.name_);
+        hwData = glMapBufferRange(GL_ARRAY_BUFFER, start * (size_t)vertexSize_, count * (size_t)vertexSize_, access);
+        if (!hwData)
+            URHO3D_LOGERROR("Failed to map vertex buffer");
+        else
+            lockState_ = LOCK_HARDWARE;
+    }
+#endif
+
+    return hwData;
 }
 
 void VertexBuffer::UnmapBuffer()
 {
-    // Never called on OpenGL
+#if (!defined(GL_ES_VERSION_2_0) || defined(GL_ES_VERSION_3_0)) && !defined(__EMSCRIPTEN__)
+    if (object_.name_ && lockState_ == LOCK_HARDWARE)
+    {
+        graphics_->SetVBO(object_.name_);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        lockState_ = LOCK_NONE;
+    }
+#endif
 }
 
 }
@@ -757,6 +757,10 @@ void Renderer::Render()
 
     URHO3D_PROFILE("RenderViews");
 
+    // Instancing data written by the oldest frame in flight can now be overwritten
+    if (instancingBuffer_)
+        instancingBuffer_->BeginFrame();
+
     // If the indirection textures have lost content (OpenGL mode only), restore them now
     if (faceSelectCubeMap_ && faceSelectCubeMap_->IsDataLost())
         SetIndirectionTextureData();
@@ -1407,30 +1411,18 @@ void Renderer::SetCullMode(CullMode mode, Camera* camera)
     graphics_->SetCullMode(mode);
 }
 
-bool Renderer::ResizeInstancingBuffer(unsigned numInstances)
+void* Renderer::LockInstancingBuffer(unsigned numInstances, unsigned& startInstance)
 {
     if (!instancingBuffer_ || !dynamicInstancing_)
-        return false;
-
-    unsigned oldSize = instancingBuffer_->GetVertexCount();
-    if (numInstances <= oldSize)
-        return true;
-
-    unsigned newSize = INSTANCING_BUFFER_DEFAULT_SIZE;
-    while (newSize < numInstances)
-        newSize <<= 1;
+        return nullptr;
 
-    const ea::vector<VertexElement> instancingBufferElements = CreateInstancingBufferElements(numExtraInstancingBufferElements_);
-    if (!instancingBuffer_->SetSize(newSize, instancingBufferElements, true))
-    {
-        URHO3D_LOGERROR("Failed to resize instancing buffer to " + ea::to_string(newSize));
-        // If failed, try to restore the old size
-        instancingBuffer_->SetSize(oldSize, instancingBufferElements, true);
-        return false;
-    }
+    return instancingBuffer_->Lock(numInstances, startInstance);
+}
 
-    URHO3D_LOGDEBUG("Resized instancing buffer to " + ea::to_string(newSize));
-    return true;
+void Renderer::UnlockInstancingBuffer()
+{
+    if (instancingBuffer_)
+        instancingBuffer_->Unlock();
 }
 
 void Renderer::OptimizeLightByScissor(Light* light, Camera* camera)
@@ -1955,9 +1947,9 @@ void Renderer::CreateInstancingBuffer()
         return;
     }
 
-    instancingBuffer_ = context_->CreateObject<VertexBuffer>();
+    instancingBuffer_ = MakeShared<RingVertexBuffer>(context_);
     const ea::vector<VertexElement> instancingBufferElements = CreateInstancingBufferElements(numExtraInstancingBufferElements_);
-    if (!instancingBuffer_->SetSize(INSTANCING_BUFFER_DEFAULT_SIZE, instancingBufferElements, true))
+    if (!instancingBuffer_->SetSize(INSTANCING_BUFFER_DEFAULT_SIZE * RING_BUFFER_FRAMES_IN_FLIGHT, instancingBufferElements))
     {
         instancingBuffer_.Reset();
         dynamicInstancing_ = false;
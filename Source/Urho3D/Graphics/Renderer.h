@@ -27,6 +27,7 @@
 #include "../Core/Mutex.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Drawable.h"
+#include "../Graphics/RingVertexBuffer.h"
 #include "../Graphics/Viewport.h"
 #include "../Math/Color.h"
 
@@ -278,6 +279,12 @@ public:
     /// Set whether to thread occluder rendering. Default false.
     /// @property
     void SetThreadedOcclusion(bool enable);
+    /// Set whether to record scene pass draw commands on worker threads. Default false.
+    /// @property
+    void SetThreadedCommandRecording(bool enable) { threadedCommandRecording_ = enable; }
+    /// Set whether to apply software skinning and vertex morphs of visible models on worker threads. Default false.
+    /// @property
+    void SetThreadedSoftwareAnimation(bool enable) { threadedSoftwareAnimation_ = enable; }
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect).
     /// @property
     void SetMobileShadowBiasMul(float mul);
@@ -403,6 +410,14 @@ public:
     /// @property
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether scene pass draw commands are recorded on worker threads.
+    /// @property
+    bool GetThreadedCommandRecording() const { return threadedCommandRecording_; }
+
+    /// Return whether software skinning and vertex morphs are applied on worker threads.
+    /// @property
+    bool GetThreadedSoftwareAnimation() const { return threadedSoftwareAnimation_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     /// @property
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
@@ -424,6 +439,9 @@ public:
     /// Return number of bones used for software skinning.
     unsigned GetNumSoftwareSkinningBones() const { return numSoftwareSkinningBones_; }
 
+    /// Return frame number on which all shaders were last released.
+    unsigned GetShadersChangedFrameNumber() const { return shadersChangedFrameNumber_; }
+
     /// Return number of views rendered.
     /// @property
     unsigned GetNumViews() const { return views_.size(); }
@@ -472,7 +490,7 @@ public:
     TextureCube* GetIndirectionCubeMap() const { return indirectionCubeMap_; }
 
     /// Return the instancing vertex buffer.
-    VertexBuffer* GetInstancingBuffer() const { return dynamicInstancing_ ? instancingBuffer_.Get() : nullptr; }
+    VertexBuffer* GetInstancingBuffer() const { return dynamicInstancing_ && instancingBuffer_ ? instancingBuffer_->GetVertexBuffer() : nullptr; }
 
     /// Return the frame update parameters.
     const FrameInfo& GetFrameInfo() const { return frame_; }
@@ -514,8 +532,10 @@ public:
         (Batch& batch, Camera* camera, const ea::string& vsName, const ea::string& psName, const ea::string& vsDefines, const ea::string& psDefines);
     /// Set cull mode while taking possible projection flipping into account.
     void SetCullMode(CullMode mode, Camera* camera);
-    /// Ensure sufficient size of the instancing vertex buffer. Return true if successful.
-    bool ResizeInstancingBuffer(unsigned numInstances);
+    /// Allocate a region of the instancing vertex buffer for the current frame and lock it. Return data pointer and first instance of the region if successful.
+    void* LockInstancingBuffer(unsigned numInstances, unsigned& startInstance);
+    /// Unlock the instancing vertex buffer region.
+    void UnlockInstancingBuffer();
     /// Optimize a light by scissor rectangle.
     void OptimizeLightByScissor(Light* light, Camera* camera);
     /// Optimize a light by marking it to the stencil buffer and setting a stencil test.
@@ -580,8 +600,8 @@ private:
     SharedPtr<Geometry> spotLightGeometry_;
     /// Point light volume geometry.
     SharedPtr<Geometry> pointLightGeometry_;
-    /// Instance stream vertex buffer.
-    SharedPtr<VertexBuffer> instancingBuffer_;
+    /// Instance stream vertex buffer, allocated as a ring across frames.
+    SharedPtr<RingVertexBuffer> instancingBuffer_;
     /// Default material.
     SharedPtr<Material> defaultMaterial_;
     /// Default range attenuation texture.
@@ -698,6 +718,10 @@ private:
     int numExtraInstancingBufferElements_{};
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_{};
+    /// Threaded draw command recording flag.
+    bool threadedCommandRecording_{};
+    /// Threaded software skinning and morphing flag.
+    bool threadedSoftwareAnimation_{};
     /// Shaders need reloading flag.
     bool shadersDirty_{true};
     /// Initialized flag.
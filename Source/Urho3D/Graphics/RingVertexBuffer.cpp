@@ -0,0 +1,197 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/GraphicsEvents.h"
+#include "../Graphics/RingVertexBuffer.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/Log.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+RingVertexBuffer::RingVertexBuffer(Context* context) :
+    Object(context),
+    graphics_(context->GetSubsystem<Graphics>()),
+    vertexBuffer_(context->CreateObject<VertexBuffer>())
+{
+    SubscribeToEvent(E_DEVICELOST, URHO3D_HANDLER(RingVertexBuffer, HandleDeviceLost));
+}
+
+RingVertexBuffer::~RingVertexBuffer()
+{
+    ReleaseFences();
+}
+
+bool RingVertexBuffer::SetSize(unsigned vertexCount, const ea::vector<VertexElement>& elements)
+{
+    ReleaseFences();
+
+    elements_ = elements;
+    head_ = 0;
+    usedVertices_ = 0;
+    numFramesInFlight_ = 0;
+    for (unsigned& frameVertices : frameVertices_)
+        frameVertices = 0;
+
+    return vertexBuffer_->SetSize(vertexCount, elements_, true);
+}
+
+void RingVertexBuffer::BeginFrame()
+{
+    // The commands of the ending frame are the last ones to read its regions
+    if (frameVertices_[frameIndex_] && graphics_)
+        frameFences_[frameIndex_] = graphics_->InsertFence();
+
+    frameIndex_ = (frameIndex_ + 1) % RING_BUFFER_FRAMES_IN_FLIGHT;
+    ++numFramesInFlight_;
+
+    // Free the regions of the frames the GPU has finished, oldest first
+    while (numFramesInFlight_ && RetireOldestFrame(false))
+    {
+    }
+
+    // If the oldest frame still holds the slot of the new frame, wait for the GPU to finish it
+    if (numFramesInFlight_ == RING_BUFFER_FRAMES_IN_FLIGHT)
+    {
+        URHO3D_PROFILE("WaitRingVertexBuffer");
+        RetireOldestFrame(true);
+    }
+}
+
+void* RingVertexBuffer::Lock(unsigned count, unsigned& start)
+{
+    if (!count)
+        return nullptr;
+
+    unsigned size = vertexBuffer_->GetVertexCount();
+
+    // Regions are contiguous, so skip the end of the buffer if the region does not fit there
+    unsigned skip = head_ + count > size ? size - head_ : 0;
+
+    // Free the regions of frames the GPU has finished meanwhile before growing the buffer
+    while (usedVertices_ + skip + count > size && numFramesInFlight_ && RetireOldestFrame(false))
+    {
+    }
+
+    if (usedVertices_ + skip + count > size)
+    {
+        if (!Grow(count))
+            return nullptr;
+
+        size = vertexBuffer_->GetVertexCount();
+        skip = 0;
+    }
+
+    if (skip)
+        head_ = 0;
+
+    start = head_;
+    head_ = (head_ + count) % size;
+    usedVertices_ += skip + count;
+    frameVertices_[frameIndex_] += skip + count;
+
+    return vertexBuffer_->LockNoOverwrite(start, count);
+}
+
+void RingVertexBuffer::Unlock()
+{
+    vertexBuffer_->Unlock();
+}
+
+unsigned RingVertexBuffer::GetVertexCount() const
+{
+    return vertexBuffer_->GetVertexCount();
+}
+
+bool RingVertexBuffer::Grow(unsigned count)
+{
+    const unsigned oldSize = vertexBuffer_->GetVertexCount();
+    unsigned newSize = Max(oldSize * 2, 1u);
+    while (newSize < count * RING_BUFFER_FRAMES_IN_FLIGHT)
+        newSize <<= 1u;
+
+    // Recreating the buffer orphans the old one, which the GPU may still be reading, so all regions become free
+    if (!SetSize(newSize, elements_))
+    {
+        URHO3D_LOGERROR("Failed to resize ring vertex buffer to " + ea::to_string(newSize));
+        // If failed, try to restore the old size
+        SetSize(oldSize, elements_);
+        return false;
+    }
+
+    URHO3D_LOGDEBUG("Resized ring vertex buffer to " + ea::to_string(newSize));
+    return true;
+}
+
+bool RingVertexBuffer::RetireOldestFrame(bool wait)
+{
+    const unsigned oldest = (frameIndex_ + RING_BUFFER_FRAMES_IN_FLIGHT - numFramesInFlight_) % RING_BUFFER_FRAMES_IN_FLIGHT;
+
+    void*& fence = frameFences_[oldest];
+    if (fence)
+    {
+        if (!graphics_ || !graphics_->IsFenceSignaled(fence, wait))
+            return false;
+
+        graphics_->ReleaseFence(fence);
+        fence = nullptr;
+    }
+    // Without a fence the frame can only be assumed finished when its slot is needed
+    else if (frameVertices_[oldest] && !wait)
+        return false;
+
+    usedVertices_ -= frameVertices_[oldest];
+    frameVertices_[oldest] = 0;
+    --numFramesInFlight_;
+    return true;
+}
+
+void RingVertexBuffer::ReleaseFences()
+{
+    for (void*& fence : frameFences_)
+    {
+        if (fence && graphics_)
+            graphics_->ReleaseFence(fence);
+        fence = nullptr;
+    }
+}
+
+void RingVertexBuffer::HandleDeviceLost(StringHash eventType, VariantMap& eventData)
+{
+    // The buffer contents are lost along with the device, so all regions become free
+    ReleaseFences();
+    head_ = 0;
+    usedVertices_ = 0;
+    numFramesInFlight_ = 0;
+    for (unsigned& frameVertices : frameVertices_)
+        frameVertices = 0;
+}
+
+}
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Graphics/GraphicsDefs.h"
+
+namespace Urho3D
+{
+
+class Graphics;
+class VertexBuffer;
+
+/// Maximum number of frames the ring buffer keeps regions for. When the GPU lags further behind, the CPU waits for it.
+static const unsigned RING_BUFFER_FRAMES_IN_FLIGHT = 4;
+
+/// Dynamic vertex buffer suballocated as a ring for data that is rewritten every frame, such as instancing transforms.
+/// Each allocation takes a fresh region of the buffer, which is locked without synchronizing with the GPU. A fence is
+/// inserted after each frame and its regions are reused only once the GPU has passed the fence, so the driver neither
+/// stalls nor renames the buffer. Without fence support, regions are reused after a fixed number of frames.
+class URHO3D_API RingVertexBuffer : public Object
+{
+    URHO3D_OBJECT(RingVertexBuffer, Object);
+
+public:
+    /// Construct.
+    explicit RingVertexBuffer(Context* context);
+    /// Destruct.
+    ~RingVertexBuffer() override;
+
+    /// Set size in vertices and vertex elements. Previous allocations are lost. Return true if successful.
+    bool SetSize(unsigned vertexCount, const ea::vector<VertexElement>& elements);
+    /// Begin a new frame. Fences the regions of the previous frame and frees the regions of the frames the GPU has finished.
+    void BeginFrame();
+    /// Allocate a region for the current frame and lock it for write-only editing. Return data pointer and first vertex of the region if successful.
+    /// If the region does not fit, the buffer grows and earlier allocations of the current frame are lost.
+    void* Lock(unsigned count, unsigned& start);
+    /// Unlock the region.
+    void Unlock();
+
+    /// Return the vertex buffer.
+    VertexBuffer* GetVertexBuffer() const { return vertexBuffer_; }
+    /// Return size in vertices.
+    unsigned GetVertexCount() const;
+    /// Return number of vertices used by the frames in flight.
+    unsigned GetUsedVertexCount() const { return usedVertices_; }
+
+private:
+    /// Grow the buffer to hold the requested amount of vertices on every frame in flight. Return true if successful.
+    bool Grow(unsigned count);
+    /// Free the regions of the oldest frame in flight if the GPU has finished it, optionally waiting for the GPU. Return true if freed.
+    bool RetireOldestFrame(bool wait);
+    /// Release the fences of all frames in flight.
+    void ReleaseFences();
+    /// Handle device loss.
+    void HandleDeviceLost(StringHash eventType, VariantMap& eventData);
+
+    /// Graphics subsystem.
+    WeakPtr<Graphics> graphics_;
+    /// Vertex buffer.
+    SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Vertex elements.
+    ea::vector<VertexElement> elements_;
+    /// Vertices allocated by each frame in flight, including skipped space at the end of the buffer when wrapping.
+    unsigned frameVertices_[RING_BUFFER_FRAMES_IN_FLIGHT]{};
+    /// Fence inserted after each frame in flight, or null if none.
+    void* frameFences_[RING_BUFFER_FRAMES_IN_FLIGHT]{};
+    /// Index of the current frame in frame vertex counts.
+    unsigned frameIndex_{};
+    /// Number of previous frames whose regions have not been freed.
+    unsigned numFramesInFlight_{};
+    /// Next free vertex.
+    unsigned head_{};
+    /// Number of vertices used by the frames in flight.
+    unsigned usedVertices_{};
+};
+
+}
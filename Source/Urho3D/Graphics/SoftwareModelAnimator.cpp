@@ -39,6 +39,51 @@ namespace Urho3D
 namespace
 {
 
+#ifdef URHO3D_SSE
+/// Skinning matrix blended from bone matrices, stored as three SSE rows.
+struct BlendedMatrix
+{
+    /// Blend bone matrices by weights.
+    BlendedMatrix(const Matrix3x4* boneMatrices, const unsigned char* indices, const float* weights, unsigned numBones)
+    {
+        const float* matrix = &boneMatrices[indices[0]].m00_;
+        __m128 weight = _mm_set1_ps(weights[0]);
+        row0_ = _mm_mul_ps(_mm_loadu_ps(matrix), weight);
+        row1_ = _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight);
+        row2_ = _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight);
+
+        for (unsigned boneIndex = 1; boneIndex < numBones; ++boneIndex)
+        {
+            matrix = &boneMatrices[indices[boneIndex]].m00_;
+            weight = _mm_set1_ps(weights[boneIndex]);
+            row0_ = _mm_add_ps(row0_, _mm_mul_ps(_mm_loadu_ps(matrix), weight));
+            row1_ = _mm_add_ps(row1_, _mm_mul_ps(_mm_loadu_ps(matrix + 4), weight));
+            row2_ = _mm_add_ps(row2_, _mm_mul_ps(_mm_loadu_ps(matrix + 8), weight));
+        }
+    }
+
+    /// Transform a vector in place. W is 1 for positions and 0 for directions.
+    void Transform(float* data, float w) const
+    {
+        const __m128 vec = _mm_setr_ps(data[0], data[1], data[2], w);
+        __m128 x = _mm_mul_ps(row0_, vec);
+        __m128 y = _mm_mul_ps(row1_, vec);
+        __m128 z = _mm_mul_ps(row2_, vec);
+        __m128 unused = _mm_setzero_ps();
+        _MM_TRANSPOSE4_PS(x, y, z, unused);
+        const __m128 result = _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, unused));
+
+        // Store only XYZ, as the vertex data continues after the element
+        _mm_storel_pi(reinterpret_cast<__m64*>(data), result);
+        _mm_store_ss(data + 2, _mm_movehl_ps(result, result));
+    }
+
+    /// Matrix rows.
+    __m128 row0_;
+    __m128 row1_;
+    __m128 row2_;
+};
+#else
 Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
 {
     return {
@@ -47,6 +92,7 @@ Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
         m.m20_ * v.x_ + m.m21_ * v.y_ + m.m22_ * v.z_
     };
 }
+#endif
 
 }
 
@@ -146,9 +192,21 @@ void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer
     const float* weightsData = animationData.blendWeights_.data();
 
     const unsigned numVertices = clonedBuffer->GetVertexCount();
+#ifndef URHO3D_SSE
     Matrix3x4 matrix;
+#endif
     for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
     {
+#ifdef URHO3D_SSE
+        // Blend the bone matrices and transform the vertex with SSE, one matrix row per lane
+        const BlendedMatrix matrix(worldTransforms.data(), indicesData, weightsData, numBones_);
+
+        matrix.Transform(reinterpret_cast<float*>(positionsData), 1.0f);
+        if (SkinNormals)
+            matrix.Transform(reinterpret_cast<float*>(normalsData), 0.0f);
+        if (SkinTangents)
+            matrix.Transform(reinterpret_cast<float*>(tangentsData), 0.0f);
+#else
         matrix = worldTransforms[indicesData[0]] * weightsData[0];
         for (unsigned boneIndex = 1; boneIndex < numBones_; ++boneIndex)
             matrix = matrix + worldTransforms[indicesData[boneIndex]] * weightsData[boneIndex];
@@ -167,6 +225,7 @@ void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer
             Vector3& tangent = *reinterpret_cast<Vector3*>(tangentsData);
             tangent = TransformNormal(matrix, tangent);
         }
+#endif
 
         // Advance
         indicesData += numBones_;
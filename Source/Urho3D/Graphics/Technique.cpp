@@ -139,6 +139,7 @@ void Pass::ReleaseShaders()
     pixelShaders_.clear();
     extraVertexShaders_.clear();
     extraPixelShaders_.clear();
+    ++shadersRevision_;
 }
 
 void Pass::MarkShadersLoaded(unsigned frameNumber)
@@ -152,6 +152,8 @@ public:
 
     /// Return last shaders loaded frame number.
     unsigned GetShadersLoadedFrameNumber() const { return shadersLoadedFrameNumber_; }
+    /// Return shaders revision. Changes whenever the shaders are released.
+    unsigned GetShadersRevision() const { return shadersRevision_; }
 
     /// Return depth write mode.
     /// @property
@@ -217,6 +219,8 @@ private:
     PassLightingMode lightingMode_;
     /// Last shaders loaded frame number.
     unsigned shadersLoadedFrameNumber_;
+    /// Shaders revision.
+    unsigned shadersRevision_{};
     /// Depth write mode.
     bool depthWrite_;
     /// Alpha-to-coverage mode.
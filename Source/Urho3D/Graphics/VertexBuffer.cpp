@@ -146,6 +146,14 @@ void VertexBuffer::SetShadowed(bool enable)
     }
 }
 
+void* VertexBuffer::LockNoOverwrite(unsigned start, unsigned count)
+{
+    noOverwriteLock_ = true;
+    void* data = Lock(start, count, false);
+    noOverwriteLock_ = false;
+    return data;
+}
+
 bool VertexBuffer::SetSize(unsigned vertexCount, unsigned elementMask, bool dynamic)
 {
     return SetSize(vertexCount, GetElements(elementMask), dynamic);
@@ -68,6 +68,8 @@ public:
     bool SetDataRange(const void* data, unsigned start, unsigned count, bool discard = false);
     /// Lock the buffer for write-only editing. Return data pointer if successful. Optionally discard data outside the range.
     void* Lock(unsigned start, unsigned count, bool discard = false);
+    /// Lock a range of a dynamic buffer for write-only editing without synchronizing with the GPU. The caller must ensure that the GPU no longer uses the range. Falls back to a regular lock if the hardware buffer can not be mapped.
+    void* LockNoOverwrite(unsigned start, unsigned count);
     /// Unlock the buffer and apply changes to the GPU buffer.
     void Unlock();
 
@@ -168,9 +170,9 @@ private:
     bool Create();
     /// Update the shadow data to the GPU buffer.
     bool UpdateToGPU();
-    /// Map the GPU buffer into CPU memory. Not used on OpenGL.
+    /// Map the GPU buffer into CPU memory. Used on OpenGL only for no-overwrite locks.
     void* MapBuffer(unsigned start, unsigned count, bool discard);
-    /// Unmap the GPU buffer. Not used on OpenGL.
+    /// Unmap the GPU buffer.
     void UnmapBuffer();
 
     /// Shadow data.
@@ -199,6 +201,8 @@ private:
     bool shadowed_{};
     /// Discard lock flag. Used by OpenGL only.
     bool discardLock_{};
+    /// No-overwrite lock flag.
+    bool noOverwriteLock_{};
 };
 
 }
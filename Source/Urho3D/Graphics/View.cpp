@@ -61,21 +61,128 @@
 namespace Urho3D
 {
 
+/// Minimum number of drawables processed by one parallel work chunk.
+static const unsigned DRAWABLES_PER_WORK_ITEM = 64;
+/// Maximum number of batches and batch groups recorded into one command list.
+static const unsigned DRAW_ITEMS_PER_COMMAND_LIST = 256;
+
+/// Part of a scene pass batch queue to be recorded into a command list.
+struct ScenePassRecordJob
+{
+    /// Batch queue.
+    const BatchQueue* queue_;
+    /// Whether to mark lit pixels to stencil.
+    bool markToStencil_;
+    /// First draw item.
+    unsigned start_;
+    /// End draw item.
+    unsigned end_;
+};
+
+/// Return whether a batch can be recorded on a worker thread. Calculate lazily updated zone transforms if so.
+static bool PrepareBatchRecording(const Batch& batch)
+{
+    // Per-pixel lit batches need light scissor rectangles, which are cached in Renderer
+    if (batch.lightQueue_ && batch.lightQueue_->light_)
+        return false;
+
+    if (batch.zone_)
+        batch.zone_->GetInverseWorldTransform();
+
+    return true;
+}
+
+/// Return whether a batch queue can be recorded on worker threads.
+static bool PrepareBatchQueueRecording(const BatchQueue& queue)
+{
+    for (const BatchGroup* group : queue.sortedBatchGroups_)
+    {
+        if (!PrepareBatchRecording(*group))
+            return false;
+    }
+
+    for (const Batch* batch : queue.sortedBatches_)
+    {
+        if (!PrepareBatchRecording(*batch))
+            return false;
+    }
+
+    return true;
+}
+
+/// Set global (per-frame) shader parameters.
+template <class T> static void WriteGlobalShaderParameters(T& target, float timeStep, Scene* scene)
+{
+    target.SetShaderParameter(VSP_DELTATIME, timeStep);
+    target.SetShaderParameter(PSP_DELTATIME, timeStep);
+
+    if (scene)
+    {
+        float elapsedTime = scene->GetElapsedTime();
+        target.SetShaderParameter(VSP_ELAPSEDTIME, elapsedTime);
+        target.SetShaderParameter(PSP_ELAPSEDTIME, elapsedTime);
+    }
+}
+
+/// Return whether a weak reference still points to the given object. An expired reference never matches, not even null.
+template <class T> static bool IsSameObject(const WeakPtr<T>& reference, T* object)
+{
+    return reference.Null() ? object == nullptr : reference.Get() == object && object != nullptr;
+}
+
 /// Update ambient for Drawable.
-static void UpdateBatchAmbient(Batch& destBatch, GlobalIllumination* gi, Drawable* drawable)
+static void UpdateBatchAmbient(Batch& destBatch, GlobalIllumination* gi, Drawable* drawable, RetainedBaseBatch* retained = nullptr)
 {
     if (gi && !destBatch.lightmapScaleOffset_)
     {
+        const Vector3 samplePosition = drawable->GetWorldBoundingBox().Center();
+
+        // Reuse ambient sampled on previous frames if the drawable has not moved
+        if (retained && retained->ambientValid_ && IsSameObject(retained->globalIllumination_, gi) &&
+            retained->globalIlluminationRevision_ == gi->GetRevision() && retained->ambientPosition_ == samplePosition)
+        {
+            destBatch.shaderParameters_ = retained->batch_.shaderParameters_;
+            return;
+        }
+
         unsigned& hint = drawable->GetMutableLightProbeTetrahedronHint();
-        const Vector3& samplePosition = drawable->GetWorldBoundingBox().Center();
 #if URHO3D_SPHERICAL_HARMONICS
         destBatch.shaderParameters_.ambient_ = gi->SampleAmbientSH(samplePosition, hint);
 #else
         destBatch.shaderParameters_.ambient_ = gi->SampleAverageAmbient(samplePosition, hint);
 #endif
+
+        if (retained)
+        {
+            retained->ambientValid_ = true;
+            retained->globalIllumination_ = gi;
+            retained->globalIlluminationRevision_ = gi->GetRevision();
+            retained->ambientPosition_ = samplePosition;
+            retained->batch_.shaderParameters_ = destBatch.shaderParameters_;
+        }
     }
 }
 
+/// Return whether a retained base batch was prepared from the same state.
+static bool IsRetainedBatchValid(const RetainedBaseBatch& retained, const SourceBatch& srcBatch, Pass* pass, Zone* zone,
+    unsigned char lightMask, bool allowInstancing, const BatchQueue& queue, Renderer* renderer)
+{
+    return retained.valid_ &&
+        IsSameObject(retained.sourceMaterial_, srcBatch.material_.Get()) &&
+        retained.sourceGeometryType_ == srcBatch.geometryType_ &&
+        retained.allowInstancing_ == allowInstancing &&
+        IsSameObject(retained.sourceGeometry_, srcBatch.geometry_) &&
+        IsSameObject(retained.pass_, pass) &&
+        IsSameObject(retained.zone_, zone) &&
+        retained.batch_.lightMask_ == lightMask &&
+        retained.heightFog_ == (zone && zone->GetHeightFog()) &&
+        retained.dynamicInstancing_ == renderer->GetDynamicInstancing() &&
+        retained.shadersChangedFrameNumber_ == renderer->GetShadersChangedFrameNumber() &&
+        retained.shadersRevision_ == pass->GetShadersRevision() &&
+        retained.vsExtraDefinesHash_ == (queue.hasExtraDefines_ ? queue.vsExtraDefinesHash_ : StringHash::ZERO) &&
+        retained.psExtraDefinesHash_ == (queue.hasExtraDefines_ ? queue.psExtraDefinesHash_ : StringHash::ZERO);
+}
+
 /// %Frustum octree query for shadowcasters.
 class ShadowCasterOctreeQuery : public FrustumOctreeQuery
 {
@@ -178,12 +285,9 @@ public:
     OcclusionBuffer* buffer_;
 };
 
-void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
+void CheckVisibilityWork(View* view, Drawable** start, Drawable** end, unsigned threadIndex)
 {
     URHO3D_PROFILE("CheckVisibilityWork");
-    auto* view = reinterpret_cast<View*>(item->aux_);
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
     OcclusionBuffer* buffer = view->occlusionBuffer_;
     const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
     Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
@@ -192,11 +296,30 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     bool cameraZoneOverride = view->cameraZoneOverride_;
     PerThreadSceneResult& result = view->sceneResults_[threadIndex];
 
+    BoundingBox occludeeBoxes[DRAWABLES_PER_WORK_ITEM];
+    bool occludeeVisible[DRAWABLES_PER_WORK_ITEM];
+    Drawable** batchEnd = start;
+    unsigned occludeeIndex = 0;
+
     while (start != end)
     {
+        // Test occludees against the occlusion buffer in batches
+        if (buffer && start == batchEnd)
+        {
+            batchEnd = start + Min(static_cast<unsigned>(end - start), DRAWABLES_PER_WORK_ITEM);
+            unsigned numOccludees = 0;
+            for (Drawable** i = start; i != batchEnd; ++i)
+            {
+                if ((*i)->IsOccludee())
+                    occludeeBoxes[numOccludees++] = (*i)->GetWorldBoundingBox();
+            }
+            buffer->IsVisible(occludeeBoxes, numOccludees, occludeeVisible);
+            occludeeIndex = 0;
+        }
+
         Drawable* drawable = *start++;
 
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
+        if (!buffer || !drawable->IsOccludee() || occludeeVisible[occludeeIndex++])
         {
             drawable->UpdateBatches(view->frame_);
             // If draw distance non-zero, update and check it
@@ -248,21 +371,9 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
-void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("ProcessLightWork");
-    auto* view = reinterpret_cast<View*>(item->aux_);
-    auto* query = reinterpret_cast<LightQueryResult*>(item->start_);
-
-    view->ProcessLight(*query, threadIndex);
-}
-
-void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
+void UpdateDrawableGeometriesWork(const FrameInfo& frame, Drawable** start, Drawable** end)
 {
     URHO3D_PROFILE("UpdateDrawableGeometriesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
 
     while (start != end)
     {
@@ -646,6 +757,9 @@ void View::Render()
     }
 #endif
 
+    // Record scene passes on worker threads before executing the render path
+    RecordScenePasses();
+
     // Render
     ExecuteRenderPathCommands();
 
@@ -712,39 +826,22 @@ View* View::GetSourceView() const
     return sourceView_;
 }
 
-void View::SetGlobalShaderParameters()
+/// Set camera-specific shader parameters.
+template <class T> static void WriteCameraShaderParameters(T& target, Camera* camera)
 {
-    graphics_->SetShaderParameter(VSP_DELTATIME, frame_.timeStep_);
-    graphics_->SetShaderParameter(PSP_DELTATIME, frame_.timeStep_);
-
-    if (scene_)
-    {
-        float elapsedTime = scene_->GetElapsedTime();
-        graphics_->SetShaderParameter(VSP_ELAPSEDTIME, elapsedTime);
-        graphics_->SetShaderParameter(PSP_ELAPSEDTIME, elapsedTime);
-    }
-
-    SendViewEvent(E_VIEWGLOBALSHADERPARAMETERS);
-}
-
-void View::SetCameraShaderParameters(Camera* camera)
-{
-    if (!camera)
-        return;
-
     Matrix3x4 cameraEffectiveTransform = camera->GetEffectiveWorldTransform();
 
-    graphics_->SetShaderParameter(VSP_CAMERAPOS, cameraEffectiveTransform.Translation());
-    graphics_->SetShaderParameter(VSP_VIEWINV, cameraEffectiveTransform);
-    graphics_->SetShaderParameter(VSP_VIEW, camera->GetView());
-    graphics_->SetShaderParameter(PSP_CAMERAPOS, cameraEffectiveTransform.Translation());
+    target.SetShaderParameter(VSP_CAMERAPOS, cameraEffectiveTransform.Translation());
+    target.SetShaderParameter(VSP_VIEWINV, cameraEffectiveTransform);
+    target.SetShaderParameter(VSP_VIEW, camera->GetView());
+    target.SetShaderParameter(PSP_CAMERAPOS, cameraEffectiveTransform.Translation());
 
     float nearClip = camera->GetNearClip();
     float farClip = camera->GetFarClip();
-    graphics_->SetShaderParameter(VSP_NEARCLIP, nearClip);
-    graphics_->SetShaderParameter(VSP_FARCLIP, farClip);
-    graphics_->SetShaderParameter(PSP_NEARCLIP, nearClip);
-    graphics_->SetShaderParameter(PSP_FARCLIP, farClip);
+    target.SetShaderParameter(VSP_NEARCLIP, nearClip);
+    target.SetShaderParameter(VSP_FARCLIP, farClip);
+    target.SetShaderParameter(PSP_NEARCLIP, nearClip);
+    target.SetShaderParameter(PSP_FARCLIP, farClip);
 
     Vector4 depthMode = Vector4::ZERO;
     if (camera->IsOrthographic())
@@ -760,40 +857,31 @@ void View::SetCameraShaderParameters(Camera* camera)
     else
         depthMode.w_ = 1.0f / camera->GetFarClip();
 
-    graphics_->SetShaderParameter(VSP_DEPTHMODE, depthMode);
+    target.SetShaderParameter(VSP_DEPTHMODE, depthMode);
 
     Vector4 depthReconstruct
         (farClip / (farClip - nearClip), -nearClip / (farClip - nearClip), camera->IsOrthographic() ? 1.0f : 0.0f,
             camera->IsOrthographic() ? 0.0f : 1.0f);
-    graphics_->SetShaderParameter(PSP_DEPTHRECONSTRUCT, depthReconstruct);
+    target.SetShaderParameter(PSP_DEPTHRECONSTRUCT, depthReconstruct);
 
     Vector3 nearVector, farVector;
     camera->GetFrustumSize(nearVector, farVector);
-    graphics_->SetShaderParameter(VSP_FRUSTUMSIZE, farVector);
+    target.SetShaderParameter(VSP_FRUSTUMSIZE, farVector);
 
     Matrix4 projection = camera->GetGPUProjection();
 #ifdef URHO3D_OPENGL
     // Add constant depth bias manually to the projection matrix due to glPolygonOffset() inconsistency
-    float constantBias = 2.0f * graphics_->GetDepthConstantBias();
+    float constantBias = 2.0f * target.GetDepthConstantBias();
     projection.m22_ += projection.m32_ * constantBias;
     projection.m23_ += projection.m33_ * constantBias;
 #endif
 
-    graphics_->SetShaderParameter(VSP_VIEWPROJ, projection * camera->GetView());
+    target.SetShaderParameter(VSP_VIEWPROJ, projection * camera->GetView());
 
-    // If in a scene pass and the command defines shader parameters, set them now
-    if (passCommand_)
-        SetCommandShaderParameters(*passCommand_);
 }
 
-void View::SetCommandShaderParameters(const RenderPathCommand& command)
-{
-    const ea::unordered_map<StringHash, Variant>& parameters = command.shaderParameters_;
-    for (auto k = parameters.begin(); k != parameters.end(); ++k)
-        graphics_->SetShaderParameter(k->first, k->second);
-}
-
-void View::SetGBufferShaderParameters(const IntVector2& texSize, const IntRect& viewRect)
+/// Set G-buffer offset and inverse size shader parameters.
+template <class T> static void WriteGBufferShaderParameters(T& target, const IntVector2& texSize, const IntRect& viewRect)
 {
     auto texWidth = (float)texSize.x_;
     auto texHeight = (float)texSize.y_;
@@ -808,11 +896,60 @@ void View::SetGBufferShaderParameters(const IntVector2& texSize, const IntRect&
     Vector4 bufferUVOffset((pixelUVOffset.x_ + (float)viewRect.left_) / texWidth + widthRange,
         (pixelUVOffset.y_ + (float)viewRect.top_) / texHeight + heightRange, widthRange, heightRange);
 #endif
-    graphics_->SetShaderParameter(VSP_GBUFFEROFFSETS, bufferUVOffset);
+    target.SetShaderParameter(VSP_GBUFFEROFFSETS, bufferUVOffset);
 
     float invSizeX = 1.0f / texWidth;
     float invSizeY = 1.0f / texHeight;
-    graphics_->SetShaderParameter(PSP_GBUFFERINVSIZE, Vector2(invSizeX, invSizeY));
+    target.SetShaderParameter(PSP_GBUFFERINVSIZE, Vector2(invSizeX, invSizeY));
+}
+
+void View::SetGlobalShaderParameters()
+{
+    WriteGlobalShaderParameters(*graphics_, frame_.timeStep_, scene_);
+
+    SendViewEvent(E_VIEWGLOBALSHADERPARAMETERS);
+}
+
+void View::SetGlobalShaderParameters(DrawCommandList& commandList)
+{
+    WriteGlobalShaderParameters(commandList, frame_.timeStep_, scene_);
+}
+
+void View::SetCameraShaderParameters(Camera* camera)
+{
+    if (!camera)
+        return;
+
+    WriteCameraShaderParameters(*graphics_, camera);
+
+    // If in a scene pass and the command defines shader parameters, set them now
+    if (passCommand_)
+        SetCommandShaderParameters(*passCommand_);
+}
+
+void View::SetCameraShaderParameters(DrawCommandList& commandList, Camera* camera)
+{
+    if (!camera)
+        return;
+
+    WriteCameraShaderParameters(commandList, camera);
+}
+
+void View::SetCommandShaderParameters(const RenderPathCommand& command)
+{
+    const ea::unordered_map<StringHash, Variant>& parameters = command.shaderParameters_;
+    for (auto k = parameters.begin(); k != parameters.end(); ++k)
+        graphics_->SetShaderParameter(k->first, k->second);
+}
+
+void View::SetGBufferShaderParameters(const IntVector2& texSize, const IntRect& viewRect)
+{
+    WriteGBufferShaderParameters(*graphics_, texSize, viewRect);
+}
+
+void View::SetGBufferShaderParameters(DrawCommandList& commandList, const IntVector2& texSize, const IntRect& viewRect)
+{
+    WriteGBufferShaderParameters(commandList, texSize, viewRect);
 }
 
 void View::GetDrawables()
@@ -920,30 +1057,10 @@ void View::GetDrawables()
             result.maxZ_ = 0.0f;
         }
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = tempDrawables.size() / numWorkItems;
-
-        auto start = tempDrawables.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        queue->ParallelFor(tempDrawables.size(), DRAWABLES_PER_WORK_ITEM, [&](unsigned begin, unsigned end, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = CheckVisibilityWork;
-            item->aux_ = this;
-
-            auto end = tempDrawables.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
+            CheckVisibilityWork(this, tempDrawables.data() + begin, tempDrawables.data() + end, threadIndex);
+        });
     }
 
     // Combine lights, geometries & scene Z range from the threads
@@ -994,6 +1111,7 @@ void View::GetBatches()
 
     nonThreadedGeometries_.clear();
     threadedGeometries_.clear();
+    committedGeometries_.clear();
 
     ProcessLights();
     GetLightBatches();
@@ -1009,21 +1127,17 @@ void View::ProcessLights()
     lightQueryResults_.resize(lights_.size());
 
     for (unsigned i = 0; i < lightQueryResults_.size(); ++i)
-    {
-        SharedPtr<WorkItem> item = queue->GetFreeItem();
-        item->priority_ = M_MAX_UNSIGNED;
-        item->workFunction_ = ProcessLightWork;
-        item->aux_ = this;
-
-        LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
+        lightQueryResults_[i].light_ = lights_[i];
 
-        item->start_ = &query;
-        queue->AddWorkItem(item);
-    }
-
-    // Ensure all lights have been processed before proceeding
-    queue->Complete(M_MAX_UNSIGNED);
+    // Process each light in a separate chunk, as light queries are heavy and vary in cost
+    queue->ParallelFor(lightQueryResults_.size(), 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            URHO3D_PROFILE("ProcessLightWork");
+            ProcessLight(lightQueryResults_[i], threadIndex);
+        }
+    });
 }
 
 void View::GetLightBatches()
@@ -1119,7 +1233,7 @@ void View::GetLightBatches()
                             UpdateGeometryType type = drawable->GetUpdateGeometryType();
                             if (type == UPDATE_MAIN_THREAD)
                                 nonThreadedGeometries_.push_back(drawable);
-                            else if (type == UPDATE_WORKER_THREAD)
+                            else if (type == UPDATE_WORKER_THREAD || type == UPDATE_WORKER_THREAD_COMMIT)
                                 threadedGeometries_.push_back(drawable);
                         }
 
@@ -1222,15 +1336,28 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE("GetBaseBatches");
 
-    for (auto i = geometries_.begin(); i != geometries_.end(); ++i)
+    // Base batches retained on the previous frame are carried over for the drawables that are still visible
+    ea::swap(retainedBaseBatches_, previousRetainedBaseBatches_);
+    ea::swap(retainedDrawables_, previousRetainedDrawables_);
+    retainedBaseBatches_.clear();
+    retainedDrawables_.clear();
+    previousRetainedDrawableIndices_.clear();
+    previousRetainedDrawableIndicesBuilt_ = false;
+
+    for (unsigned i = 0; i < geometries_.size(); ++i)
     {
-        Drawable* drawable = *i;
+        Drawable* drawable = geometries_[i];
         UpdateGeometryType type = drawable->GetUpdateGeometryType();
         if (type == UPDATE_MAIN_THREAD)
             nonThreadedGeometries_.push_back(drawable);
-        else if (type == UPDATE_WORKER_THREAD)
+        else if (type == UPDATE_WORKER_THREAD || type == UPDATE_WORKER_THREAD_COMMIT)
             threadedGeometries_.push_back(drawable);
 
+        const RetainedDrawable* previousDrawable = GetPreviousRetainedDrawable(drawable, i);
+        RetainedDrawable& retainedDrawable = retainedDrawables_.push_back();
+        retainedDrawable.drawable_ = drawable;
+        retainedDrawable.firstBatch_ = retainedBaseBatches_.size();
+
         const ea::vector<SourceBatch>& batches = drawable->GetBatches();
         bool vertexLightsProcessed = false;
 
@@ -1259,12 +1386,9 @@ void View::GetBaseBatches()
                 if (!pass)
                     continue;
 
-                Batch destBatch(srcBatch);
-                destBatch.pass_ = pass;
-                destBatch.zone_ = GetZone(drawable);
-                UpdateBatchAmbient(destBatch, globalIllumination_, drawable);
-                destBatch.isBase_ = true;
-                destBatch.lightMask_ = (unsigned char)GetLightMask(drawable);
+                Zone* zone = GetZone(drawable);
+                auto lightMask = (unsigned char)GetLightMask(drawable);
+                LightBatchQueue* vertexLightQueue = nullptr;
 
                 if (info.vertexLights_)
                 {
@@ -1274,7 +1398,7 @@ void View::GetBaseBatches()
                         // Limit vertex lights. If this is a deferred opaque batch, remove converted per-pixel lights,
                         // as they will be rendered as light volumes in any case, and drawing them also as vertex lights
                         // would result in double lighting
-                        drawable->LimitVertexLights(deferred_ && destBatch.pass_->GetBlendMode() == BLEND_REPLACE);
+                        drawable->LimitVertexLights(deferred_ && pass->GetBlendMode() == BLEND_REPLACE);
                         vertexLightsProcessed = true;
                     }
 
@@ -1292,17 +1416,129 @@ void View::GetBaseBatches()
                             i->second.vertexLights_ = drawableVertexLights;
                         }
 
-                        destBatch.lightQueue_ = &(i->second);
+                        vertexLightQueue = &(i->second);
                     }
                 }
-                else
-                    destBatch.lightQueue_ = nullptr;
 
                 bool allowInstancing = info.allowInstancing_;
-                if (allowInstancing && info.markToStencil_ && destBatch.lightMask_ != (destBatch.zone_->GetLightMask() & 0xffu))
+                if (allowInstancing && info.markToStencil_ && lightMask != (zone->GetLightMask() & 0xffu))
                     allowInstancing = false;
 
-                AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing);
+                // Batches with vertex lights depend on the lights of the frame and are not retained
+                if (vertexLightQueue)
+                {
+                    Batch destBatch(srcBatch);
+                    destBatch.pass_ = pass;
+                    destBatch.zone_ = zone;
+                    destBatch.isBase_ = true;
+                    destBatch.lightMask_ = lightMask;
+                    destBatch.lightQueue_ = vertexLightQueue;
+
+                    UpdateBatchAmbient(destBatch, globalIllumination_, drawable);
+                    AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing, true);
+                    continue;
+                }
+
+                const unsigned retainedIndex = retainedBaseBatches_.size();
+                RetainedBaseBatch& retained = retainedBaseBatches_.push_back();
+                retained.batchIndex_ = j;
+                retained.passIndex_ = info.passIndex_;
+                if (previousDrawable)
+                {
+                    const unsigned end = previousDrawable->firstBatch_ + previousDrawable->numBatches_;
+                    for (unsigned l = previousDrawable->firstBatch_; l < end; ++l)
+                    {
+                        const RetainedBaseBatch& previous = previousRetainedBaseBatches_[l];
+                        if (previous.batchIndex_ == j && previous.passIndex_ == info.passIndex_)
+                        {
+                            retained = previous;
+                            break;
+                        }
+                    }
+                }
+
+                Batch destBatch;
+                if (IsRetainedBatchValid(retained, srcBatch, pass, zone, lightMask, allowInstancing, *info.batchQueue_, renderer_))
+                {
+                    // Reuse the prepared batch, only the per-frame state of the source batch is refreshed
+                    destBatch = retained.batch_;
+                    destBatch.distance_ = srcBatch.distance_;
+                    destBatch.renderOrder_ = srcBatch.material_ ? srcBatch.material_->GetRenderOrder() : DEFAULT_RENDER_ORDER;
+                    destBatch.worldTransform_ = srcBatch.worldTransform_;
+                    destBatch.numWorldTransforms_ = srcBatch.numWorldTransforms_;
+                    destBatch.instancingData_ = srcBatch.instancingData_;
+                    destBatch.lightmapScaleOffset_ = srcBatch.lightmapScaleOffset_;
+                    destBatch.lightmapIndex_ = srcBatch.lightmapIndex_;
+                }
+                else
+                {
+                    destBatch = Batch(srcBatch);
+                    destBatch.pass_ = pass;
+                    destBatch.zone_ = zone;
+                    destBatch.isBase_ = true;
+                    destBatch.lightMask_ = lightMask;
+                    // Resume sorting from the previous positions even if the batch is prepared again
+                    destBatch.sortOrder_[0] = retained.batch_.sortOrder_[0];
+                    destBatch.sortOrder_[1] = retained.batch_.sortOrder_[1];
+
+                    const BatchQueue& queue = *info.batchQueue_;
+                    retained.valid_ = false;
+                    retained.sourceMaterial_ = srcBatch.material_;
+                    retained.sourceGeometry_ = srcBatch.geometry_;
+                    retained.pass_ = pass;
+                    retained.zone_ = zone;
+                    retained.sourceGeometryType_ = srcBatch.geometryType_;
+                    retained.allowInstancing_ = allowInstancing;
+                    retained.heightFog_ = zone && zone->GetHeightFog();
+                    retained.dynamicInstancing_ = renderer_->GetDynamicInstancing();
+                    retained.shadersChangedFrameNumber_ = renderer_->GetShadersChangedFrameNumber();
+                    retained.shadersRevision_ = pass->GetShadersRevision();
+                    retained.vsExtraDefinesHash_ = queue.hasExtraDefines_ ? queue.vsExtraDefinesHash_ : StringHash::ZERO;
+                    retained.psExtraDefinesHash_ = queue.hasExtraDefines_ ? queue.psExtraDefinesHash_ : StringHash::ZERO;
+                }
+                destBatch.retainedIndex_ = retainedIndex;
+
+                UpdateBatchAmbient(destBatch, globalIllumination_, drawable, &retained);
+                AddBatchToQueue(*info.batchQueue_, destBatch, tech, allowInstancing, true, &retained);
+            }
+        }
+
+        retainedDrawable.numBatches_ = retainedBaseBatches_.size() - retainedDrawable.firstBatch_;
+    }
+}
+
+const RetainedDrawable* View::GetPreviousRetainedDrawable(Drawable* drawable, unsigned index)
+{
+    // The geometry order usually matches the previous frame
+    if (index < previousRetainedDrawables_.size() && previousRetainedDrawables_[index].drawable_.Get() == drawable)
+        return &previousRetainedDrawables_[index];
+
+    if (!previousRetainedDrawableIndicesBuilt_)
+    {
+        previousRetainedDrawableIndicesBuilt_ = true;
+        for (unsigned i = 0; i < previousRetainedDrawables_.size(); ++i)
+        {
+            const RetainedDrawable& previous = previousRetainedDrawables_[i];
+            if (previous.numBatches_ && previous.drawable_)
+                previousRetainedDrawableIndices_[previous.drawable_.Get()] = i;
+        }
+    }
+
+    auto i = previousRetainedDrawableIndices_.find(drawable);
+    return i != previousRetainedDrawableIndices_.end() ? &previousRetainedDrawables_[i->second] : nullptr;
+}
+
+void View::StoreRetainedSortOrder()
+{
+    for (auto i = batchQueues_.begin(); i != batchQueues_.end(); ++i)
+    {
+        for (const Batch& batch : i->second.batches_)
+        {
+            if (batch.retainedIndex_ < retainedBaseBatches_.size())
+            {
+                Batch& retainedBatch = retainedBaseBatches_[batch.retainedIndex_].batch_;
+                retainedBatch.sortOrder_[0] = batch.sortOrder_[0];
+                retainedBatch.sortOrder_[1] = batch.sortOrder_[1];
             }
         }
     }
@@ -1320,6 +1556,7 @@ void View::UpdateGeometries()
     URHO3D_PROFILE("SortAndUpdateGeometry");
 
     auto* queue = GetSubsystem<WorkQueue>();
+    ea::vector<SharedPtr<WorkItem> > workItems;
 
     // Sort batches
     {
@@ -1337,6 +1574,7 @@ void View::UpdateGeometries()
                     command.sortMode_ == SORT_FRONTTOBACK ? SortBatchQueueFrontToBackWork : SortBatchQueueBackToFrontWork;
                 item->start_ = &batchQueues_[command.passIndex_];
                 queue->AddWorkItem(item);
+                workItems.push_back(item);
             }
         }
 
@@ -1347,6 +1585,7 @@ void View::UpdateGeometries()
             lightItem->workFunction_ = SortLightQueueWork;
             lightItem->start_ = &(*i);
             queue->AddWorkItem(lightItem);
+            workItems.push_back(lightItem);
 
             if (i->shadowSplits_.size())
             {
@@ -1355,6 +1594,7 @@ void View::UpdateGeometries()
                 shadowItem->workFunction_ = SortShadowQueueWork;
                 shadowItem->start_ = &(*i);
                 queue->AddWorkItem(shadowItem);
+                workItems.push_back(shadowItem);
             }
         }
     }
@@ -1366,35 +1606,31 @@ void View::UpdateGeometries()
             // In special cases (context loss, multi-view) a drawable may theoretically first have reported a threaded update, but will actually
             // require a main thread update. Check these cases first and move as applicable. The threaded work routine will tolerate the null
             // pointer holes that we leave to the threaded update queue.
+            // Also collect the drawables that need to commit their threaded update in the main thread
+            committedGeometries_.clear();
             for (auto i = threadedGeometries_.begin(); i != threadedGeometries_.end(); ++i)
             {
-                if ((*i)->GetUpdateGeometryType() == UPDATE_MAIN_THREAD)
+                const UpdateGeometryType type = (*i)->GetUpdateGeometryType();
+                if (type == UPDATE_MAIN_THREAD)
                 {
                     nonThreadedGeometries_.push_back(*i);
                     *i = nullptr;
                 }
+                else if (type == UPDATE_WORKER_THREAD_COMMIT)
+                    committedGeometries_.push_back(*i);
             }
 
-            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-            int drawablesPerItem = threadedGeometries_.size() / numWorkItems;
-
-            auto start = threadedGeometries_.begin();
-            for (int i = 0; i < numWorkItems; ++i)
+            // Queue threaded updates as a single work item, so that the main thread can update non-threaded
+            // geometries meanwhile. The work item splits the geometries further between the threads
+            SharedPtr<WorkItem> item = queue->AddWorkItem([this, queue]()
             {
-                auto end = threadedGeometries_.end();
-                if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                    end = start + drawablesPerItem;
-
-                SharedPtr<WorkItem> item = queue->GetFreeItem();
-                item->priority_ = M_MAX_UNSIGNED;
-                item->workFunction_ = UpdateDrawableGeometriesWork;
-                item->aux_ = const_cast<FrameInfo*>(&frame_);
-                item->start_ = &(*start);
-                item->end_ = &(*end);
-                queue->AddWorkItem(item);
-
-                start = end;
-            }
+                queue->ParallelFor(threadedGeometries_.size(), DRAWABLES_PER_WORK_ITEM,
+                    [this](unsigned begin, unsigned end, unsigned threadIndex)
+                {
+                    UpdateDrawableGeometriesWork(frame_, threadedGeometries_.data() + begin, threadedGeometries_.data() + end);
+                });
+            }, M_MAX_UNSIGNED);
+            workItems.push_back(item);
         }
 
         // While the work queue is processed, update non-threaded geometries
@@ -1403,8 +1639,14 @@ void View::UpdateGeometries()
             (*i)->UpdateGeometry(frame_);
     }
 
-    // Finally ensure all threaded work has completed
-    queue->Complete(M_MAX_UNSIGNED);
+    // Finally ensure all threaded work of this view has completed, then upload the results that need the main thread
+    queue->Complete(workItems);
+    for (Drawable* drawable : committedGeometries_)
+        drawable->CommitGeometry();
+
+    // Sorting on the next frame resumes from the sorted positions of this frame
+    StoreRetainedSortOrder();
+
     geometriesUpdated_ = true;
 }
 
@@ -1481,6 +1723,95 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
     }
 }
 
+void View::RecordScenePasses()
+{
+    scenePassCommandLists_.clear();
+
+    if (!renderer_->GetThreadedCommandRecording() || !camera_)
+        return;
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue->GetNumThreads())
+        return;
+
+    // Global shader parameters may be extended by event handlers, which can only run on the main thread
+    if (context_->GetEventReceivers(renderer_, E_VIEWGLOBALSHADERPARAMETERS) ||
+        context_->GetEventReceivers(E_VIEWGLOBALSHADERPARAMETERS))
+        return;
+
+    URHO3D_PROFILE("RecordScenePasses");
+
+    View* actualView = sourceView_ ? sourceView_.Get() : this;
+    ea::vector<ScenePassRecordJob> jobs;
+    scenePassCommandLists_.resize(renderPath_->commands_.size());
+
+    for (unsigned i = 0; i < renderPath_->commands_.size(); ++i)
+    {
+        // Commands that define shader parameters set them together with the camera parameters, which is not recorded
+        const RenderPathCommand& command = renderPath_->commands_[i];
+        if (command.type_ != CMD_SCENEPASS || !command.shaderParameters_.empty() || !actualView->IsNecessary(command))
+            continue;
+
+        auto batchQueue = actualView->batchQueues_.find(command.passIndex_);
+        if (batchQueue == actualView->batchQueues_.end() || batchQueue->second.IsEmpty() ||
+            !PrepareBatchQueueRecording(batchQueue->second))
+            continue;
+
+        const unsigned numDrawItems = batchQueue->second.GetNumDrawItems();
+        scenePassCommandLists_[i].first = jobs.size();
+        for (unsigned start = 0; start < numDrawItems; start += DRAW_ITEMS_PER_COMMAND_LIST)
+        {
+            const unsigned end = Min(start + DRAW_ITEMS_PER_COMMAND_LIST, numDrawItems);
+            jobs.push_back(ScenePassRecordJob{ &batchQueue->second, command.markToStencil_, start, end });
+        }
+        scenePassCommandLists_[i].second = jobs.size() - scenePassCommandLists_[i].first;
+    }
+
+    if (jobs.empty())
+    {
+        scenePassCommandLists_.clear();
+        return;
+    }
+
+    // Calculate lazily updated camera matrices now, as they are read by the worker threads
+    camera_->GetView();
+    camera_->GetProjection();
+
+    if (drawCommandLists_.size() < jobs.size())
+        drawCommandLists_.resize(jobs.size());
+
+    // Render targets of scene passes are assumed to be viewport-sized, which is checked before execution
+    const IntRect viewport(0, 0, viewSize_.x_, viewSize_.y_);
+    queue->ParallelFor(jobs.size(), 1, [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const ScenePassRecordJob& job = jobs[i];
+            DrawCommandList& commandList = drawCommandLists_[i];
+            commandList.Reset(viewport);
+            job.queue_->Draw(commandList, this, camera_, job.markToStencil_, false, true, job.start_, job.end_);
+        }
+    });
+}
+
+bool View::ExecuteRecordedScenePass(unsigned commandIndex, bool allowDepthWrite)
+{
+    if (commandIndex >= scenePassCommandLists_.size() || !scenePassCommandLists_[commandIndex].second)
+        return false;
+
+    // The command lists were recorded with depth write allowed, for a viewport-sized render target
+    const IntRect viewport = graphics_->GetViewport();
+    if (!allowDepthWrite || viewport.Width() != viewSize_.x_ || viewport.Height() != viewSize_.y_)
+        return false;
+
+    const unsigned first = scenePassCommandLists_[commandIndex].first;
+    const unsigned count = scenePassCommandLists_[commandIndex].second;
+    for (unsigned i = first; i < first + count; ++i)
+        graphics_->ExecuteCommandList(drawCommandLists_[i]);
+
+    return true;
+}
+
 void View::ExecuteRenderPathCommands()
 {
     View* actualView = sourceView_ ? sourceView_.Get() : this;
@@ -1631,7 +1962,8 @@ void View::ExecuteRenderPathCommands()
                             passCommand_ = &command;
                         }
 
-                        queue.Draw(this, camera_, command.markToStencil_, false, allowDepthWrite);
+                        if (!ExecuteRecordedScenePass(i, allowDepthWrite))
+                            queue.Draw(this, camera_, command.markToStencil_, false, allowDepthWrite);
 
                         passCommand_ = nullptr;
                     }
@@ -2932,7 +3264,8 @@ void View::SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& com
         queue.hasExtraDefines_ = false;
 }
 
-void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing, bool allowShadows)
+void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing, bool allowShadows,
+    RetainedBaseBatch* retained)
 {
     if (!batch.material_)
         batch.material_ = renderer_->GetDefaultMaterial();
@@ -2943,6 +3276,12 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
 
     if (batch.geometryType_ == GEOM_INSTANCED)
     {
+        if (retained && !retained->valid_)
+        {
+            retained->batch_ = batch;
+            retained->valid_ = true;
+        }
+
         BatchGroupKey key(batch);
 
         auto i = queue.batchGroups_.find(key);
@@ -2969,14 +3308,26 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     }
     else
     {
-        renderer_->SetBatchShaders(batch, tech, allowShadows, queue);
-        batch.CalculateSortKey();
+        if (!retained || !retained->valid_)
+        {
+            renderer_->SetBatchShaders(batch, tech, allowShadows, queue);
+            batch.CalculateSortKey();
+
+            if (retained)
+            {
+                retained->batch_ = batch;
+                retained->valid_ = true;
+            }
+        }
 
         // If batch is static with multiple world transforms and cannot instance, we must push copies of the batch individually
         if (batch.geometryType_ == GEOM_STATIC && batch.numWorldTransforms_ > 1)
         {
             unsigned numTransforms = batch.numWorldTransforms_;
             batch.numWorldTransforms_ = 1;
+            // The copies share the retained state, so they are sorted without it
+            batch.retainedIndex_ = M_MAX_UNSIGNED;
+            batch.sortOrder_[0] = batch.sortOrder_[1] = M_MAX_UNSIGNED;
             for (unsigned i = 0; i < numTransforms; ++i)
             {
                 // Move the transform pointer to generate copies of the batch which only refer to 1 world transform
@@ -3014,28 +3365,29 @@ void View::PrepareInstancingBuffer()
         totalInstances += i->litBatches_.GetNumInstances();
     }
 
-    if (!totalInstances || !renderer_->ResizeInstancingBuffer(totalInstances))
+    if (!totalInstances)
         return;
 
-    VertexBuffer* instancingBuffer = renderer_->GetInstancingBuffer();
-    unsigned freeIndex = 0;
-    void* dest = instancingBuffer->Lock(0, totalInstances, true);
+    // Each view takes a fresh region of the instancing ring buffer, so no data still used by the GPU is overwritten
+    unsigned lockStart = 0;
+    void* dest = renderer_->LockInstancingBuffer(totalInstances, lockStart);
     if (!dest)
         return;
 
-    const unsigned stride = instancingBuffer->GetVertexSize();
+    unsigned freeIndex = lockStart;
+    const unsigned stride = renderer_->GetInstancingBuffer()->GetVertexSize();
     for (auto i = batchQueues_.begin(); i != batchQueues_.end(); ++i)
-        i->second.SetInstancingData(dest, stride, freeIndex);
+        i->second.SetInstancingData(dest, lockStart, stride, freeIndex);
 
     for (auto i = lightQueues_.begin(); i != lightQueues_.end(); ++i)
     {
         for (unsigned j = 0; j < i->shadowSplits_.size(); ++j)
-            i->shadowSplits_[j].shadowBatches_.SetInstancingData(dest, stride, freeIndex);
-        i->litBaseBatches_.SetInstancingData(dest, stride, freeIndex);
-        i->litBatches_.SetInstancingData(dest, stride, freeIndex);
+            i->shadowSplits_[j].shadowBatches_.SetInstancingData(dest, lockStart, stride, freeIndex);
+        i->litBaseBatches_.SetInstancingData(dest, lockStart, stride, freeIndex);
+        i->litBatches_.SetInstancingData(dest, lockStart, stride, freeIndex);
     }
 
-    instancingBuffer->Unlock();
+    renderer_->UnlockInstancingBuffer();
 }
 
 void View::SetupLightVolumeBatch(Batch& batch)
@@ -26,6 +26,7 @@
 
 #include "../Core/Object.h"
 #include "../Graphics/Batch.h"
+#include "../Graphics/DrawCommandList.h"
 #include "../Graphics/Light.h"
 #include "../Graphics/Zone.h"
 #include "../Math/Polyhedron.h"
@@ -110,8 +111,7 @@ static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
 class URHO3D_API View : public Object
 {
-    friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
-    friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void CheckVisibilityWork(View* view, Drawable** start, Drawable** end, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -197,6 +197,12 @@ public:
     void SetCommandShaderParameters(const RenderPathCommand& command);
     /// Set G-buffer offset and inverse size shader parameters. Called by Batch and internally by View.
     void SetGBufferShaderParameters(const IntVector2& texSize, const IntRect& viewRect);
+    /// Record global (per-frame) shader parameters into a command list. Does not send the view global shader parameters event. Called by Batch.
+    void SetGlobalShaderParameters(DrawCommandList& commandList);
+    /// Record camera-specific shader parameters into a command list. Does not include render path command shader parameters. Called by Batch.
+    void SetCameraShaderParameters(DrawCommandList& commandList, Camera* camera);
+    /// Record G-buffer offset and inverse size shader parameters into a command list. Called by Batch.
+    void SetGBufferShaderParameters(DrawCommandList& commandList, const IntVector2& texSize, const IntRect& viewRect);
 
     /// Draw a fullscreen quad. Shaders and renderstates must have been set beforehand. Quad will be drawn to the middle of depth range, similarly to deferred directional lights.
     void DrawFullscreenQuad(bool setIdentityProjection = false);
@@ -219,6 +225,10 @@ private:
     void UpdateGeometries();
     /// Get pixel lit batches for a certain light and drawable.
     void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
+    /// Record scene pass batch queues into command lists on worker threads, if enabled in Renderer.
+    void RecordScenePasses();
+    /// Execute the command lists recorded for a scene pass render command. Return false if none were recorded or they do not match the current render state.
+    bool ExecuteRecordedScenePass(unsigned commandIndex, bool allowDepthWrite);
     /// Execute render commands.
     void ExecuteRenderPathCommands();
     /// Set rendertargets for current render command.
@@ -270,8 +280,13 @@ private:
     void CheckMaterialForAuxView(Material* material);
     /// Set shader defines for a batch queue if used.
     void SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command);
-    /// Choose shaders for a batch and add it to queue.
-    void AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing = true, bool allowShadows = true);
+    /// Choose shaders for a batch and add it to queue. A valid retained base batch is already prepared, otherwise the prepared batch is stored to it.
+    void AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing = true, bool allowShadows = true,
+        RetainedBaseBatch* retained = nullptr);
+    /// Return the base batches retained for a drawable on the previous frame, or null if none.
+    const RetainedDrawable* GetPreviousRetainedDrawable(Drawable* drawable, unsigned index);
+    /// Store the sorted positions of the base batch queues to the retained base batches.
+    void StoreRetainedSortOrder();
     /// Prepare instancing buffer by filling it with all instance transforms.
     void PrepareInstancingBuffer();
     /// Set up a light volume rendering batch.
@@ -407,6 +422,8 @@ private:
     ea::vector<Drawable*> nonThreadedGeometries_;
     /// Geometry objects that will be updated in worker threads.
     ea::vector<Drawable*> threadedGeometries_;
+    /// Geometry objects updated in worker threads that are committed in the main thread afterwards.
+    ea::vector<Drawable*> committedGeometries_;
     /// Occluder objects.
     ea::vector<Drawable*> occluders_;
     /// Lights.
@@ -428,6 +445,22 @@ private:
     ea::unordered_map<unsigned long long, LightBatchQueue> vertexLightQueues_;
     /// Batch queues by pass index.
     ea::unordered_map<unsigned, BatchQueue> batchQueues_;
+    /// Base batches retained across frames, grouped by drawable.
+    ea::vector<RetainedBaseBatch> retainedBaseBatches_;
+    /// Base batches retained on the previous frame.
+    ea::vector<RetainedBaseBatch> previousRetainedBaseBatches_;
+    /// Retained base batch ranges by geometry index.
+    ea::vector<RetainedDrawable> retainedDrawables_;
+    /// Retained base batch ranges of the previous frame by geometry index.
+    ea::vector<RetainedDrawable> previousRetainedDrawables_;
+    /// Index of previous frame retained base batch ranges by drawable. Built only when the geometry order changes.
+    ea::unordered_map<Drawable*, unsigned> previousRetainedDrawableIndices_;
+    /// Whether the index of previous frame retained base batch ranges has been built this frame.
+    bool previousRetainedDrawableIndicesBuilt_{};
+    /// Command lists recorded for scene passes.
+    ea::vector<DrawCommandList> drawCommandLists_;
+    /// First command list index and number of command lists by render path command index.
+    ea::vector<ea::pair<unsigned, unsigned> > scenePassCommandLists_;
     /// Index of the GBuffer pass.
     unsigned gBufferPassIndex_{};
     /// Index of the opaque forward base pass.
@@ -0,0 +1,178 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Maximum magnitude of the three smallest components of a unit quaternion.
+static const float QUATERNION_COMPONENT_RANGE = 0.70710678f;
+
+void BitWriter::Clear()
+{
+    data_.clear();
+    numBits_ = 0;
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    while (numBits)
+    {
+        const unsigned bitOffset = numBits_ & 7u;
+        if (!bitOffset)
+            data_.push_back(0);
+
+        const unsigned count = Min(8 - bitOffset, numBits);
+        data_.back() |= (unsigned char)((value & ((1u << count) - 1)) << bitOffset);
+        value >>= count;
+        numBits -= count;
+        numBits_ += count;
+    }
+}
+
+void BitWriter::WriteVarUInt(unsigned value)
+{
+    do
+    {
+        const unsigned group = value & 0x7fu;
+        value >>= 7;
+        WriteBool(value != 0);
+        WriteBits(group, 7);
+    } while (value);
+}
+
+void BitWriter::WriteVarInt(int value)
+{
+    WriteVarUInt(((unsigned)value << 1u) ^ (unsigned)(value >> 31));
+}
+
+void BitWriter::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits)
+{
+    numBits = Clamp(numBits, 1u, MAX_QUANTIZED_FLOAT_BITS);
+    const auto maxQuantized = (float)((1u << numBits) - 1);
+    const float range = maxValue - minValue;
+    const float normalized = range > 0.0f ? (Clamp(value, minValue, maxValue) - minValue) / range : 0.0f;
+    WriteBits((unsigned)RoundToInt(normalized * maxQuantized), numBits);
+}
+
+void BitWriter::WriteQuaternion(const Quaternion& value, unsigned componentBits)
+{
+    const float components[4] = { value.w_, value.x_, value.y_, value.z_ };
+
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // Negating the quaternion does not change the rotation, so the largest component can be made positive
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    WriteBits(largest, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+            WriteQuantizedFloat(components[i] * sign, -QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, componentBits);
+    }
+}
+
+BitReader::BitReader(const unsigned char* data, unsigned size) :
+    data_(data),
+    size_(size)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    unsigned value = 0;
+    unsigned shift = 0;
+    while (numBits)
+    {
+        const unsigned byteIndex = position_ >> 3u;
+        const unsigned bitOffset = position_ & 7u;
+        const unsigned count = Min(8 - bitOffset, numBits);
+        if (byteIndex < size_)
+            value |= ((data_[byteIndex] >> bitOffset) & ((1u << count) - 1)) << shift;
+
+        shift += count;
+        numBits -= count;
+        position_ += count;
+    }
+
+    return value;
+}
+
+unsigned BitReader::ReadVarUInt()
+{
+    unsigned value = 0;
+    unsigned shift = 0;
+    bool more = true;
+    while (more && shift < 32 && !IsEof())
+    {
+        more = ReadBool();
+        value |= ReadBits(7) << shift;
+        shift += 7;
+    }
+
+    return value;
+}
+
+int BitReader::ReadVarInt()
+{
+    const unsigned value = ReadVarUInt();
+    return (int)(value >> 1u) ^ -(int)(value & 1u);
+}
+
+float BitReader::ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits)
+{
+    numBits = Clamp(numBits, 1u, MAX_QUANTIZED_FLOAT_BITS);
+    const auto maxQuantized = (float)((1u << numBits) - 1);
+    return minValue + (maxValue - minValue) * (float)ReadBits(numBits) / maxQuantized;
+}
+
+Quaternion BitReader::ReadQuaternion(unsigned componentBits)
+{
+    const unsigned largest = ReadBits(2);
+
+    float components[4];
+    float sumSquares = 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            components[i] = ReadQuantizedFloat(-QUATERNION_COMPONENT_RANGE, QUATERNION_COMPONENT_RANGE, componentBits);
+            sumSquares += components[i] * components[i];
+        }
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+
+    Quaternion ret(components[0], components[1], components[2], components[3]);
+    ret.Normalize();
+    return ret;
+}
+
+}
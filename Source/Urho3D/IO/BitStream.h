@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Math/Quaternion.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Maximum number of bits of a quantized float, as more bits would not fit the float precision.
+static const unsigned MAX_QUANTIZED_FLOAT_BITS = 24;
+
+/// Writes values into a byte buffer with bit granularity. Used for bandwidth-critical network data.
+/// @nobind
+class URHO3D_API BitWriter
+{
+public:
+    /// Clear the buffer.
+    void Clear();
+    /// Write the lowest bits of a value. At most 32 bits.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a bool as one bit.
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+    /// Write an unsigned integer in groups of 7 bits preceded by a continuation bit.
+    void WriteVarUInt(unsigned value);
+    /// Write a signed integer zigzag encoded, so that values close to zero take few bits.
+    void WriteVarInt(int value);
+    /// Write a float clamped to a range and quantized to the specified number of bits. The number of bits is clamped to [1, MAX_QUANTIZED_FLOAT_BITS].
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits);
+    /// Write a unit quaternion as the index of its largest component and the other three components quantized to the specified number of bits.
+    void WriteQuaternion(const Quaternion& value, unsigned componentBits);
+
+    /// Return the buffer. The last byte is padded with zero bits.
+    const ea::vector<unsigned char>& GetData() const { return data_; }
+    /// Return number of bits written.
+    unsigned GetNumBits() const { return numBits_; }
+
+private:
+    /// Buffer.
+    ea::vector<unsigned char> data_;
+    /// Number of bits written.
+    unsigned numBits_{};
+};
+
+/// Reads values written by BitWriter from a byte buffer.
+/// @nobind
+class URHO3D_API BitReader
+{
+public:
+    /// Construct with a pointer and size in bytes. The data must stay valid while reading.
+    BitReader(const unsigned char* data, unsigned size);
+
+    /// Read bits. At most 32 bits. Reading past the end returns zero bits.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a bool.
+    bool ReadBool() { return ReadBits(1) != 0; }
+    /// Read an unsigned integer.
+    unsigned ReadVarUInt();
+    /// Read a zigzag encoded signed integer.
+    int ReadVarInt();
+    /// Read a quantized float. The number of bits is clamped like when writing.
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits);
+    /// Read a quaternion.
+    Quaternion ReadQuaternion(unsigned componentBits);
+
+    /// Return whether reading went past the end.
+    bool IsEof() const { return position_ > size_ * 8; }
+
+private:
+    /// Data.
+    const unsigned char* data_;
+    /// Size in bytes.
+    unsigned size_;
+    /// Read position in bits.
+    unsigned position_{};
+};
+
+}
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+MappedFile::MappedFile(Context* context) :
+    Object(context)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const ea::string& fileName)
+{
+    Close();
+
+    if (!Map(fileName))
+    {
+        // Files that can not be mapped, for example inside the APK on Android, are read as a whole
+        File file(context_);
+        if (!file.Open(fileName))
+            return false;
+
+        buffer_.resize(file.GetSize());
+        if (file.Read(buffer_.data(), buffer_.size()) != buffer_.size())
+        {
+            URHO3D_LOGERROR("Could not read file " + fileName);
+            buffer_.clear();
+            return false;
+        }
+
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    fileName_ = fileName;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (mapping_)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data_);
+        CloseHandle((HANDLE)mapping_);
+#elif !defined(__EMSCRIPTEN__)
+        munmap(mapping_, size_);
+#endif
+        mapping_ = nullptr;
+    }
+
+    data_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+    fileName_.clear();
+}
+
+bool MappedFile::Map(const ea::string& fileName)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(GetWideNativePath(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart || fileSize.QuadPart > M_MAX_UNSIGNED)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    mapping_ = mapping;
+    data_ = static_cast<const unsigned char*>(data);
+    size_ = (unsigned)fileSize.QuadPart;
+    return true;
+#elif !defined(__EMSCRIPTEN__)
+    int file = open(GetNativePath(fileName).c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat fileStat{};
+    if (fstat(file, &fileStat) != 0 || !fileStat.st_size || (unsigned long long)fileStat.st_size > M_MAX_UNSIGNED)
+    {
+        close(file);
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+        return false;
+
+    mapping_ = data;
+    data_ = static_cast<const unsigned char*>(data);
+    size_ = (unsigned)fileStat.st_size;
+    return true;
+#else
+    return false;
+#endif
+}
+
+}
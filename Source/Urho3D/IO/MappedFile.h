@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Read-only file mapped into memory. Falls back to reading the whole file when mapping is not supported.
+class URHO3D_API MappedFile : public Object
+{
+    URHO3D_OBJECT(MappedFile, Object);
+
+public:
+    /// Construct.
+    explicit MappedFile(Context* context);
+    /// Destruct and unmap.
+    ~MappedFile() override;
+
+    /// Map a file from the filesystem. If already open, the previous file is unmapped. Return true if successful.
+    bool Open(const ea::string& fileName);
+    /// Unmap the file.
+    void Close();
+
+    /// Return file name.
+    const ea::string& GetName() const { return fileName_; }
+    /// Return mapped data.
+    const unsigned char* GetData() const { return data_; }
+    /// Return size of the data in bytes.
+    unsigned GetSize() const { return size_; }
+    /// Return whether a file is open.
+    bool IsOpen() const { return data_ != nullptr; }
+    /// Return whether the file is mapped rather than read into memory.
+    bool IsMapped() const { return mapping_ != nullptr; }
+
+private:
+    /// Map the file using the operating system. Return true if successful.
+    bool Map(const ea::string& fileName);
+
+    /// File name.
+    ea::string fileName_;
+    /// Mapped or read data.
+    const unsigned char* data_{};
+    /// Size of the data.
+    unsigned size_{};
+    /// Operating system mapping handle or address.
+    void* mapping_{};
+    /// Data read into memory when mapping is not supported.
+    ea::vector<unsigned char> buffer_;
+};
+
+}
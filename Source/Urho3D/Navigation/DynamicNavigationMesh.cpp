@@ -429,28 +429,7 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = nullptr;
-                    }
-                }
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-                ++numTiles;
-            }
-        }
+        unsigned numTiles = BuildTiles(geometryList, IntVector2::ZERO, GetNumTiles() - IntVector2::ONE);
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
@@ -819,11 +798,12 @@ bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
     return true;
 }
 
-int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+bool DynamicNavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z,
+    ea::vector<TileCacheData>& layers)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    layers.clear();
 
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
@@ -860,20 +840,20 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     GetTileGeometry(&build, geometryList, expandedBox);
 
     if (build.vertices_.empty() || build.indices_.empty())
-        return 0; // Nothing to do
+        return false; // Nothing to do
 
     build.heightField_ = rcAllocHeightfield();
     if (!build.heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return false;
     }
 
     if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return 0;
+        return false;
     }
 
     unsigned numTriangles = build.indices_.size() / 3;
@@ -893,18 +873,18 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return false;
     }
     if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return false;
     }
 
     // area volumes
@@ -917,13 +897,13 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return 0;
+            return false;
         }
         if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return 0;
+            return false;
         }
     }
     else
@@ -931,7 +911,7 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return 0;
+            return false;
         }
     }
 
@@ -939,17 +919,17 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
     if (!build.heightFieldLayers_)
     {
         URHO3D_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return false;
     }
 
     if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
         *build.heightFieldLayers_))
     {
         URHO3D_LOGERROR("Could not build height field layers");
-        return 0;
+        return false;
     }
 
-    int retCt = 0;
+    layers.reserve(build.heightFieldLayers_->nlayers);
     for (int i = 0; i < build.heightFieldLayers_->nlayers; ++i)
     {
         dtTileCacheLayerHeader header;      // NOLINT(hicpp-member-init)
@@ -973,39 +953,51 @@ int DynamicNavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometr
         header.hmin = (unsigned short)layer->hmin;
         header.hmax = (unsigned short)layer->hmax;
 
+        TileCacheData tile{};
         if (dtStatusFailed(
             dtBuildTileCacheLayer(compressor_.get()/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
-                &(tiles[retCt].data), &tiles[retCt].dataSize)))
+                &tile.data, &tile.dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            for (TileCacheData& builtLayer : layers)
+                dtFree(builtLayer.data);
+            layers.clear();
+            return false;
         }
         else
-            ++retCt;
+            layers.push_back(tile);
     }
 
-    // Send a notification of the rebuild of this tile to anyone interested
-    {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
-    }
-
-    return retCt;
+    return true;
 }
 
 unsigned DynamicNavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
+    if (to.x_ < from.x_ || to.y_ < from.y_)
+        return 0;
 
+    struct BuiltTile
+    {
+        ea::vector<TileCacheData> layers_;
+        bool success_{};
+    };
+
+    ea::vector<BuiltTile> builtTiles((to.x_ - from.x_ + 1) * (to.y_ - from.y_ + 1));
+    ProcessTiles(geometryList, from, to, [&](unsigned index, int x, int z)
+    {
+        BuiltTile& tile = builtTiles[index];
+        tile.success_ = BuildTileData(geometryList, x, z, tile.layers_);
+    });
+
+    // The tile cache and the navigation mesh are only modified on the main thread
+    unsigned numTiles = 0;
+    unsigned index = 0;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
         {
+            BuiltTile& tile = builtTiles[index++];
+
             dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
             const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
             for (int i = 0; i < existingCt; ++i)
@@ -1015,22 +1007,32 @@ unsigned DynamicNavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& g
                     dtFree(data);
             }
 
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
+            for (TileCacheData& layer : tile.layers_)
             {
                 dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
+                int status = tileCache_->addTile(layer.data, layer.dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
                 if (dtStatusFailed((dtStatus)status))
                 {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = nullptr;
+                    dtFree(layer.data);
+                    layer.data = nullptr;
                 }
                 else
-                {
                     tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
+            }
+            ++numTiles;
+
+            // Send a notification of the rebuild of this tile to anyone interested
+            if (tile.success_)
+            {
+                const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+
+                using namespace NavigationAreaRebuilt;
+                VariantMap& eventData = GetContext()->GetEventDataMap();
+                eventData[P_NODE] = GetNode();
+                eventData[P_MESH] = this;
+                eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
+                eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+                SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
             }
         }
     }
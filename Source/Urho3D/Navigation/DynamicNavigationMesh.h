@@ -121,8 +121,8 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle* obstacle, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
+    /// Build the compressed tile cache layers of one tile without modifying the tile cache. Safe to call from worker threads. Return true if the tile has geometry and was built successfully.
+    bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, ea::vector<TileCacheData>& layers);
     /// Build tiles in the rectangular area. Return number of built tiles.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
     /// Off-mesh connections to be rebuilt in the mesh processor.
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -46,8 +47,12 @@
 #include "../Physics/CollisionShape.h"
 #endif
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
+#include <atomic>
 #include <cfloat>
+#include <EASTL/deque.h>
+#include <EASTL/unordered_map.h>
 #include <Detour/DetourNavMesh.h>
 #include <Detour/DetourNavMeshBuilder.h>
 #include <Detour/DetourNavMeshQuery.h>
@@ -80,6 +85,8 @@ static const float DEFAULT_EDGE_MAX_LENGTH = 12.0f;
 static const float DEFAULT_EDGE_MAX_ERROR = 1.3f;
 static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
+static const unsigned DEFAULT_PATH_ITERATION_BUDGET = 4096;
+static const unsigned DEFAULT_PATH_CACHE_SIZE = 256;
 
 static const int MAX_POLYS = 2048;
 
@@ -97,12 +104,218 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS]{};
 };
 
+/// Key of a cached polygon corridor.
+struct PathCacheKey
+{
+    /// Test for equality with another key.
+    bool operator ==(const PathCacheKey& rhs) const
+    {
+        return startRef_ == rhs.startRef_ && endRef_ == rhs.endRef_ && filter_ == rhs.filter_;
+    }
+
+    /// Return hash value.
+    unsigned ToHash() const
+    {
+        unsigned hash = 0;
+        CombineHash(hash, MakeHash(startRef_));
+        CombineHash(hash, MakeHash(endRef_));
+        CombineHash(hash, MakeHash(filter_));
+        return hash;
+    }
+
+    /// Start polygon.
+    dtPolyRef startRef_;
+    /// End polygon.
+    dtPolyRef endRef_;
+    /// Query filter.
+    const dtQueryFilter* filter_;
+};
+
+/// Asynchronous path request.
+struct PathRequest
+{
+    /// Request ID.
+    unsigned id_{};
+    /// Start point in navigation mesh space.
+    Vector3 start_;
+    /// End point in navigation mesh space.
+    Vector3 end_;
+    /// Search extents.
+    Vector3 extents_;
+    /// Query filter.
+    const dtQueryFilter* filter_{};
+    /// Status.
+    NavigationPathStatus status_{NAVPATH_PENDING};
+    /// Start polygon.
+    dtPolyRef startRef_{};
+    /// End polygon.
+    dtPolyRef endRef_{};
+    /// Whether the corridor was searched instead of taken from the cache.
+    bool searched_{};
+    /// Whether the search has been restarted after failing.
+    bool retried_{};
+    /// Polygon corridor.
+    ea::vector<dtPolyRef> polys_;
+    /// Path points in navigation mesh space.
+    ea::vector<Vector3> points_;
+    /// Path point flags.
+    ea::vector<unsigned char> flags_;
+};
+
+/// Navigation mesh query processed by one thread at a time, with the request whose sliced search it is running.
+struct PathQuerySlot
+{
+    /// Destruct.
+    ~PathQuerySlot() { dtFreeNavMeshQuery(query_); }
+
+    /// Detour navigation mesh query.
+    dtNavMeshQuery* query_{};
+    /// Request being searched.
+    PathRequest* request_{};
+    /// Requests completed during the update.
+    ea::vector<PathRequest*> completed_;
+    /// Temporary data for finding a path.
+    FindPathData data_;
+};
+
+/// Asynchronous path requests of a navigation mesh.
+struct PathRequestData
+{
+    /// Requests by ID.
+    ea::unordered_map<unsigned, PathRequest> requests_;
+    /// IDs of requests waiting for a query slot.
+    ea::deque<unsigned> queue_;
+    /// Waiting requests available to the query slots during the update.
+    ea::vector<PathRequest*> frameQueue_;
+    /// Index of the next request in frameQueue_ to claim.
+    std::atomic<unsigned> nextFrameRequest_{};
+    /// Query slots, one per worker thread and the main thread.
+    ea::vector<ea::unique_ptr<PathQuerySlot> > slots_;
+    /// Cached polygon corridors.
+    ea::unordered_map<PathCacheKey, ea::vector<dtPolyRef> > cache_;
+    /// Cached corridors in insertion order for eviction.
+    ea::deque<PathCacheKey> cacheOrder_;
+    /// Next request ID.
+    unsigned nextRequestID_{1};
+};
+
+/// Build the straight path of a request from its polygon corridor.
+static void FinishPathRequest(PathQuerySlot& slot, PathRequest& request)
+{
+    slot.completed_.push_back(&request);
+
+    if (request.polys_.empty())
+    {
+        request.status_ = NAVPATH_FAILED;
+        return;
+    }
+
+    // If full path was not found, clamp end point to the end polygon
+    Vector3 actualEnd = request.end_;
+    if (request.polys_.back() != request.endRef_)
+        slot.query_->closestPointOnPoly(request.polys_.back(), &request.end_.x_, &actualEnd.x_, nullptr);
+
+    FindPathData& data = slot.data_;
+    int numPathPoints = 0;
+    slot.query_->findStraightPath(&request.start_.x_, &actualEnd.x_, request.polys_.data(), request.polys_.size(),
+        &data.pathPoints_[0].x_, data.pathFlags_, data.pathPolys_, &numPathPoints, MAX_POLYS);
+
+    request.points_.assign(data.pathPoints_, data.pathPoints_ + numPathPoints);
+    request.flags_.assign(data.pathFlags_, data.pathFlags_ + numPathPoints);
+    request.status_ = numPathPoints ? NAVPATH_SUCCEEDED : NAVPATH_FAILED;
+}
+
+/// Find the end polygons of a request and start its search, or complete it right away from the cache.
+static void StartPathRequest(PathQuerySlot& slot, PathRequest& request, const dtNavMesh* navMesh, const PathRequestData& data)
+{
+    dtNavMeshQuery* query = slot.query_;
+    query->findNearestPoly(&request.start_.x_, &request.extents_.x_, request.filter_, &request.startRef_, nullptr);
+    query->findNearestPoly(&request.end_.x_, &request.extents_.x_, request.filter_, &request.endRef_, nullptr);
+    request.polys_.clear();
+    request.searched_ = false;
+
+    if (!request.startRef_ || !request.endRef_)
+    {
+        FinishPathRequest(slot, request);
+        return;
+    }
+
+    // Rebuilt tiles invalidate the references to their polygons, so a corridor that is still valid is still walkable
+    auto cached = data.cache_.find(PathCacheKey{request.startRef_, request.endRef_, request.filter_});
+    if (cached != data.cache_.end())
+    {
+        const ea::vector<dtPolyRef>& polys = cached->second;
+        if (ea::all_of(polys.begin(), polys.end(), [&](dtPolyRef ref) { return navMesh->isValidPolyRef(ref); }))
+        {
+            request.polys_ = polys;
+            FinishPathRequest(slot, request);
+            return;
+        }
+    }
+
+    if (dtStatusFailed(query->initSlicedFindPath(request.startRef_, request.endRef_, &request.start_.x_, &request.end_.x_,
+        request.filter_)))
+    {
+        FinishPathRequest(slot, request);
+        return;
+    }
+
+    request.searched_ = true;
+    slot.request_ = &request;
+}
+
+/// Advance the search of a query slot, claiming new requests until the iterations run out.
+static void UpdatePathQuerySlot(PathQuerySlot& slot, PathRequestData& data, const dtNavMesh* navMesh, int maxIterations)
+{
+    while (maxIterations > 0)
+    {
+        if (!slot.request_)
+        {
+            const unsigned index = data.nextFrameRequest_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= data.frameQueue_.size())
+                break;
+
+            // Finding the end polygons is not free either
+            StartPathRequest(slot, *data.frameQueue_[index], navMesh, data);
+            --maxIterations;
+            continue;
+        }
+
+        PathRequest& request = *slot.request_;
+        int numIterations = 0;
+        const dtStatus status = slot.query_->updateSlicedFindPath(maxIterations, &numIterations);
+        maxIterations -= Max(numIterations, 1);
+        if (dtStatusInProgress(status))
+            continue;
+
+        slot.request_ = nullptr;
+
+        // The search fails when tiles on its way have been rebuilt since it started, so try once more
+        if (dtStatusFailed(status) && !request.retried_)
+        {
+            request.retried_ = true;
+            StartPathRequest(slot, request, navMesh, data);
+            continue;
+        }
+
+        int numPolys = 0;
+        if (dtStatusSucceed(status))
+            slot.query_->finalizeSlicedFindPath(slot.data_.polys_, &numPolys, MAX_POLYS);
+        request.polys_.assign(slot.data_.polys_, slot.data_.polys_ + numPolys);
+        FinishPathRequest(slot, request);
+    }
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(nullptr),
     navMeshQuery_(nullptr),
     queryFilter_(new dtQueryFilter()),
     pathData_(new FindPathData()),
+    pathRequests_(new PathRequestData()),
+    pathIterationBudget_(DEFAULT_PATH_ITERATION_BUDGET),
+    pathCacheSize_(DEFAULT_PATH_CACHE_SIZE),
+    subscribed_(false),
     tileSize_(DEFAULT_TILE_SIZE),
     cellSize_(DEFAULT_CELL_SIZE),
     cellHeight_(DEFAULT_CELL_HEIGHT),
@@ -671,8 +884,7 @@ void NavigationMesh::FindPath(ea::vector<NavigationPathPoint>& dest, const Vecto
         return;
 
     // Navigation data is in local space. Transform path points from world to local
-    const Matrix3x4& transform = node_->GetWorldTransform();
-    Matrix3x4 inverse = transform.Inverse();
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
 
     Vector3 localStart = inverse * start;
     Vector3 localEnd = inverse * end;
@@ -703,12 +915,228 @@ void NavigationMesh::FindPath(ea::vector<NavigationPathPoint>& dest, const Vecto
     navMeshQuery_->findStraightPath(&localStart.x_, &actualLocalEnd.x_, pathData_->polys_, numPolys,
         &pathData_->pathPoints_[0].x_, pathData_->pathFlags_, pathData_->pathPolys_, &numPathPoints, MAX_POLYS);
 
+    ConvertPathPoints(dest, pathData_->pathPoints_, pathData_->pathFlags_, numPathPoints);
+}
+
+unsigned NavigationMesh::RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents, const dtQueryFilter* filter)
+{
+    if (!navMesh_ || !node_)
+        return 0;
+
+    // Navigation data is in local space. Transform path points from world to local
+    const Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+
+    PathRequestData& data = *pathRequests_;
+    unsigned requestID = data.nextRequestID_++;
+    if (!requestID)
+        requestID = data.nextRequestID_++;
+
+    PathRequest& request = data.requests_[requestID];
+    request.id_ = requestID;
+    request.start_ = inverse * start;
+    request.end_ = inverse * end;
+    request.extents_ = extents;
+    request.filter_ = filter ? filter : queryFilter_.get();
+    data.queue_.push_back(requestID);
+
+    UpdateEventSubscription();
+    return requestID;
+}
+
+NavigationPathStatus NavigationMesh::GetPathStatus(unsigned requestID) const
+{
+    auto i = pathRequests_->requests_.find(requestID);
+    return i != pathRequests_->requests_.end() ? i->second.status_ : NAVPATH_UNKNOWN;
+}
+
+NavigationPathStatus NavigationMesh::GetPathResult(unsigned requestID, ea::vector<NavigationPathPoint>& dest)
+{
+    auto i = pathRequests_->requests_.find(requestID);
+    if (i == pathRequests_->requests_.end())
+        return NAVPATH_UNKNOWN;
+
+    const PathRequest& request = i->second;
+    const NavigationPathStatus status = request.status_;
+    if (status == NAVPATH_PENDING)
+        return status;
+
+    dest.clear();
+    if (status == NAVPATH_SUCCEEDED && node_)
+        ConvertPathPoints(dest, request.points_.data(), request.flags_.data(), request.points_.size());
+
+    pathRequests_->requests_.erase(i);
+    return status;
+}
+
+void NavigationMesh::CancelPath(unsigned requestID)
+{
+    auto i = pathRequests_->requests_.find(requestID);
+    if (i == pathRequests_->requests_.end())
+        return;
+
+    // The ID stays in the queue and is skipped on the next update
+    for (const auto& slot : pathRequests_->slots_)
+    {
+        if (slot->request_ == &i->second)
+            slot->request_ = nullptr;
+    }
+
+    pathRequests_->requests_.erase(i);
+    UpdateEventSubscription();
+}
+
+void NavigationMesh::UpdatePathRequests()
+{
+    PathRequestData& data = *pathRequests_;
+    if (!GetNumPendingPaths())
+    {
+        data.queue_.clear();
+        UpdateEventSubscription();
+        return;
+    }
+
+    URHO3D_PROFILE("UpdatePathRequests");
+
+    // One query per worker thread and the main thread, as a sliced search keeps its state in the query
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numSlots = (queue ? queue->GetNumThreads() : 0) + 1;
+    while (navMesh_ && data.slots_.size() < numSlots)
+    {
+        auto slot = ea::make_unique<PathQuerySlot>();
+        slot->query_ = dtAllocNavMeshQuery();
+        if (!slot->query_ || dtStatusFailed(slot->query_->init(navMesh_, MAX_POLYS)))
+        {
+            URHO3D_LOGERROR("Could not init navigation mesh query");
+            break;
+        }
+        data.slots_.push_back(ea::move(slot));
+    }
+
+    // Without navigation data nothing can be found
+    if (data.slots_.empty())
+    {
+        for (auto& item : data.requests_)
+        {
+            if (item.second.status_ == NAVPATH_PENDING)
+                item.second.status_ = NAVPATH_FAILED;
+        }
+        data.queue_.clear();
+        UpdateEventSubscription();
+        return;
+    }
+
+    // Skip the IDs of cancelled requests
+    data.frameQueue_.clear();
+    for (unsigned requestID : data.queue_)
+    {
+        auto i = data.requests_.find(requestID);
+        if (i != data.requests_.end())
+            data.frameQueue_.push_back(&i->second);
+    }
+    data.queue_.clear();
+    data.nextFrameRequest_ = 0;
+
+    unsigned numActiveSlots = 0;
+    for (const auto& slot : data.slots_)
+    {
+        slot->completed_.clear();
+        if (slot->request_)
+            ++numActiveSlots;
+    }
+
+    const int iterationsPerSlot = Max(pathIterationBudget_ / (unsigned)data.slots_.size(), 1U);
+    if (queue && data.slots_.size() > 1 && numActiveSlots + data.frameQueue_.size() > 1)
+    {
+        queue->ParallelFor(data.slots_.size(), 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                UpdatePathQuerySlot(*data.slots_[i], data, navMesh_, iterationsPerSlot);
+        });
+    }
+    else
+    {
+        for (const auto& slot : data.slots_)
+            UpdatePathQuerySlot(*slot, data, navMesh_, iterationsPerSlot);
+    }
+
+    // Requests that no slot got to wait for the next update in the same order
+    for (unsigned i = Min<unsigned>(data.nextFrameRequest_, data.frameQueue_.size()); i < data.frameQueue_.size(); ++i)
+        data.queue_.push_back(data.frameQueue_[i]->id_);
+    data.frameQueue_.clear();
+
+    // Cache the corridors searched during the update
+    for (const auto& slot : data.slots_)
+    {
+        for (PathRequest* request : slot->completed_)
+        {
+            // Partial corridors end elsewhere, so they are not valid for the next request to the same end polygon
+            if (!pathCacheSize_ || !request->searched_ || request->status_ != NAVPATH_SUCCEEDED ||
+                request->polys_.back() != request->endRef_)
+                continue;
+
+            const PathCacheKey key{request->startRef_, request->endRef_, request->filter_};
+            auto insertResult = data.cache_.insert(key);
+            insertResult.first->second = request->polys_;
+            if (!insertResult.second)
+                continue;
+
+            data.cacheOrder_.push_back(key);
+            if (data.cacheOrder_.size() > pathCacheSize_)
+            {
+                data.cache_.erase(data.cacheOrder_.front());
+                data.cacheOrder_.pop_front();
+            }
+        }
+        slot->completed_.clear();
+    }
+
+    UpdateEventSubscription();
+}
+
+void NavigationMesh::SetPathIterationBudget(unsigned iterations)
+{
+    pathIterationBudget_ = Max(iterations, 1U);
+}
+
+void NavigationMesh::SetPathCacheSize(unsigned size)
+{
+    pathCacheSize_ = size;
+
+    PathRequestData& data = *pathRequests_;
+    while (data.cacheOrder_.size() > pathCacheSize_)
+    {
+        data.cache_.erase(data.cacheOrder_.front());
+        data.cacheOrder_.pop_front();
+    }
+}
+
+void NavigationMesh::ClearPathCache()
+{
+    pathRequests_->cache_.clear();
+    pathRequests_->cacheOrder_.clear();
+}
+
+unsigned NavigationMesh::GetNumPendingPaths() const
+{
+    unsigned numPending = 0;
+    for (const auto& item : pathRequests_->requests_)
+    {
+        if (item.second.status_ == NAVPATH_PENDING)
+            ++numPending;
+    }
+    return numPending;
+}
+
+void NavigationMesh::ConvertPathPoints(ea::vector<NavigationPathPoint>& dest, const Vector3* points, const unsigned char* flags,
+    unsigned numPoints) const
+{
     // Transform path result back to world space
-    for (int i = 0; i < numPathPoints; ++i)
+    const Matrix3x4& transform = node_->GetWorldTransform();
+    for (unsigned i = 0; i < numPoints; ++i)
     {
         NavigationPathPoint pt;
-        pt.position_ = transform * pathData_->pathPoints_[i];
-        pt.flag_ = (NavigationPathPointFlag)pathData_->pathFlags_[i];
+        pt.position_ = transform * points[i];
+        pt.flag_ = (NavigationPathPointFlag)flags[i];
 
         // Walk through all NavAreas and find nearest
         unsigned nearestNavAreaID = 0;       // 0 is the default nav area ID
@@ -862,6 +1290,9 @@ void NavigationMesh::SetAreaCost(unsigned areaID, float cost)
 {
     if (queryFilter_)
         queryFilter_->setAreaCost((int)areaID, cost);
+
+    // Cached corridors were found with the old costs
+    ClearPathCache();
 }
 
 BoundingBox NavigationMesh::GetWorldBoundingBox() const
@@ -1299,12 +1730,13 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
-bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z)
+bool NavigationMesh::BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData,
+    int& navDataSize)
 {
     URHO3D_PROFILE("BuildNavigationMeshTile");
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    navData = nullptr;
+    navDataSize = 0;
 
     const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
 
@@ -1462,9 +1894,6 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
             build.polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = nullptr;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;       // NOLINT(hicpp-member-init)
     memset(&params, 0, sizeof params);
     params.verts = build.polyMesh_->verts;
@@ -1504,9 +1933,19 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
     {
         URHO3D_LOGERROR("Could not build navigation mesh tile data");
+        navData = nullptr;
+        navDataSize = 0;
         return false;
     }
 
+    return true;
+}
+
+bool NavigationMesh::AddTileData(int x, int z, unsigned char* navData, int navDataSize)
+{
+    if (!navData)
+        return true; // Nothing to do
+
     if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
@@ -1516,6 +1955,8 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
 
     // Send a notification of the rebuild of this tile to anyone interested
     {
+        const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1529,19 +1970,79 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
 
 unsigned NavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
+    if (to.x_ < from.x_ || to.y_ < from.y_)
+        return 0;
 
+    struct BuiltTile
+    {
+        unsigned char* navData_{};
+        int navDataSize_{};
+        bool success_{};
+    };
+
+    ea::vector<BuiltTile> builtTiles((to.x_ - from.x_ + 1) * (to.y_ - from.y_ + 1));
+    ProcessTiles(geometryList, from, to, [&](unsigned index, int x, int z)
+    {
+        BuiltTile& tile = builtTiles[index];
+        tile.success_ = BuildTileData(geometryList, x, z, tile.navData_, tile.navDataSize_);
+    });
+
+    // Replace the tiles in the same order as they would have been built one by one
+    unsigned numTiles = 0;
+    unsigned index = 0;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
         {
-            if (BuildTile(geometryList, x, z))
+            const BuiltTile& tile = builtTiles[index++];
+            navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+            if (tile.success_ && AddTileData(x, z, tile.navData_, tile.navDataSize_))
                 ++numTiles;
         }
     }
     return numTiles;
 }
 
+void NavigationMesh::ProcessTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to,
+    const std::function<void(unsigned, int, int)>& callback)
+{
+    if (to.x_ < from.x_ || to.y_ < from.y_)
+        return;
+
+    const unsigned width = to.x_ - from.x_ + 1;
+    const unsigned numTiles = width * (to.y_ - from.y_ + 1);
+
+    const auto processRange = [&](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+            callback(i, from.x_ + i % width, from.y_ + i / width);
+    };
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (!queue || !queue->GetNumThreads() || numTiles < 2)
+    {
+        processRange(0, numTiles);
+        return;
+    }
+
+    // Worker threads can not update dirty nodes, so make sure the off-mesh connection end points are up to date
+    for (const NavigationGeometryInfo& info : geometryList)
+    {
+        if (info.component_->GetType() == OffMeshConnection::GetTypeStatic())
+        {
+            auto* connection = static_cast<OffMeshConnection*>(info.component_);
+            connection->GetNode()->GetWorldTransform();
+            connection->GetEndPoint()->GetWorldTransform();
+        }
+    }
+
+    // Tiles differ a lot in cost, so let the threads claim them one at a time
+    queue->ParallelFor(numTiles, 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        processRange(begin, end);
+    });
+}
+
 bool NavigationMesh::InitializeQuery()
 {
     if (!navMesh_ || !node_)
@@ -1574,11 +2075,45 @@ void NavigationMesh::ReleaseNavigationMesh()
     dtFreeNavMeshQuery(navMeshQuery_);
     navMeshQuery_ = nullptr;
 
+    // The queries refer to the released navigation mesh, so restart the searches in progress later
+    PathRequestData& data = *pathRequests_;
+    for (const auto& slot : data.slots_)
+    {
+        if (slot->request_)
+            data.queue_.push_front(slot->request_->id_);
+    }
+    data.slots_.clear();
+    ClearPathCache();
+
     numTilesX_ = 0;
     numTilesZ_ = 0;
     boundingBox_.Clear();
 }
 
+void NavigationMesh::UpdateEventSubscription()
+{
+    Scene* scene = GetScene();
+    bool enabled = scene && !pathRequests_->queue_.empty();
+    for (const auto& slot : pathRequests_->slots_)
+        enabled = enabled || (scene && slot->request_);
+
+    if (enabled && !subscribed_)
+    {
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(NavigationMesh, HandleScenePostUpdate));
+        subscribed_ = true;
+    }
+    else if (!enabled && subscribed_)
+    {
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        subscribed_ = false;
+    }
+}
+
+void NavigationMesh::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    UpdatePathRequests();
+}
+
 void NavigationMesh::SetPartitionType(NavmeshPartitionType partitionType)
 {
     partitionType_ = partitionType;
@@ -26,6 +26,8 @@
 
 #include <EASTL/unique_ptr.h>
 
+#include <functional>
+
 #include "../Math/BoundingBox.h"
 #include "../Math/Matrix3x4.h"
 #include "../Scene/Component.h"
@@ -54,6 +56,7 @@ class NavArea;
 
 struct FindPathData;
 struct NavBuildData;
+struct PathRequestData;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -78,6 +81,19 @@ enum NavigationPathPointFlag
     NAVPATHFLAG_OFF_MESH = 0x04
 };
 
+/// Status of an asynchronous path request.
+enum NavigationPathStatus
+{
+    /// The request does not exist, or its result has already been retrieved.
+    NAVPATH_UNKNOWN = 0,
+    /// The path is being searched.
+    NAVPATH_PENDING,
+    /// The path was found. It may end at the closest reachable point if the destination could not be reached.
+    NAVPATH_SUCCEEDED,
+    /// No path was found.
+    NAVPATH_FAILED
+};
+
 struct URHO3D_API NavigationPathPoint
 {
     /// World-space position of the path point.
@@ -185,6 +201,24 @@ public:
     void FindPath
         (ea::vector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE,
             const dtQueryFilter* filter = nullptr);
+    /// Queue an asynchronous path request between world space points. Requests are searched in parallel at the end of the scene update, within the per-frame iteration budget. The filter must stay valid until the request completes. Return the request ID, or 0 if the navigation mesh has not been built.
+    unsigned RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = nullptr);
+    /// Return the status of an asynchronous path request.
+    NavigationPathStatus GetPathStatus(unsigned requestID) const;
+    /// Return the status of an asynchronous path request. When completed, fill the path points if successful and release the request.
+    NavigationPathStatus GetPathResult(unsigned requestID, ea::vector<NavigationPathPoint>& dest);
+    /// Cancel an asynchronous path request.
+    void CancelPath(unsigned requestID);
+    /// Advance the asynchronous path requests. Called automatically at the end of the scene update while there are pending requests.
+    void UpdatePathRequests();
+    /// Set the number of search iterations the asynchronous path requests may use per frame in total.
+    /// @property
+    void SetPathIterationBudget(unsigned iterations);
+    /// Set the number of found polygon corridors to cache for reuse by requests between the same start and end polygons. 0 disables the cache.
+    /// @property
+    void SetPathCacheSize(unsigned size);
+    /// Clear the cached polygon corridors. Called automatically by SetAreaCost(), call manually after changing the costs or flags of a custom query filter.
+    void ClearPathCache();
     /// Return a random point on the navigation mesh.
     Vector3 GetRandomPoint(const dtQueryFilter* filter = nullptr, dtPolyRef* randomRef = nullptr);
     /// Return a random point on the navigation mesh within a circle. The circle radius is only a guideline and in practice the returned point may be further away.
@@ -283,6 +317,18 @@ public:
     /// @property
     IntVector2 GetNumTiles() const { return IntVector2(numTilesX_, numTilesZ_); }
 
+    /// Return the number of search iterations the asynchronous path requests may use per frame in total.
+    /// @property
+    unsigned GetPathIterationBudget() const { return pathIterationBudget_; }
+
+    /// Return the number of cached polygon corridors.
+    /// @property
+    unsigned GetPathCacheSize() const { return pathCacheSize_; }
+
+    /// Return the number of asynchronous path requests that have not completed yet.
+    /// @property
+    unsigned GetNumPendingPaths() const;
+
     /// Set the partition type used for polygon generation.
     /// @property
     void SetPartitionType(NavmeshPartitionType partitionType);
@@ -317,6 +363,12 @@ private:
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Convert local space path points to world space navigation path points.
+    void ConvertPathPoints(ea::vector<NavigationPathPoint>& dest, const Vector3* points, const unsigned char* flags, unsigned numPoints) const;
+    /// Subscribe to the scene post-update while there are pending path requests.
+    void UpdateEventSubscription();
+    /// Handle the scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
 
 protected:
     /// Collect geometry from under Navigable components.
@@ -327,10 +379,15 @@ protected:
     void GetTileGeometry(NavBuildData* build, ea::vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
-    /// Build one tile of the navigation mesh. Return true if successful.
-    virtual bool BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Build the Detour data of one tile without modifying the navigation mesh. Safe to call from worker threads. Return true if successful. The data is null if the tile has no geometry.
+    bool BuildTileData(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, unsigned char*& navData, int& navDataSize);
+    /// Add built Detour data of one tile to the navigation mesh, which takes ownership of it. Return true if successful.
+    bool AddTileData(int x, int z, unsigned char* navData, int navDataSize);
     /// Build tiles in the rectangular area. Return number of built tiles.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Call a function with the index and coordinates of each tile in the rectangular area, row by row. Uses the worker threads when there are several tiles, so the function must not modify the navigation mesh or send events.
+    void ProcessTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to,
+        const std::function<void(unsigned, int, int)>& callback);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
@@ -346,6 +403,14 @@ protected:
     ea::unique_ptr<dtQueryFilter> queryFilter_;
     /// Temporary data for finding a path.
     ea::unique_ptr<FindPathData> pathData_;
+    /// Asynchronous path requests, their query objects and the path cache.
+    ea::unique_ptr<PathRequestData> pathRequests_;
+    /// Search iterations per frame for asynchronous path requests.
+    unsigned pathIterationBudget_;
+    /// Maximum number of cached polygon corridors.
+    unsigned pathCacheSize_;
+    /// Scene post-update subscription flag.
+    bool subscribed_;
     /// Tile size.
     int tileSize_;
     /// Cell size.
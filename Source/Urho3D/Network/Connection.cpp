@@ -43,6 +43,8 @@
 #include <slikenet/peerinterface.h>
 #include <slikenet/statistics.h>
 
+#include <EASTL/sort.h>
+
 #ifdef SendMessage
 #undef SendMessage
 #endif
@@ -57,6 +59,10 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Priority of nodes without a NetworkPriority component in scheduled replication.
+static const float DEFAULT_REPLICATION_PRIORITY = 100.0f;
+/// Size of the message ID and length preceding each packed message.
+static const unsigned PACKED_MESSAGE_HEADER_SIZE = 8;
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -152,6 +158,7 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
     buffer.WriteUInt((unsigned int) msgID);
     buffer.WriteUInt(numBytes);
     buffer.Write(data, numBytes);
+    updateBytes_ += numBytes + PACKED_MESSAGE_HEADER_SIZE;
 }
 
 void Connection::SendRemoteEvent(StringHash eventType, bool inOrder, const VariantMap& eventData)
@@ -208,6 +215,7 @@ void Connection::SetScene(Scene* newScene)
     if (isClient_)
     {
         sceneState_.Clear();
+        nodeStaleness_.clear();
 
         // When scene is assigned on the server, instruct the client to load it. This may require downloading packages
         const ea::vector<SharedPtr<PackageFile> >& packages = scene_->GetRequiredPackageFiles();
@@ -222,6 +230,8 @@ void Connection::SetScene(Scene* newScene)
             msg_.WriteUInt(package->GetTotalSize());
             msg_.WriteUInt(package->GetChecksum());
         }
+        scenePackedReplication_ = packedReplication_;
+        msg_.WriteBool(scenePackedReplication_);
         SendMessage(MSG_LOADSCENE, true, true, msg_);
     }
     else
@@ -266,6 +276,21 @@ void Connection::SetLogStatistics(bool enable)
     logStatistics_ = enable;
 }
 
+void Connection::SetReplicationBudget(unsigned bytes)
+{
+    replicationBudget_ = bytes;
+}
+
+void Connection::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+}
+
+void Connection::SetPackedReplication(bool enable)
+{
+    packedReplication_ = enable;
+}
+
 void Connection::Disconnect(int waitMSec)
 {
     peer_->CloseConnection(*address_, true);
@@ -276,12 +301,20 @@ void Connection::SendServerUpdate()
     if (!scene_ || !sceneLoaded_)
         return;
 
+    updateBytes_ = 0;
+
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
     unsigned sceneID = scene_->GetID();
     nodesToProcess_.insert(sceneID);
     ProcessNode(sceneID);
 
+    if (replicationBudget_ || interestRadius_ > 0.0f)
+    {
+        SendScheduledNodes(sceneID);
+        return;
+    }
+
     // Then go through all dirtied nodes
     nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
     nodesToProcess_.erase(sceneID); // Do not process the root node twice
@@ -293,6 +326,89 @@ void Connection::SendServerUpdate()
     }
 }
 
+void Connection::SendThreadedServerUpdate()
+{
+    threadedUpdate_ = true;
+    SendServerUpdate();
+    threadedUpdate_ = false;
+}
+
+void Connection::ApplyDeferredReplicationStates()
+{
+    for (const auto& deferred : deferredNodeStates_)
+        deferred.first->AddReplicationState(deferred.second);
+    for (const auto& deferred : deferredComponentStates_)
+        deferred.first->AddReplicationState(deferred.second);
+
+    deferredNodeStates_.clear();
+    deferredComponentStates_.clear();
+}
+
+void Connection::SendScheduledNodes(unsigned sceneID)
+{
+    URHO3D_PROFILE("SendScheduledNodes");
+
+    // Rank the dirty nodes. Removals and nodes owned by this connection always go first
+    replicationQueue_.clear();
+    for (unsigned nodeID : sceneState_.dirtyNodes_)
+    {
+        if (nodeID == sceneID)
+            continue;
+
+        auto i = sceneState_.nodeStates_.find(nodeID);
+        Node* node = i != sceneState_.nodeStates_.end() ? i->second.node_.Get() : scene_->GetNode(nodeID);
+        if (!node || node->GetOwner() == this)
+        {
+            replicationQueue_.emplace_back(M_INFINITY, nodeID);
+            continue;
+        }
+
+        const float distance = (node->GetWorldPosition() - position_).Length();
+        if (interestRadius_ > 0.0f && distance > interestRadius_)
+            continue;
+
+        float priority = DEFAULT_REPLICATION_PRIORITY;
+        if (auto* networkPriority = node->GetComponent<NetworkPriority>())
+        {
+            priority = Max(networkPriority->GetBasePriority() - networkPriority->GetDistanceFactor() * distance,
+                networkPriority->GetMinPriority());
+        }
+
+        auto staleness = nodeStaleness_.find(nodeID);
+        const unsigned numWaited = staleness != nodeStaleness_.end() ? staleness->second : 0;
+        replicationQueue_.emplace_back(priority * (1 + numWaited), nodeID);
+    }
+
+    ea::sort(replicationQueue_.begin(), replicationQueue_.end(),
+        [](const ea::pair<float, unsigned>& lhs, const ea::pair<float, unsigned>& rhs) { return lhs.first > rhs.first; });
+
+    // Out of interest nodes may still be sent when in-interest nodes depend on them
+    nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
+    nodesToProcess_.erase(sceneID);
+
+    unsigned numSent = 0;
+    for (const auto& item : replicationQueue_)
+    {
+        // Send at least one ranked node per update, so that a single large node cannot stall replication
+        if (replicationBudget_ && updateBytes_ >= replicationBudget_ && item.first != M_INFINITY && numSent)
+            break;
+
+        ProcessNode(item.second);
+        ++numSent;
+    }
+
+    // Nodes left dirty, including ones skipped by NetworkPriority, age so that they eventually win over frequently updated nodes
+    for (const auto& item : replicationQueue_)
+    {
+        if (sceneState_.dirtyNodes_.contains(item.second))
+            ++nodeStaleness_[item.second];
+        else
+            nodeStaleness_.erase(item.second);
+    }
+
+    nodesToProcess_.clear();
+}
+
 void Connection::SendClientUpdate()
 {
     if (!scene_ || !sceneLoaded_)
@@ -437,7 +553,10 @@ void Connection::ProcessPendingLatestData()
         {
             MemoryBuffer msg(current->second);
             msg.ReadNetID(); // Skip the node ID
-            node->ReadLatestDataUpdate(msg);
+            if (scenePackedReplication_)
+                node->ReadPackedLatestDataUpdate(msg);
+            else
+                node->ReadLatestDataUpdate(msg);
             // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
             // Furthermore it would propagate to components and child nodes, which is not desired in this case
             nodeLatestData_.erase(current);
@@ -453,7 +572,7 @@ void Connection::ProcessPendingLatestData()
         {
             MemoryBuffer msg(current->second);
             msg.ReadNetID(); // Skip the component ID
-            if (component->ReadLatestDataUpdate(msg))
+            if (scenePackedReplication_ ? component->ReadPackedLatestDataUpdate(msg) : component->ReadLatestDataUpdate(msg))
                 component->ApplyAttributes();
             componentLatestData_.erase(current);
         }
@@ -560,6 +679,8 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
     // Clear previous pending latest data and package downloads if any
     nodeLatestData_.clear();
     componentLatestData_.clear();
+    nodeDeltaBases_.clear();
+    componentDeltaBases_.clear();
     downloads_.clear();
 
     // In case we have joined other scenes in this session, remove first all downloaded package files from the resource system
@@ -583,6 +704,9 @@ void Connection::ProcessLoadScene(int msgID, MemoryBuffer& msg)
         return;
     }
 
+    // Servers without packed replication support do not write the flag
+    scenePackedReplication_ = !msg.IsEof() && msg.ReadBool();
+
     // If no downloads were queued, can load the scene directly
     if (downloads_.empty())
         OnPackagesReady();
@@ -629,7 +753,14 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             }
 
             // Read initial attributes, then snap the motion smoothing immediately to the end
-            node->ReadDeltaUpdate(msg);
+            if (scenePackedReplication_)
+            {
+                ea::vector<int>& deltaBase = nodeDeltaBases_[nodeID];
+                deltaBase.clear();
+                node->ReadPackedDeltaUpdate(msg, deltaBase);
+            }
+            else
+                node->ReadDeltaUpdate(msg);
             auto* transform = node->GetComponent<SmoothedTransform>();
             if (transform)
                 transform->Update(1.0f, 0.0f);
@@ -669,7 +800,14 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
-                component->ReadDeltaUpdate(msg);
+                if (scenePackedReplication_)
+                {
+                    ea::vector<int>& deltaBase = componentDeltaBases_[componentID];
+                    deltaBase.clear();
+                    component->ReadPackedDeltaUpdate(msg, deltaBase);
+                }
+                else
+                    component->ReadDeltaUpdate(msg);
                 component->ApplyAttributes();
             }
         }
@@ -681,7 +819,10 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Node* node = scene_->GetNode(nodeID);
             if (node)
             {
-                node->ReadDeltaUpdate(msg);
+                if (scenePackedReplication_)
+                    node->ReadPackedDeltaUpdate(msg, nodeDeltaBases_[nodeID]);
+                else
+                    node->ReadDeltaUpdate(msg);
                 // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
                 // Furthermore it would propagate to components and child nodes, which is not desired in this case
                 unsigned changedVars = msg.ReadVLE();
@@ -703,7 +844,10 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Node* node = scene_->GetNode(nodeID);
             if (node)
             {
-                node->ReadLatestDataUpdate(msg);
+                if (scenePackedReplication_)
+                    node->ReadPackedLatestDataUpdate(msg);
+                else
+                    node->ReadLatestDataUpdate(msg);
                 // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
                 // Furthermore it would propagate to components and child nodes, which is not desired in this case
             }
@@ -724,6 +868,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (node)
                 node->Remove();
             nodeLatestData_.erase(nodeID);
+            nodeDeltaBases_.erase(nodeID);
         }
         break;
 
@@ -753,7 +898,14 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
-                component->ReadDeltaUpdate(msg);
+                if (scenePackedReplication_)
+                {
+                    ea::vector<int>& deltaBase = componentDeltaBases_[componentID];
+                    deltaBase.clear();
+                    component->ReadPackedDeltaUpdate(msg, deltaBase);
+                }
+                else
+                    component->ReadDeltaUpdate(msg);
                 component->ApplyAttributes();
             }
             else
@@ -767,7 +919,10 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Component* component = scene_->GetComponent(componentID);
             if (component)
             {
-                component->ReadDeltaUpdate(msg);
+                if (scenePackedReplication_)
+                    component->ReadPackedDeltaUpdate(msg, componentDeltaBases_[componentID]);
+                else
+                    component->ReadDeltaUpdate(msg);
                 component->ApplyAttributes();
             }
             else
@@ -781,7 +936,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             Component* component = scene_->GetComponent(componentID);
             if (component)
             {
-                if (component->ReadLatestDataUpdate(msg))
+                if (scenePackedReplication_ ? component->ReadPackedLatestDataUpdate(msg) : component->ReadLatestDataUpdate(msg))
                     component->ApplyAttributes();
             }
             else
@@ -801,6 +956,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             if (component)
                 component->Remove();
             componentLatestData_.erase(componentID);
+            componentDeltaBases_.erase(componentID);
         }
         break;
 
@@ -1271,10 +1427,13 @@ void Connection::ProcessNewNode(Node* node)
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
     nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    AddReplicationState(node, nodeState);
 
     // Write node's attributes
-    node->WriteInitialDeltaUpdate(msg_, timeStamp_);
+    if (scenePackedReplication_)
+        node->WritePackedInitialDeltaUpdate(msg_, timeStamp_, nodeState.deltaBase_);
+    else
+        node->WriteInitialDeltaUpdate(msg_, timeStamp_);
 
     // Write node's user variables
     const VariantMap& vars = node->GetVars();
@@ -1299,11 +1458,14 @@ void Connection::ProcessNewNode(Node* node)
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
         componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        AddReplicationState(component, componentState);
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
-        component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+        if (scenePackedReplication_)
+            component->WritePackedInitialDeltaUpdate(msg_, timeStamp_, componentState.deltaBase_);
+        else
+            component->WriteInitialDeltaUpdate(msg_, timeStamp_);
     }
 
     SendMessage(MSG_CREATENODE, true, true, msg_);
@@ -1354,7 +1516,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         {
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
-            node->WriteLatestDataUpdate(msg_, timeStamp_);
+            if (!node->WriteCachedLatestDataUpdate(msg_, timeStamp_, scenePackedReplication_))
+            {
+                if (scenePackedReplication_)
+                    node->WritePackedLatestDataUpdate(msg_, timeStamp_);
+                else
+                    node->WriteLatestDataUpdate(msg_, timeStamp_);
+            }
 
             SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
         }
@@ -1364,7 +1532,10 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         {
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
-            node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_);
+            if (scenePackedReplication_)
+                node->WritePackedDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_, nodeState.deltaBase_);
+            else if (!node->WriteCachedDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_))
+                node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_);
 
             // Write changed variables
             msg_.WriteVLE(nodeState.dirtyVars_.size());
@@ -1432,7 +1603,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 {
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
-                    component->WriteLatestDataUpdate(msg_, timeStamp_);
+                    if (!component->WriteCachedLatestDataUpdate(msg_, timeStamp_, scenePackedReplication_))
+                    {
+                        if (scenePackedReplication_)
+                            component->WritePackedLatestDataUpdate(msg_, timeStamp_);
+                        else
+                            component->WriteLatestDataUpdate(msg_, timeStamp_);
+                    }
 
                     SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
                 }
@@ -1442,7 +1619,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 {
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
-                    component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
+                    if (scenePackedReplication_)
+                    {
+                        component->WritePackedDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_,
+                            componentState.deltaBase_);
+                    }
+                    else if (!component->WriteCachedDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_))
+                        component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
 
                     SendMessage(MSG_COMPONENTDELTAUPDATE, true, true, msg_);
 
@@ -1472,13 +1655,16 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
                 componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                AddReplicationState(component, componentState);
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
                 msg_.WriteStringHash(component->GetType());
                 msg_.WriteNetID(component->GetID());
-                component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+                if (scenePackedReplication_)
+                    component->WritePackedInitialDeltaUpdate(msg_, timeStamp_, componentState.deltaBase_);
+                else
+                    component->WriteInitialDeltaUpdate(msg_, timeStamp_);
 
                 SendMessage(MSG_CREATECOMPONENT, true, true, msg_);
             }
@@ -1489,6 +1675,22 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     sceneState_.dirtyNodes_.erase(node->GetID());
 }
 
+void Connection::AddReplicationState(Node* node, NodeReplicationState& nodeState)
+{
+    if (threadedUpdate_)
+        deferredNodeStates_.emplace_back(node, &nodeState);
+    else
+        node->AddReplicationState(&nodeState);
+}
+
+void Connection::AddReplicationState(Component* component, ComponentReplicationState& componentState)
+{
+    if (threadedUpdate_)
+        deferredComponentStates_.emplace_back(component, &componentState);
+    else
+        component->AddReplicationState(&componentState);
+}
+
 bool Connection::RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg)
 {
     auto* cache = GetSubsystem<ResourceCache>();
@@ -159,10 +159,23 @@ public:
     /// Set whether to log data in/out statistics.
     /// @property
     void SetLogStatistics(bool enable);
+    /// Set maximum bytes of scene replication messages per server update. Dirty nodes are sent in order of priority multiplied by the number of updates they have waited, until the budget is used. Zero (default) sends all dirty nodes.
+    /// @property
+    void SetReplicationBudget(unsigned bytes);
+    /// Set radius around the observer position outside which nodes are not created or updated on the client, but stay dirty until they come within the radius. Nodes owned by this connection are always replicated. Zero (default) replicates all nodes.
+    /// @property
+    void SetInterestRadius(float radius);
+    /// Set whether to send scene replication in bit-packed format, using the network quantization hints of attributes. Takes effect when the next scene is assigned. Both ends must use this version of the protocol.
+    /// @property
+    void SetPackedReplication(bool enable);
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
     /// Send scene update messages. Called by Network.
     void SendServerUpdate();
+    /// Send scene update messages from a worker thread. Registering the replication states of newly sent objects is deferred to ApplyDeferredReplicationStates(). Called by Network.
+    void SendThreadedServerUpdate();
+    /// Register the replication states deferred by SendThreadedServerUpdate(). Called by Network.
+    void ApplyDeferredReplicationStates();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
     /// Send queued remote events. Called by Network.
@@ -224,6 +237,18 @@ public:
     /// @property
     bool GetLogStatistics() const { return logStatistics_; }
 
+    /// Return maximum bytes of scene replication messages per server update.
+    /// @property
+    unsigned GetReplicationBudget() const { return replicationBudget_; }
+
+    /// Return interest management radius.
+    /// @property
+    float GetInterestRadius() const { return interestRadius_; }
+
+    /// Return whether scene replication is sent in bit-packed format.
+    /// @property
+    bool GetPackedReplication() const { return packedReplication_; }
+
     /// Return remote address.
     /// @property
     ea::string GetAddress() const;
@@ -301,12 +326,18 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Send dirty nodes within the interest radius in priority order until the replication budget is used.
+    void SendScheduledNodes(unsigned sceneID);
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
     /// Process a node that the client has not yet received.
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Register a node replication state with the node, or defer it during a threaded update.
+    void AddReplicationState(Node* node, NodeReplicationState& nodeState);
+    /// Register a component replication state with the component, or defer it during a threaded update.
+    void AddReplicationState(Component* component, ComponentReplicationState& componentState);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Process unknown message. All unknown messages are forwarded as an events
@@ -336,8 +367,20 @@ private:
     ea::unordered_map<unsigned, ea::vector<unsigned char> > nodeLatestData_;
     /// Pending latest data for not yet received components.
     ea::unordered_map<unsigned, ea::vector<unsigned char> > componentLatestData_;
+    /// Packed delta update bases of received nodes.
+    ea::unordered_map<unsigned, ea::vector<int> > nodeDeltaBases_;
+    /// Packed delta update bases of received components.
+    ea::unordered_map<unsigned, ea::vector<int> > componentDeltaBases_;
     /// Node ID's to process during a replication update.
     ea::hash_set<unsigned> nodesToProcess_;
+    /// Dirty node ID's in the interest radius sorted by priority during a scheduled replication update.
+    ea::vector<ea::pair<float, unsigned> > replicationQueue_;
+    /// Number of server updates that dirty nodes have been left unsent by the scheduled replication.
+    ea::unordered_map<unsigned, unsigned> nodeStaleness_;
+    /// Node replication states to register after a threaded update.
+    ea::vector<ea::pair<Node*, NodeReplicationState*> > deferredNodeStates_;
+    /// Component replication states to register after a threaded update.
+    ea::vector<ea::pair<Component*, ComponentReplicationState*> > deferredComponentStates_;
     /// Reusable message buffer.
     VectorBuffer msg_;
     /// Queued remote events.
@@ -378,6 +421,18 @@ private:
     ea::unordered_map<int, VectorBuffer> outgoingBuffer_;
     /// Outgoing packet size limit
     int packedMessageLimit_;
+    /// Bytes of messages queued since the start of the current server update.
+    unsigned updateBytes_{};
+    /// Replication byte budget per server update.
+    unsigned replicationBudget_{};
+    /// Interest management radius.
+    float interestRadius_{};
+    /// Packed replication setting.
+    bool packedReplication_{};
+    /// Whether the current scene is replicated in packed format.
+    bool scenePackedReplication_{};
+    /// Threaded server update flag.
+    bool threadedUpdate_{};
 };
 
 }
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -577,6 +578,11 @@ void Network::SetUpdateFps(int fps)
     updateAcc_ = 0.0f;
 }
 
+void Network::SetParallelServerUpdate(bool enable)
+{
+    parallelServerUpdate_ = enable;
+}
+
 void Network::SetSimulatedLatency(int ms)
 {
     simulatedLatency_ = Max(ms, 0);
@@ -940,6 +946,10 @@ void Network::PostUpdate(float timeStep)
                     (*i)->PrepareNetworkUpdate();
             }
 
+            auto* queue = GetSubsystem<WorkQueue>();
+            if (parallelServerUpdate_ && queue && queue->GetNumThreads() && clientConnections_.size() > 1)
+                SendParallelServerUpdate();
+            else
             {
                 URHO3D_PROFILE("SendServerUpdate");
 
@@ -967,6 +977,42 @@ void Network::PostUpdate(float timeStep)
     }
 }
 
+void Network::SendParallelServerUpdate()
+{
+    URHO3D_PROFILE("SendParallelServerUpdate");
+
+    // Serialize the shared payloads once for all connections
+    updateConnections_.clear();
+    bool plainFormat = false;
+    bool packedFormat = false;
+    for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+    {
+        updateConnections_.push_back(i->second);
+        if (i->second->GetPackedReplication())
+            packedFormat = true;
+        else
+            plainFormat = true;
+    }
+
+    for (auto i = networkScenes_.begin(); i != networkScenes_.end(); ++i)
+        (*i)->PrepareParallelNetworkUpdate(plainFormat, packedFormat);
+
+    // Then assemble the messages of each connection on the worker threads
+    GetSubsystem<WorkQueue>()->ParallelFor(updateConnections_.size(), 1, [this](unsigned begin, unsigned end, unsigned)
+    {
+        for (unsigned i = begin; i < end; ++i)
+            updateConnections_[i]->SendThreadedServerUpdate();
+    });
+
+    for (Connection* connection : updateConnections_)
+    {
+        connection->ApplyDeferredReplicationStates();
+        connection->SendRemoteEvents();
+        connection->SendPackages();
+        connection->SendAllBuffers();
+    }
+}
+
 void Network::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     using namespace BeginFrame;
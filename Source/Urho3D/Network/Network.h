@@ -89,6 +89,9 @@ public:
     /// Set network update FPS.
     /// @property
     void SetUpdateFps(int fps);
+    /// Set whether to serialize the server updates of client connections in parallel on the work queue. Update payloads shared by the connections are then serialized once per network update. Default false.
+    /// @property
+    void SetParallelServerUpdate(bool enable);
     /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet.
     /// @property
     void SetSimulatedLatency(int ms);
@@ -114,6 +117,10 @@ public:
     /// @property
     int GetUpdateFps() const { return updateFps_; }
 
+    /// Return whether server updates are serialized in parallel.
+    /// @property
+    bool GetParallelServerUpdate() const { return parallelServerUpdate_; }
+
     /// Return simulated latency in milliseconds.
     /// @property
     int GetSimulatedLatency() const { return simulatedLatency_; }
@@ -150,6 +157,8 @@ private:
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Handle render update frame event.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Send server updates of all client connections, serializing them on the worker threads.
+    void SendParallelServerUpdate();
     /// Handle server connection.
     void OnServerConnected(const SLNet::AddressOrGUID& address);
     /// Handle server disconnection.
@@ -185,6 +194,10 @@ private:
     float updateInterval_;
     /// Update time accumulator.
     float updateAcc_;
+    /// Parallel server update flag.
+    bool parallelServerUpdate_{};
+    /// Client connections of a parallel server update.
+    ea::vector<Connection*> updateConnections_;
     /// Package cache directory.
     ea::string packageCacheDir_;
     /// Whether we started as server or not.
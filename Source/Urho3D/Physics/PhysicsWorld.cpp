@@ -27,9 +27,11 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Math/Ray.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/Constraint.h"
@@ -43,12 +45,19 @@
 
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionObjectWrapper.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btManifoldResult.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#ifdef URHO3D_THREADING
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#endif
 
 
 extern ContactAddedCallback gContactAddedCallback;
@@ -61,6 +70,16 @@ extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+/// Minimum number of contact manifolds or collision pairs to process them on the worker threads.
+static const unsigned MIN_THREADED_MANIFOLDS = 512;
+/// Number of contact manifolds or collision pairs per work item.
+static const unsigned MANIFOLDS_PER_WORK_ITEM = 128;
+/// Minimum number of batched queries to execute them on the worker threads.
+static const unsigned MIN_THREADED_QUERIES = 64;
+/// Number of batched queries per work item.
+static const unsigned QUERIES_PER_WORK_ITEM = 16;
+/// Size of one contact in the collision event contact data: position, normal, distance and impulse.
+static const unsigned CONTACT_DATA_SIZE = 2 * sizeof(Vector3) + 2 * sizeof(float);
 
 PhysicsWorldConfig PhysicsWorld::config;
 
@@ -98,6 +117,191 @@ static bool CustomMaterialCombinerCallback(btManifoldPoint& cp, const btCollisio
     return true;
 }
 
+static void ClearRaycastResult(PhysicsRaycastResult& result)
+{
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+    result.body_ = nullptr;
+}
+
+static void RaycastSingleImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+static void ConvexCastImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const btConvexShape* shape,
+    const Vector3& startPos, const Quaternion& startRot, const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask)
+{
+    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(shape, btTransform(ToBtQuaternion(startRot), convexCallback.m_convexFromWorld),
+        btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+        ClearRaycastResult(result);
+}
+
+static void SphereCastImpl(const btCollisionWorld* world, PhysicsRaycastResult& result, const Ray& ray, float radius,
+    float maxDistance, unsigned collisionMask)
+{
+    btSphereShape shape(radius);
+    ConvexCastImpl(world, result, &shape, ray.origin_, Quaternion::IDENTITY, ray.origin_ + maxDistance * ray.direction_,
+        Quaternion::IDENTITY, collisionMask);
+}
+
+static bool IsCollisionEventEnabled(const RigidBody* bodyA, const RigidBody* bodyB)
+{
+    // Skip collision event signaling if both objects are static, or if collision event mode does not match
+    if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
+        !bodyA->IsActive() && !bodyB->IsActive())
+        return false;
+    return true;
+}
+
+static void WriteContacts(Serializer& dest, const btPersistentManifold* manifold, bool flipNormals)
+{
+    if (!manifold)
+        return;
+
+    for (int i = 0; i < manifold->getNumContacts(); ++i)
+    {
+        const btManifoldPoint& point = manifold->getContactPoint(i);
+        dest.WriteVector3(ToVector3(point.m_positionWorldOnB));
+        dest.WriteVector3(flipNormals ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB));
+        dest.WriteFloat(point.m_distance1);
+        dest.WriteFloat(point.m_appliedImpulse);
+    }
+}
+
+static bool CompareCollisionPairs(const PhysicsCollisionPair& lhs, const PhysicsCollisionPair& rhs)
+{
+    return lhs.bodyA_ != rhs.bodyA_ ? lhs.bodyA_ < rhs.bodyA_ : lhs.bodyB_ < rhs.bodyB_;
+}
+
+static bool ContainsCollisionPair(const ea::vector<PhysicsCollisionPair>& pairs, const PhysicsCollisionPair& pair)
+{
+    auto i = ea::lower_bound(pairs.begin(), pairs.end(), pair, CompareCollisionPairs);
+    // A body created at the address of a removed one does not continue its collisions
+    return i != pairs.end() && i->bodyA_ == pair.bodyA_ && i->bodyB_ == pair.bodyB_ && i->weakBodyA_ == pair.weakBodyA_
+        && i->weakBodyB_ == pair.weakBodyB_;
+}
+
+#ifdef URHO3D_THREADING
+/// Bullet task scheduler that runs the parallel loops of the multithreaded world on the work queue.
+class WorkQueueTaskScheduler : public btITaskScheduler
+{
+public:
+    /// Construct.
+    WorkQueueTaskScheduler() :
+        btITaskScheduler("WorkQueue")
+    {
+    }
+
+    /// Set the work queue.
+    void SetWorkQueue(WorkQueue* workQueue) { workQueue_ = workQueue; }
+
+    /// Return maximum number of threads.
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+
+    /// Return number of threads, including the main thread.
+    int getNumThreads() const override
+    {
+        return workQueue_ ? Min(static_cast<int>(workQueue_->GetNumThreads()) + 1, static_cast<int>(BT_MAX_THREAD_COUNT)) : 1;
+    }
+
+    /// Set number of threads. The work queue owns the threads, so this is ignored.
+    void setNumThreads(int numThreads) override { }
+
+    /// Run a loop in parallel.
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        WorkQueue* workQueue = workQueue_;
+        if (!workQueue || iEnd - iBegin <= grainSize)
+        {
+            body.forLoop(iBegin, iEnd);
+            return;
+        }
+
+        workQueue->ParallelFor(iEnd - iBegin, grainSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            body.forLoop(iBegin + begin, iBegin + end);
+        });
+    }
+
+    /// Run a loop in parallel and return the sum of its iterations.
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        WorkQueue* workQueue = workQueue_;
+        if (!workQueue || iEnd - iBegin <= grainSize)
+            return body.sumLoop(iBegin, iEnd);
+
+        return workQueue->ParallelReduce<btScalar>(iEnd - iBegin, grainSize, btScalar(0),
+            [&](unsigned begin, unsigned end) { return body.sumLoop(iBegin + begin, iBegin + end); },
+            [](btScalar lhs, btScalar rhs) { return lhs + rhs; });
+    }
+
+private:
+    /// Work queue.
+    WeakPtr<WorkQueue> workQueue_;
+};
+
+/// Collision dispatcher for the multithreaded world. Bullet assigns thread indices on first use, so they are not bounded
+/// by the number of work queue threads; reserve the batch arrays for all possible indices.
+class CollisionDispatcherMt : public btCollisionDispatcherMt
+{
+public:
+    /// Construct.
+    explicit CollisionDispatcherMt(btCollisionConfiguration* config) :
+        btCollisionDispatcherMt(config)
+    {
+        m_batchManifoldsPtr.resize(BT_MAX_THREAD_COUNT);
+    }
+};
+
+/// Set up the global Bullet task scheduler to use the work queue and return it.
+static btITaskScheduler* SetupTaskScheduler(WorkQueue* workQueue)
+{
+    static WorkQueueTaskScheduler taskScheduler;
+    taskScheduler.SetWorkQueue(workQueue);
+    if (btGetTaskScheduler() != &taskScheduler)
+        btSetTaskScheduler(&taskScheduler);
+    return &taskScheduler;
+}
+#endif
+
 void RemoveCachedGeometryImpl(CollisionGeometryDataCache& cache, Model* model)
 {
     for (auto i = cache.begin(); i != cache.end();)
@@ -147,6 +351,88 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+/// Narrowphase result of an overlap query. Forwards the contact points to the query callback.
+struct PhysicsQueryManifoldResult : public btManifoldResult
+{
+    /// Construct.
+    PhysicsQueryManifoldResult(const btCollisionObjectWrapper* obj0Wrap, const btCollisionObjectWrapper* obj1Wrap,
+        PhysicsQueryCallback& callback) :
+        btManifoldResult(obj0Wrap, obj1Wrap),
+        callback_(callback)
+    {
+    }
+
+    /// Add a contact point.
+    void addContactPoint(const btVector3& normalOnBInWorld, const btVector3& pointInWorld, btScalar depth) override
+    {
+        btManifoldPoint point(btVector3(0, 0, 0), btVector3(0, 0, 0), normalOnBInWorld, depth);
+        point.m_positionWorldOnB = pointInWorld;
+        callback_.addSingleResult(point, m_body0Wrap, m_partId0, m_index0, m_body1Wrap, m_partId1, m_index1);
+    }
+
+    /// Query callback.
+    PhysicsQueryCallback& callback_;
+};
+
+/// Broadphase callback of an overlap query. Runs the narrowphase like btCollisionWorld::contactTest(), but with a dispatcher
+/// owned by the calling thread, as the world dispatcher may not create and release manifolds concurrently.
+struct PhysicsQueryBroadphaseCallback : public btBroadphaseAabbCallback
+{
+    /// Construct.
+    PhysicsQueryBroadphaseCallback(btCollisionObject* queryObject, btDispatcher* dispatcher, const btDispatcherInfo& dispatchInfo,
+        PhysicsQueryCallback& callback) :
+        queryObject_(queryObject),
+        dispatcher_(dispatcher),
+        dispatchInfo_(dispatchInfo),
+        callback_(callback)
+    {
+    }
+
+    /// Test a collision object whose bounding box overlaps the query.
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        auto* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        if (object == queryObject_ || !callback_.needsCollision(object->getBroadphaseHandle()))
+            return true;
+
+        btCollisionObjectWrapper queryWrap(nullptr, queryObject_->getCollisionShape(), queryObject_, queryObject_->getWorldTransform(), -1, -1);
+        btCollisionObjectWrapper objectWrap(nullptr, object->getCollisionShape(), object, object->getWorldTransform(), -1, -1);
+        if (btCollisionAlgorithm* algorithm = dispatcher_->findAlgorithm(&queryWrap, &objectWrap, nullptr, BT_CLOSEST_POINT_ALGORITHMS))
+        {
+            PhysicsQueryManifoldResult result(&queryWrap, &objectWrap, callback_);
+            algorithm->processCollision(&queryWrap, &objectWrap, dispatchInfo_, &result);
+            algorithm->~btCollisionAlgorithm();
+            dispatcher_->freeCollisionAlgorithm(algorithm);
+        }
+        return true;
+    }
+
+    /// Query object.
+    btCollisionObject* queryObject_;
+    /// Dispatcher of the calling thread.
+    btDispatcher* dispatcher_;
+    /// Dispatcher info of the world.
+    const btDispatcherInfo& dispatchInfo_;
+    /// Query callback.
+    PhysicsQueryCallback& callback_;
+};
+
+static void GetRigidBodiesImpl(btCollisionWorld* world, btDispatcher* dispatcher, ea::vector<RigidBody*>& result,
+    btCollisionShape* shape, const Vector3& position, unsigned collisionMask)
+{
+    // The query object does not need to be in the world, as the test only uses the broadphase and the dispatcher
+    btCollisionObject queryObject;
+    queryObject.setCollisionShape(shape);
+    queryObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), ToBtVector3(position)));
+
+    btVector3 aabbMin, aabbMax;
+    shape->getAabb(queryObject.getWorldTransform(), aabbMin, aabbMax);
+
+    PhysicsQueryCallback callback(result, collisionMask);
+    PhysicsQueryBroadphaseCallback broadphaseCallback(&queryObject, dispatcher, world->getDispatchInfo(), callback);
+    world->getBroadphase()->aabbTest(aabbMin, aabbMax, broadphaseCallback);
+}
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -159,12 +445,39 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
-    btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
-
     broadphase_ = ea::make_unique<btDbvtBroadphase>();
-    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
-    world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+
+#ifdef URHO3D_THREADING
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    if (PhysicsWorld::config.multiThreaded_ && workQueue && workQueue->GetNumThreads())
+    {
+        btITaskScheduler* taskScheduler = SetupTaskScheduler(workQueue);
+        multiThreaded_ = true;
+
+        collisionDispatcher_ = ea::make_unique<CollisionDispatcherMt>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+
+        // Small islands are solved in parallel by the pool, large islands by the multithreaded solver
+        solverPool_ = ea::make_unique<btConstraintSolverPoolMt>(taskScheduler->getNumThreads());
+        solver_ = ea::make_unique<btSequentialImpulseConstraintSolverMt>();
+        world_ = ea::make_unique<btDiscreteDynamicsWorldMt>(collisionDispatcher_.get(), broadphase_.get(),
+            static_cast<btConstraintSolverPoolMt*>(solverPool_.get()), solver_.get(), collisionConfiguration_);
+    }
+    else if (PhysicsWorld::config.multiThreaded_)
+        URHO3D_LOGWARNING("No worker threads, using single-threaded physics world");
+#else
+    if (PhysicsWorld::config.multiThreaded_)
+        URHO3D_LOGWARNING("Threading disabled, using single-threaded physics world");
+#endif
+
+    if (!world_)
+    {
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
+
+        solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
+        world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -192,8 +505,10 @@ PhysicsWorld::~PhysicsWorld()
 
     world_.reset();
     solver_.reset();
+    solverPool_.reset();
     broadphase_.reset();
     collisionDispatcher_.reset();
+    queryDispatchers_.clear();
 
     // Delete configuration only if it was the default created by PhysicsWorld
     if (!PhysicsWorld::config.collisionConfig_)
@@ -288,6 +603,11 @@ void PhysicsWorld::Update(float timeStep)
 
     simulating_ = false;
 
+    ApplyDelayedWorldTransforms();
+}
+
+void PhysicsWorld::ApplyDelayedWorldTransforms()
+{
     // Apply delayed (parented) world transforms now
     while (!delayedWorldTransforms_.empty())
     {
@@ -313,6 +633,133 @@ void PhysicsWorld::UpdateCollisions()
     world_->performDiscreteCollisionDetection();
 }
 
+void PhysicsWorld::SaveSnapshot(PhysicsWorldSnapshot& snapshot) const
+{
+    URHO3D_PROFILE("SavePhysicsSnapshot");
+
+    // Bullet state is stored as is, so that restoring does not lose precision
+    snapshot.bodies_.resize(rigidBodies_.size());
+    unsigned numBodies = 0;
+    for (RigidBody* body : rigidBodies_)
+    {
+        const btRigidBody* btBody = body->GetBody();
+        if (!btBody)
+            continue;
+
+        RigidBodySnapshot& state = snapshot.bodies_[numBodies++];
+        state.body_ = body;
+        btBody->getWorldTransform().serializeFloat(state.worldTransform_);
+        btBody->getInterpolationWorldTransform().serializeFloat(state.interpolationWorldTransform_);
+        btBody->getLinearVelocity().serializeFloat(state.linearVelocity_);
+        btBody->getAngularVelocity().serializeFloat(state.angularVelocity_);
+        btBody->getInterpolationLinearVelocity().serializeFloat(state.interpolationLinearVelocity_);
+        btBody->getInterpolationAngularVelocity().serializeFloat(state.interpolationAngularVelocity_);
+        state.activationState_ = btBody->getActivationState();
+        state.deactivationTime_ = btBody->getDeactivationTime();
+    }
+    snapshot.bodies_.resize(numBodies);
+
+    snapshot.constraints_.resize(constraints_.size());
+    unsigned numConstraints = 0;
+    for (Constraint* constraint : constraints_)
+    {
+        const btTypedConstraint* btConstraint = constraint->GetConstraint();
+        if (!btConstraint)
+            continue;
+
+        ConstraintSnapshot& state = snapshot.constraints_[numConstraints++];
+        state.constraint_ = constraint;
+        state.appliedImpulse_ = btConstraint->getAppliedImpulse();
+        state.enabled_ = btConstraint->isEnabled();
+    }
+    snapshot.constraints_.resize(numConstraints);
+
+    snapshot.timeAcc_ = timeAcc_;
+}
+
+void PhysicsWorld::RestoreSnapshot(const PhysicsWorldSnapshot& snapshot)
+{
+    URHO3D_PROFILE("RestorePhysicsSnapshot");
+
+    delayedWorldTransforms_.clear();
+
+    for (const RigidBodySnapshot& state : snapshot.bodies_)
+    {
+        RigidBody* body = state.body_;
+        btRigidBody* btBody = body ? body->GetBody() : nullptr;
+        if (!btBody)
+            continue;
+
+        btTransform transform;
+        transform.deSerializeFloat(state.worldTransform_);
+        btBody->setWorldTransform(transform);
+        transform.deSerializeFloat(state.interpolationWorldTransform_);
+        btBody->setInterpolationWorldTransform(transform);
+
+        btVector3 velocity;
+        velocity.deSerializeFloat(state.linearVelocity_);
+        btBody->setLinearVelocity(velocity);
+        velocity.deSerializeFloat(state.angularVelocity_);
+        btBody->setAngularVelocity(velocity);
+        velocity.deSerializeFloat(state.interpolationLinearVelocity_);
+        btBody->setInterpolationLinearVelocity(velocity);
+        velocity.deSerializeFloat(state.interpolationAngularVelocity_);
+        btBody->setInterpolationAngularVelocity(velocity);
+
+        btBody->forceActivationState(state.activationState_);
+        btBody->setDeactivationTime(state.deactivationTime_);
+        btBody->clearForces();
+
+        // Also for sleeping bodies, which the motion state callback skips
+        body->ApplyBodyWorldTransform(btBody->getWorldTransform());
+    }
+
+    for (const ConstraintSnapshot& state : snapshot.constraints_)
+    {
+        Constraint* constraint = state.constraint_;
+        btTypedConstraint* btConstraint = constraint ? constraint->GetConstraint() : nullptr;
+        if (!btConstraint)
+            continue;
+
+        btConstraint->internalSetAppliedImpulse(state.appliedImpulse_);
+        btConstraint->setEnabled(state.enabled_);
+    }
+
+    timeAcc_ = snapshot.timeAcc_;
+    ApplyDelayedWorldTransforms();
+
+    // Cached contacts would warm start the solver differently on each restore, so drop them. The overlapping pairs stay
+    btOverlappingPairCache* pairCache = world_->getBroadphase()->getOverlappingPairCache();
+    btBroadphasePairArray& pairs = pairCache->getOverlappingPairArray();
+    for (int i = 0; i < pairs.size(); ++i)
+        pairCache->cleanOverlappingPair(pairs[i], world_->getDispatcher());
+
+    solver_->reset();
+    if (solverPool_)
+        solverPool_->reset();
+    world_->updateAabbs();
+}
+
+void PhysicsWorld::Resimulate(unsigned numSteps)
+{
+    URHO3D_PROFILE("ResimulatePhysics");
+
+    const float internalTimeStep = 1.0f / fps_;
+
+    delayedWorldTransforms_.clear();
+    simulating_ = true;
+    resimulating_ = true;
+
+    // Exactly one fixed step per call, regardless of the time left over from interpolated updates
+    for (unsigned i = 0; i < numSteps; ++i)
+        world_->stepSimulation(internalTimeStep, 1, internalTimeStep);
+
+    resimulating_ = false;
+    simulating_ = false;
+
+    ApplyDelayedWorldTransforms();
+}
+
 void PhysicsWorld::SetFps(int fps)
 {
     fps_ = (unsigned)Clamp(fps, 1, 1000);
@@ -407,29 +854,28 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
+    RaycastSingleImpl(world_.get(), result, ray, maxDistance, collisionMask);
+}
 
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+void PhysicsWorld::RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<PhysicsRaycastQuery>& queries)
+{
+    URHO3D_PROFILE("PhysicsRaycastSingleBatch");
 
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
+    result.resize(queries.size());
+
+    // Bullet queries only read the world, so they can run concurrently as long as the world is not stepped or modified
+    const btCollisionWorld* world = world_.get();
+    ProcessRange(queries.size(), MIN_THREADED_QUERIES, QUERIES_PER_WORK_ITEM, [&](unsigned begin, unsigned end)
     {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsRaycastQuery& query = queries[i];
+            if (query.radius_ > 0.0f)
+                SphereCastImpl(world, result[i], query.ray_, query.radius_, query.maxDistance_, query.collisionMask_);
+            else
+                RaycastSingleImpl(world, result[i], query.ray_, query.maxDistance_, query.collisionMask_);
+        }
+    });
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
@@ -491,33 +937,7 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
-    btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
-
-    if (convexCallback.hasHit())
-    {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
-    }
-    else
-    {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+    SphereCastImpl(world_.get(), result, ray, radius, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -588,30 +1008,59 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
 
     URHO3D_PROFILE("PhysicsConvexCast");
 
-    btCollisionWorld::ClosestConvexResultCallback convexCallback(ToBtVector3(startPos), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    ConvexCastImpl(world_.get(), result, static_cast<btConvexShape*>(shape), startPos, startRot, endPos, endRot, collisionMask);
+}
 
-    world_->convexSweepTest(static_cast<btConvexShape*>(shape), btTransform(ToBtQuaternion(startRot),
-            convexCallback.m_convexFromWorld), btTransform(ToBtQuaternion(endRot), convexCallback.m_convexToWorld),
-        convexCallback);
+void PhysicsWorld::ConvexCastBatch(ea::vector<PhysicsRaycastResult>& result, CollisionShape* shape,
+    const ea::vector<PhysicsConvexCastQuery>& queries)
+{
+    result.resize(queries.size());
 
-    if (convexCallback.hasHit())
+    btCollisionShape* collisionShape = shape ? shape->GetCollisionShape() : nullptr;
+    if (!collisionShape || !collisionShape->isConvex())
     {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - startPos).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
+        URHO3D_LOGERROR("Null or non-convex collision shape for convex cast");
+        for (PhysicsRaycastResult& queryResult : result)
+            ClearRaycastResult(queryResult);
+        return;
     }
-    else
+
+    URHO3D_PROFILE("PhysicsConvexCastBatch");
+
+    // If shape is attached in a rigidbody, set its collision group temporarily to 0 to make sure it is not returned in the sweep results
+    auto* bodyComp = shape->GetComponent<RigidBody>();
+    btRigidBody* body = bodyComp ? bodyComp->GetBody() : nullptr;
+    btBroadphaseProxy* proxy = body ? body->getBroadphaseProxy() : nullptr;
+    short group = 0;
+    if (proxy)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
+        group = proxy->m_collisionFilterGroup;
+        proxy->m_collisionFilterGroup = 0;
     }
+
+    // Take the shape's offset position & rotation into account
+    Node* shapeNode = shape->GetNode();
+    const Vector3 scale = shapeNode ? shapeNode->GetWorldScale() : Vector3::ONE;
+    const Vector3& offsetPos = shape->GetPosition();
+    const Quaternion& offsetRot = shape->GetRotation();
+    const auto* convexShape = static_cast<btConvexShape*>(collisionShape);
+
+    const btCollisionWorld* world = world_.get();
+    ProcessRange(queries.size(), MIN_THREADED_QUERIES, QUERIES_PER_WORK_ITEM, [&](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsConvexCastQuery& query = queries[i];
+            const Vector3 startPos = Matrix3x4(query.startPos_, query.startRot_, scale) * offsetPos;
+            const Vector3 endPos = Matrix3x4(query.endPos_, query.endRot_, scale) * offsetPos;
+            ConvexCastImpl(world, result[i], convexShape, startPos, query.startRot_ * offsetRot, endPos,
+                query.endRot_ * offsetRot, query.collisionMask_);
+        }
+    });
+
+    // Restore the collision group
+    if (proxy)
+        proxy->m_collisionFilterGroup = group;
 }
 
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
@@ -658,6 +1107,32 @@ void PhysicsWorld::GetRigidBodies(ea::vector<RigidBody*>& result, const Bounding
     world_->removeRigidBody(tempRigidBody.get());
 }
 
+void PhysicsWorld::GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets,
+    const ea::vector<Sphere>& spheres, unsigned collisionMask)
+{
+    URHO3D_PROFILE("PhysicsSphereQueryBatch");
+
+    btCollisionWorld* world = world_.get();
+    GetRigidBodiesBatch(result, resultOffsets, spheres.size(), [&](unsigned index, btDispatcher* dispatcher, ea::vector<RigidBody*>& bodies)
+    {
+        btSphereShape sphereShape(spheres[index].radius_);
+        GetRigidBodiesImpl(world, dispatcher, bodies, &sphereShape, spheres[index].center_, collisionMask);
+    });
+}
+
+void PhysicsWorld::GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets,
+    const ea::vector<BoundingBox>& boxes, unsigned collisionMask)
+{
+    URHO3D_PROFILE("PhysicsBoxQueryBatch");
+
+    btCollisionWorld* world = world_.get();
+    GetRigidBodiesBatch(result, resultOffsets, boxes.size(), [&](unsigned index, btDispatcher* dispatcher, ea::vector<RigidBody*>& bodies)
+    {
+        btBoxShape boxShape(ToBtVector3(boxes[index].HalfSize()));
+        GetRigidBodiesImpl(world, dispatcher, bodies, &boxShape, boxes[index].Center(), collisionMask);
+    });
+}
+
 void PhysicsWorld::GetRigidBodies(ea::vector<RigidBody*>& result, const RigidBody* body)
 {
     URHO3D_PROFILE("PhysicsBodyQuery");
@@ -687,18 +1162,17 @@ void PhysicsWorld::GetCollidingBodies(ea::vector<RigidBody*>& result, const Rigi
 
     result.clear();
 
-    for (auto i = currentCollisions_.begin();
-         i != currentCollisions_.end(); ++i)
+    for (const PhysicsCollisionPair& pair : currentCollisions_)
     {
-        if (i->first.first == body)
+        if (pair.bodyA_ == body)
         {
-            if (i->first.second)
-                result.push_back(i->first.second);
+            if (pair.weakBodyB_)
+                result.push_back(pair.weakBodyB_);
         }
-        else if (i->first.second == body)
+        else if (pair.bodyB_ == body)
         {
-            if (i->first.first)
-                result.push_back(i->first.first);
+            if (pair.weakBodyA_)
+                result.push_back(pair.weakBodyA_);
         }
     }
 }
@@ -833,64 +1307,23 @@ void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE("SendCollisionEvents");
 
-    currentCollisions_.clear();
+    previousCollisions_.swap(currentCollisions_);
     physicsCollisionData_.clear();
     nodeCollisionData_.clear();
 
-    int numManifolds = collisionDispatcher_->getNumManifolds();
+    GatherCollisions();
 
-    if (numManifolds)
+    if (!currentCollisions_.empty())
     {
         physicsCollisionData_[PhysicsCollision::P_WORLD] = this;
 
-        for (int i = 0; i < numManifolds; ++i)
-        {
-            btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
-            // First check that there are actual contacts, as the manifold exists also when objects are close but not touching
-            if (!contactManifold->getNumContacts())
-                continue;
-
-            const btCollisionObject* objectA = contactManifold->getBody0();
-            const btCollisionObject* objectB = contactManifold->getBody1();
-
-            auto* bodyA = static_cast<RigidBody*>(objectA->getUserPointer());
-            auto* bodyB = static_cast<RigidBody*>(objectB->getUserPointer());
-            // If it's not a rigidbody, maybe a ghost object
-            if (!bodyA || !bodyB)
-                continue;
-
-            // Skip collision event signaling if both objects are static, or if collision event mode does not match
-            if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                !bodyA->IsActive() && !bodyB->IsActive())
-                continue;
-
-            WeakPtr<RigidBody> bodyWeakA(bodyA);
-            WeakPtr<RigidBody> bodyWeakB(bodyB);
-
-            // First only store the collision pair as weak pointers and the manifold pointer, so user code can safely destroy
-            // objects during collision event handling
-            ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> > bodyPair;
-            if (bodyA < bodyB)
-            {
-                bodyPair = ea::make_pair(bodyWeakA, bodyWeakB);
-                currentCollisions_[bodyPair].manifold_ = contactManifold;
-            }
-            else
-            {
-                bodyPair = ea::make_pair(bodyWeakB, bodyWeakA);
-                currentCollisions_[bodyPair].flippedManifold_ = contactManifold;
-            }
-        }
-
-        for (auto i = currentCollisions_.begin();
-             i != currentCollisions_.end(); ++i)
+        // Dispatch in the sorted order. The pairs are not modified by event handlers, and the weak pointers tell
+        // whether the bodies still exist
+        for (unsigned i = 0; i < currentCollisions_.size(); ++i)
         {
-            RigidBody* bodyA = i->first.first;
-            RigidBody* bodyB = i->first.second;
+            const PhysicsCollisionPair& pair = currentCollisions_[i];
+            RigidBody* bodyA = pair.weakBodyA_;
+            RigidBody* bodyB = pair.weakBodyB_;
             if (!bodyA || !bodyB)
                 continue;
 
@@ -900,7 +1333,7 @@ void PhysicsWorld::SendCollisionEvents()
             WeakPtr<Node> nodeWeakB(nodeB);
 
             bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
-            bool newCollision = !previousCollisions_.contains(i->first);
+            bool newCollision = !ContainsCollisionPair(previousCollisions_, pair);
 
             physicsCollisionData_[PhysicsCollision::P_NODEA] = nodeA;
             physicsCollisionData_[PhysicsCollision::P_NODEB] = nodeB;
@@ -908,35 +1341,7 @@ void PhysicsWorld::SendCollisionEvents()
             physicsCollisionData_[PhysicsCollision::P_BODYB] = bodyB;
             physicsCollisionData_[PhysicsCollision::P_TRIGGER] = trigger;
 
-            contacts_.Clear();
-
-            // "Pointers not flipped"-manifold, send unmodified normals
-            btPersistentManifold* contactManifold = i->second.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            // "Pointers flipped"-manifold, flip normals also
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-
+            contacts_.SetData(&collisionContacts_[pair.contactsOffset_], pair.contactsSize_);
             physicsCollisionData_[PhysicsCollision::P_CONTACTS] = contacts_.GetBuffer();
 
             // Send separate collision start event if collision is new
@@ -944,13 +1349,13 @@ void PhysicsWorld::SendCollisionEvents()
             {
                 SendEvent(E_PHYSICSCOLLISIONSTART, physicsCollisionData_);
                 // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
                     continue;
             }
 
             // Then send the ongoing collision event
             SendEvent(E_PHYSICSCOLLISION, physicsCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+            if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
                 continue;
 
             nodeCollisionData_[NodeCollision::P_BODY] = bodyA;
@@ -962,40 +1367,16 @@ void PhysicsWorld::SendCollisionEvents()
             if (newCollision)
             {
                 nodeA->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
                     continue;
             }
 
             nodeA->SendEvent(E_NODECOLLISION, nodeCollisionData_);
-            if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+            if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
                 continue;
 
             // Flip perspective to body B
-            contacts_.Clear();
-            contactManifold = i->second.manifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(-ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
-            contactManifold = i->second.flippedManifold_;
-            if (contactManifold)
-            {
-                for (int j = 0; j < contactManifold->getNumContacts(); ++j)
-                {
-                    btManifoldPoint& point = contactManifold->getContactPoint(j);
-                    contacts_.WriteVector3(ToVector3(point.m_positionWorldOnB));
-                    contacts_.WriteVector3(ToVector3(point.m_normalWorldOnB));
-                    contacts_.WriteFloat(point.m_distance1);
-                    contacts_.WriteFloat(point.m_appliedImpulse);
-                }
-            }
+            contacts_.SetData(&collisionContacts_[pair.contactsOffset_ + pair.contactsSize_], pair.contactsSize_);
 
             nodeCollisionData_[NodeCollision::P_BODY] = bodyB;
             nodeCollisionData_[NodeCollision::P_OTHERNODE] = nodeA;
@@ -1005,7 +1386,7 @@ void PhysicsWorld::SendCollisionEvents()
             if (newCollision)
             {
                 nodeB->SendEvent(E_NODECOLLISIONSTART, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
+                if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
                     continue;
             }
 
@@ -1017,62 +1398,222 @@ void PhysicsWorld::SendCollisionEvents()
     {
         physicsCollisionData_[PhysicsCollisionEnd::P_WORLD] = this;
 
-        for (auto
-                 i = previousCollisions_.begin(); i != previousCollisions_.end(); ++i)
+        for (const PhysicsCollisionPair& pair : previousCollisions_)
         {
-            if (!currentCollisions_.contains(i->first))
-            {
-                RigidBody* bodyA = i->first.first;
-                RigidBody* bodyB = i->first.second;
-                if (!bodyA || !bodyB)
-                    continue;
+            if (ContainsCollisionPair(currentCollisions_, pair))
+                continue;
 
-                bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
+            RigidBody* bodyA = pair.weakBodyA_;
+            RigidBody* bodyB = pair.weakBodyB_;
+            if (!bodyA || !bodyB)
+                continue;
 
-                // Skip collision event signaling if both objects are static, or if collision event mode does not match
-                if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                    !bodyA->IsActive() && !bodyB->IsActive())
-                    continue;
+            bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
+
+            if (!IsCollisionEventEnabled(bodyA, bodyB))
+                continue;
 
-                Node* nodeA = bodyA->GetNode();
-                Node* nodeB = bodyB->GetNode();
-                WeakPtr<Node> nodeWeakA(nodeA);
-                WeakPtr<Node> nodeWeakB(nodeB);
+            Node* nodeA = bodyA->GetNode();
+            Node* nodeB = bodyB->GetNode();
+            WeakPtr<Node> nodeWeakA(nodeA);
+            WeakPtr<Node> nodeWeakB(nodeB);
 
-                physicsCollisionData_[PhysicsCollisionEnd::P_BODYA] = bodyA;
-                physicsCollisionData_[PhysicsCollisionEnd::P_BODYB] = bodyB;
-                physicsCollisionData_[PhysicsCollisionEnd::P_NODEA] = nodeA;
-                physicsCollisionData_[PhysicsCollisionEnd::P_NODEB] = nodeB;
-                physicsCollisionData_[PhysicsCollisionEnd::P_TRIGGER] = trigger;
+            physicsCollisionData_[PhysicsCollisionEnd::P_BODYA] = bodyA;
+            physicsCollisionData_[PhysicsCollisionEnd::P_BODYB] = bodyB;
+            physicsCollisionData_[PhysicsCollisionEnd::P_NODEA] = nodeA;
+            physicsCollisionData_[PhysicsCollisionEnd::P_NODEB] = nodeB;
+            physicsCollisionData_[PhysicsCollisionEnd::P_TRIGGER] = trigger;
 
-                SendEvent(E_PHYSICSCOLLISIONEND, physicsCollisionData_);
-                // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                    continue;
+            SendEvent(E_PHYSICSCOLLISIONEND, physicsCollisionData_);
+            // Skip rest of processing if either of the nodes or bodies is removed as a response to the event
+            if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
+                continue;
 
-                nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyA;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeB;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyB;
-                nodeCollisionData_[NodeCollisionEnd::P_TRIGGER] = trigger;
+            nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyA;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeB;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyB;
+            nodeCollisionData_[NodeCollisionEnd::P_TRIGGER] = trigger;
 
-                nodeA->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
-                if (!nodeWeakA || !nodeWeakB || !i->first.first || !i->first.second)
-                    continue;
+            nodeA->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
+            if (!nodeWeakA || !nodeWeakB || !pair.weakBodyA_ || !pair.weakBodyB_)
+                continue;
 
-                nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyB;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeA;
-                nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyA;
+            nodeCollisionData_[NodeCollisionEnd::P_BODY] = bodyB;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERNODE] = nodeA;
+            nodeCollisionData_[NodeCollisionEnd::P_OTHERBODY] = bodyA;
 
-                nodeB->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
+            nodeB->SendEvent(E_NODECOLLISIONEND, nodeCollisionData_);
+        }
+    }
+}
+
+void PhysicsWorld::GatherCollisions()
+{
+    URHO3D_PROFILE("GatherCollisions");
+
+    // Take one entry per manifold, marking the manifolds that do not produce events with a null body
+    const unsigned numManifolds = static_cast<unsigned>(collisionDispatcher_->getNumManifolds());
+    currentCollisions_.clear();
+    currentCollisions_.resize(numManifolds);
+
+    ProcessRange(numManifolds, MIN_THREADED_MANIFOLDS, MANIFOLDS_PER_WORK_ITEM, [this](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+            // First check that there are actual contacts, as the manifold exists also when objects are close but not touching
+            if (!contactManifold->getNumContacts())
+                continue;
+
+            auto* bodyA = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+            auto* bodyB = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+            // If it's not a rigidbody, maybe a ghost object
+            if (!bodyA || !bodyB || !IsCollisionEventEnabled(bodyA, bodyB))
+                continue;
+
+            PhysicsCollisionPair& pair = currentCollisions_[i];
+            if (bodyA < bodyB)
+            {
+                pair.bodyA_ = bodyA;
+                pair.bodyB_ = bodyB;
+                pair.manifolds_.manifold_ = contactManifold;
+            }
+            else
+            {
+                pair.bodyA_ = bodyB;
+                pair.bodyB_ = bodyA;
+                pair.manifolds_.flippedManifold_ = contactManifold;
             }
         }
+    });
+
+    // Compact, sort and merge the manifolds of the same body pair
+    currentCollisions_.erase(ea::remove_if(currentCollisions_.begin(), currentCollisions_.end(),
+        [](const PhysicsCollisionPair& pair) { return !pair.bodyA_; }), currentCollisions_.end());
+    ea::quick_sort(currentCollisions_.begin(), currentCollisions_.end(), CompareCollisionPairs);
+
+    unsigned numPairs = 0;
+    unsigned contactsSize = 0;
+    for (unsigned i = 0; i < currentCollisions_.size(); ++i)
+    {
+        const PhysicsCollisionPair& source = currentCollisions_[i];
+        if (numPairs && currentCollisions_[numPairs - 1].bodyA_ == source.bodyA_ && currentCollisions_[numPairs - 1].bodyB_ == source.bodyB_)
+        {
+            ManifoldPair& manifolds = currentCollisions_[numPairs - 1].manifolds_;
+            if (source.manifolds_.manifold_)
+                manifolds.manifold_ = source.manifolds_.manifold_;
+            if (source.manifolds_.flippedManifold_)
+                manifolds.flippedManifold_ = source.manifolds_.flippedManifold_;
+            continue;
+        }
+
+        if (numPairs != i)
+            currentCollisions_[numPairs].manifolds_ = source.manifolds_;
+        PhysicsCollisionPair& pair = currentCollisions_[numPairs++];
+        pair.bodyA_ = source.bodyA_;
+        pair.bodyB_ = source.bodyB_;
+    }
+    currentCollisions_.resize(numPairs);
+
+    // Store weak pointers, so user code can safely destroy objects during collision event handling. Also lay out the contact data
+    for (PhysicsCollisionPair& pair : currentCollisions_)
+    {
+        pair.weakBodyA_ = pair.bodyA_;
+        pair.weakBodyB_ = pair.bodyB_;
+
+        unsigned numContacts = 0;
+        if (pair.manifolds_.manifold_)
+            numContacts += pair.manifolds_.manifold_->getNumContacts();
+        if (pair.manifolds_.flippedManifold_)
+            numContacts += pair.manifolds_.flippedManifold_->getNumContacts();
+
+        pair.contactsOffset_ = contactsSize;
+        pair.contactsSize_ = numContacts * CONTACT_DATA_SIZE;
+        contactsSize += 2 * pair.contactsSize_;
+    }
+
+    // Write the contact data from the perspective of both bodies
+    collisionContacts_.resize(contactsSize);
+    ProcessRange(currentCollisions_.size(), MIN_THREADED_MANIFOLDS, MANIFOLDS_PER_WORK_ITEM, [this](unsigned begin, unsigned end)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            const PhysicsCollisionPair& pair = currentCollisions_[i];
+            MemoryBuffer dest(&collisionContacts_[pair.contactsOffset_], 2 * pair.contactsSize_);
+
+            // "Pointers not flipped"-manifold, send unmodified normals. "Pointers flipped"-manifold, flip normals also
+            WriteContacts(dest, pair.manifolds_.manifold_, false);
+            WriteContacts(dest, pair.manifolds_.flippedManifold_, true);
+            // Same from the perspective of body B
+            WriteContacts(dest, pair.manifolds_.manifold_, true);
+            WriteContacts(dest, pair.manifolds_.flippedManifold_, false);
+        }
+    });
+}
+
+void PhysicsWorld::GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets, unsigned numQueries,
+    const std::function<void(unsigned, btDispatcher*, ea::vector<RigidBody*>&)>& query)
+{
+    if (batchQueryResults_.size() < numQueries)
+        batchQueryResults_.resize(numQueries);
+
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    const bool threaded = workQueue && workQueue->GetNumThreads() && numQueries >= MIN_THREADED_QUERIES;
+
+    // Each thread runs the narrowphase with its own dispatcher. They share the collision configuration, whose pool
+    // allocators are locked in thread-safe Bullet builds
+    const unsigned numDispatchers = threaded ? workQueue->GetNumThreads() + 1 : 1;
+    while (queryDispatchers_.size() < numDispatchers)
+    {
+        auto* dispatcher = new btCollisionDispatcher(collisionConfiguration_);
+        btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher);
+        queryDispatchers_.emplace_back(dispatcher);
+    }
+
+    const auto processQueries = [&](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        btDispatcher* dispatcher = queryDispatchers_[threadIndex].get();
+        for (unsigned i = begin; i < end; ++i)
+        {
+            batchQueryResults_[i].clear();
+            query(i, dispatcher, batchQueryResults_[i]);
+        }
+    };
+
+    if (threaded)
+        workQueue->ParallelFor(numQueries, QUERIES_PER_WORK_ITEM, processQueries);
+    else
+        processQueries(0, numQueries, 0);
+
+    // Flatten the per-query results
+    resultOffsets.resize(numQueries + 1);
+    unsigned numResults = 0;
+    for (unsigned i = 0; i < numQueries; ++i)
+    {
+        resultOffsets[i] = numResults;
+        numResults += batchQueryResults_[i].size();
     }
+    resultOffsets[numQueries] = numResults;
+
+    result.clear();
+    result.reserve(numResults);
+    for (unsigned i = 0; i < numQueries; ++i)
+        result.insert(result.end(), batchQueryResults_[i].begin(), batchQueryResults_[i].end());
+}
 
-    previousCollisions_ = currentCollisions_;
+void PhysicsWorld::ProcessRange(unsigned count, unsigned minThreadedCount, unsigned chunkSize,
+    const std::function<void(unsigned, unsigned)>& callback)
+{
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    if (workQueue && workQueue->GetNumThreads() && count >= minThreadedCount)
+    {
+        workQueue->ParallelFor(count, chunkSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            callback(begin, end);
+        });
+    }
+    else
+        callback(0, count);
 }
 
 void RegisterPhysicsLibrary(Context* context)
@@ -26,11 +26,13 @@
 
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
 
 #include <Bullet/LinearMath/btIDebugDraw.h>
+#include <Bullet/LinearMath/btTransform.h>
 
 class btCollisionConfiguration;
 class btCollisionShape;
@@ -49,7 +51,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -78,6 +79,34 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Physics raycast or sphere cast query for batched execution.
+struct URHO3D_API PhysicsRaycastQuery
+{
+    /// Ray.
+    Ray ray_;
+    /// Maximum distance along the ray.
+    float maxDistance_{};
+    /// Sphere radius. Zero casts a ray.
+    float radius_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Physics convex cast query for batched execution.
+struct URHO3D_API PhysicsConvexCastQuery
+{
+    /// Start position.
+    Vector3 startPos_;
+    /// Start rotation.
+    Quaternion startRot_;
+    /// End position.
+    Vector3 endPos_;
+    /// End rotation.
+    Quaternion endRot_;
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -107,16 +136,83 @@ struct ManifoldPair
     btPersistentManifold* flippedManifold_;
 };
 
+/// Colliding rigid body pair gathered from the contact manifolds of a simulation step.
+struct PhysicsCollisionPair
+{
+    /// Rigid body with the lower address. Only used as a key, may be already destroyed.
+    RigidBody* bodyA_{};
+    /// Rigid body with the higher address. Only used as a key, may be already destroyed.
+    RigidBody* bodyB_{};
+    /// Weak pointer to body A, expires if the body is removed.
+    WeakPtr<RigidBody> weakBodyA_;
+    /// Weak pointer to body B, expires if the body is removed.
+    WeakPtr<RigidBody> weakBodyB_;
+    /// Contact manifolds.
+    ManifoldPair manifolds_;
+    /// Offset of the contact data in the contact buffer. The contacts from the perspective of body A are followed by the contacts from the perspective of body B.
+    unsigned contactsOffset_{};
+    /// Size of the contact data from the perspective of one body.
+    unsigned contactsSize_{};
+};
+
+/// Saved simulation state of a rigid body.
+struct RigidBodySnapshot
+{
+    /// Rigid body.
+    WeakPtr<RigidBody> body_;
+    /// World transform.
+    btTransformFloatData worldTransform_;
+    /// World transform used for interpolation.
+    btTransformFloatData interpolationWorldTransform_;
+    /// Linear velocity.
+    btVector3FloatData linearVelocity_;
+    /// Angular velocity.
+    btVector3FloatData angularVelocity_;
+    /// Linear velocity used for interpolation.
+    btVector3FloatData interpolationLinearVelocity_;
+    /// Angular velocity used for interpolation.
+    btVector3FloatData interpolationAngularVelocity_;
+    /// Activation state.
+    int activationState_{};
+    /// Time below the sleep thresholds.
+    float deactivationTime_{};
+};
+
+/// Saved simulation state of a constraint.
+struct ConstraintSnapshot
+{
+    /// Constraint.
+    WeakPtr<Constraint> constraint_;
+    /// Impulse applied on the last step, used for breaking.
+    float appliedImpulse_{};
+    /// Enabled flag, cleared when the constraint breaks.
+    bool enabled_{};
+};
+
+/// Saved simulation state of a physics world. Saving into the same snapshot again reuses its memory.
+struct PhysicsWorldSnapshot
+{
+    /// Rigid body states.
+    ea::vector<RigidBodySnapshot> bodies_;
+    /// Constraint states.
+    ea::vector<ConstraintSnapshot> constraints_;
+    /// Time accumulator for non-interpolated mode.
+    float timeAcc_{};
+};
+
 /// Custom overrides of physics internals. To use overrides, must be set before the physics component is created.
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multiThreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Use the multithreaded dynamics world, which runs collision detection, island solving and integration on the work queue. Requires threading support and worker threads.
+    bool multiThreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -166,6 +262,12 @@ public:
     void Update(float timeStep);
     /// Refresh collisions only without updating dynamics.
     void UpdateCollisions();
+    /// Save the simulation state of the rigid bodies and constraints. Does not allocate memory when the snapshot has been used for a world of the same size before.
+    void SaveSnapshot(PhysicsWorldSnapshot& snapshot) const;
+    /// Restore the simulation state from a snapshot and move the scene nodes accordingly. Rigid bodies and constraints created after the snapshot keep their state. Contact caches are reset, so that resimulating from the same snapshot gives the same result.
+    void RestoreSnapshot(const PhysicsWorldSnapshot& snapshot);
+    /// Step the simulation by a number of fixed steps of 1 / fps seconds. Sends the same events as the automatic update.
+    void Resimulate(unsigned numSteps);
     /// Set simulation substeps per second.
     /// @property
     void SetFps(int fps);
@@ -209,12 +311,20 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform raycasts and sphere casts in parallel and return the closest hit of each query, in the same order as the queries. The world must not be modified during the call.
+    void RaycastSingleBatch(ea::vector<PhysicsRaycastResult>& result, const ea::vector<PhysicsRaycastQuery>& queries);
+    /// Perform swept convex tests using a user-supplied collision shape in parallel and return the first hit of each query, in the same order as the queries.
+    void ConvexCastBatch(ea::vector<PhysicsRaycastResult>& result, CollisionShape* shape, const ea::vector<PhysicsConvexCastQuery>& queries);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
     void GetRigidBodies(ea::vector<RigidBody*>& result, const Sphere& sphere, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Return rigid bodies by a box query.
     void GetRigidBodies(ea::vector<RigidBody*>& result, const BoundingBox& box, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Return rigid bodies by sphere queries performed in parallel. The bodies of query i are result[resultOffsets[i]] to result[resultOffsets[i + 1] - 1].
+    void GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets, const ea::vector<Sphere>& spheres, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Return rigid bodies by box queries performed in parallel. The bodies of query i are result[resultOffsets[i]] to result[resultOffsets[i + 1] - 1].
+    void GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets, const ea::vector<BoundingBox>& boxes, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Return rigid bodies by contact test with the specified body. It needs to be active to return all contacts reliably.
     void GetRigidBodies(ea::vector<RigidBody*>& result, const RigidBody* body);
     /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
@@ -255,6 +365,10 @@ public:
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return whether the simulation runs on the work queue.
+    /// @property
+    bool IsMultiThreaded() const { return multiThreaded_; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
@@ -300,6 +414,9 @@ public:
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
 
+    /// Return whether is currently resimulating steps, for example to replay inputs after restoring a snapshot.
+    bool IsResimulating() const { return resimulating_; }
+
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
 
@@ -314,17 +431,30 @@ private:
     void PreStep(float timeStep);
     /// Trigger update after each physics simulation step.
     void PostStep(float timeStep);
+    /// Apply the world transforms of parented rigid bodies stored during the simulation.
+    void ApplyDelayedWorldTransforms();
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Gather the colliding rigid body pairs and their contact data from the contact manifolds.
+    void GatherCollisions();
+    /// Run a callback for index range [0, count), in parallel chunks if the range has at least the minimum number of elements.
+    void ProcessRange(unsigned count, unsigned minThreadedCount, unsigned chunkSize, const std::function<void(unsigned, unsigned)>& callback);
+    /// Perform overlap queries in parallel and flatten the results. The query callback collects the bodies of one query using the dispatcher of the calling thread.
+    void GetRigidBodiesBatch(ea::vector<RigidBody*>& result, ea::vector<unsigned>& resultOffsets, unsigned numQueries,
+        const std::function<void(unsigned, btDispatcher*, ea::vector<RigidBody*>&)>& query);
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
     /// Bullet collision dispatcher.
     ea::unique_ptr<btDispatcher> collisionDispatcher_;
+    /// Bullet collision dispatchers for the narrowphase of overlap query batches, one per thread.
+    ea::vector<ea::unique_ptr<btDispatcher> > queryDispatchers_;
     /// Bullet collision broadphase.
     ea::unique_ptr<btBroadphaseInterface> broadphase_;
     /// Bullet constraint solver.
     ea::unique_ptr<btConstraintSolver> solver_;
+    /// Bullet constraint solver pool for the islands solved in parallel. Only used by the multithreaded world.
+    ea::unique_ptr<btConstraintSolver> solverPool_;
     /// Bullet physics world.
     ea::unique_ptr<btDiscreteDynamicsWorld> world_;
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
@@ -335,10 +465,14 @@ private:
     ea::vector<CollisionShape*> collisionShapes_;
     /// Constraints in the world.
     ea::vector<Constraint*> constraints_;
-    /// Collision pairs on this frame.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
-    /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
-    ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
+    /// Collision pairs on this frame, sorted by rigid body addresses.
+    ea::vector<PhysicsCollisionPair> currentCollisions_;
+    /// Collision pairs on the previous frame, sorted by rigid body addresses. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
+    ea::vector<PhysicsCollisionPair> previousCollisions_;
+    /// Contact data of the collision pairs on this frame.
+    ea::vector<unsigned char> collisionContacts_;
+    /// Per-query results of batched overlap queries.
+    ea::vector<ea::vector<RigidBody*> > batchQueryResults_;
     /// Delayed (parented) world transform assignments.
     ea::unordered_map<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
@@ -371,6 +505,10 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Multithreaded world flag.
+    bool multiThreaded_{};
+    /// Resimulating flag.
+    bool resimulating_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
@@ -164,6 +164,11 @@ void RigidBody::setWorldTransform(const btTransform& worldTrans)
     if (!body_->isActive()) // Fix #2491
         return;
 
+    ApplyBodyWorldTransform(worldTrans);
+}
+
+void RigidBody::ApplyBodyWorldTransform(const btTransform& worldTrans)
+{
     Quaternion newWorldRotation = ToQuaternion(worldTrans.getRotation());
     Vector3 newWorldPosition = ToVector3(worldTrans.getOrigin()) - newWorldRotation * centerOfMass_;
     RigidBody* parentRigidBody = nullptr;
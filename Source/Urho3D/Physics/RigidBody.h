@@ -284,6 +284,8 @@ public:
 
     /// Apply new world transform after a simulation step. Called internally.
     void ApplyWorldTransform(const Vector3& newWorldPosition, const Quaternion& newWorldRotation);
+    /// Apply a Bullet world transform to the scene node, delayed if parented to another rigid body. Called internally.
+    void ApplyBodyWorldTransform(const btTransform& worldTrans);
     /// Update mass and inertia to the Bullet rigid body. Readd body to world if necessary: if was in world and the Bullet collision shape to use changed.
     void UpdateMass();
     /// Update gravity parameters to the Bullet rigid body.
@@ -31,11 +31,39 @@
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 
+#include <EASTL/heap.h>
+
 #include "../DebugNew.h"
 
 namespace Urho3D
 {
 
+/// Worker thread of the background loader.
+class BackgroundLoaderThread : public Thread
+{
+public:
+    /// Construct.
+    explicit BackgroundLoaderThread(BackgroundLoader* loader) :
+        loader_(loader)
+    {
+    }
+
+    /// Load queued resources until stopped.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            // No resources to load found
+            if (!loader_->LoadNextResource())
+                Time::Sleep(5);
+        }
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* loader_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
     owner_(owner)
 {
@@ -43,72 +71,97 @@ BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
 
 BackgroundLoader::~BackgroundLoader()
 {
+    StopThreads();
+
     MutexLock lock(backgroundLoadMutex_);
 
     backgroundLoadQueue_.clear();
+    pendingResources_.clear();
 }
 
-void BackgroundLoader::ThreadFunction()
+void BackgroundLoader::SetNumThreads(unsigned num)
 {
-    while (shouldRun_)
+    num = Max(num, 1U);
+
+    // The worker threads start more threads when they queue dependencies, so the thread vector is only changed under the mutex
+    ea::vector<ea::unique_ptr<BackgroundLoaderThread> > oldThreads;
     {
-        backgroundLoadMutex_.Acquire();
+        MutexLock lock(backgroundLoadMutex_);
+        if (num == numThreads_)
+            return;
 
-        // Search for a queued resource that has not been loaded yet
-        auto i = backgroundLoadQueue_.begin();
-        while (i != backgroundLoadQueue_.end())
-        {
-            if (i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
-        }
+        numThreads_ = num;
+        oldThreads.swap(threads_);
+    }
 
-        if (i == backgroundLoadQueue_.end())
-        {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
-        }
-        else
-        {
-            BackgroundLoadItem& item = i->second;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
-
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+    if (oldThreads.empty())
+        return;
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.size())
-            {
-                for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
-                {
-                    auto j = backgroundLoadQueue_.find(*i);
-                    if (j != backgroundLoadQueue_.end())
-                        j->second.dependencies_.erase(key);
-                }
+    // Running threads finish their current resource before stopping, for which they need the mutex
+    for (auto& thread : oldThreads)
+        thread->Stop();
 
-                item.dependents_.clear();
-            }
+    MutexLock lock(backgroundLoadMutex_);
+    StartThreads();
+}
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+bool BackgroundLoader::LoadNextResource()
+{
+    backgroundLoadMutex_.Acquire();
+
+    // Take the highest priority resource that is still waiting. Entries of removed or raised resources are skipped
+    BackgroundLoadItem* item = nullptr;
+    while (!pendingResources_.empty() && !item)
+    {
+        ea::pop_heap(pendingResources_.begin(), pendingResources_.end());
+        const PendingResource pending = pendingResources_.back();
+        pendingResources_.pop_back();
+
+        auto i = backgroundLoadQueue_.find(pending.key_);
+        if (i != backgroundLoadQueue_.end() && i->second.priority_ == pending.priority_
+            && i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+            item = &i->second;
+    }
+
+    if (!item)
+    {
+        backgroundLoadMutex_.Release();
+        return false;
+    }
+
+    // Claim the resource for this thread. We can be sure that the item is not removed from the queue as long as it is in the
+    // "queued" or "loading" state
+    Resource* resource = item->resource_;
+    resource->SetAsyncLoadState(ASYNC_LOADING);
+    backgroundLoadMutex_.Release();
+
+    bool success = false;
+    SharedPtr<File> file = owner_->GetFile(resource->GetName(), item->sendEventOnFailure_);
+    if (file)
+        success = resource->BeginLoad(*file);
+
+    // Process dependencies now
+    // Need to lock the queue again when manipulating other entries
+    ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
+    backgroundLoadMutex_.Acquire();
+    if (item->dependents_.size())
+    {
+        for (auto i = item->dependents_.begin(); i != item->dependents_.end(); ++i)
+        {
+            auto j = backgroundLoadQueue_.find(*i);
+            if (j != backgroundLoadQueue_.end())
+                j->second.dependencies_.erase(key);
         }
+
+        item->dependents_.clear();
     }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    backgroundLoadMutex_.Release();
+    return true;
 }
 
-bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller)
+bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash nameHash(name);
     ea::pair<StringHash, StringHash> key = ea::make_pair(type, nameHash);
@@ -117,7 +170,10 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
 
     // Check if already exists in the queue
     if (backgroundLoadQueue_.find(key) != backgroundLoadQueue_.end())
+    {
+        RaisePriority(key, priority);
         return false;
+    }
 
     BackgroundLoadItem& item = backgroundLoadQueue_[key];
     item.sendEventOnFailure_ = sendEventOnFailure;
@@ -157,15 +213,20 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
             BackgroundLoadItem& callerItem = j->second;
             item.dependents_.insert(callerKey);
             callerItem.dependencies_.insert(key);
+
+            // Dependencies are needed as soon as the caller
+            priority = Max(priority, callerItem.priority_);
         }
         else
             URHO3D_LOGWARNING("Resource " + caller->GetName() +
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
-    if (!IsStarted())
-        Run();
+    item.priority_ = priority;
+    PushPendingResource(key, priority);
+
+    // Start the background loader threads now
+    StartThreads();
 
     return true;
 }
@@ -180,6 +241,9 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
         key);
     if (i != backgroundLoadQueue_.end())
     {
+        // Needed right now, so load it and its dependencies before everything else
+        RaisePriority(key, M_MAX_INT);
+
         backgroundLoadMutex_.Release();
 
         {
@@ -218,7 +282,7 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
 
 void BackgroundLoader::FinishResources(int maxMs)
 {
-    if (IsStarted())
+    if (!threads_.empty())
     {
         HiresTimer timer;
 
@@ -257,6 +321,48 @@ unsigned BackgroundLoader::GetNumQueuedResources() const
     return backgroundLoadQueue_.size();
 }
 
+void BackgroundLoader::PushPendingResource(const ea::pair<StringHash, StringHash>& key, int priority)
+{
+    pendingResources_.push_back(PendingResource{ priority, queueOrder_++, key });
+    ea::push_heap(pendingResources_.begin(), pendingResources_.end());
+}
+
+void BackgroundLoader::RaisePriority(const ea::pair<StringHash, StringHash>& key, int priority)
+{
+    auto i = backgroundLoadQueue_.find(key);
+    if (i == backgroundLoadQueue_.end() || i->second.priority_ >= priority)
+        return;
+
+    BackgroundLoadItem& item = i->second;
+    item.priority_ = priority;
+    if (item.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
+        PushPendingResource(key, priority);
+
+    for (const auto& dependency : item.dependencies_)
+        RaisePriority(dependency, priority);
+}
+
+void BackgroundLoader::StartThreads()
+{
+    if (!threads_.empty())
+        return;
+
+    for (unsigned i = 0; i < numThreads_; ++i)
+    {
+        auto thread = ea::make_unique<BackgroundLoaderThread>(this);
+        thread->SetName(Format("ResourceLoader{}", i));
+        thread->Run();
+        threads_.push_back(ea::move(thread));
+    }
+}
+
+void BackgroundLoader::StopThreads()
+{
+    for (auto& thread : threads_)
+        thread->Stop();
+    threads_.clear();
+}
+
 void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
 {
     Resource* resource = item.resource_;
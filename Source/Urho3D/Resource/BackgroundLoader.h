@@ -23,7 +23,9 @@
 #pragma once
 
 #include <EASTL/hash_set.h>
+#include <EASTL/unique_ptr.h>
 #include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
 
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
@@ -33,6 +35,7 @@
 namespace Urho3D
 {
 
+class BackgroundLoaderThread;
 class Resource;
 class ResourceCache;
 
@@ -47,24 +50,26 @@ struct URHO3D_API BackgroundLoadItem
     ea::hash_set<ea::pair<StringHash, StringHash> > dependents_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
+    /// Load priority, higher is loaded first.
+    int priority_{};
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
+/// Background loader of resources. Owned by the ResourceCache. Queued resources are loaded by a pool of worker threads in the order of priority.
 /// @nobind
-class URHO3D_API BackgroundLoader : public RefCounted, public Thread
+class URHO3D_API BackgroundLoader : public RefCounted
 {
 public:
     /// Construct.
     explicit BackgroundLoader(ResourceCache* owner);
-
-    /// Destruct. Forcibly clear the load queue.
+    /// Destruct. Stop the worker threads and forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
-    void ThreadFunction() override;
-
-    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
-    bool QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller);
+    /// Set number of worker threads. Threads are started on the first queued resource.
+    void SetNumThreads(unsigned num);
+    /// Load the queued resource with the highest priority. Called from the worker threads. Return false if there was nothing to load.
+    bool LoadNextResource();
+    /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type). A duplicate with higher priority raises the priority of the queued resource and its dependencies.
+    bool QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller, int priority = 0);
     /// Wait and finish possible loading of a resource when being requested from the cache.
     void WaitForResource(StringHash type, StringHash nameHash);
     /// Process resources that are ready to finish.
@@ -72,8 +77,35 @@ public:
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of worker threads.
+    unsigned GetNumThreads() const { return numThreads_; }
 
 private:
+    /// Entry of the priority queue of resources waiting for a worker thread.
+    struct PendingResource
+    {
+        /// Return whether the other entry should be loaded before this.
+        bool operator <(const PendingResource& rhs) const
+        {
+            return priority_ != rhs.priority_ ? priority_ < rhs.priority_ : order_ > rhs.order_;
+        }
+
+        /// Load priority at the time of queueing.
+        int priority_;
+        /// Queueing order for loading resources of the same priority first in first out.
+        unsigned order_;
+        /// Resource type and name hash.
+        ea::pair<StringHash, StringHash> key_;
+    };
+
+    /// Add a queued resource to the priority queue.
+    void PushPendingResource(const ea::pair<StringHash, StringHash>& key, int priority);
+    /// Raise the priority of a queued resource and its dependencies.
+    void RaisePriority(const ea::pair<StringHash, StringHash>& key, int priority);
+    /// Start the worker threads if not running. Call with the mutex held.
+    void StartThreads();
+    /// Stop all worker threads.
+    void StopThreads();
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
 
@@ -83,6 +115,14 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     ea::unordered_map<ea::pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Priority queue (max heap) of resources waiting for a worker thread. May contain stale entries of raised or removed resources.
+    ea::vector<PendingResource> pendingResources_;
+    /// Queueing counter.
+    unsigned queueOrder_{};
+    /// Worker threads.
+    ea::vector<ea::unique_ptr<BackgroundLoaderThread> > threads_;
+    /// Number of worker threads.
+    unsigned numThreads_{1};
 };
 
 }
@@ -75,7 +75,8 @@ ResourceCache::ResourceCache(Context* context) :
     returnFailedResources_(false),
     searchPackagesFirst_(true),
     isRouting_(false),
-    finishBackgroundResourcesMs_(5)
+    finishBackgroundResourcesMs_(5),
+    numBackgroundLoadThreads_(1)
 {
     // Register Resource library object factories
     RegisterResourceLibrary(context_);
@@ -178,6 +179,7 @@ bool ResourceCache::AddManualResource(Resource* resource)
 
     resource->ResetUseTimer();
     resourceGroups_[resource->GetType()].resources_[resource->GetNameHash()] = resource;
+    AddResourceLookup(resource->GetType(), resource->GetNameHash());
     UpdateResourceGroup(resource->GetType());
     return true;
 }
@@ -255,6 +257,7 @@ void ResourceCache::ReleaseResource(StringHash type, const ea::string& name, boo
     // If other references exist, do not release, unless forced
     if ((existingRes.Refs() == 1 && existingRes.WeakRefs() == 0) || force)
     {
+        RemoveResourceLookup(type, nameHash);
         resourceGroups_[type].resources_.erase(nameHash);
         UpdateResourceGroup(type);
     }
@@ -279,6 +282,7 @@ void ResourceCache::ReleaseResource(const ea::string& resourceName, bool force)
                     // If other references exist, do not release, unless forced
                     if ((current->second.Refs() == 1 && current->second.WeakRefs() == 0) || force)
                     {
+                        RemoveResourceLookup(i->first, current->first);
                         j = i->second.resources_.erase(current);
                         released = true;
                         continue;
@@ -307,6 +311,7 @@ void ResourceCache::ReleaseResources(StringHash type, bool force)
             // If other references exist, do not release, unless forced
             if ((current->second.Refs() == 1 && current->second.WeakRefs() == 0) || force)
             {
+                RemoveResourceLookup(i->first, current->first);
                 i->second.resources_.erase(current);
                 released = true;
             }
@@ -333,6 +338,7 @@ void ResourceCache::ReleaseResources(StringHash type, const ea::string& partialN
                 // If other references exist, do not release, unless forced
                 if ((current->second.Refs() == 1 && current->second.WeakRefs() == 0) || force)
                 {
+                    RemoveResourceLookup(i->first, current->first);
                     i->second.resources_.erase(current);
                     released = true;
                 }
@@ -365,6 +371,7 @@ void ResourceCache::ReleaseResources(const ea::string& partialName, bool force)
                     // If other references exist, do not release, unless forced
                     if ((current->second.Refs() == 1 && current->second.WeakRefs() == 0) || force)
                     {
+                        RemoveResourceLookup(i->first, current->first);
                         i->second.resources_.erase(current);
                         released = true;
                     }
@@ -394,6 +401,7 @@ void ResourceCache::ReleaseAllResources(bool force)
                 // If other references exist, do not release, unless forced
                 if ((current->second.Refs() == 1 && current->second.WeakRefs() == 0) || force)
                 {
+                    RemoveResourceLookup(i->first, current->first);
                     i->second.resources_.erase(current);
                     released = true;
                 }
@@ -669,12 +677,13 @@ Resource* ResourceCache::GetResource(StringHash type, const ea::string& name, bo
     // Store to cache
     resource->ResetUseTimer();
     resourceGroups_[type].resources_[nameHash] = resource;
+    AddResourceLookup(type, nameHash);
     UpdateResourceGroup(type);
 
     return resource;
 }
 
-bool ResourceCache::BackgroundLoadResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller)
+bool ResourceCache::BackgroundLoadResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
 #ifdef URHO3D_THREADING
     // If empty name, fail immediately
@@ -684,10 +693,10 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const ea::string& na
 
     // First check if already exists as a loaded resource
     StringHash nameHash(sanitatedName);
-    if (FindResource(type, nameHash) != noResource)
+    if (IsResourceCached(type, nameHash))
         return false;
 
-    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller);
+    return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller, priority);
 #else
     // When threading not supported, fall back to synchronous loading
     return GetResource(type, name, sendEventOnFailure);
@@ -748,6 +757,14 @@ SharedPtr<Resource> ResourceCache::GetTempResource(StringHash type, const ea::st
     return resource;
 }
 
+void ResourceCache::SetNumBackgroundLoadThreads(unsigned num)
+{
+    numBackgroundLoadThreads_ = Max(num, 1U);
+#ifdef URHO3D_THREADING
+    backgroundLoader_->SetNumThreads(numBackgroundLoadThreads_);
+#endif
+}
+
 unsigned ResourceCache::GetNumBackgroundLoadResources() const
 {
 #ifdef URHO3D_THREADING
@@ -1015,8 +1032,6 @@ ea::string ResourceCache::PrintMemoryUsage() const
 
 const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHash nameHash)
 {
-    MutexLock lock(resourceMutex_);
-
     auto i = resourceGroups_.find(type);
     if (i == resourceGroups_.end())
         return noResource;
@@ -1029,8 +1044,6 @@ const SharedPtr<Resource>& ResourceCache::FindResource(StringHash type, StringHa
 
 const SharedPtr<Resource>& ResourceCache::FindResource(StringHash nameHash)
 {
-    MutexLock lock(resourceMutex_);
-
     for (auto i = resourceGroups_.begin(); i !=
         resourceGroups_.end(); ++i)
     {
@@ -1061,6 +1074,7 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
                 // If other references exist, do not release, unless forced
                 if ((k->second.Refs() == 1 && k->second.WeakRefs() == 0) || force)
                 {
+                    RemoveResourceLookup(j->first, nameHash);
                     j->second.resources_.erase(k);
                     affectedGroups.insert(j->first);
                 }
@@ -1106,6 +1120,7 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
         {
             URHO3D_LOGDEBUG("Resource group " + oldestResource->second->GetTypeName() + " over memory budget, releasing resource " +
                      oldestResource->second->GetName());
+            RemoveResourceLookup(type, oldestResource->first);
             i->second.resources_.erase(oldestResource);
         }
         else
@@ -1113,6 +1128,32 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     }
 }
 
+void ResourceCache::AddResourceLookup(StringHash type, StringHash nameHash)
+{
+    ResourceLookupShard& shard = resourceLookupShards_[nameHash.Value() % NUM_RESOURCE_LOOKUP_SHARDS];
+    MutexLock lock(shard.mutex_);
+    shard.names_[type].insert(nameHash);
+}
+
+void ResourceCache::RemoveResourceLookup(StringHash type, StringHash nameHash)
+{
+    ResourceLookupShard& shard = resourceLookupShards_[nameHash.Value() % NUM_RESOURCE_LOOKUP_SHARDS];
+    MutexLock lock(shard.mutex_);
+
+    auto i = shard.names_.find(type);
+    if (i != shard.names_.end())
+        i->second.erase(nameHash);
+}
+
+bool ResourceCache::IsResourceCached(StringHash type, StringHash nameHash) const
+{
+    ResourceLookupShard& shard = resourceLookupShards_[nameHash.Value() % NUM_RESOURCE_LOOKUP_SHARDS];
+    MutexLock lock(shard.mutex_);
+
+    auto i = shard.names_.find(type);
+    return i != shard.names_.end() && i->second.find(nameHash) != i->second.end();
+}
+
 void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     for (unsigned i = 0; i < fileWatchers_.size(); ++i)
@@ -1375,10 +1416,12 @@ bool ResourceCache::RenameResource(const ea::string& source, const ea::string& d
                 ignoreResourceAutoReload_.emplace_back(resource->GetName());
             }
 
+            RemoveResourceLookup(groupPair.first, resource->GetNameHash());
             groupPair.second.resources_.erase(resource->GetNameHash());
             resource->SetName(newName);
             resource->SetAbsoluteFileName(newNativeFileName);
             groupPair.second.resources_[resource->GetNameHash()] = resource;
+            AddResourceLookup(groupPair.first, resource->GetNameHash());
             movedAny = true;
 
             using namespace ResourceRenamed;
@@ -1423,6 +1466,12 @@ void ResourceCache::Clear()
 {
     resourceGroups_.clear();
     dependentResources_.clear();
+
+    for (ResourceLookupShard& shard : resourceLookupShards_)
+    {
+        MutexLock lock(shard.mutex_);
+        shard.names_.clear();
+    }
 }
 
 }
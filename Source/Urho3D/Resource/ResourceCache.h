@@ -41,6 +41,8 @@ class PackageFile;
 
 /// Sets to priority so that a package or file is pushed to the end of the vector.
 static const unsigned PRIORITY_LAST = 0xffffffff;
+/// Number of lock shards of the thread-safe cached resource lookup.
+static const unsigned NUM_RESOURCE_LOOKUP_SHARDS = 16;
 
 /// Container of resources with specific type.
 struct ResourceGroup
@@ -142,6 +144,9 @@ public:
     /// Set how many milliseconds maximum per frame to spend on finishing background loaded resources.
     /// @property
     void SetFinishBackgroundResourcesMs(int ms) { finishBackgroundResourcesMs_ = Max(ms, 1); }
+    /// Set number of background loader threads, at least one. Resources are loaded highest priority first.
+    /// @property
+    void SetNumBackgroundLoadThreads(unsigned num);
 
     /// Add a resource router object. By default there is none, so the routing process is skipped.
     void AddResourceRouter(ResourceRouter* router, bool addAsFirst = false);
@@ -154,8 +159,8 @@ public:
     Resource* GetResource(StringHash type, const ea::string& name, bool sendEventOnFailure = true);
     /// Load a resource without storing it in the resource cache. Return null if not found or if fails. Can be called from outside the main thread if the resource itself is safe to load completely (it does not possess for example GPU data).
     SharedPtr<Resource> GetTempResource(StringHash type, const ea::string& name, bool sendEventOnFailure = true);
-    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Can be called from outside the main thread.
-    bool BackgroundLoadResource(StringHash type, const ea::string& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    /// Background load a resource. An event will be sent when complete. Return true if successfully stored to the load queue, false if eg. already exists. Resources with higher priority are loaded first; queueing an already queued resource with a higher priority raises it. Resources requested by a caller resource inherit its priority. Can be called from outside the main thread.
+    bool BackgroundLoadResource(StringHash type, const ea::string& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0);
     /// Return number of pending background-loaded resources.
     /// @property
     unsigned GetNumBackgroundLoadResources() const;
@@ -184,7 +189,7 @@ public:
     /// Template version of releasing a resource by name.
     template <class T> void ReleaseResource(const ea::string& resourceName, bool force = false);
     /// Template version of queueing a resource background load.
-    template <class T> bool BackgroundLoadResource(const ea::string& name, bool sendEventOnFailure = true, Resource* caller = nullptr);
+    template <class T> bool BackgroundLoadResource(const ea::string& name, bool sendEventOnFailure = true, Resource* caller = nullptr, int priority = 0);
     /// Template version of returning loaded resources of a specific type.
     template <class T> void GetResources(ea::vector<T*>& result) const;
     /// Return whether a file exists in the resource directories or package files. Does not check manually added in-memory resources.
@@ -217,6 +222,10 @@ public:
     /// @property
     int GetFinishBackgroundResourcesMs() const { return finishBackgroundResourcesMs_; }
 
+    /// Return number of background loader threads.
+    /// @property
+    unsigned GetNumBackgroundLoadThreads() const { return numBackgroundLoadThreads_; }
+
     /// Return a resource router by index.
     ResourceRouter* GetResourceRouter(unsigned index) const;
 
@@ -255,14 +264,29 @@ public:
     void Clear();
 
 private:
-    /// Find a resource.
+    /// Shard of the thread-safe cached resource lookup.
+    struct ResourceLookupShard
+    {
+        /// Mutex of the shard.
+        SpinLockMutex mutex_;
+        /// Name hashes of cached resources by type.
+        ea::unordered_map<StringHash, ea::hash_set<StringHash> > names_;
+    };
+
+    /// Find a resource. Must be called from the main thread.
     const SharedPtr<Resource>& FindResource(StringHash type, StringHash nameHash);
-    /// Find a resource by name only. Searches all type groups.
+    /// Find a resource by name only. Searches all type groups. Must be called from the main thread.
     const SharedPtr<Resource>& FindResource(StringHash nameHash);
     /// Release resources loaded from a package file.
     void ReleasePackageResources(PackageFile* package, bool force = false);
     /// Update a resource group. Recalculate memory use and release resources if over memory budget.
     void UpdateResourceGroup(StringHash type);
+    /// Add a cached resource to the thread-safe lookup.
+    void AddResourceLookup(StringHash type, StringHash nameHash);
+    /// Remove a resource from the thread-safe lookup before it is removed from its group.
+    void RemoveResourceLookup(StringHash type, StringHash nameHash);
+    /// Return whether a resource is cached. Can be called from outside the main thread.
+    bool IsResourceCached(StringHash type, StringHash nameHash) const;
     /// Handle begin frame event. Automatic resource reloads and the finalization of background loaded resources are processed here.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Search FileSystem for file.
@@ -272,8 +296,10 @@ private:
 
     /// Mutex for thread-safe access to the resource directories, resource packages and resource dependencies.
     mutable Mutex resourceMutex_;
-    /// Resources by type.
+    /// Resources by type. Modified and accessed only from the main thread.
     ea::unordered_map<StringHash, ResourceGroup> resourceGroups_;
+    /// Cached resources for lookups from other threads, sharded by name hash so that background loader threads rarely contend.
+    mutable ResourceLookupShard resourceLookupShards_[NUM_RESOURCE_LOOKUP_SHARDS];
     /// Resource load directories.
     ea::vector<ea::string> resourceDirs_;
     /// File watchers for resource directories, if automatic reloading enabled.
@@ -296,6 +322,8 @@ private:
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// Number of background loader threads.
+    unsigned numBackgroundLoadThreads_;
     /// List of resources that will not be auto-reloaded if reloading event triggers.
     ea::vector<ea::string> ignoreResourceAutoReload_;
 };
@@ -324,10 +352,10 @@ template <class T> SharedPtr<T> ResourceCache::GetTempResource(const ea::string&
     return StaticCast<T>(GetTempResource(type, name, sendEventOnFailure));
 }
 
-template <class T> bool ResourceCache::BackgroundLoadResource(const ea::string& name, bool sendEventOnFailure, Resource* caller)
+template <class T> bool ResourceCache::BackgroundLoadResource(const ea::string& name, bool sendEventOnFailure, Resource* caller, int priority)
 {
     StringHash type = T::GetTypeStatic();
-    return BackgroundLoadResource(type, name, sendEventOnFailure, caller);
+    return BackgroundLoadResource(type, name, sendEventOnFailure, caller, priority);
 }
 
 template <class T> void ResourceCache::GetResources(ea::vector<T*>& result) const
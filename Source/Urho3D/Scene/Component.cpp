@@ -175,6 +175,7 @@ void Component::PrepareNetworkUpdate()
         return;
 
     unsigned numAttributes = attributes->size();
+    DirtyBits changedAttributes;
 
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
@@ -189,6 +190,7 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (auto j = networkState_->replicationStates_.begin();
@@ -208,6 +210,10 @@ void Component::PrepareNetworkUpdate()
         }
     }
 
+    // Invalidate the cached update payloads, as they were serialized from the previous values
+    if (changedAttributes.Count())
+        SetChangedNetworkAttributes(changedAttributes);
+
     networkUpdate_ = false;
 }
 
@@ -27,6 +27,7 @@
 #include "../Physics/PhysicsEvents.h"
 #endif
 #include "../Scene/LogicComponent.h"
+#include "../Scene/LogicComponentScheduler.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
@@ -73,6 +74,15 @@ void LogicComponent::SetUpdateEventMask(UpdateEventFlags mask)
     }
 }
 
+void LogicComponent::SetUpdateAccess(UpdateAccess access)
+{
+    if (updateAccess_ != access)
+    {
+        updateAccess_ = access;
+        UpdateEventSubscription();
+    }
+}
+
 void LogicComponent::OnNodeSet(Node* node)
 {
     if (node)
@@ -93,13 +103,64 @@ void LogicComponent::OnSceneSet(Scene* scene)
         UpdateEventSubscription();
     else
     {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        UnsubscribeFromUpdateEvents();
+        currentEventMask_ = USE_NO_EVENT;
+    }
+}
+
+void LogicComponent::UnsubscribeFromUpdateEvents()
+{
+    UnsubscribeFromEvent<SceneUpdateArgs>();
+    UnsubscribeFromEvent<ScenePostUpdateArgs>();
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
+    UnsubscribeFromEvent(E_PHYSICSPRESTEP);
+    UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
 #endif
-        currentEventMask_ = USE_NO_EVENT;
+
+    if (scheduler_)
+    {
+        scheduler_->RemoveComponent(this);
+        scheduler_.Reset();
+    }
+}
+
+void LogicComponent::UpdateParallelSubscription(Scene* scene)
+{
+    // Drop the subscriptions of the main thread update when switching from it
+    if (!scheduler_ && currentEventMask_)
+        UnsubscribeFromUpdateEvents();
+
+    bool enabled = IsEnabledEffective();
+    UpdateEventFlags mask = USE_NO_EVENT;
+    if (enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_))
+        mask |= USE_UPDATE;
+    if (enabled && (updateEventMask_ & USE_POSTUPDATE))
+        mask |= USE_POSTUPDATE;
+
+    LogicComponentScheduler* scheduler = scene->GetLogicComponentScheduler();
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    if (Component* world = GetFixedUpdateSource())
+    {
+        if (enabled && (updateEventMask_ & USE_FIXEDUPDATE))
+            mask |= USE_FIXEDUPDATE;
+        if (enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE))
+            mask |= USE_FIXEDPOSTUPDATE;
+        if (mask & (USE_FIXEDUPDATE | USE_FIXEDPOSTUPDATE))
+            scheduler->SetFixedUpdateSource(world);
+    }
+#endif
+
+    currentEventMask_ = mask;
+    if (mask && !scheduler_)
+    {
+        scheduler->AddComponent(this);
+        scheduler_ = scheduler;
+    }
+    else if (!mask && scheduler_)
+    {
+        scheduler_->RemoveComponent(this);
+        scheduler_.Reset();
     }
 }
 
@@ -109,29 +170,41 @@ void LogicComponent::UpdateEventSubscription()
     if (!scene)
         return;
 
+    if (updateAccess_ != ACCESS_MAIN_THREAD)
+    {
+        UpdateParallelSubscription(scene);
+        return;
+    }
+    else if (scheduler_)
+    {
+        // Switching back to the main thread update
+        UnsubscribeFromUpdateEvents();
+        currentEventMask_ = USE_NO_EVENT;
+    }
+
     bool enabled = IsEnabledEffective();
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
+        SubscribeToEvent(scene, &LogicComponent::HandleSceneUpdate);
         currentEventMask_ |= USE_UPDATE;
     }
     else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
+        UnsubscribeFromEvent<SceneUpdateArgs>();
         currentEventMask_ &= ~USE_UPDATE;
     }
 
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
+        SubscribeToEvent(scene, &LogicComponent::HandleScenePostUpdate);
         currentEventMask_ |= USE_POSTUPDATE;
     }
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+        UnsubscribeFromEvent<ScenePostUpdateArgs>();
         currentEventMask_ &= ~USE_POSTUPDATE;
     }
 
@@ -166,10 +239,8 @@ void LogicComponent::UpdateEventSubscription()
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleSceneUpdate(SceneUpdateArgs& args)
 {
-    using namespace SceneUpdate;
-
     // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
@@ -179,22 +250,20 @@ void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
         // If did not need actual update events, unsubscribe now
         if (!(updateEventMask_ & USE_UPDATE))
         {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
+            UnsubscribeFromEvent<SceneUpdateArgs>();
             currentEventMask_ &= ~USE_UPDATE;
             return;
         }
     }
 
     // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(args.timeStep_);
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleScenePostUpdate(ScenePostUpdateArgs& args)
 {
-    using namespace ScenePostUpdate;
-
     // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
+    PostUpdate(args.timeStep_);
 }
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
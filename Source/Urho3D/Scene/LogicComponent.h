@@ -30,6 +30,9 @@
 namespace Urho3D
 {
 
+struct SceneUpdateArgs;
+struct ScenePostUpdateArgs;
+
 enum UpdateEvent : unsigned
 {
     /// Bitmask for not using any events.
@@ -45,11 +48,26 @@ enum UpdateEvent : unsigned
 };
 URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 
+/// Scene data that a logic component modifies in its update functions, which determines whether they may run in parallel.
+enum UpdateAccess
+{
+    /// Update functions run on the main thread and may access anything.
+    ACCESS_MAIN_THREAD = 0,
+    /// Update functions run on worker threads and modify only the component's own node and its components. Components under the same top-level node of the scene are updated in the same job, because modifying a node also affects its descendants.
+    ACCESS_OWN_NODE,
+    /// Update functions run on worker threads and modify only nodes under the same top-level node of the scene. Components under the same top-level node are updated in the same job.
+    ACCESS_OWN_HIERARCHY
+};
+
+class LogicComponentScheduler;
+
 /// Helper base class for user-defined game logic components that hooks up to update events and forwards them to virtual functions similar to ScriptInstance class.
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
 
+    friend class LogicComponentScheduler;
+
     /// Construct.
     explicit LogicComponent(Context* context);
     /// Destruct.
@@ -82,6 +100,12 @@ class URHO3D_API LogicComponent : public Component
     /// Return what update events are subscribed to.
     UpdateEventFlags GetUpdateEventMask() const { return updateEventMask_; }
 
+    /// Declare what the update functions modify. With other than ACCESS_MAIN_THREAD the update functions run in the scene's parallel update phase, after the main thread subscribers of the same event, and must defer node creation, node removal and event sending through the scene's Delayed functions. DelayedStart() is still called on the main thread. Like the event mask, this is not an attribute.
+    void SetUpdateAccess(UpdateAccess access);
+
+    /// Return what the update functions modify.
+    UpdateAccess GetUpdateAccess() const { return updateAccess_; }
+
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
@@ -94,10 +118,14 @@ protected:
 private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
+    /// Add to or remove from the scene's parallel update based on current enabled state and update event mask.
+    void UpdateParallelSubscription(Scene* scene);
+    /// Unsubscribe from all update events.
+    void UnsubscribeFromUpdateEvents();
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(SceneUpdateArgs& args);
     /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(ScenePostUpdateArgs& args);
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
     /// Handle physics pre-step event.
     void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
@@ -108,6 +136,10 @@ private:
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
+    /// Scheduler running the parallel update, if added to it.
+    WeakPtr<LogicComponentScheduler> scheduler_;
+    /// Declared update access.
+    UpdateAccess updateAccess_{ACCESS_MAIN_THREAD};
     /// Flag for delayed start.
     bool delayedStartCalled_;
 };
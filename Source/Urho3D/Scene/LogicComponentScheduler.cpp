@@ -0,0 +1,250 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+#include "../Physics/PhysicsEvents.h"
+#endif
+#include "../Scene/LogicComponentScheduler.h"
+#include "../Scene/Scene.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of jobs per work item.
+static const unsigned JOBS_PER_WORK_ITEM = 4;
+
+LogicComponentScheduler::LogicComponentScheduler(Scene* scene) :
+    Object(scene->GetContext()),
+    scene_(scene)
+{
+}
+
+LogicComponentScheduler::~LogicComponentScheduler() = default;
+
+void LogicComponentScheduler::AddComponent(LogicComponent* component)
+{
+    if (updating_)
+    {
+        MutexLock lock(pendingChangesMutex_);
+        pendingChanges_.emplace_back(WeakPtr<LogicComponent>(component), true);
+        return;
+    }
+
+    components_.emplace_back(component);
+}
+
+void LogicComponentScheduler::RemoveComponent(LogicComponent* component)
+{
+    if (updating_)
+    {
+        MutexLock lock(pendingChangesMutex_);
+        pendingChanges_.emplace_back(WeakPtr<LogicComponent>(component), false);
+        return;
+    }
+
+    ea::erase_if(components_, [component](const WeakPtr<LogicComponent>& item)
+    {
+        return item.Expired() || item == component;
+    });
+}
+
+void LogicComponentScheduler::SetFixedUpdateSource(Component* source)
+{
+    if (fixedUpdateSource_ == source)
+        return;
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    if (fixedUpdateSource_)
+        UnsubscribeFromEvents(fixedUpdateSource_);
+
+    if (source)
+    {
+        SubscribeToEvent(source, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponentScheduler, HandlePhysicsPreStep));
+        SubscribeToEvent(source, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponentScheduler, HandlePhysicsPostStep));
+    }
+#endif
+
+    fixedUpdateSource_ = source;
+}
+
+void LogicComponentScheduler::Update(UpdateEvent phase, float timeStep)
+{
+    Scene* scene = scene_;
+    if (components_.empty() || updating_ || !scene)
+        return;
+
+    // Changes to the component list are deferred until the phase is finished, as DelayedStart() and the update functions may add or remove components
+    updating_ = true;
+    GatherJobs(phase);
+
+    const unsigned numJobs = jobs_.size() - 1;
+    if (numJobs)
+    {
+        URHO3D_PROFILE("ParallelLogicUpdate");
+
+        // During the threaded update components defer dirty notifications, node changes and events to the main thread
+        scene->BeginThreadedUpdate();
+        if (scene->IsThreadedUpdate())
+        {
+            auto* queue = GetSubsystem<WorkQueue>();
+            queue->ParallelFor(numJobs, JOBS_PER_WORK_ITEM, [&](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                UpdateJobs(phase, timeStep, begin, end);
+            });
+        }
+        else
+            UpdateJobs(phase, timeStep, 0, numJobs);
+        scene->EndThreadedUpdate();
+    }
+
+    updating_ = false;
+    ApplyPendingChanges();
+}
+
+void LogicComponentScheduler::ApplyPendingChanges()
+{
+    if (pendingChanges_.empty())
+        return;
+
+    ea::vector<ea::pair<WeakPtr<LogicComponent>, bool> > changes;
+    changes.swap(pendingChanges_);
+
+    for (const auto& change : changes)
+    {
+        if (change.second)
+        {
+            if (change.first)
+                AddComponent(change.first);
+        }
+        else
+            RemoveComponent(change.first);
+    }
+}
+
+void LogicComponentScheduler::GatherJobs(UpdateEvent phase)
+{
+    jobComponents_.clear();
+    jobs_.clear();
+
+    for (unsigned i = 0; i < components_.size(); ++i)
+    {
+        LogicComponent* component = components_[i];
+        if (!component || !(component->currentEventMask_ & phase))
+            continue;
+
+        // Execute user-defined delayed start function on the main thread before the first update
+        if (!component->delayedStartCalled_ && (phase == USE_UPDATE || phase == USE_FIXEDUPDATE))
+        {
+            WeakPtr<LogicComponent> self(component);
+            component->DelayedStart();
+            component->delayedStartCalled_ = true;
+
+            // The component may have been removed, or may not need actual update events
+            if (self.Expired() || !(component->currentEventMask_ & phase) || !component->GetNode())
+                continue;
+            if (phase == USE_UPDATE && !(component->updateEventMask_ & USE_UPDATE))
+            {
+                component->currentEventMask_ &= ~USE_UPDATE;
+                continue;
+            }
+        }
+
+        Node* node = component->GetNode();
+        if (!node)
+            continue;
+
+        // Components that may modify the same nodes go to the same job. Modifying a node also dirties its descendants,
+        // so components of overlapping subtrees are grouped by their top-level node regardless of their access
+        while (node->GetParent() && node->GetParent() != scene_)
+            node = node->GetParent();
+
+        jobComponents_.emplace_back(node, i);
+    }
+
+    // Ordering by index keeps the components of a job in the order they were added
+    ea::sort(jobComponents_.begin(), jobComponents_.end());
+
+    for (unsigned i = 0; i < jobComponents_.size(); ++i)
+    {
+        if (!i || jobComponents_[i].first != jobComponents_[i - 1].first)
+            jobs_.push_back(i);
+    }
+    jobs_.push_back(jobComponents_.size());
+}
+
+void LogicComponentScheduler::UpdateJobs(UpdateEvent phase, float timeStep, unsigned begin, unsigned end)
+{
+    for (unsigned i = jobs_[begin]; i < jobs_[end]; ++i)
+    {
+        LogicComponent* component = components_[jobComponents_[i].second];
+        if (!component)
+            continue;
+
+        switch (phase)
+        {
+        case USE_UPDATE:
+            component->Update(timeStep);
+            break;
+        case USE_POSTUPDATE:
+            component->PostUpdate(timeStep);
+            break;
+        case USE_FIXEDUPDATE:
+            component->FixedUpdate(timeStep);
+            break;
+        case USE_FIXEDPOSTUPDATE:
+            component->FixedPostUpdate(timeStep);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+
+void LogicComponentScheduler::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    Update(USE_FIXEDUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+void LogicComponentScheduler::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    Update(USE_FIXEDPOSTUPDATE, eventData[P_TIMESTEP].GetFloat());
+}
+
+#endif
+
+}
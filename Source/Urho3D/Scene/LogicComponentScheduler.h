@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Core/Mutex.h"
+#include "../Scene/LogicComponent.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Runs the update functions of logic components that declared a parallel update access in jobs on the work queue. Components that may modify the same nodes are placed in the same job and updated sequentially in the order they were added.
+class URHO3D_API LogicComponentScheduler : public Object
+{
+    URHO3D_OBJECT(LogicComponentScheduler, Object);
+
+public:
+    /// Construct.
+    explicit LogicComponentScheduler(Scene* scene);
+    /// Destruct.
+    ~LogicComponentScheduler() override;
+
+    /// Add component. The component's current event mask determines the phases it is updated in.
+    void AddComponent(LogicComponent* component);
+    /// Remove component.
+    void RemoveComponent(LogicComponent* component);
+    /// Set the component sending fixed update events.
+    void SetFixedUpdateSource(Component* source);
+    /// Run an update phase. Must be called from the main thread.
+    void Update(UpdateEvent phase, float timeStep);
+
+    /// Return number of components.
+    unsigned GetNumComponents() const { return components_.size(); }
+
+private:
+    /// Apply component additions and removals made during an update phase.
+    void ApplyPendingChanges();
+    /// Sort components of an update phase into jobs. Calls DelayedStart() on the main thread when needed.
+    void GatherJobs(UpdateEvent phase);
+    /// Update components of a range of jobs.
+    void UpdateJobs(UpdateEvent phase, float timeStep, unsigned begin, unsigned end);
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
+    /// Handle physics pre-step event.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle physics post-step event.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
+
+    /// Scene.
+    WeakPtr<Scene> scene_;
+    /// Fixed update source.
+    WeakPtr<Component> fixedUpdateSource_;
+    /// Components.
+    ea::vector<WeakPtr<LogicComponent> > components_;
+    /// Node that identifies the job and index in components_ for each component of the current phase, sorted by job.
+    ea::vector<ea::pair<Node*, unsigned> > jobComponents_;
+    /// Start index of each job in jobComponents_, followed by the end index.
+    ea::vector<unsigned> jobs_;
+    /// Components added (true) or removed (false) during an update phase.
+    ea::vector<ea::pair<WeakPtr<LogicComponent>, bool> > pendingChanges_;
+    /// Mutex for pending changes.
+    Mutex pendingChangesMutex_;
+    /// Update phase in progress flag.
+    bool updating_{};
+};
+
+}
@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
 #include "../IO/Archive.h"
 #include "../IO/ArchiveSerialization.h"
 #include "../IO/Log.h"
@@ -36,6 +37,7 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SmoothedTransform.h"
+#include "../Scene/TransformStore.h"
 #include "../Scene/UnknownComponent.h"
 
 #include "../DebugNew.h"
@@ -47,10 +49,13 @@
 namespace Urho3D
 {
 
+unsigned Node::numPendingTransformStores_ = 0;
+
 Node::Node(Context* context) :
     Animatable(context),
     worldTransform_(Matrix3x4::IDENTITY),
     dirty_(false),
+    transformQueued_(false),
     enabled_(true),
     enabledPrev_(true),
     networkUpdate_(false),
@@ -88,9 +93,11 @@ void Node::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Scale", GetScale, SetScale, Vector3, Vector3::ONE, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
     URHO3D_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetMetadata(AttributeMetadata::P_NETWORK_PRECISION, 0.001f);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetMetadata(AttributeMetadata::P_NETWORK_BITS, 10);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_NOEDIT);
 }
@@ -885,6 +892,23 @@ void Node::SetOwner(Connection* owner)
 }
 
 void Node::MarkDirty()
+{
+    // With batched transform update only queue the node. The scene updates the subtree and notifies the listeners later
+    TransformStore* store = scene_ && scene_ != this ? scene_->GetTransformStore() : nullptr;
+    if (store && !scene_->IsThreadedUpdate() && Thread::IsMainThread())
+    {
+        if (!dirty_)
+        {
+            dirty_ = true;
+            store->QueueNode(this);
+        }
+        return;
+    }
+
+    MarkDirtyHierarchy();
+}
+
+void Node::MarkDirtyHierarchy()
 {
     Node *cur = this;
     for (;;)
@@ -901,22 +925,7 @@ void Node::MarkDirty()
         cur->dirty_ = true;
 
         // Notify listener components first, then mark child nodes
-        for (auto i = cur->listeners_.begin(); i !=
-            cur->listeners_.end();)
-        {
-            Component *c = i->Get();
-            if (c)
-            {
-                c->OnMarkedDirty(cur);
-                ++i;
-            }
-            // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
-            else
-            {
-                *i = cur->listeners_.back();
-                cur->listeners_.pop_back();
-            }
-        }
+        cur->NotifyListeners();
 
         // Tail call optimization: Don't recurse to mark the first child dirty, but
         // instead process it in the context of the current function. If there are more
@@ -926,7 +935,7 @@ void Node::MarkDirty()
         {
             Node *next = i->Get();
             for (++i; i != cur->children_.end(); ++i)
-                (*i)->MarkDirty();
+                (*i)->MarkDirtyHierarchy();
             cur = next;
         }
         else
@@ -934,6 +943,25 @@ void Node::MarkDirty()
     }
 }
 
+void Node::NotifyListeners()
+{
+    for (auto i = listeners_.begin(); i != listeners_.end();)
+    {
+        Component *c = i->Get();
+        if (c)
+        {
+            c->OnMarkedDirty(this);
+            ++i;
+        }
+        // If listener has expired, erase from list (swap with the last element to avoid O(n^2) behavior)
+        else
+        {
+            *i = listeners_.back();
+            listeners_.pop_back();
+        }
+    }
+}
+
 Node* Node::CreateChild(const ea::string& name, CreateMode mode, unsigned id, bool temporary)
 {
     Node* newNode = CreateChild(id, mode, temporary);
@@ -1327,7 +1355,7 @@ void Node::RemoveListener(Component* component)
 
 Vector3 Node::GetSignedWorldScale() const
 {
-    if (dirty_)
+    if (dirty_ || numPendingTransformStores_)
         UpdateWorldTransform();
 
     return worldTransform_.SignedScale(worldRotation_.RotationMatrix());
@@ -1857,6 +1885,7 @@ void Node::PrepareNetworkUpdate()
 
     const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
     unsigned numAttributes = attributes->size();
+    DirtyBits changedAttributes;
 
     // Check for attribute changes
     for (unsigned i = 0; i < numAttributes; ++i)
@@ -1871,6 +1900,7 @@ void Node::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
 
             // Mark the attribute dirty in all replication states that are tracking this node
             for (auto j = networkState_->replicationStates_.begin();
@@ -1889,6 +1919,10 @@ void Node::PrepareNetworkUpdate()
         }
     }
 
+    // Invalidate the cached update payloads, as they were serialized from the previous values
+    if (changedAttributes.Count())
+        SetChangedNetworkAttributes(changedAttributes);
+
     // Finally check for user var changes
     for (auto i = vars_.begin(); i != vars_.end(); ++i)
     {
@@ -2237,6 +2271,18 @@ Component* Node::SafeCreateComponent(const ea::string& typeName, StringHash type
 
 void Node::UpdateWorldTransform() const
 {
+    // Queued changes of the parents are not visible through the dirty flag, so apply them first
+    if (numPendingTransformStores_)
+    {
+        if (scene_ && Thread::IsMainThread())
+        {
+            if (TransformStore* store = scene_->GetTransformStore())
+                store->Update();
+        }
+        if (!dirty_)
+            return;
+    }
+
     Matrix3x4 transform = GetTransform();
 
     // Assume the root node (scene) has identity transform
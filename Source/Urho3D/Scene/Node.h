@@ -77,6 +77,7 @@ class URHO3D_API Node : public Animatable
     URHO3D_OBJECT(Node, Animatable);
 
     friend class Connection;
+    friend class TransformStore;
 
 public:
     /// Construct.
@@ -450,7 +451,7 @@ public:
     /// @property
     Vector3 GetWorldPosition() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldTransform_.Translation();
@@ -468,7 +469,7 @@ public:
     /// @property
     Quaternion GetWorldRotation() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldRotation_;
@@ -485,7 +486,7 @@ public:
     /// @property
     Vector3 GetWorldDirection() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::FORWARD;
@@ -495,7 +496,7 @@ public:
     /// @property
     Vector3 GetWorldUp() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::UP;
@@ -505,7 +506,7 @@ public:
     /// @property
     Vector3 GetWorldRight() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldRotation_ * Vector3::RIGHT;
@@ -515,7 +516,7 @@ public:
     /// @property
     Vector3 GetWorldScale() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldTransform_.Scale();
@@ -537,7 +538,7 @@ public:
     /// @property
     const Matrix3x4& GetWorldTransform() const
     {
-        if (dirty_)
+        if (dirty_ || numPendingTransformStores_)
             UpdateWorldTransform();
 
         return worldTransform_;
@@ -705,8 +706,12 @@ private:
     void SetEnabled(bool enable, bool recursive, bool storeSelf);
     /// Create component, allowing UnknownComponent if actual type is not supported. Leave typeName empty if not known.
     Component* SafeCreateComponent(const ea::string& typeName, StringHash type, CreateMode mode, unsigned id);
-    /// Recalculate the world transform.
+    /// Recalculate the world transform. Flushes the batched transform update of the scene first.
     void UpdateWorldTransform() const;
+    /// Mark node and child nodes dirty and notify listeners immediately.
+    void MarkDirtyHierarchy();
+    /// Notify listener components that the node was marked dirty.
+    void NotifyListeners();
     /// Remove child node by iterator.
     void RemoveChild(ea::vector<SharedPtr<Node> >::iterator i);
     /// Return child nodes recursively.
@@ -728,6 +733,8 @@ private:
     mutable Matrix3x4 worldTransform_;
     /// World transform needs update flag.
     mutable bool dirty_;
+    /// Queued for batched transform update flag.
+    bool transformQueued_;
     /// Enabled flag.
     bool enabled_;
     /// Last SetEnabled flag before any SetDeepEnabled.
@@ -764,6 +771,10 @@ private:
 protected:
     /// User variables.
     VariantMap vars_;
+
+private:
+    /// Number of scenes with queued batched transform updates. While non-zero, world transform queries flush them first.
+    static unsigned numPendingTransformStores_;
 };
 
 template <class T> T* Node::CreateComponent(CreateMode mode, unsigned id)
@@ -58,6 +58,9 @@ struct URHO3D_API DirtyBits
         memcpy(data_, bits.data_, MAX_NETWORK_ATTRIBUTES / 8);
     }
 
+    /// Copy-assign.
+    DirtyBits& operator =(const DirtyBits& rhs) = default;
+
     /// Set a bit.
     void Set(unsigned index)
     {
@@ -132,6 +135,14 @@ struct URHO3D_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_{};
+    /// Attributes changed in the last network update that had changes.
+    DirtyBits changedAttributes_;
+    /// Cached delta update payload of the changed non-latestdata attributes, without the time stamp. Shared by all connections.
+    ea::vector<unsigned char> deltaPayload_;
+    /// Cached latest data update payload without the time stamp. Shared by all connections.
+    ea::vector<unsigned char> latestDataPayload_;
+    /// Cached packed latest data update payload without the time stamp. Shared by all connections.
+    ea::vector<unsigned char> packedLatestDataPayload_;
 };
 
 /// Base class for per-user network replication states.
@@ -139,6 +150,8 @@ struct URHO3D_API ReplicationState
 {
     /// Parent network connection.
     Connection* connection_;
+    /// Quantized values of the last packed delta update, which the receiver decodes against.
+    ea::vector<int> deltaBase_;
 };
 
 /// Per-user component network replication state.
@@ -30,6 +30,7 @@
 #include "../IO/Archive.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MappedFile.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -37,11 +38,15 @@
 #include "../Resource/JSONFile.h"
 #include "../Scene/CameraViewport.h"
 #include "../Scene/Component.h"
+#include "../Scene/LogicComponentScheduler.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
+#include "../Scene/SceneCell.h"
 #include "../Scene/SceneManager.h"
+#include "../Scene/SceneSnapshot.h"
+#include "../Scene/SceneStreamer.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
 #include "../Scene/UnknownComponent.h"
@@ -327,6 +332,51 @@ bool Scene::LoadJSON(Deserializer& source)
         return false;
 }
 
+bool Scene::LoadSnapshot(const ea::string& fileName)
+{
+    MappedFile file(context_);
+    if (!file.Open(fileName))
+    {
+        URHO3D_LOGERROR("Could not open scene snapshot " + fileName);
+        return false;
+    }
+
+    URHO3D_LOGINFO("Loading scene snapshot from " + fileName);
+
+    if (!SceneSnapshot::Load(this, file.GetData(), file.GetSize()))
+        return false;
+
+    FinishLoading(fileName, file.GetData(), file.GetSize());
+    return true;
+}
+
+bool Scene::LoadSnapshot(Deserializer& source)
+{
+    ea::vector<unsigned char> data(source.GetSize() - source.GetPosition());
+    if (source.Read(data.data(), data.size()) != data.size())
+    {
+        URHO3D_LOGERROR("Could not read scene snapshot " + source.GetName());
+        return false;
+    }
+
+    URHO3D_LOGINFO("Loading scene snapshot from " + source.GetName());
+
+    if (!SceneSnapshot::Load(this, data.data(), data.size()))
+        return false;
+
+    FinishLoading(&source);
+    return true;
+}
+
+bool Scene::SaveSnapshot(Serializer& dest) const
+{
+    if (!SceneSnapshot::Save(this, dest))
+        return false;
+
+    FinishSaving(&dest);
+    return true;
+}
+
 bool Scene::SaveXML(Serializer& dest, const ea::string& indentation) const
 {
     URHO3D_PROFILE("SaveSceneXML");
@@ -736,6 +786,20 @@ void Scene::SetAsyncLoadingMs(int ms)
     asyncLoadingMs_ = Max(ms, 1);
 }
 
+void Scene::SetBatchedTransformUpdate(bool enable)
+{
+    if (enable == GetBatchedTransformUpdate())
+        return;
+
+    if (enable)
+        transformStore_ = ea::make_unique<TransformStore>(context_);
+    else
+    {
+        transformStore_->Update();
+        transformStore_.reset();
+    }
+}
+
 void Scene::SetElapsedTime(float time)
 {
     elapsedTime_ = time;
@@ -845,20 +909,25 @@ void Scene::Update(float timeStep)
 
     timeStep *= timeScale_;
 
-    using namespace SceneUpdate;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_SCENE] = this;
-    eventData[P_TIMESTEP] = timeStep;
-
     // Update variable timestep logic
-    SendEvent(E_SCENEUPDATE, eventData);
+    SceneUpdateArgs updateArgs{this, timeStep};
+    SendEvent(updateArgs);
+    if (logicComponentScheduler_)
+        logicComponentScheduler_->Update(USE_UPDATE, timeStep);
 
     // Update scene attribute animation.
-    SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    {
+        using namespace AttributeAnimationUpdate;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_SCENE] = this;
+        eventData[P_TIMESTEP] = timeStep;
+        SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
+    }
 
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
-    SendEvent(E_SCENESUBSYSTEMUPDATE, eventData);
+    SceneSubsystemUpdateArgs subsystemUpdateArgs{this, timeStep};
+    SendEvent(subsystemUpdateArgs);
 
     // Update transform smoothing
     {
@@ -875,7 +944,12 @@ void Scene::Update(float timeStep)
     }
 
     // Post-update variable timestep logic
-    SendEvent(E_SCENEPOSTUPDATE, eventData);
+    ScenePostUpdateArgs postUpdateArgs{this, timeStep};
+    SendEvent(postUpdateArgs);
+    if (logicComponentScheduler_)
+        logicComponentScheduler_->Update(USE_POSTUPDATE, timeStep);
+
+    UpdateTransforms();
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -906,6 +980,26 @@ void Scene::EndThreadedUpdate()
             (*i)->OnMarkedDirty((*i)->GetNode());
         delayedDirtyComponents_.clear();
     }
+
+    if (!delayedAddedNodes_.empty() || !delayedRemovedNodes_.empty() || !delayedEvents_.empty())
+    {
+        URHO3D_PROFILE("ApplyDelayedOperations");
+
+        // Swap out the queues, as the operations may in turn queue more
+        ea::vector<ea::pair<SharedPtr<Node>, SharedPtr<Node> > > addedNodes;
+        ea::vector<SharedPtr<Node> > removedNodes;
+        ea::vector<DelayedEvent> events;
+        addedNodes.swap(delayedAddedNodes_);
+        removedNodes.swap(delayedRemovedNodes_);
+        events.swap(delayedEvents_);
+
+        for (const auto& item : addedNodes)
+            item.first->AddChild(item.second);
+        for (const SharedPtr<Node>& node : removedNodes)
+            node->Remove();
+        for (DelayedEvent& event : events)
+            event.sender_->SendEvent(event.eventType_, event.eventData_);
+    }
 }
 
 void Scene::DelayedMarkedDirty(Component* component)
@@ -914,6 +1008,55 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.push_back(component);
 }
 
+void Scene::DelayedAddChild(Node* parent, Node* child)
+{
+    if (!threadedUpdate_)
+    {
+        parent->AddChild(child);
+        return;
+    }
+
+    MutexLock lock(sceneMutex_);
+    delayedAddedNodes_.emplace_back(SharedPtr<Node>(parent), SharedPtr<Node>(child));
+}
+
+void Scene::DelayedRemoveNode(Node* node)
+{
+    if (!threadedUpdate_)
+    {
+        node->Remove();
+        return;
+    }
+
+    MutexLock lock(sceneMutex_);
+    delayedRemovedNodes_.emplace_back(node);
+}
+
+void Scene::DelayedSendEvent(Object* sender, StringHash eventType, const VariantMap& eventData)
+{
+    if (!threadedUpdate_)
+    {
+        sender->SendEvent(eventType, eventData);
+        return;
+    }
+
+    MutexLock lock(sceneMutex_);
+    delayedEvents_.push_back(DelayedEvent{SharedPtr<Object>(sender), eventType, eventData});
+}
+
+LogicComponentScheduler* Scene::GetLogicComponentScheduler()
+{
+    if (!logicComponentScheduler_)
+        logicComponentScheduler_ = MakeShared<LogicComponentScheduler>(this);
+    return logicComponentScheduler_;
+}
+
+void Scene::UpdateTransforms()
+{
+    if (transformStore_)
+        transformStore_->Update();
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -1065,6 +1208,9 @@ void Scene::NodeRemoved(Node* node)
     else
         localNodes_.erase(id);
 
+    if (transformStore_)
+        transformStore_->RemoveNode(node);
+
     node->ResetScene();
 
     // Remove node from tag cache
@@ -1189,6 +1335,33 @@ void Scene::PrepareNetworkUpdate()
     networkUpdateComponents_.clear();
 }
 
+void Scene::PrepareParallelNetworkUpdate(bool plainFormat, bool packedFormat)
+{
+    URHO3D_PROFILE("PrepareParallelNetworkUpdate");
+
+    // Connections must not modify shared state while serializing, so do everything that is done lazily now
+    if (!GetNetworkState())
+        AllocateNetworkState();
+    CacheNetworkUpdate(plainFormat, packedFormat);
+
+    for (auto i = replicatedNodes_.begin(); i != replicatedNodes_.end(); ++i)
+    {
+        Node* node = i->second;
+        if (!node->GetNetworkState())
+            node->AllocateNetworkState();
+        node->GetWorldTransform();
+        node->CacheNetworkUpdate(plainFormat, packedFormat);
+    }
+
+    for (auto i = replicatedComponents_.begin(); i != replicatedComponents_.end(); ++i)
+    {
+        Component* component = i->second;
+        if (!component->GetNetworkState())
+            component->AllocateNetworkState();
+        component->CacheNetworkUpdate(plainFormat, packedFormat);
+    }
+}
+
 void Scene::CleanupConnection(Connection* connection)
 {
     Node::CleanupConnection(connection);
@@ -1361,6 +1534,17 @@ void Scene::FinishLoading(Deserializer* source)
     }
 }
 
+void Scene::FinishLoading(const ea::string& fileName, const unsigned char* data, unsigned size)
+{
+    // Same checksum as File::GetChecksum() of the whole file
+    unsigned checksum = 0;
+    for (unsigned i = 0; i < size; ++i)
+        checksum = SDBMHash(checksum, data[i]);
+
+    fileName_ = fileName;
+    checksum_ = checksum;
+}
+
 void Scene::FinishSaving(Serializer* dest) const
 {
     auto* ptr = dynamic_cast<Deserializer*>(dest);
@@ -1633,6 +1817,44 @@ void RegisterSceneLibrary(Context* context)
     SplinePath::RegisterObject(context);
     SceneManager::RegisterObject(context);
     CameraViewport::RegisterObject(context);
+    SceneCell::RegisterObject(context);
+    SceneStreamer::RegisterObject(context);
+}
+
+void SceneUpdateArgs::ToVariantMap(VariantMap& eventData) const
+{
+    eventData[SceneUpdate::P_SCENE] = scene_;
+    eventData[SceneUpdate::P_TIMESTEP] = timeStep_;
+}
+
+void SceneUpdateArgs::FromVariantMap(VariantMap& eventData)
+{
+    scene_ = static_cast<Scene*>(eventData[SceneUpdate::P_SCENE].GetPtr());
+    timeStep_ = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+}
+
+void SceneSubsystemUpdateArgs::ToVariantMap(VariantMap& eventData) const
+{
+    eventData[SceneSubsystemUpdate::P_SCENE] = scene_;
+    eventData[SceneSubsystemUpdate::P_TIMESTEP] = timeStep_;
+}
+
+void SceneSubsystemUpdateArgs::FromVariantMap(VariantMap& eventData)
+{
+    scene_ = static_cast<Scene*>(eventData[SceneSubsystemUpdate::P_SCENE].GetPtr());
+    timeStep_ = eventData[SceneSubsystemUpdate::P_TIMESTEP].GetFloat();
+}
+
+void ScenePostUpdateArgs::ToVariantMap(VariantMap& eventData) const
+{
+    eventData[ScenePostUpdate::P_SCENE] = scene_;
+    eventData[ScenePostUpdate::P_TIMESTEP] = timeStep_;
+}
+
+void ScenePostUpdateArgs::FromVariantMap(VariantMap& eventData)
+{
+    scene_ = static_cast<Scene*>(eventData[ScenePostUpdate::P_SCENE].GetPtr());
+    timeStep_ = eventData[ScenePostUpdate::P_TIMESTEP].GetFloat();
 }
 
 }
@@ -32,11 +32,13 @@
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
+#include "../Scene/TransformStore.h"
 
 namespace Urho3D
 {
 
 class File;
+class LogicComponentScheduler;
 class PackageFile;
 class Texture2D;
 
@@ -151,6 +153,12 @@ public:
     bool SaveXML(Serializer& dest, const ea::string& indentation = "\t") const;
     /// Save to a JSON file. Return true if successful.
     bool SaveJSON(Serializer& dest, const ea::string& indentation = "\t") const;
+    /// Load from a binary snapshot file, which is memory mapped and instantiated without parsing. Return true if successful.
+    bool LoadSnapshot(const ea::string& fileName);
+    /// Load from a binary snapshot in a stream. Return true if successful.
+    bool LoadSnapshot(Deserializer& source);
+    /// Save to a binary snapshot. Return true if successful.
+    bool SaveSnapshot(Serializer& dest) const;
     /// Load from a binary file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
     bool LoadAsync(File* file, LoadMode mode = LOAD_SCENE_AND_RESOURCES);
     /// Load from an XML file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
@@ -192,6 +200,9 @@ public:
     /// Set maximum milliseconds per frame to spend on async scene loading.
     /// @property
     void SetAsyncLoadingMs(int ms);
+    /// Set batched transform update. When enabled, moved nodes are queued and the world transforms of their subtrees are calculated in one pass after the scene update and before the octree update, or on the first world transform query. Listener components are notified during that pass. Default false.
+    /// @property
+    void SetBatchedTransformUpdate(bool enable);
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -259,6 +270,13 @@ public:
     /// @property
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return whether batched transform update is enabled.
+    /// @property
+    bool GetBatchedTransformUpdate() const { return transformStore_ != nullptr; }
+
+    /// Return batched transform update store, or null if not enabled.
+    TransformStore* GetTransformStore() const { return transformStore_.get(); }
+
     /// Return required package files.
     /// @property
     const ea::vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
@@ -274,6 +292,16 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Add a child node at the end of the threaded update, or immediately outside it. Is thread-safe.
+    void DelayedAddChild(Node* parent, Node* child);
+    /// Remove a node from its parent at the end of the threaded update, or immediately outside it. Is thread-safe.
+    void DelayedRemoveNode(Node* node);
+    /// Send an event at the end of the threaded update, or immediately outside it. Is thread-safe.
+    void DelayedSendEvent(Object* sender, StringHash eventType, const VariantMap& eventData);
+    /// Return scheduler of the parallel logic component update. Create if it does not exist.
+    LogicComponentScheduler* GetLogicComponentScheduler();
+    /// Calculate queued world transforms when batched transform update is enabled. Must be called from the main thread.
+    void UpdateTransforms();
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
@@ -304,6 +332,8 @@ public:
     ea::string GetVarNamesAttr() const;
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
+    /// Prepare replicated objects for serializing the network update of several connections on worker threads. Allocates missing network states, updates world transforms and caches the update payloads shared by the connections in the requested formats. Call after PrepareNetworkUpdate().
+    void PrepareParallelNetworkUpdate(bool plainFormat, bool packedFormat);
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
     /// Mark a node for attribute check on the next network update.
@@ -324,6 +354,8 @@ private:
     void FinishAsyncLoading();
     /// Finish loading. Sets the scene filename and checksum.
     void FinishLoading(Deserializer* source);
+    /// Finish loading from a file that was not read through a deserializer. Sets the scene filename and checksum.
+    void FinishLoading(const ea::string& fileName, const unsigned char* data, unsigned size);
     /// Finish saving. Sets the scene filename and checksum.
     void FinishSaving(Serializer* dest) const;
     /// Preload resources from a binary scene or object prefab file.
@@ -337,6 +369,17 @@ private:
     /// Mark lightmap textures dirty.
     void MarkLightmapTexturesDirty() { lightmapTexturesDirty_ = true; }
 
+    /// Event queued during threaded update.
+    struct DelayedEvent
+    {
+        /// Sender.
+        SharedPtr<Object> sender_;
+        /// Event type.
+        StringHash eventType_;
+        /// Event data.
+        VariantMap eventData_;
+    };
+
     /// Types of components that should be indexed.
     ea::vector<StringHash> indexedComponentTypes_;
     /// Indexes of components.
@@ -368,8 +411,18 @@ private:
     ea::hash_set<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     ea::vector<Component*> delayedDirtyComponents_;
-    /// Mutex for the delayed dirty notification queue.
+    /// Delayed child additions as parent and child.
+    ea::vector<ea::pair<SharedPtr<Node>, SharedPtr<Node> > > delayedAddedNodes_;
+    /// Delayed node removals.
+    ea::vector<SharedPtr<Node> > delayedRemovedNodes_;
+    /// Delayed events.
+    ea::vector<DelayedEvent> delayedEvents_;
+    /// Mutex for the delayed dirty notification and delayed operation queues.
     Mutex sceneMutex_;
+    /// Parallel logic component update scheduler.
+    SharedPtr<LogicComponentScheduler> logicComponentScheduler_;
+    /// Batched transform update store.
+    ea::unique_ptr<TransformStore> transformStore_;
     /// Preallocated event data map for smoothing update events.
     VariantMap smoothingData_;
     /// Next free non-local node ID.
@@ -0,0 +1,168 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Node.h"
+#include "../Scene/SceneCell.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+SceneCell::SceneCell(Context* context) :
+    Resource(context)
+{
+}
+
+SceneCell::~SceneCell() = default;
+
+void SceneCell::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneCell>();
+}
+
+bool SceneCell::BeginLoad(Deserializer& source)
+{
+    if (source.ReadFileID() != "UCEL")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid scene cell file");
+        return false;
+    }
+
+    cell_ = source.ReadIntVector2();
+    numNodes_ = source.ReadVLE();
+
+    const unsigned dataSize = source.GetSize() - source.GetPosition();
+    data_.resize(dataSize);
+    if (dataSize && source.Read(data_.data(), dataSize) != dataSize)
+    {
+        URHO3D_LOGERROR("Could not read node data of scene cell " + source.GetName());
+        return false;
+    }
+
+    // Start loading the referenced resources, so that instantiation does not have to wait for them
+    if (GetAsyncLoadState() == ASYNC_LOADING)
+    {
+        MemoryBuffer buffer(data_);
+        for (unsigned i = 0; i < numNodes_ && !buffer.IsEof(); ++i)
+            PreloadResources(buffer);
+    }
+
+    SetMemoryUse(sizeof(SceneCell) + dataSize);
+    return true;
+}
+
+bool SceneCell::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID("UCEL"))
+    {
+        URHO3D_LOGERROR("Could not save scene cell, writing to stream failed");
+        return false;
+    }
+
+    dest.WriteIntVector2(cell_);
+    dest.WriteVLE(numNodes_);
+    return data_.empty() || dest.Write(data_.data(), data_.size()) == data_.size();
+}
+
+bool SceneCell::SetNodes(const IntVector2& cell, const ea::vector<Node*>& nodes)
+{
+    VectorBuffer buffer;
+    unsigned numNodes = 0;
+    for (Node* node : nodes)
+    {
+        if (node->IsTemporary())
+            continue;
+
+        if (!node->Save(buffer))
+            return false;
+        ++numNodes;
+    }
+
+    cell_ = cell;
+    numNodes_ = numNodes;
+    data_ = buffer.GetBuffer();
+    SetMemoryUse(sizeof(SceneCell) + data_.size());
+    return true;
+}
+
+void SceneCell::PreloadResources(MemoryBuffer& source)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+
+    // Skip node ID and attributes, these do not include any resources
+    source.ReadUInt();
+    const ea::vector<AttributeInfo>* attributes = context_->GetAttributes(Node::GetTypeStatic());
+    for (const AttributeInfo& attr : *attributes)
+    {
+        if (attr.ShouldLoad())
+            source.ReadVariant(attr.type_, context_);
+    }
+
+    const unsigned numComponents = source.ReadVLE();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        const unsigned compSize = source.ReadVLE();
+        MemoryBuffer compBuffer(source.GetData() + source.GetPosition(), compSize);
+        source.Seek(source.GetPosition() + compSize);
+
+        const StringHash compType = compBuffer.ReadStringHash();
+        compBuffer.ReadUInt();
+
+        attributes = context_->GetAttributes(compType);
+        if (!attributes)
+            continue;
+
+        for (const AttributeInfo& attr : *attributes)
+        {
+            if (!attr.ShouldLoad())
+                continue;
+
+            const Variant value = compBuffer.ReadVariant(attr.type_, context_);
+            if (attr.type_ == VAR_RESOURCEREF)
+            {
+                const ResourceRef& ref = value.GetResourceRef();
+                cache->BackgroundLoadResource(ref.type_, ref.name_, true, this);
+            }
+            else if (attr.type_ == VAR_RESOURCEREFLIST)
+            {
+                const ResourceRefList& refList = value.GetResourceRefList();
+                for (const ea::string& name : refList.names_)
+                    cache->BackgroundLoadResource(refList.type_, name, true, this);
+            }
+        }
+    }
+
+    const unsigned numChildren = source.ReadVLE();
+    for (unsigned i = 0; i < numChildren && !source.IsEof(); ++i)
+        PreloadResources(source);
+}
+
+}
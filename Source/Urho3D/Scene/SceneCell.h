@@ -0,0 +1,77 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/Vector2.h"
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+class MemoryBuffer;
+class Node;
+
+/// Spatial cell of a streamed scene. Contains root-level nodes in the same binary format as a scene file, loaded as a resource in the background and instantiated by SceneStreamer.
+class URHO3D_API SceneCell : public Resource
+{
+    URHO3D_OBJECT(SceneCell, Resource);
+
+public:
+    /// Construct.
+    explicit SceneCell(Context* context);
+    /// Destruct.
+    ~SceneCell() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Save resource. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Serialize nodes into the cell. Temporary nodes are skipped. Return true if successful.
+    bool SetNodes(const IntVector2& cell, const ea::vector<Node*>& nodes);
+
+    /// Return cell coordinates.
+    const IntVector2& GetCell() const { return cell_; }
+    /// Return number of root-level nodes.
+    unsigned GetNumNodes() const { return numNodes_; }
+    /// Return serialized node data.
+    const ea::vector<unsigned char>& GetData() const { return data_; }
+
+private:
+    /// Queue background loading of the resources referenced by a node hierarchy.
+    void PreloadResources(MemoryBuffer& source);
+
+    /// Cell coordinates.
+    IntVector2 cell_;
+    /// Number of root-level nodes.
+    unsigned numNodes_{};
+    /// Serialized node data.
+    ea::vector<unsigned char> data_;
+};
+
+}
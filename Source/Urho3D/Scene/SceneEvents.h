@@ -27,6 +27,8 @@
 namespace Urho3D
 {
 
+class Scene;
+
 /// Variable timestep scene update.
 URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
 {
@@ -34,6 +36,22 @@ URHO3D_EVENT(E_SCENEUPDATE, SceneUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Variable timestep scene update event payload.
+struct URHO3D_API SceneUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_SCENEUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_{};
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Scene subsystem update.
 URHO3D_EVENT(E_SCENESUBSYSTEMUPDATE, SceneSubsystemUpdate)
 {
@@ -41,6 +59,22 @@ URHO3D_EVENT(E_SCENESUBSYSTEMUPDATE, SceneSubsystemUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Scene subsystem update event payload.
+struct URHO3D_API SceneSubsystemUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_SCENESUBSYSTEMUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_{};
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Scene transform smoothing update.
 URHO3D_EVENT(E_UPDATESMOOTHING, UpdateSmoothing)
 {
@@ -93,6 +127,22 @@ URHO3D_EVENT(E_SCENEPOSTUPDATE, ScenePostUpdate)
     URHO3D_PARAM(P_TIMESTEP, TimeStep);            // float
 }
 
+/// Variable timestep scene post-update event payload.
+struct URHO3D_API ScenePostUpdateArgs
+{
+    URHO3D_TYPED_EVENT(E_SCENEPOSTUPDATE)
+
+    /// Fill event data for VariantMap subscribers.
+    void ToVariantMap(VariantMap& eventData) const;
+    /// Read payload from event data of VariantMap senders.
+    void FromVariantMap(VariantMap& eventData);
+
+    /// Scene.
+    Scene* scene_{};
+    /// Time step.
+    float timeStep_{};
+};
+
 /// Asynchronous scene loading progress.
 URHO3D_EVENT(E_ASYNCLOADPROGRESS, AsyncLoadProgress)
 {
@@ -110,6 +160,20 @@ URHO3D_EVENT(E_ASYNCLOADFINISHED, AsyncLoadFinished)
     URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
 }
 
+/// Nodes of a streamed scene cell have been instantiated.
+URHO3D_EVENT(E_SCENECELLLOADED, SceneCellLoaded)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
+    URHO3D_PARAM(P_CELL, Cell);                    // IntVector2
+}
+
+/// Nodes of a streamed scene cell have been removed.
+URHO3D_EVENT(E_SCENECELLUNLOADED, SceneCellUnloaded)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                  // Scene pointer
+    URHO3D_PARAM(P_CELL, Cell);                    // IntVector2
+}
+
 /// A child node has been added to a parent node.
 URHO3D_EVENT(E_NODEADDED, NodeAdded)
 {
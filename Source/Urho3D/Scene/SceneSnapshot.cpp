@@ -0,0 +1,812 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Scene/Component.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneResolver.h"
+#include "../Scene/SceneSnapshot.h"
+
+#include <EASTL/hash_set.h>
+#include <EASTL/unordered_map.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Snapshot format version. Increment when the layout changes.
+const unsigned SNAPSHOT_VERSION = 1;
+/// Index value for no parent node.
+const unsigned NO_PARENT = M_MAX_UNSIGNED;
+
+/// Snapshot file header. All offsets are from the beginning of the file and 4-byte aligned.
+struct SnapshotHeader
+{
+    /// File ID "USNP".
+    char fileID_[4];
+    /// Format version.
+    unsigned version_;
+    /// Total size in bytes.
+    unsigned size_;
+    /// Number of string table entries.
+    unsigned numStrings_;
+    /// Offset of string table entries.
+    unsigned stringsOffset_;
+    /// Number of serializable types.
+    unsigned numTypes_;
+    /// Offset of type entries.
+    unsigned typesOffset_;
+    /// Number of nodes.
+    unsigned numNodes_;
+    /// Offset of node entries, in depth first order with the root first.
+    unsigned nodesOffset_;
+    /// Number of components.
+    unsigned numComponents_;
+    /// Offset of component entries.
+    unsigned componentsOffset_;
+    /// Number of referenced resources.
+    unsigned numResources_;
+    /// Offset of resource entries.
+    unsigned resourcesOffset_;
+    /// Offset of variable size attribute data.
+    unsigned dataOffset_;
+    /// Size of variable size attribute data.
+    unsigned dataSize_;
+};
+
+/// String table entry. Characters are followed by a null terminator.
+struct StringEntry
+{
+    /// Offset of characters.
+    unsigned offset_;
+    /// Length without the null terminator.
+    unsigned length_;
+};
+
+/// Serializable type with the records of all its instances.
+struct TypeEntry
+{
+    /// Type name string.
+    unsigned name_;
+    /// Number of attribute entries.
+    unsigned numAttributes_;
+    /// Offset of attribute entries.
+    unsigned attributesOffset_;
+    /// Size of one record in bytes.
+    unsigned recordSize_;
+    /// Number of records.
+    unsigned numRecords_;
+    /// Offset of records.
+    unsigned recordsOffset_;
+};
+
+/// Attribute stored in the records of a type.
+struct AttributeEntry
+{
+    /// Attribute name string.
+    unsigned name_;
+    /// Variant type.
+    unsigned type_;
+    /// Offset of the value within a record.
+    unsigned offset_;
+};
+
+/// Node in the hierarchy.
+struct NodeEntry
+{
+    /// Node ID.
+    unsigned id_;
+    /// Parent node index, or NO_PARENT for the root.
+    unsigned parent_;
+    /// Type index.
+    unsigned type_;
+    /// Record index.
+    unsigned record_;
+    /// Index of the first component.
+    unsigned firstComponent_;
+    /// Number of components.
+    unsigned numComponents_;
+};
+
+/// Component of a node.
+struct ComponentEntry
+{
+    /// Component ID.
+    unsigned id_;
+    /// Type index.
+    unsigned type_;
+    /// Record index.
+    unsigned record_;
+};
+
+/// Resource referenced by attributes.
+struct ResourceEntry
+{
+    /// Resource type hash.
+    unsigned type_;
+    /// Resource name string.
+    unsigned name_;
+};
+
+/// Return size of an attribute value in a record. Types without a fixed size store an offset and size into the variable size data.
+unsigned GetRecordValueSize(VariantType type)
+{
+    switch (type)
+    {
+    case VAR_INT:
+    case VAR_BOOL:
+    case VAR_FLOAT:
+    case VAR_STRING:
+        return 4;
+    case VAR_VECTOR2:
+    case VAR_INTVECTOR2:
+    case VAR_DOUBLE:
+    case VAR_INT64:
+    case VAR_RESOURCEREF:
+        return 8;
+    case VAR_VECTOR3:
+    case VAR_INTVECTOR3:
+        return 12;
+    case VAR_VECTOR4:
+    case VAR_QUATERNION:
+    case VAR_COLOR:
+    case VAR_INTRECT:
+    case VAR_RECT:
+        return 16;
+    case VAR_MATRIX3:
+        return sizeof(Matrix3);
+    case VAR_MATRIX3X4:
+        return sizeof(Matrix3x4);
+    case VAR_MATRIX4:
+        return sizeof(Matrix4);
+    default:
+        return 8;
+    }
+}
+
+/// Copy a value into a record.
+template <class T> void StoreValue(unsigned char* dest, const T& value)
+{
+    memcpy(dest, &value, sizeof(T));
+}
+
+/// Copy a value out of a record.
+template <class T> T LoadValue(const unsigned char* src)
+{
+    T value;
+    memcpy(static_cast<void*>(&value), src, sizeof(T));
+    return value;
+}
+
+/// Snapshot builder.
+class SnapshotWriter
+{
+public:
+    /// Add a node and its persistent components and children.
+    void AddNode(const Node* node, unsigned parent)
+    {
+        const unsigned index = nodes_.size();
+        nodes_.emplace_back();
+        nodes_[index].id_ = node->GetID();
+        nodes_[index].parent_ = parent;
+        nodes_[index].type_ = GetTypeIndex(node);
+        nodes_[index].record_ = AddRecord(node, nodes_[index].type_);
+        nodes_[index].firstComponent_ = components_.size();
+
+        for (const SharedPtr<Component>& component : node->GetComponents())
+        {
+            if (component->IsTemporary())
+                continue;
+
+            ComponentEntry entry;
+            entry.id_ = component->GetID();
+            entry.type_ = GetTypeIndex(component);
+            entry.record_ = AddRecord(component, entry.type_);
+            components_.push_back(entry);
+        }
+        nodes_[index].numComponents_ = components_.size() - nodes_[index].firstComponent_;
+
+        for (const SharedPtr<Node>& child : node->GetChildren())
+        {
+            if (!child->IsTemporary())
+                AddNode(child, index);
+        }
+    }
+
+    /// Write the snapshot.
+    bool Write(Serializer& dest)
+    {
+        // Lay out the sections
+        SnapshotHeader header{};
+        memcpy(header.fileID_, "USNP", 4);
+        header.version_ = SNAPSHOT_VERSION;
+
+        unsigned offset = sizeof(SnapshotHeader);
+        header.numStrings_ = strings_.size();
+        header.stringsOffset_ = Allocate(offset, strings_.size() * sizeof(StringEntry));
+        header.numTypes_ = types_.size();
+        header.typesOffset_ = Allocate(offset, types_.size() * sizeof(TypeEntry));
+        for (TypeData& type : types_)
+        {
+            type.entry_.attributesOffset_ = Allocate(offset, type.attributes_.size() * sizeof(AttributeEntry));
+            type.entry_.recordsOffset_ = Allocate(offset, type.records_.size());
+        }
+        header.numNodes_ = nodes_.size();
+        header.nodesOffset_ = Allocate(offset, nodes_.size() * sizeof(NodeEntry));
+        header.numComponents_ = components_.size();
+        header.componentsOffset_ = Allocate(offset, components_.size() * sizeof(ComponentEntry));
+        header.numResources_ = resources_.size();
+        header.resourcesOffset_ = Allocate(offset, resources_.size() * sizeof(ResourceEntry));
+        header.dataSize_ = data_.GetSize();
+        header.dataOffset_ = Allocate(offset, data_.GetSize());
+
+        ea::vector<StringEntry> stringEntries(strings_.size());
+        for (unsigned i = 0; i < strings_.size(); ++i)
+        {
+            stringEntries[i].offset_ = Allocate(offset, strings_[i].length() + 1);
+            stringEntries[i].length_ = strings_[i].length();
+        }
+        header.size_ = offset;
+
+        // Write them in the same order
+        bool success = dest.Write(&header, sizeof(header)) == sizeof(header);
+        success &= WriteSection(dest, stringEntries.data(), stringEntries.size() * sizeof(StringEntry));
+        ea::vector<TypeEntry> typeEntries;
+        for (const TypeData& type : types_)
+            typeEntries.push_back(type.entry_);
+        success &= WriteSection(dest, typeEntries.data(), typeEntries.size() * sizeof(TypeEntry));
+        for (const TypeData& type : types_)
+        {
+            success &= WriteSection(dest, type.attributes_.data(), type.attributes_.size() * sizeof(AttributeEntry));
+            success &= WriteSection(dest, type.records_.data(), type.records_.size());
+        }
+        success &= WriteSection(dest, nodes_.data(), nodes_.size() * sizeof(NodeEntry));
+        success &= WriteSection(dest, components_.data(), components_.size() * sizeof(ComponentEntry));
+        success &= WriteSection(dest, resources_.data(), resources_.size() * sizeof(ResourceEntry));
+        success &= WriteSection(dest, data_.GetData(), data_.GetSize());
+        for (const ea::string& str : strings_)
+            success &= WriteSection(dest, str.c_str(), str.length() + 1);
+
+        return success;
+    }
+
+private:
+    /// Type being written.
+    struct TypeData
+    {
+        /// Type entry.
+        TypeEntry entry_{};
+        /// Attribute entries.
+        ea::vector<AttributeEntry> attributes_;
+        /// Attribute infos in the same order.
+        ea::vector<const AttributeInfo*> infos_;
+        /// Records of all instances.
+        ea::vector<unsigned char> records_;
+    };
+
+    /// Return aligned offset of a section and advance past it.
+    static unsigned Allocate(unsigned& offset, unsigned size)
+    {
+        const unsigned ret = offset;
+        offset += (size + 3) & ~3u;
+        return ret;
+    }
+
+    /// Write a section padded to 4 bytes.
+    static bool WriteSection(Serializer& dest, const void* data, unsigned size)
+    {
+        static const unsigned char padding[4]{};
+        const unsigned paddingSize = ((size + 3) & ~3u) - size;
+        return dest.Write(data, size) == size && dest.Write(padding, paddingSize) == paddingSize;
+    }
+
+    /// Return index of a string, adding it to the table if necessary.
+    unsigned GetStringIndex(const ea::string& str)
+    {
+        auto i = stringIndices_.find(str);
+        if (i != stringIndices_.end())
+            return i->second;
+
+        const unsigned index = strings_.size();
+        strings_.push_back(str);
+        stringIndices_[str] = index;
+        return index;
+    }
+
+    /// Add a resource to the preload list.
+    void AddResource(StringHash type, const ea::string& name)
+    {
+        if (name.empty())
+            return;
+
+        ResourceEntry entry;
+        entry.type_ = type.Value();
+        entry.name_ = GetStringIndex(name);
+        if (resourceSet_.insert(ea::make_pair(entry.type_, entry.name_)).second)
+            resources_.push_back(entry);
+    }
+
+    /// Return index of the type of an object, adding it if necessary.
+    unsigned GetTypeIndex(const Serializable* object)
+    {
+        auto i = typeIndices_.find(object->GetType());
+        if (i != typeIndices_.end())
+            return i->second;
+
+        const unsigned index = types_.size();
+        typeIndices_[object->GetType()] = index;
+        types_.emplace_back();
+
+        TypeData& type = types_.back();
+        type.entry_.name_ = GetStringIndex(object->GetTypeName());
+        if (const ea::vector<AttributeInfo>* attributes = object->GetAttributes())
+        {
+            for (const AttributeInfo& attr : *attributes)
+            {
+                if (!attr.ShouldSave())
+                    continue;
+
+                AttributeEntry entry;
+                entry.name_ = GetStringIndex(attr.name_);
+                entry.type_ = attr.type_;
+                entry.offset_ = type.entry_.recordSize_;
+                type.entry_.recordSize_ += GetRecordValueSize(attr.type_);
+                type.attributes_.push_back(entry);
+                type.infos_.push_back(&attr);
+            }
+        }
+        type.entry_.numAttributes_ = type.attributes_.size();
+        return index;
+    }
+
+    /// Add the attribute record of an object and return its index.
+    unsigned AddRecord(const Serializable* object, unsigned typeIndex)
+    {
+        TypeData& type = types_[typeIndex];
+        const unsigned index = type.entry_.numRecords_++;
+        type.records_.resize(type.records_.size() + type.entry_.recordSize_);
+        unsigned char* record = type.records_.data() + index * type.entry_.recordSize_;
+
+        Variant value;
+        for (unsigned i = 0; i < type.infos_.size(); ++i)
+        {
+            object->OnGetAttribute(*type.infos_[i], value);
+            StoreAttribute(record + type.attributes_[i].offset_, type.infos_[i]->type_, value);
+        }
+        return index;
+    }
+
+    /// Store an attribute value in a record.
+    void StoreAttribute(unsigned char* dest, VariantType type, const Variant& value)
+    {
+        switch (type)
+        {
+        case VAR_INT: StoreValue(dest, value.GetInt()); break;
+        case VAR_BOOL: StoreValue(dest, (unsigned)value.GetBool()); break;
+        case VAR_FLOAT: StoreValue(dest, value.GetFloat()); break;
+        case VAR_STRING: StoreValue(dest, GetStringIndex(value.GetString())); break;
+        case VAR_VECTOR2: StoreValue(dest, value.GetVector2()); break;
+        case VAR_INTVECTOR2: StoreValue(dest, value.GetIntVector2()); break;
+        case VAR_DOUBLE: StoreValue(dest, value.GetDouble()); break;
+        case VAR_INT64: StoreValue(dest, value.GetInt64()); break;
+        case VAR_VECTOR3: StoreValue(dest, value.GetVector3()); break;
+        case VAR_INTVECTOR3: StoreValue(dest, value.GetIntVector3()); break;
+        case VAR_VECTOR4: StoreValue(dest, value.GetVector4()); break;
+        case VAR_QUATERNION: StoreValue(dest, value.GetQuaternion()); break;
+        case VAR_COLOR: StoreValue(dest, value.GetColor()); break;
+        case VAR_INTRECT: StoreValue(dest, value.GetIntRect()); break;
+        case VAR_RECT: StoreValue(dest, value.GetRect()); break;
+        case VAR_MATRIX3: StoreValue(dest, value.GetMatrix3()); break;
+        case VAR_MATRIX3X4: StoreValue(dest, value.GetMatrix3x4()); break;
+        case VAR_MATRIX4: StoreValue(dest, value.GetMatrix4()); break;
+
+        case VAR_RESOURCEREF:
+            {
+                const ResourceRef& ref = value.GetResourceRef();
+                StoreValue(dest, ref.type_.Value());
+                StoreValue(dest + 4, GetStringIndex(ref.name_));
+                AddResource(ref.type_, ref.name_);
+            }
+            break;
+
+        default:
+            {
+                if (type == VAR_RESOURCEREFLIST)
+                {
+                    const ResourceRefList& refList = value.GetResourceRefList();
+                    for (const ea::string& name : refList.names_)
+                        AddResource(refList.type_, name);
+                }
+
+                const unsigned offset = data_.GetSize();
+                data_.WriteVariantData(value);
+                StoreValue(dest, offset);
+                StoreValue(dest + 4, data_.GetSize() - offset);
+            }
+            break;
+        }
+    }
+
+    /// Strings.
+    ea::vector<ea::string> strings_;
+    /// String indices.
+    ea::unordered_map<ea::string, unsigned> stringIndices_;
+    /// Types.
+    ea::vector<TypeData> types_;
+    /// Type indices.
+    ea::unordered_map<StringHash, unsigned> typeIndices_;
+    /// Nodes.
+    ea::vector<NodeEntry> nodes_;
+    /// Components.
+    ea::vector<ComponentEntry> components_;
+    /// Referenced resources.
+    ea::vector<ResourceEntry> resources_;
+    /// Referenced resources as type and name index pairs.
+    ea::hash_set<ea::pair<unsigned, unsigned> > resourceSet_;
+    /// Variable size attribute data.
+    VectorBuffer data_;
+};
+
+/// Attribute of a snapshot type matched to a registered attribute.
+struct LoadAttribute
+{
+    /// Registered attribute.
+    const AttributeInfo* info_;
+    /// Offset of the value within a record.
+    unsigned offset_;
+};
+
+/// Snapshot type matched to a registered type.
+struct LoadType
+{
+    /// Type name.
+    const ea::string* name_;
+    /// Type hash.
+    StringHash type_;
+    /// Whether instances can be created.
+    bool valid_;
+    /// Matched attributes.
+    ea::vector<LoadAttribute> attributes_;
+    /// Records.
+    const unsigned char* records_;
+    /// Size of one record.
+    unsigned recordSize_;
+    /// Number of records.
+    unsigned numRecords_;
+};
+
+/// Snapshot reader.
+class SnapshotReader
+{
+public:
+    /// Construct.
+    SnapshotReader(Context* context, const unsigned char* data, unsigned size) :
+        context_(context),
+        data_(data),
+        size_(size)
+    {
+    }
+
+    /// Validate the snapshot and match its types with the registered ones. Return true if successful.
+    bool Open()
+    {
+        if (size_ < sizeof(SnapshotHeader) || memcmp(data_, "USNP", 4) != 0)
+        {
+            URHO3D_LOGERROR("Not a valid scene snapshot");
+            return false;
+        }
+
+        header_ = reinterpret_cast<const SnapshotHeader*>(data_);
+        if (header_->version_ != SNAPSHOT_VERSION)
+        {
+            URHO3D_LOGERROR("Unsupported scene snapshot version " + ea::to_string(header_->version_));
+            return false;
+        }
+
+        if (header_->size_ > size_ || !CheckRange(header_->stringsOffset_, header_->numStrings_, sizeof(StringEntry)) ||
+            !CheckRange(header_->typesOffset_, header_->numTypes_, sizeof(TypeEntry)) ||
+            !CheckRange(header_->nodesOffset_, header_->numNodes_, sizeof(NodeEntry)) ||
+            !CheckRange(header_->componentsOffset_, header_->numComponents_, sizeof(ComponentEntry)) ||
+            !CheckRange(header_->resourcesOffset_, header_->numResources_, sizeof(ResourceEntry)) ||
+            !CheckRange(header_->dataOffset_, header_->dataSize_, 1))
+        {
+            URHO3D_LOGERROR("Scene snapshot is truncated");
+            return false;
+        }
+
+        // Strings are needed as Variants anyway, so convert them once
+        const auto* stringEntries = reinterpret_cast<const StringEntry*>(data_ + header_->stringsOffset_);
+        strings_.resize(header_->numStrings_);
+        for (unsigned i = 0; i < header_->numStrings_; ++i)
+        {
+            if (!CheckRange(stringEntries[i].offset_, stringEntries[i].length_, 1))
+            {
+                URHO3D_LOGERROR("Scene snapshot is truncated");
+                return false;
+            }
+            strings_[i].assign(reinterpret_cast<const char*>(data_ + stringEntries[i].offset_), stringEntries[i].length_);
+        }
+
+        // Match the stored attributes to the registered ones once per type
+        const auto* typeEntries = reinterpret_cast<const TypeEntry*>(data_ + header_->typesOffset_);
+        types_.resize(header_->numTypes_);
+        for (unsigned i = 0; i < header_->numTypes_; ++i)
+        {
+            const TypeEntry& entry = typeEntries[i];
+            if (entry.name_ >= strings_.size() || !CheckRange(entry.attributesOffset_, entry.numAttributes_, sizeof(AttributeEntry)) ||
+                !CheckRange(entry.recordsOffset_, entry.numRecords_, entry.recordSize_))
+            {
+                URHO3D_LOGERROR("Scene snapshot is truncated");
+                return false;
+            }
+
+            LoadType& type = types_[i];
+            type.name_ = &strings_[entry.name_];
+            type.type_ = StringHash(*type.name_);
+            type.records_ = data_ + entry.recordsOffset_;
+            type.recordSize_ = entry.recordSize_;
+            type.numRecords_ = entry.numRecords_;
+
+            const auto& factories = context_->GetObjectFactories();
+            type.valid_ = factories.find(type.type_) != factories.end();
+            if (!type.valid_)
+            {
+                URHO3D_LOGWARNING("Unknown type " + *type.name_ + " in scene snapshot, skipping its instances");
+                continue;
+            }
+
+            const ea::vector<AttributeInfo>* attributes = context_->GetAttributes(type.type_);
+            const auto* attributeEntries = reinterpret_cast<const AttributeEntry*>(data_ + entry.attributesOffset_);
+            for (unsigned j = 0; j < entry.numAttributes_; ++j)
+            {
+                const AttributeEntry& attrEntry = attributeEntries[j];
+                const AttributeInfo* info = nullptr;
+                if (attributes && attrEntry.name_ < strings_.size())
+                {
+                    for (const AttributeInfo& attr : *attributes)
+                    {
+                        if (attr.name_ == strings_[attrEntry.name_] && attr.type_ == attrEntry.type_ && attr.ShouldLoad())
+                        {
+                            info = &attr;
+                            break;
+                        }
+                    }
+                }
+
+                if (info && attrEntry.offset_ + GetRecordValueSize(info->type_) <= entry.recordSize_)
+                    type.attributes_.push_back(LoadAttribute{info, attrEntry.offset_});
+                else
+                    URHO3D_LOGWARNING("Skipping attribute " + GetString(attrEntry.name_) + " of " + *type.name_ + " in scene snapshot");
+            }
+        }
+
+        return true;
+    }
+
+    /// Start background loading the referenced resources.
+    void PreloadResources()
+    {
+#ifdef URHO3D_THREADING
+        auto* cache = context_->GetSubsystem<ResourceCache>();
+        if (!cache)
+            return;
+
+        const auto* resources = reinterpret_cast<const ResourceEntry*>(data_ + header_->resourcesOffset_);
+        for (unsigned i = 0; i < header_->numResources_; ++i)
+        {
+            if (resources[i].name_ < strings_.size())
+                cache->BackgroundLoadResource(StringHash(resources[i].type_), strings_[resources[i].name_]);
+        }
+#endif
+    }
+
+    /// Instantiate the nodes and components into the scene.
+    bool Instantiate(Scene* scene)
+    {
+        const auto* nodes = reinterpret_cast<const NodeEntry*>(data_ + header_->nodesOffset_);
+        const auto* components = reinterpret_cast<const ComponentEntry*>(data_ + header_->componentsOffset_);
+        if (!header_->numNodes_ || nodes[0].parent_ != NO_PARENT)
+        {
+            URHO3D_LOGERROR("Scene snapshot has no root node");
+            return false;
+        }
+
+        SceneResolver resolver;
+        ea::vector<Node*> createdNodes(header_->numNodes_);
+        for (unsigned i = 0; i < header_->numNodes_; ++i)
+        {
+            const NodeEntry& entry = nodes[i];
+            Node* node = scene;
+            if (i > 0)
+            {
+                // Parents always precede their children
+                if (entry.parent_ >= i)
+                {
+                    URHO3D_LOGERROR("Invalid node hierarchy in scene snapshot");
+                    return false;
+                }
+                node = createdNodes[entry.parent_]->CreateChild(entry.id_, Scene::IsReplicatedID(entry.id_) ? REPLICATED : LOCAL);
+            }
+            createdNodes[i] = node;
+            resolver.AddNode(entry.id_, node);
+            if (!ApplyRecord(node, entry.type_, entry.record_))
+                return false;
+
+            if (entry.firstComponent_ + entry.numComponents_ > header_->numComponents_)
+            {
+                URHO3D_LOGERROR("Invalid component range in scene snapshot");
+                return false;
+            }
+
+            for (unsigned j = entry.firstComponent_; j < entry.firstComponent_ + entry.numComponents_; ++j)
+            {
+                const ComponentEntry& componentEntry = components[j];
+                if (componentEntry.type_ >= types_.size() || !types_[componentEntry.type_].valid_)
+                    continue;
+
+                Component* component = node->CreateComponent(types_[componentEntry.type_].type_,
+                    Scene::IsReplicatedID(componentEntry.id_) ? REPLICATED : LOCAL, componentEntry.id_);
+                if (!component)
+                    continue;
+
+                resolver.AddComponent(componentEntry.id_, component);
+                if (!ApplyRecord(component, componentEntry.type_, componentEntry.record_))
+                    return false;
+            }
+        }
+
+        resolver.Resolve();
+        return true;
+    }
+
+private:
+    /// Return whether an array is within the snapshot.
+    bool CheckRange(unsigned offset, unsigned count, unsigned elementSize) const
+    {
+        return offset <= size_ && (unsigned long long)count * elementSize <= size_ - offset;
+    }
+
+    /// Set the attributes of an object from its record.
+    bool ApplyRecord(Serializable* object, unsigned typeIndex, unsigned recordIndex)
+    {
+        if (typeIndex >= types_.size() || recordIndex >= types_[typeIndex].numRecords_)
+        {
+            URHO3D_LOGERROR("Invalid record in scene snapshot");
+            return false;
+        }
+
+        const LoadType& type = types_[typeIndex];
+        const unsigned char* record = type.records_ + recordIndex * type.recordSize_;
+        for (const LoadAttribute& attr : type.attributes_)
+            object->OnSetAttribute(*attr.info_, LoadAttributeValue(record + attr.offset_, attr.info_->type_));
+        return true;
+    }
+
+    /// Construct an attribute value from a record. Fixed size values are copied directly.
+    Variant LoadAttributeValue(const unsigned char* src, VariantType type) const
+    {
+        switch (type)
+        {
+        case VAR_INT: return LoadValue<int>(src);
+        case VAR_BOOL: return LoadValue<unsigned>(src) != 0;
+        case VAR_FLOAT: return LoadValue<float>(src);
+        case VAR_STRING: return GetString(LoadValue<unsigned>(src));
+        case VAR_VECTOR2: return LoadValue<Vector2>(src);
+        case VAR_INTVECTOR2: return LoadValue<IntVector2>(src);
+        case VAR_DOUBLE: return LoadValue<double>(src);
+        case VAR_INT64: return LoadValue<long long>(src);
+        case VAR_VECTOR3: return LoadValue<Vector3>(src);
+        case VAR_INTVECTOR3: return LoadValue<IntVector3>(src);
+        case VAR_VECTOR4: return LoadValue<Vector4>(src);
+        case VAR_QUATERNION: return LoadValue<Quaternion>(src);
+        case VAR_COLOR: return LoadValue<Color>(src);
+        case VAR_INTRECT: return LoadValue<IntRect>(src);
+        case VAR_RECT: return LoadValue<Rect>(src);
+        case VAR_MATRIX3: return LoadValue<Matrix3>(src);
+        case VAR_MATRIX3X4: return LoadValue<Matrix3x4>(src);
+        case VAR_MATRIX4: return LoadValue<Matrix4>(src);
+        case VAR_RESOURCEREF: return ResourceRef(StringHash(LoadValue<unsigned>(src)), GetString(LoadValue<unsigned>(src + 4)));
+
+        default:
+            {
+                const unsigned offset = LoadValue<unsigned>(src);
+                const unsigned size = LoadValue<unsigned>(src + 4);
+                if (offset > header_->dataSize_ || size > header_->dataSize_ - offset)
+                    return Variant::EMPTY;
+
+                MemoryBuffer buffer(data_ + header_->dataOffset_ + offset, size);
+                return buffer.ReadVariant(type, context_);
+            }
+        }
+    }
+
+    /// Return a string from the string table.
+    const ea::string& GetString(unsigned index) const { return index < strings_.size() ? strings_[index] : EMPTY_STRING; }
+
+    /// Context.
+    Context* context_;
+    /// Snapshot data.
+    const unsigned char* data_;
+    /// Snapshot size.
+    unsigned size_;
+    /// Header.
+    const SnapshotHeader* header_{};
+    /// String table.
+    ea::vector<ea::string> strings_;
+    /// Types.
+    ea::vector<LoadType> types_;
+};
+
+}
+
+bool SceneSnapshot::Save(const Node* node, Serializer& dest)
+{
+    URHO3D_PROFILE("SaveSceneSnapshot");
+
+    if (!node)
+        return false;
+
+    SnapshotWriter writer;
+    writer.AddNode(node, NO_PARENT);
+    if (!writer.Write(dest))
+    {
+        URHO3D_LOGERROR("Could not save scene snapshot, writing to stream failed");
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneSnapshot::Load(Scene* scene, const unsigned char* data, unsigned size)
+{
+    URHO3D_PROFILE("LoadSceneSnapshot");
+
+    if (!scene || !data)
+        return false;
+
+    SnapshotReader reader(scene->GetContext(), data, size);
+    if (!reader.Open())
+        return false;
+
+    scene->StopAsyncLoading();
+    reader.PreloadResources();
+    scene->Clear();
+
+    if (!reader.Instantiate(scene))
+        return false;
+
+    scene->ApplyAttributes();
+    return true;
+}
+
+}
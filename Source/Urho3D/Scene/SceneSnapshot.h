@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Urho3D.h>
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+class Serializer;
+
+/// Versioned binary scene snapshot. Strings and resource names are stored once in a string table and attribute values of each type in fixed-size records, so that a memory mapped snapshot can be instantiated without a parsing pass. Resource references are listed separately to start loading them before instantiation.
+class URHO3D_API SceneSnapshot
+{
+public:
+    /// Save a node hierarchy, normally a scene. Temporary nodes and components are skipped. Return true if successful.
+    static bool Save(const Node* node, Serializer& dest);
+    /// Instantiate a snapshot into a scene, which is cleared first. The data must stay valid during the call. Return true if successful.
+    static bool Load(Scene* scene, const unsigned char* data, unsigned size);
+};
+
+}
@@ -0,0 +1,423 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneCell.h"
+#include "../Scene/SceneEvents.h"
+#include "../Scene/SceneStreamer.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* SCENE_CATEGORY;
+
+static const float DEFAULT_CELL_SIZE = 100.0f;
+static const float DEFAULT_LOAD_DISTANCE = 250.0f;
+static const float DEFAULT_UNLOAD_DISTANCE = 300.0f;
+static const unsigned DEFAULT_MAX_LOADING_CELLS = 2;
+static const int DEFAULT_INSTANTIATE_MS = 5;
+
+SceneStreamer::SceneStreamer(Context* context) :
+    Component(context),
+    cellPrefix_("Cells/"),
+    cellSize_(DEFAULT_CELL_SIZE),
+    loadDistance_(DEFAULT_LOAD_DISTANCE),
+    unloadDistance_(DEFAULT_UNLOAD_DISTANCE),
+    maxLoadingCells_(DEFAULT_MAX_LOADING_CELLS),
+    instantiateMs_(DEFAULT_INSTANTIATE_MS),
+    persistentTag_("Persistent")
+{
+}
+
+SceneStreamer::~SceneStreamer() = default;
+
+void SceneStreamer::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneStreamer>(SCENE_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Cell Prefix", ea::string, cellPrefix_, "Cells/", AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cell Size", GetCellSize, SetCellSize, float, DEFAULT_CELL_SIZE, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Load Distance", float, loadDistance_, DEFAULT_LOAD_DISTANCE, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Unload Distance", float, unloadDistance_, DEFAULT_UNLOAD_DISTANCE, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Max Loading Cells", unsigned, maxLoadingCells_, DEFAULT_MAX_LOADING_CELLS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Instantiate Ms", GetInstantiateMs, SetInstantiateMs, int, DEFAULT_INSTANTIATE_MS, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Persistent Tag", ea::string, persistentTag_, "Persistent", AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cells", GetCellsAttr, SetCellsAttr, VariantVector, Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
+}
+
+bool SceneStreamer::SaveCells(const ea::string& resourceDir)
+{
+    Scene* scene = GetScene();
+    if (!scene)
+    {
+        URHO3D_LOGERROR("Can not save cells, streamer is not in a scene");
+        return false;
+    }
+
+    for (const auto& item : cells_)
+    {
+        if (item.second.state_ != CELL_LOADED)
+        {
+            URHO3D_LOGERROR("Can not save cells, all cells must be loaded");
+            return false;
+        }
+    }
+
+    // Group root-level nodes by the cell containing their position
+    ea::unordered_map<IntVector2, ea::vector<Node*> > cellNodes;
+    for (const SharedPtr<Node>& child : scene->GetChildren())
+    {
+        if (child->IsTemporary() || child == node_ || child->HasTag(persistentTag_))
+            continue;
+        if (observer_ && (observer_ == child || observer_->IsChildOf(child)))
+            continue;
+
+        cellNodes[GetCellCoordinates(child->GetWorldPosition())].push_back(child);
+    }
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    for (const auto& item : cellNodes)
+    {
+        SceneCell cell(context_);
+        const ea::string fileName = AddTrailingSlash(resourceDir) + GetCellResourceName(item.first);
+        fileSystem->CreateDirsRecursive(GetPath(fileName));
+        if (!cell.SetNodes(item.first, item.second) || !cell.SaveFile(fileName))
+        {
+            URHO3D_LOGERROR("Could not save scene cell " + fileName);
+            return false;
+        }
+    }
+
+    // Cells now live in the files
+    for (auto& item : cells_)
+        item.second.nodes_.clear();
+    for (const auto& item : cellNodes)
+    {
+        for (Node* node : item.second)
+            node->Remove();
+    }
+
+    cells_.clear();
+    loadingCells_.clear();
+    for (const auto& item : cellNodes)
+        cells_[item.first].coordinates_ = item.first;
+
+    return true;
+}
+
+void SceneStreamer::UnloadCells()
+{
+    for (auto& item : cells_)
+        UnloadCell(item.second);
+}
+
+void SceneStreamer::SetCellSize(float size)
+{
+    if (!cells_.empty() && size != cellSize_)
+        URHO3D_LOGWARNING("Changing cell size of a streamer with saved cells, cells must be saved again");
+    cellSize_ = Max(size, M_EPSILON);
+}
+
+unsigned SceneStreamer::GetNumLoadedCells() const
+{
+    unsigned numLoaded = 0;
+    for (const auto& item : cells_)
+    {
+        if (item.second.state_ == CELL_LOADED)
+            ++numLoaded;
+    }
+    return numLoaded;
+}
+
+SceneCellState SceneStreamer::GetCellState(const IntVector2& cell) const
+{
+    auto iter = cells_.find(cell);
+    return iter != cells_.end() ? iter->second.state_ : CELL_UNLOADED;
+}
+
+IntVector2 SceneStreamer::GetCellCoordinates(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+ea::string SceneStreamer::GetCellResourceName(const IntVector2& cell) const
+{
+    return Format("{}{}_{}.cell", cellPrefix_, cell.x_, cell.y_);
+}
+
+void SceneStreamer::SetCellsAttr(const VariantVector& value)
+{
+    UnloadCells();
+    cells_.clear();
+    loadingCells_.clear();
+
+    // Cells of a newly loaded scene are not in it yet
+    for (const Variant& cell : value)
+        cells_[cell.GetIntVector2()].coordinates_ = cell.GetIntVector2();
+}
+
+VariantVector SceneStreamer::GetCellsAttr() const
+{
+    VariantVector ret;
+    ret.reserve(cells_.size());
+    for (const auto& item : cells_)
+        ret.push_back(item.first);
+    return ret;
+}
+
+void SceneStreamer::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(SceneStreamer, HandleSceneUpdate));
+        SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(SceneStreamer, HandleResourceBackgroundLoaded));
+    }
+    else
+    {
+        UnsubscribeFromEvent(E_SCENEUPDATE);
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+    }
+}
+
+void SceneStreamer::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (!observer_ || cells_.empty() || !IsEnabledEffective())
+        return;
+
+    URHO3D_PROFILE("UpdateSceneStreaming");
+
+    // Update distances and unload cells out of range
+    const Vector3 position = observer_->GetWorldPosition();
+    sortedCells_.clear();
+    unsigned numLoading = 0;
+    for (auto& item : cells_)
+    {
+        Cell& cell = item.second;
+        cell.distance_ = GetDistanceToCell(cell.coordinates_, position);
+
+        if (cell.state_ != CELL_UNLOADED && cell.distance_ > unloadDistance_)
+            UnloadCell(cell);
+
+        if (cell.state_ == CELL_INSTANTIATING || (cell.state_ == CELL_UNLOADED && !cell.failed_ && cell.distance_ <= loadDistance_))
+            sortedCells_.push_back(&cell);
+
+        if (cell.state_ == CELL_LOADING)
+            ++numLoading;
+    }
+
+    // Nearest cells are loaded and instantiated first
+    ea::quick_sort(sortedCells_.begin(), sortedCells_.end(),
+        [](const Cell* lhs, const Cell* rhs) { return lhs->distance_ < rhs->distance_; });
+
+    for (Cell* cell : sortedCells_)
+    {
+        if (numLoading >= maxLoadingCells_)
+            break;
+        if (cell->state_ == CELL_UNLOADED)
+        {
+            LoadCell(*cell);
+            if (cell->state_ == CELL_LOADING)
+                ++numLoading;
+        }
+    }
+
+    HiresTimer timer;
+    for (Cell* cell : sortedCells_)
+    {
+        while (cell->state_ == CELL_INSTANTIATING)
+        {
+            InstantiateNode(*cell);
+            if (timer.GetUSec(false) >= instantiateMs_ * 1000LL)
+                return;
+        }
+    }
+}
+
+void SceneStreamer::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    auto loadingIter = loadingCells_.find(StringHash(eventData[P_RESOURCENAME].GetString()));
+    if (loadingIter == loadingCells_.end())
+        return;
+
+    auto cellIter = cells_.find(loadingIter->second);
+    loadingCells_.erase(loadingIter);
+    if (cellIter == cells_.end() || cellIter->second.state_ != CELL_LOADING)
+    {
+        // The cell went out of range meanwhile
+        GetSubsystem<ResourceCache>()->ReleaseResource(SceneCell::GetTypeStatic(), eventData[P_RESOURCENAME].GetString());
+        return;
+    }
+
+    Cell& cell = cellIter->second;
+    auto* resource = dynamic_cast<SceneCell*>(eventData[P_RESOURCE].GetPtr());
+    if (!eventData[P_SUCCESS].GetBool() || !resource)
+    {
+        URHO3D_LOGERROR("Could not load scene cell " + GetCellResourceName(cell.coordinates_));
+        cell.state_ = CELL_UNLOADED;
+        cell.failed_ = true;
+        return;
+    }
+
+    BeginInstantiate(cell, resource);
+}
+
+void SceneStreamer::LoadCell(Cell& cell)
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    const ea::string name = GetCellResourceName(cell.coordinates_);
+
+    cell.state_ = CELL_LOADING;
+    loadingCells_[StringHash(cache->SanitateResourceName(name))] = cell.coordinates_;
+    // Nearer cells and their resources are loaded first
+    cache->BackgroundLoadResource<SceneCell>(name, true, nullptr, -RoundToInt(cell.distance_));
+
+    // The resource may be already cached or loaded synchronously when threading is disabled
+    if (SceneCell* resource = cache->GetExistingResource<SceneCell>(name))
+    {
+        if (cell.state_ == CELL_LOADING)
+        {
+            loadingCells_.erase(StringHash(cache->SanitateResourceName(name)));
+            BeginInstantiate(cell, resource);
+        }
+    }
+}
+
+void SceneStreamer::BeginInstantiate(Cell& cell, SceneCell* resource)
+{
+    cell.state_ = CELL_INSTANTIATING;
+    cell.resource_ = resource;
+    cell.readPosition_ = 0;
+    cell.numInstantiated_ = 0;
+    cell.resolver_.Reset();
+    cell.nodes_.clear();
+}
+
+bool SceneStreamer::InstantiateNode(Cell& cell)
+{
+    Scene* scene = GetScene();
+    const ea::vector<unsigned char>& data = cell.resource_->GetData();
+
+    if (cell.numInstantiated_ < cell.resource_->GetNumNodes() && cell.readPosition_ < data.size())
+    {
+        MemoryBuffer buffer(data);
+        buffer.Seek(cell.readPosition_);
+
+        // Rewrite IDs, so that reloaded cells never conflict with nodes created meanwhile
+        const unsigned nodeID = buffer.ReadUInt();
+        const CreateMode mode = Scene::IsReplicatedID(nodeID) ? REPLICATED : LOCAL;
+        Node* node = scene->CreateChild(0, mode);
+        cell.resolver_.AddNode(nodeID, node);
+        if (node->Load(buffer, cell.resolver_, true, true, mode))
+        {
+            cell.nodes_.emplace_back(node);
+            cell.readPosition_ = buffer.GetPosition();
+            ++cell.numInstantiated_;
+            return false;
+        }
+
+        URHO3D_LOGERROR("Could not instantiate scene cell " + GetCellResourceName(cell.coordinates_));
+        node->Remove();
+        cell.failed_ = true;
+    }
+
+    cell.resolver_.Resolve();
+    for (const WeakPtr<Node>& node : cell.nodes_)
+    {
+        if (node)
+            node->ApplyAttributes();
+    }
+
+    // Release the cell data, the nodes are in the scene now
+    const ea::string name = cell.resource_->GetName();
+    cell.resource_.Reset();
+    GetSubsystem<ResourceCache>()->ReleaseResource(SceneCell::GetTypeStatic(), name);
+
+    cell.state_ = CELL_LOADED;
+    SendCellEvent(E_SCENECELLLOADED, cell.coordinates_);
+    return true;
+}
+
+void SceneStreamer::UnloadCell(Cell& cell)
+{
+    const bool hadNodes = cell.state_ == CELL_INSTANTIATING || cell.state_ == CELL_LOADED;
+
+    for (const WeakPtr<Node>& node : cell.nodes_)
+    {
+        if (node)
+            node->Remove();
+    }
+
+    // Release the data of a cell interrupted while instantiating, like when the instantiation completes
+    if (cell.resource_)
+    {
+        const ea::string name = cell.resource_->GetName();
+        cell.resource_.Reset();
+        GetSubsystem<ResourceCache>()->ReleaseResource(SceneCell::GetTypeStatic(), name);
+    }
+
+    // A cell still loading in the background is ignored when it finishes
+    cell.nodes_.clear();
+    cell.resolver_.Reset();
+    cell.state_ = CELL_UNLOADED;
+
+    if (hadNodes)
+        SendCellEvent(E_SCENECELLUNLOADED, cell.coordinates_);
+}
+
+void SceneStreamer::SendCellEvent(StringHash eventType, const IntVector2& coordinates)
+{
+    using namespace SceneCellLoaded;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SCENE] = GetScene();
+    eventData[P_CELL] = coordinates;
+    GetScene()->SendEvent(eventType, eventData);
+}
+
+float SceneStreamer::GetDistanceToCell(const IntVector2& cell, const Vector3& position) const
+{
+    const float minX = cell.x_ * cellSize_;
+    const float minZ = cell.y_ * cellSize_;
+    const float dx = Max(Max(minX - position.x_, position.x_ - (minX + cellSize_)), 0.0f);
+    const float dz = Max(Max(minZ - position.z_, position.z_ - (minZ + cellSize_)), 0.0f);
+    return sqrtf(dx * dx + dz * dz);
+}
+
+}
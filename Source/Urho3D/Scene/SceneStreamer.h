@@ -0,0 +1,206 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Math/Vector2.h"
+#include "../Scene/Component.h"
+#include "../Scene/SceneResolver.h"
+
+namespace Urho3D
+{
+
+class SceneCell;
+
+/// Streaming state of a scene cell.
+enum SceneCellState
+{
+    /// Cell nodes are not in the scene.
+    CELL_UNLOADED = 0,
+    /// Cell resource is being loaded in the background.
+    CELL_LOADING,
+    /// Cell nodes are being created on the main thread.
+    CELL_INSTANTIATING,
+    /// Cell nodes are in the scene.
+    CELL_LOADED
+};
+
+/// Streams the content of a large scene in spatial cells around an observer node. Root-level nodes are split into square cells on the XZ plane and saved as SceneCell resources, which are loaded in the background nearest first and instantiated within a time budget per frame. Cells that move out of range are removed from the scene. Changes to streamed nodes are lost when their cell is unloaded, and references between nodes of different cells are not resolved.
+class URHO3D_API SceneStreamer : public Component
+{
+    URHO3D_OBJECT(SceneStreamer, Component);
+
+public:
+    /// Construct.
+    explicit SceneStreamer(Context* context);
+    /// Destruct.
+    ~SceneStreamer() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Move root-level nodes into cells and save the cells as files in a resource directory. Temporary nodes, nodes with the persistent tag and the observer hierarchy stay in the scene. All existing cells must be loaded. Return true if successful.
+    bool SaveCells(const ea::string& resourceDir);
+    /// Remove the nodes of all cells from the scene.
+    void UnloadCells();
+
+    /// Set the node around which cells are loaded, usually the camera.
+    /// @property
+    void SetObserver(Node* observer) { observer_ = observer; }
+    /// Set resource name prefix of the cell files.
+    /// @property
+    void SetCellPrefix(const ea::string& prefix) { cellPrefix_ = prefix; }
+    /// Set cell size.
+    /// @property
+    void SetCellSize(float size);
+    /// Set distance from the observer to a cell at which it is loaded.
+    /// @property
+    void SetLoadDistance(float distance) { loadDistance_ = distance; }
+    /// Set distance from the observer to a cell at which it is unloaded. Should be larger than the load distance.
+    /// @property
+    void SetUnloadDistance(float distance) { unloadDistance_ = distance; }
+    /// Set maximum number of cells loaded in the background at the same time.
+    /// @property
+    void SetMaxLoadingCells(unsigned count) { maxLoadingCells_ = count; }
+    /// Set maximum milliseconds per frame spent creating nodes of loaded cells.
+    /// @property
+    void SetInstantiateMs(int ms) { instantiateMs_ = Max(ms, 1); }
+    /// Set tag of root-level nodes that are never moved into cells.
+    /// @property
+    void SetPersistentTag(const ea::string& tag) { persistentTag_ = tag; }
+
+    /// Return observer node.
+    /// @property
+    Node* GetObserver() const { return observer_; }
+    /// Return resource name prefix of the cell files.
+    /// @property
+    const ea::string& GetCellPrefix() const { return cellPrefix_; }
+    /// Return cell size.
+    /// @property
+    float GetCellSize() const { return cellSize_; }
+    /// Return load distance.
+    /// @property
+    float GetLoadDistance() const { return loadDistance_; }
+    /// Return unload distance.
+    /// @property
+    float GetUnloadDistance() const { return unloadDistance_; }
+    /// Return maximum number of cells loaded in the background at the same time.
+    /// @property
+    unsigned GetMaxLoadingCells() const { return maxLoadingCells_; }
+    /// Return maximum milliseconds per frame spent creating nodes.
+    /// @property
+    int GetInstantiateMs() const { return instantiateMs_; }
+    /// Return tag of persistent root-level nodes.
+    /// @property
+    const ea::string& GetPersistentTag() const { return persistentTag_; }
+
+    /// Return number of cells.
+    /// @property
+    unsigned GetNumCells() const { return cells_.size(); }
+    /// Return number of cells whose nodes are in the scene.
+    /// @property
+    unsigned GetNumLoadedCells() const;
+    /// Return streaming state of a cell.
+    SceneCellState GetCellState(const IntVector2& cell) const;
+    /// Return coordinates of the cell containing a world position.
+    IntVector2 GetCellCoordinates(const Vector3& position) const;
+    /// Return resource name of a cell.
+    ea::string GetCellResourceName(const IntVector2& cell) const;
+
+    /// Set cell index attribute.
+    void SetCellsAttr(const VariantVector& value);
+    /// Return cell index attribute.
+    VariantVector GetCellsAttr() const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Streamed cell.
+    struct Cell
+    {
+        /// Cell coordinates.
+        IntVector2 coordinates_;
+        /// Streaming state.
+        SceneCellState state_{CELL_UNLOADED};
+        /// Distance to the observer.
+        float distance_{};
+        /// Loading failed, do not retry.
+        bool failed_{};
+        /// Loaded resource during instantiation.
+        SharedPtr<SceneCell> resource_;
+        /// Read position in the resource data.
+        unsigned readPosition_{};
+        /// Number of instantiated root-level nodes.
+        unsigned numInstantiated_{};
+        /// ID resolver of the instantiated nodes.
+        SceneResolver resolver_;
+        /// Instantiated root-level nodes.
+        ea::vector<WeakPtr<Node> > nodes_;
+    };
+
+    /// Handle scene update.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle a resource finishing background loading.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+    /// Start loading a cell.
+    void LoadCell(Cell& cell);
+    /// Start instantiating a loaded cell resource.
+    void BeginInstantiate(Cell& cell, SceneCell* resource);
+    /// Instantiate one root-level node of a cell. Return true when the cell is finished.
+    bool InstantiateNode(Cell& cell);
+    /// Remove the nodes of a cell from the scene.
+    void UnloadCell(Cell& cell);
+    /// Send a cell loaded or unloaded event.
+    void SendCellEvent(StringHash eventType, const IntVector2& coordinates);
+    /// Return distance from a position to a cell on the XZ plane.
+    float GetDistanceToCell(const IntVector2& cell, const Vector3& position) const;
+
+    /// Observer node.
+    WeakPtr<Node> observer_;
+    /// Resource name prefix of the cell files.
+    ea::string cellPrefix_;
+    /// Cell size.
+    float cellSize_;
+    /// Load distance.
+    float loadDistance_;
+    /// Unload distance.
+    float unloadDistance_;
+    /// Maximum number of cells loaded in the background at the same time.
+    unsigned maxLoadingCells_;
+    /// Maximum milliseconds per frame spent creating nodes.
+    int instantiateMs_;
+    /// Tag of persistent root-level nodes.
+    ea::string persistentTag_;
+    /// Cells by coordinates.
+    ea::unordered_map<IntVector2, Cell> cells_;
+    /// Cells being loaded in the background by resource name.
+    ea::unordered_map<StringHash, IntVector2> loadingCells_;
+    /// Cells sorted by distance, reused between frames.
+    ea::vector<Cell*> sortedCells_;
+};
+
+}
@@ -24,11 +24,14 @@
 
 #include "../Core/Context.h"
 #include "../IO/Archive.h"
+#include "../IO/BitStream.h"
 #include "../IO/ArchiveSerialization.h"
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/Serializer.h"
+#include "../IO/VectorBuffer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
@@ -83,6 +86,13 @@ static bool SaveAttributeWithName(Archive& archive, const AttributeInfo& attr, c
     }
 }
 
+/// Return whether the attribute may be serialized directly between the object and the archive.
+static bool CanSerializeAttributeDirect(const Serializable* serializable, const Archive& archive, const AttributeInfo& attr)
+{
+    return !archive.IsHumanReadable() && !attr.enumNames_ && attr.accessor_ && attr.accessor_->IsDirectSerializable()
+        && serializable->IsDirectAttributeSerializationEnabled();
+}
+
 static bool LoadAttribute(Archive& archive, const AttributeInfo& attr, Variant& value)
 {
     assert(archive.IsInput());
@@ -107,6 +117,179 @@ static bool LoadAttribute(Archive& archive, const AttributeInfo& attr, Variant&
     }
 }
 
+/// Number of delta base integers reserved per network attribute for packed updates.
+static const unsigned PACKED_BASE_STRIDE = 4;
+
+/// Return number of float components of a precision or range quantized attribute, or zero if it is not quantized.
+static unsigned GetQuantizedComponents(const AttributeInfo& attr)
+{
+    switch (attr.type_)
+    {
+    case VAR_FLOAT: return 1;
+    case VAR_VECTOR2: return 2;
+    case VAR_VECTOR3: return 3;
+    case VAR_VECTOR4: return 4;
+    default: return 0;
+    }
+}
+
+/// Return network quantization step of an attribute, or zero if it is missing or not positive.
+static float GetNetworkPrecision(const AttributeInfo& attr)
+{
+    const float step = attr.GetMetadata(AttributeMetadata::P_NETWORK_PRECISION).GetFloat();
+    return step > 0.0f ? step : 0.0f;
+}
+
+/// Return number of bits per component of an attribute in packed network updates, or zero if it is missing or out of range.
+static unsigned GetNetworkBits(const AttributeInfo& attr)
+{
+    const int numBits = attr.GetMetadata(AttributeMetadata::P_NETWORK_BITS).GetInt();
+    return numBits >= 1 && numBits <= (int)MAX_QUANTIZED_FLOAT_BITS ? (unsigned)numBits : 0;
+}
+
+/// Return whether an attribute is written into the bit section of a packed update. Attributes with invalid quantization metadata are sent at full precision.
+static bool IsPackedAttribute(const AttributeInfo& attr)
+{
+    if (attr.type_ == VAR_INT || attr.type_ == VAR_BOOL)
+        return true;
+
+    if (GetQuantizedComponents(attr))
+    {
+        return GetNetworkPrecision(attr) > 0.0f ||
+            (attr.GetMetadata(AttributeMetadata::P_NETWORK_RANGE).GetType() == VAR_VECTOR2 && GetNetworkBits(attr));
+    }
+
+    if (attr.type_ == VAR_QUATERNION || attr.type_ == VAR_BUFFER)
+        return GetNetworkBits(attr) != 0;
+
+    return false;
+}
+
+/// Write a packed attribute value. Integers and precision quantized values are delta coded against the base and update it, or written absolute if there is no base.
+static void WritePackedValue(BitWriter& dest, const AttributeInfo& attr, const Variant& value, int* base)
+{
+    if (attr.type_ == VAR_BOOL)
+    {
+        dest.WriteBool(value.GetBool());
+        return;
+    }
+
+    if (attr.type_ == VAR_INT)
+    {
+        const int intValue = value.GetInt();
+        dest.WriteVarInt(base ? intValue - base[0] : intValue);
+        if (base)
+            base[0] = intValue;
+        return;
+    }
+
+    if (const unsigned numComponents = GetQuantizedComponents(attr))
+    {
+        const float scalar = value.GetFloat();
+        const float* components = &scalar;
+        if (attr.type_ == VAR_VECTOR2)
+            components = value.GetVector2().Data();
+        else if (attr.type_ == VAR_VECTOR3)
+            components = value.GetVector3().Data();
+        else if (attr.type_ == VAR_VECTOR4)
+            components = value.GetVector4().Data();
+
+        const float step = GetNetworkPrecision(attr);
+        if (step > 0.0f)
+        {
+            for (unsigned i = 0; i < numComponents; ++i)
+            {
+                const int quantized = RoundToInt(components[i] / step);
+                const int delta = base ? quantized - base[i] : quantized;
+                dest.WriteBool(delta != 0);
+                if (delta != 0)
+                    dest.WriteVarInt(delta);
+                if (base)
+                    base[i] = quantized;
+            }
+        }
+        else
+        {
+            const Vector2 range = attr.GetMetadata(AttributeMetadata::P_NETWORK_RANGE).GetVector2();
+            const unsigned numBits = GetNetworkBits(attr);
+            for (unsigned i = 0; i < numComponents; ++i)
+                dest.WriteQuantizedFloat(components[i], range.x_, range.y_, numBits);
+        }
+        return;
+    }
+
+    // Quaternions, either as such or in a buffer written with WritePackedQuaternion
+    const unsigned numBits = GetNetworkBits(attr);
+    if (attr.type_ == VAR_QUATERNION)
+        dest.WriteQuaternion(value.GetQuaternion(), numBits);
+    else
+    {
+        MemoryBuffer buffer(value.GetBuffer());
+        dest.WriteQuaternion(buffer.ReadPackedQuaternion(), numBits);
+    }
+}
+
+/// Read a packed attribute value.
+static Variant ReadPackedValue(BitReader& source, const AttributeInfo& attr, int* base)
+{
+    if (attr.type_ == VAR_BOOL)
+        return source.ReadBool();
+
+    if (attr.type_ == VAR_INT)
+    {
+        int intValue = source.ReadVarInt();
+        if (base)
+        {
+            intValue += base[0];
+            base[0] = intValue;
+        }
+        return intValue;
+    }
+
+    if (const unsigned numComponents = GetQuantizedComponents(attr))
+    {
+        float components[4]{};
+        const float step = GetNetworkPrecision(attr);
+        if (step > 0.0f)
+        {
+            for (unsigned i = 0; i < numComponents; ++i)
+            {
+                int quantized = source.ReadBool() ? source.ReadVarInt() : 0;
+                if (base)
+                {
+                    quantized += base[i];
+                    base[i] = quantized;
+                }
+                components[i] = (float)quantized * step;
+            }
+        }
+        else
+        {
+            const Vector2 range = attr.GetMetadata(AttributeMetadata::P_NETWORK_RANGE).GetVector2();
+            const unsigned numBits = GetNetworkBits(attr);
+            for (unsigned i = 0; i < numComponents; ++i)
+                components[i] = source.ReadQuantizedFloat(range.x_, range.y_, numBits);
+        }
+
+        switch (attr.type_)
+        {
+        case VAR_FLOAT: return components[0];
+        case VAR_VECTOR2: return Vector2(components);
+        case VAR_VECTOR3: return Vector3(components);
+        default: return Vector4(components);
+        }
+    }
+
+    const unsigned numBits = GetNetworkBits(attr);
+    const Quaternion rotation = source.ReadQuaternion(numBits);
+    if (attr.type_ == VAR_QUATERNION)
+        return rotation;
+
+    VectorBuffer buffer;
+    buffer.WritePackedQuaternion(rotation);
+    return buffer.GetBuffer();
+}
+
 Serializable::Serializable(Context* context) :
     Object(context),
     setInstanceDefault_(false),
@@ -749,6 +932,20 @@ bool Serializable::Serialize(Archive& archive, ArchiveBlock& block)
                 if (nextAttributeIndex < numAttributes && (*attributes)[nextAttributeIndex].nameHash_ == attrNameHash)
                 {
                     const AttributeInfo& attr = (*attributes)[nextAttributeIndex];
+
+                    // Read typed attribute directly into the object unless instance defaults are recorded
+                    if (!setInstanceDefault_ && CanSerializeAttributeDirect(this, archive, attr))
+                    {
+                        if (!attr.accessor_->SerializeDirect(this, archive, "attribute"))
+                        {
+                            URHO3D_LOGERROR("Could not load " + GetTypeName() + ", failed to read attribute " + attr.name_);
+                            return false;
+                        }
+
+                        ++nextAttributeIndex;
+                        continue;
+                    }
+
                     Variant value;
                     if (!LoadAttribute(archive, attr, value))
                     {
@@ -819,6 +1016,18 @@ bool Serializable::Serialize(Archive& archive, ArchiveBlock& block)
                     if (!attr.ShouldSave())
                         continue;
 
+                    // Write typed attribute directly from the object
+                    if (CanSerializeAttributeDirect(this, archive, attr))
+                    {
+                        if (!SerializeStringHashKey(archive, const_cast<StringHash&>(attr.nameHash_), attr.name_)
+                            || !attr.accessor_->SerializeDirect(this, archive, "attribute"))
+                        {
+                            URHO3D_LOGERROR("Could not save " + GetTypeName() + ", failed to write attribute " + attr.name_);
+                            return false;
+                        }
+                        continue;
+                    }
+
                     OnGetAttribute(attr, value);
 
                     if (!SaveAttributeWithName(archive, attr, value))
@@ -1103,23 +1312,8 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
         if (attributeBits.IsSet(i))
         {
             const AttributeInfo& attr = attributes->at(i);
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+            if (ApplyNetworkAttribute(attr, i, source.ReadVariant(attr.type_), timeStamp, interceptMask))
                 changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
         }
     }
 
@@ -1143,29 +1337,278 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         const AttributeInfo& attr = attributes->at(i);
         if (attr.mode_ & AM_LATESTDATA)
         {
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+            if (ApplyNetworkAttribute(attr, i, source.ReadVariant(attr.type_), timeStamp, interceptMask))
                 changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
         }
     }
 
     return changed;
 }
 
+void Serializable::WritePackedInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp, ea::vector<int>& deltaBase)
+{
+    if (!networkState_)
+    {
+        URHO3D_LOGERROR("WritePackedInitialDeltaUpdate called without allocated NetworkState");
+        return;
+    }
+
+    const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
+    if (!attributes)
+        return;
+
+    unsigned numAttributes = attributes->size();
+    DirtyBits attributeBits;
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if (networkState_->currentValues_[i] != attr.defaultValue_)
+            attributeBits.Set(i);
+    }
+
+    // The receiver starts from a zero base when the object is created
+    deltaBase.clear();
+    deltaBase.resize(numAttributes * PACKED_BASE_STRIDE);
+
+    dest.WriteUByte(timeStamp);
+    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3u);
+    WritePackedAttributes(dest, attributeBits, deltaBase.data());
+}
+
+void Serializable::WritePackedDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp,
+    ea::vector<int>& deltaBase)
+{
+    if (!networkState_)
+    {
+        URHO3D_LOGERROR("WritePackedDeltaUpdate called without allocated NetworkState");
+        return;
+    }
+
+    const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
+    if (!attributes)
+        return;
+
+    unsigned numAttributes = attributes->size();
+    deltaBase.resize(numAttributes * PACKED_BASE_STRIDE);
+
+    dest.WriteUByte(timeStamp);
+    dest.Write(attributeBits.data_, (numAttributes + 7) >> 3u);
+    WritePackedAttributes(dest, attributeBits, deltaBase.data());
+}
+
+void Serializable::WritePackedLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
+{
+    if (!networkState_)
+    {
+        URHO3D_LOGERROR("WritePackedLatestDataUpdate called without allocated NetworkState");
+        return;
+    }
+
+    const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
+    if (!attributes)
+        return;
+
+    unsigned numAttributes = attributes->size();
+    DirtyBits attributeBits;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (attributes->at(i).mode_ & AM_LATESTDATA)
+            attributeBits.Set(i);
+    }
+
+    // Latest data may be lost, so it can not be delta coded
+    dest.WriteUByte(timeStamp);
+    WritePackedAttributes(dest, attributeBits, nullptr);
+}
+
+bool Serializable::ReadPackedDeltaUpdate(Deserializer& source, ea::vector<int>& deltaBase)
+{
+    const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
+    if (!attributes)
+        return false;
+
+    unsigned numAttributes = attributes->size();
+    DirtyBits attributeBits;
+    deltaBase.resize(numAttributes * PACKED_BASE_STRIDE);
+
+    unsigned char timeStamp = source.ReadUByte();
+    source.Read(attributeBits.data_, (numAttributes + 7) >> 3u);
+    return ReadPackedAttributes(source, attributeBits, timeStamp, deltaBase.data());
+}
+
+bool Serializable::ReadPackedLatestDataUpdate(Deserializer& source)
+{
+    const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
+    if (!attributes)
+        return false;
+
+    unsigned numAttributes = attributes->size();
+    DirtyBits attributeBits;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (attributes->at(i).mode_ & AM_LATESTDATA)
+            attributeBits.Set(i);
+    }
+
+    unsigned char timeStamp = source.ReadUByte();
+    return ReadPackedAttributes(source, attributeBits, timeStamp, nullptr);
+}
+
+void Serializable::CacheNetworkUpdate(bool plainFormat, bool packedFormat)
+{
+    if (!networkState_ || !networkState_->attributes_ || !networkState_->changedAttributes_.Count())
+        return;
+
+    const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
+    unsigned numAttributes = attributes->size();
+    bool hasLatestData = false;
+    DirtyBits deltaBits = networkState_->changedAttributes_;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (attributes->at(i).mode_ & AM_LATESTDATA)
+        {
+            hasLatestData = true;
+            deltaBits.Clear(i);
+        }
+    }
+
+    // Payloads are serialized with a zero time stamp, which is then stripped
+    VectorBuffer buffer;
+    if (plainFormat && deltaBits.Count() && networkState_->deltaPayload_.empty())
+    {
+        WriteDeltaUpdate(buffer, deltaBits, 0);
+        networkState_->deltaPayload_.assign(buffer.GetData() + 1, buffer.GetData() + buffer.GetSize());
+    }
+    if (plainFormat && hasLatestData && networkState_->latestDataPayload_.empty())
+    {
+        buffer.Clear();
+        WriteLatestDataUpdate(buffer, 0);
+        networkState_->latestDataPayload_.assign(buffer.GetData() + 1, buffer.GetData() + buffer.GetSize());
+    }
+    if (packedFormat && hasLatestData && networkState_->packedLatestDataPayload_.empty())
+    {
+        buffer.Clear();
+        WritePackedLatestDataUpdate(buffer, 0);
+        networkState_->packedLatestDataPayload_.assign(buffer.GetData() + 1, buffer.GetData() + buffer.GetSize());
+    }
+}
+
+bool Serializable::WriteCachedDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp) const
+{
+    if (!networkState_ || networkState_->deltaPayload_.empty())
+        return false;
+
+    // The payload starts with the bitfield of the changed attributes
+    const ea::vector<unsigned char>& payload = networkState_->deltaPayload_;
+    const unsigned bitsSize = (networkState_->attributes_->size() + 7) >> 3u;
+    if (memcmp(payload.data(), attributeBits.data_, bitsSize) != 0)
+        return false;
+
+    dest.WriteUByte(timeStamp);
+    dest.Write(payload.data(), payload.size());
+    return true;
+}
+
+bool Serializable::WriteCachedLatestDataUpdate(Serializer& dest, unsigned char timeStamp, bool packed) const
+{
+    if (!networkState_)
+        return false;
+
+    const ea::vector<unsigned char>& payload = packed ? networkState_->packedLatestDataPayload_ : networkState_->latestDataPayload_;
+    if (payload.empty())
+        return false;
+
+    dest.WriteUByte(timeStamp);
+    dest.Write(payload.data(), payload.size());
+    return true;
+}
+
+void Serializable::SetChangedNetworkAttributes(const DirtyBits& changedAttributes)
+{
+    networkState_->changedAttributes_ = changedAttributes;
+    networkState_->deltaPayload_.clear();
+    networkState_->latestDataPayload_.clear();
+    networkState_->packedLatestDataPayload_.clear();
+}
+
+bool Serializable::ApplyNetworkAttribute(const AttributeInfo& attr, unsigned index, const Variant& value, unsigned char timeStamp,
+    unsigned long long interceptMask)
+{
+    if (!(interceptMask & (1ULL << index)))
+    {
+        OnSetAttribute(attr, value);
+        return true;
+    }
+
+    using namespace InterceptNetworkUpdate;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_SERIALIZABLE] = this;
+    eventData[P_TIMESTAMP] = (unsigned)timeStamp;
+    eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, index);
+    eventData[P_NAME] = attr.name_;
+    eventData[P_VALUE] = value;
+    SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
+    return false;
+}
+
+void Serializable::WritePackedAttributes(Serializer& dest, const DirtyBits& attributeBits, int* deltaBase)
+{
+    const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
+    unsigned numAttributes = attributes->size();
+
+    // First the bit section for the attributes that have a packed encoding, then plain data for the rest
+    BitWriter bits;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if (attributeBits.IsSet(i) && IsPackedAttribute(attr))
+            WritePackedValue(bits, attr, networkState_->currentValues_[i], deltaBase ? deltaBase + i * PACKED_BASE_STRIDE : nullptr);
+    }
+
+    dest.WriteVLE(bits.GetData().size());
+    dest.Write(bits.GetData().data(), bits.GetData().size());
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        if (attributeBits.IsSet(i) && !IsPackedAttribute(attr))
+            dest.WriteVariantData(networkState_->currentValues_[i]);
+    }
+}
+
+bool Serializable::ReadPackedAttributes(Deserializer& source, const DirtyBits& attributeBits, unsigned char timeStamp, int* deltaBase)
+{
+    const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
+    unsigned numAttributes = attributes->size();
+    bool changed = false;
+
+    unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
+
+    ea::fixed_vector<unsigned char, 64> data(source.ReadVLE());
+    source.Read(data.data(), data.size());
+    BitReader bits(data.data(), data.size());
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (!attributeBits.IsSet(i))
+            continue;
+
+        const AttributeInfo& attr = attributes->at(i);
+        const bool packed = IsPackedAttribute(attr);
+        if (packed ? bits.IsEof() : source.IsEof())
+            break;
+
+        const Variant value = packed ? ReadPackedValue(bits, attr, deltaBase ? deltaBase + i * PACKED_BASE_STRIDE : nullptr) :
+            source.ReadVariant(attr.type_);
+        if (ApplyNetworkAttribute(attr, i, value, timeStamp, interceptMask))
+            changed = true;
+    }
+
+    return changed;
+}
+
 Variant Serializable::GetAttribute(unsigned index) const
 {
     Variant ret;
@@ -24,6 +24,7 @@
 
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
+#include "../IO/ArchiveSerialization.h"
 
 #include <cstddef>
 
@@ -57,6 +58,8 @@ public:
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
     /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
+    /// Return whether binary archives may serialize typed attributes directly, bypassing OnSetAttribute() and OnGetAttribute(). Should return false if either is overridden.
+    virtual bool IsDirectAttributeSerializationEnabled() const { return true; }
     /// Return attribute descriptions, or null if none defined.
     virtual const ea::vector<AttributeInfo>* GetAttributes() const;
     /// Return network replication attribute descriptions, or null if none defined.
@@ -129,6 +132,22 @@ public:
     bool ReadDeltaUpdate(Deserializer& source);
     /// Read and apply a network latest data update. Return true if attributes were changed.
     bool ReadLatestDataUpdate(Deserializer& source);
+    /// Write initial delta network update in packed format. Quantized values are delta coded against and update the base.
+    void WritePackedInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp, ea::vector<int>& deltaBase);
+    /// Write a delta network update in packed format according to dirty attribute bits.
+    void WritePackedDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp, ea::vector<int>& deltaBase);
+    /// Write a latest data network update in packed format. Quantized values are written absolute.
+    void WritePackedLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
+    /// Read and apply a packed network delta update. Return true if attributes were changed.
+    bool ReadPackedDeltaUpdate(Deserializer& source, ea::vector<int>& deltaBase);
+    /// Read and apply a packed network latest data update. Return true if attributes were changed.
+    bool ReadPackedLatestDataUpdate(Deserializer& source);
+    /// Serialize the delta and latest data update payloads of the attributes changed in the last network update, so that connections can copy them instead of serializing the same data. Must be called from the main thread.
+    void CacheNetworkUpdate(bool plainFormat, bool packedFormat);
+    /// Write a delta network update from the cached payload if it was serialized for the same dirty attribute bits. Return true if written.
+    bool WriteCachedDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp) const;
+    /// Write a latest data network update from the cached payload if it exists. Return true if written.
+    bool WriteCachedLatestDataUpdate(Serializer& dest, unsigned char timeStamp, bool packed) const;
 
     /// Return attribute value by index. Return empty if illegal index.
     /// @property{get_attributes}
@@ -157,6 +176,9 @@ public:
     NetworkState* GetNetworkState() const { return networkState_.get(); }
 
 protected:
+    /// Store the attributes changed in a network update and invalidate the cached update payloads.
+    void SetChangedNetworkAttributes(const DirtyBits& changedAttributes);
+
     /// Network attribute state.
     ea::unique_ptr<NetworkState> networkState_;
 
@@ -166,6 +188,14 @@ protected:
     bool setInstanceDefault_;
     /// Temporary flag.
     bool temporary_;
+
+private:
+    /// Apply an attribute value received from the network, or send it as an event if intercepted. Return true if applied.
+    bool ApplyNetworkAttribute(const AttributeInfo& attr, unsigned index, const Variant& value, unsigned char timeStamp, unsigned long long interceptMask);
+    /// Write the bit section and plain data of a packed network update.
+    void WritePackedAttributes(Serializer& dest, const DirtyBits& attributeBits, int* deltaBase);
+    /// Read and apply the bit section and plain data of a packed network update. Return true if attributes were changed.
+    bool ReadPackedAttributes(Deserializer& source, const DirtyBits& attributeBits, unsigned char timeStamp, int* deltaBase);
 };
 
 /// Template implementation of the variant attribute accessor.
@@ -209,15 +239,104 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     return SharedPtr<AttributeAccessor>(new VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction));
 }
 
+#ifndef SWIG
+/// Return whether the attribute value type is written to archives the same way directly and through Variant.
+template <class T>
+constexpr bool IsDirectSerializableAttributeType()
+{
+    return std::is_same_v<T, int> || std::is_same_v<T, bool> || std::is_same_v<T, float> || std::is_same_v<T, double>
+        || std::is_same_v<T, long long> || std::is_same_v<T, Vector2> || std::is_same_v<T, Vector3> || std::is_same_v<T, Vector4>
+        || std::is_same_v<T, Quaternion> || std::is_same_v<T, Color> || std::is_same_v<T, ea::string> || std::is_same_v<T, IntRect>
+        || std::is_same_v<T, IntVector2> || std::is_same_v<T, IntVector3> || std::is_same_v<T, Rect> || std::is_same_v<T, Matrix3>
+        || std::is_same_v<T, Matrix3x4> || std::is_same_v<T, Matrix4> || std::is_same_v<T, ResourceRef> || std::is_same_v<T, ResourceRefList>;
+}
+
+/// Template implementation of the attribute accessor for a statically known value type. Binary archives are serialized directly between the object and the archive without a temporary Variant.
+/// \tparam TClassType Serializable class type.
+/// \tparam TValueType Attribute value type.
+/// \tparam TGetFunction Functional object with call signature `TValueType getFunction(const TClassType& self)`, may return a reference.
+/// \tparam TSetFunction Functional object with call signature `void setFunction(TClassType& self, const TValueType& value)`
+template <class TClassType, class TValueType, class TGetFunction, class TSetFunction>
+class TypedAttributeAccessorImpl : public AttributeAccessor
+{
+public:
+    /// Return type of the getter.
+    using GetResultType = decltype(ea::declval<TGetFunction>()(ea::declval<const TClassType&>()));
+    /// Whether the value can be serialized directly.
+    static constexpr bool directSerializable_ = IsDirectSerializableAttributeType<TValueType>()
+        && std::is_convertible_v<GetResultType, const TValueType&>;
+
+    /// Construct.
+    TypedAttributeAccessorImpl(TGetFunction getFunction, TSetFunction setFunction) : getFunction_(getFunction), setFunction_(setFunction) { }
+
+    /// Invoke getter function.
+    void Get(const Serializable* ptr, Variant& value) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        value = getFunction_(*classPtr);
+    }
+
+    /// Invoke setter function.
+    void Set(Serializable* ptr, const Variant& value) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        setFunction_(*classPtr, value.Get<TValueType>());
+    }
+
+    /// Return whether the attribute can be serialized directly to and from binary archives.
+    bool IsDirectSerializable() const override { return directSerializable_; }
+
+    /// Serialize the attribute directly between the object and the archive.
+    bool SerializeDirect(Serializable* ptr, Archive& archive, const char* name) override
+    {
+        if constexpr (directSerializable_)
+        {
+            assert(ptr);
+            auto classPtr = static_cast<TClassType*>(ptr);
+            if (archive.IsInput())
+            {
+                TValueType value{};
+                if (!SerializeValue(archive, name, value))
+                    return false;
+                setFunction_(*classPtr, value);
+                return true;
+            }
+            else
+            {
+                const TValueType& value = getFunction_(*classPtr);
+                return SerializeValue(archive, name, const_cast<TValueType&>(value));
+            }
+        }
+        else
+            return false;
+    }
+
+private:
+    /// Get functor.
+    TGetFunction getFunction_;
+    /// Set functor.
+    TSetFunction setFunction_;
+};
+
+/// Make typed attribute accessor implementation.
+template <class TClassType, class TValueType, class TGetFunction, class TSetFunction>
+SharedPtr<AttributeAccessor> MakeTypedAttributeAccessor(TGetFunction getFunction, TSetFunction setFunction)
+{
+    return SharedPtr<AttributeAccessor>(new TypedAttributeAccessorImpl<TClassType, TValueType, TGetFunction, TSetFunction>(getFunction, setFunction));
+}
+#endif
+
 /// Make member attribute accessor.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); })
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return (self.variable); }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; })
 
 /// Make member attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); })
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return (self.variable); }, \
+    [](ClassName& self, const typeName& value) { self.variable = value; self.postSetCallback(); })
 
 /// Make custom member attribute accessor.
 #define URHO3D_MAKE_CUSTOM_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
@@ -225,9 +344,9 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.GetCustom<typeName>(); })
 
 /// Make get/set attribute accessor.
-#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
-    [](const ClassName& self, Urho3D::Variant& value) { value = self.getFunction(); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); })
+#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName >( \
+    [](const ClassName& self) -> decltype(auto) { return self.getFunction(); }, \
+    [](ClassName& self, const typeName& value) { self.setFunction(value); })
 
 /// Make member enum attribute accessor.
 #define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
@@ -249,6 +368,12 @@ namespace AttributeMetadata
 {
     /// Names of vector struct elements. StringVector.
     static const StringHash P_VECTOR_STRUCT_ELEMENTS = "VectorStructElements";
+    /// Quantization step of a float or vector attribute in packed network updates. Float. Values are delta coded against the last update.
+    static const StringHash P_NETWORK_PRECISION = "NetworkPrecision";
+    /// Value range of a float or vector attribute in packed network updates, used together with P_NETWORK_BITS. Vector2.
+    static const StringHash P_NETWORK_RANGE = "NetworkRange";
+    /// Number of bits per component in packed network updates. Applies to ranged floats and vectors, and to quaternions, also when stored in a buffer with WritePackedQuaternion. Int.
+    static const StringHash P_NETWORK_BITS = "NetworkBits";
 }
 
 // The following macros need to be used within a class member function such as ClassName::RegisterObject().
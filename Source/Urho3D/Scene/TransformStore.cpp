@@ -0,0 +1,202 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/TransformStore.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of nodes in a depth level to calculate it on the worker threads.
+static const unsigned MIN_THREADED_LEVEL_NODES = 1024;
+/// Number of nodes per work item.
+static const unsigned NODES_PER_WORK_ITEM = 256;
+
+TransformStore::TransformStore(Context* context) :
+    context_(context)
+{
+}
+
+TransformStore::~TransformStore()
+{
+    if (!queuedNodes_.empty())
+    {
+        --Node::numPendingTransformStores_;
+        for (Node* node : queuedNodes_)
+            node->transformQueued_ = false;
+    }
+}
+
+void TransformStore::QueueNode(Node* node)
+{
+    if (node->transformQueued_)
+        return;
+
+    if (queuedNodes_.empty())
+        ++Node::numPendingTransformStores_;
+
+    node->transformQueued_ = true;
+    queuedNodes_.push_back(node);
+}
+
+void TransformStore::RemoveNode(Node* node)
+{
+    if (!node->transformQueued_)
+        return;
+
+    node->transformQueued_ = false;
+    queuedNodes_.erase_first(node);
+    if (queuedNodes_.empty())
+        --Node::numPendingTransformStores_;
+
+    // The node leaves the batched update, so mark the subtree dirty the immediate way
+    node->dirty_ = false;
+    node->MarkDirtyHierarchy();
+}
+
+void TransformStore::Update()
+{
+    if (queuedNodes_.empty() || updating_)
+        return;
+
+    URHO3D_PROFILE("UpdateTransforms");
+
+    updating_ = true;
+    --Node::numPendingTransformStores_;
+    GatherNodes();
+
+    worldTransforms_.resize(nodes_.size());
+    worldRotations_.resize(nodes_.size());
+
+    // Each level only depends on the previous one
+    auto* queue = context_->GetSubsystem<WorkQueue>();
+    for (unsigned i = 0; i + 1 < levels_.size(); ++i)
+    {
+        const unsigned levelBegin = levels_[i];
+        const unsigned levelSize = levels_[i + 1] - levelBegin;
+
+        if (queue && queue->GetNumThreads() && levelSize >= MIN_THREADED_LEVEL_NODES)
+        {
+            queue->ParallelFor(levelSize, NODES_PER_WORK_ITEM, [&](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                UpdateLevel(levelBegin + begin, levelBegin + end);
+            });
+        }
+        else
+            UpdateLevel(levelBegin, levelBegin + levelSize);
+    }
+
+    updating_ = false;
+
+    // Notify listeners in depth order. Nodes that the listeners mark dirty are queued for the next update
+    ea::vector<Node*> notifyNodes;
+    notifyNodes.swap(nodes_);
+    for (Node* node : notifyNodes)
+        node->NotifyListeners();
+
+    notifyNodes.clear();
+    if (nodes_.empty())
+        nodes_.swap(notifyNodes);
+}
+
+void TransformStore::GatherNodes()
+{
+    nodes_.clear();
+    parents_.clear();
+    rootParentTransforms_.clear();
+    levels_.clear();
+
+    // Subtree roots form the first level. Queued nodes inside another queued subtree are covered by it
+    for (Node* node : queuedNodes_)
+    {
+        bool nested = false;
+        for (Node* parent = node->parent_; parent && !nested; parent = parent->parent_)
+            nested = parent->transformQueued_;
+        if (nested)
+            continue;
+
+        Node* parent = node->parent_;
+        nodes_.push_back(node);
+        parents_.push_back(M_MAX_UNSIGNED);
+        if (!parent || parent == node->scene_)
+            rootParentTransforms_.emplace_back(Matrix3x4::IDENTITY, Quaternion::IDENTITY);
+        else
+            rootParentTransforms_.emplace_back(parent->GetWorldTransform(), parent->GetWorldRotation());
+    }
+
+    for (Node* node : queuedNodes_)
+        node->transformQueued_ = false;
+    queuedNodes_.clear();
+
+    // Append children breadth first, so that every level is contiguous and follows its parents
+    unsigned levelBegin = 0;
+    levels_.push_back(0);
+    while (levelBegin < nodes_.size())
+    {
+        const unsigned levelEnd = nodes_.size();
+        for (unsigned i = levelBegin; i < levelEnd; ++i)
+        {
+            for (const SharedPtr<Node>& child : nodes_[i]->children_)
+            {
+                nodes_.push_back(child);
+                parents_.push_back(i);
+            }
+        }
+
+        levels_.push_back(levelEnd);
+        levelBegin = levelEnd;
+    }
+}
+
+void TransformStore::UpdateLevel(unsigned begin, unsigned end)
+{
+    for (unsigned i = begin; i < end; ++i)
+    {
+        Node* node = nodes_[i];
+        const Matrix3x4 transform(node->position_, node->rotation_, node->scale_);
+        const unsigned parent = parents_[i];
+
+        if (parent == M_MAX_UNSIGNED)
+        {
+            worldTransforms_[i] = rootParentTransforms_[i].first * transform;
+            worldRotations_[i] = rootParentTransforms_[i].second * node->rotation_;
+        }
+        else
+        {
+            worldTransforms_[i] = worldTransforms_[parent] * transform;
+            worldRotations_[i] = worldRotations_[parent] * node->rotation_;
+        }
+
+        node->worldTransform_ = worldTransforms_[i];
+        node->worldRotation_ = worldRotations_[i];
+        node->dirty_ = false;
+    }
+}
+
+}
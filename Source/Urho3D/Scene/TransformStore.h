@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Math/Matrix3x4.h"
+#include "../Math/Quaternion.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Context;
+class Node;
+
+/// Batched world transform update of a scene. Nodes marked dirty are queued instead of marking their subtrees and notifying listeners immediately. On update the dirty subtrees are gathered into contiguous arrays sorted by hierarchy depth and their world transforms are calculated one depth level at a time, in parallel for large levels.
+class URHO3D_API TransformStore
+{
+public:
+    /// Construct.
+    explicit TransformStore(Context* context);
+    /// Destruct.
+    ~TransformStore();
+
+    /// Queue a node whose transform changed. The node should already be flagged dirty.
+    void QueueNode(Node* node);
+    /// Remove a queued node when it leaves the scene.
+    void RemoveNode(Node* node);
+    /// Calculate world transforms of queued subtrees and notify their listeners. Must be called from the main thread.
+    void Update();
+
+    /// Return whether there are queued nodes.
+    bool IsPending() const { return !queuedNodes_.empty(); }
+
+private:
+    /// Gather the subtrees of queued nodes breadth first.
+    void GatherNodes();
+    /// Calculate world transforms of a depth level.
+    void UpdateLevel(unsigned begin, unsigned end);
+
+    /// Context.
+    Context* context_;
+    /// Queued nodes.
+    ea::vector<Node*> queuedNodes_;
+    /// Nodes to update, sorted by depth.
+    ea::vector<Node*> nodes_;
+    /// Index of the parent in nodes_, or M_MAX_UNSIGNED when the parent transform is in rootParentTransforms_.
+    ea::vector<unsigned> parents_;
+    /// World transforms, same order as nodes_.
+    ea::vector<Matrix3x4> worldTransforms_;
+    /// World rotations, same order as nodes_.
+    ea::vector<Quaternion> worldRotations_;
+    /// Parent world transforms and rotations of the subtree roots, same order as nodes_.
+    ea::vector<ea::pair<Matrix3x4, Quaternion> > rootParentTransforms_;
+    /// Start index of each depth level in nodes_.
+    ea::vector<unsigned> levels_;
+    /// Update in progress flag.
+    bool updating_{};
+};
+
+}
@@ -53,6 +53,8 @@ public:
     void UpdateGeometry(const FrameInfo& frame) override;
     /// Return whether a geometry update is necessary, and if it can happen in a worker thread.
     UpdateGeometryType GetUpdateGeometryType() override;
+    /// Return whether the world bounding box depends on the view.
+    bool HasViewDependentBoundingBox() const override { return faceCameraMode_ != FC_NONE || fixedScreenSize_; }
 
     /// Set font by looking from resource cache by name and font size. Return true if successful.
     bool SetFont(const ea::string& fontName, float size = DEFAULT_FONT_SIZE);